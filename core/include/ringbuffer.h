@@ -150,6 +150,37 @@ int ringbuffer_peek_one(const ringbuffer_t *__restrict rb);
  */
 unsigned ringbuffer_peek(const ringbuffer_t *__restrict rb, char *buf, unsigned n);
 
+/**
+ * @brief           Get the contiguous readable part of the ringbuffer.
+ * @details         The elements stay in the ringbuffer, remove them with
+ *                  ringbuffer_remove() after processing them in place.
+ * @param[in]       rb     Ringbuffer to operate on.
+ * @param[out]      data   Start of the readable elements.
+ * @returns         Number of elements readable at @p data, may be less than
+ *                  the number of available elements if the content wraps around.
+ */
+unsigned ringbuffer_peek_span(const ringbuffer_t *__restrict rb, char **data);
+
+/**
+ * @brief           Get the contiguous free part of the ringbuffer.
+ * @details         Elements written to @p data are added to the ringbuffer
+ *                  with ringbuffer_commit_write(). This allows e.g. a DMA to fill
+ *                  the ringbuffer directly.
+ * @param[in]       rb     Ringbuffer to operate on.
+ * @param[out]      data   Start of the free space.
+ * @returns         Number of elements that can be written to @p data, may be
+ *                  less than ringbuffer_get_free() if the free space wraps around.
+ */
+unsigned ringbuffer_reserve_span(const ringbuffer_t *__restrict rb, char **data);
+
+/**
+ * @brief           Add elements written to a span from ringbuffer_reserve_span().
+ * @param[in,out]   rb     Ringbuffer to operate on.
+ * @param[in]       n      Number of elements written.
+ * @returns         Number of elements actually added.
+ */
+unsigned ringbuffer_commit_write(ringbuffer_t *__restrict rb, unsigned n);
+
 #ifdef __cplusplus
 }
 #endif
@@ -54,14 +54,26 @@ static char get_head(ringbuffer_t *restrict rb)
 
 unsigned ringbuffer_add(ringbuffer_t *restrict rb, const char *buf, unsigned n)
 {
-    unsigned i;
-    for (i = 0; i < n; i++) {
-        if (ringbuffer_full(rb)) {
-            break;
+    unsigned free = rb->size - rb->avail;
+    if (n > free) {
+        n = free;
+    }
+    if (n > 0) {
+        unsigned pos = rb->start + rb->avail;
+        if (pos >= rb->size) {
+            pos -= rb->size;
+        }
+        unsigned bytes_till_end = rb->size - pos;
+        if (bytes_till_end >= n) {
+            memcpy(rb->buf + pos, buf, n);
+        }
+        else {
+            memcpy(rb->buf + pos, buf, bytes_till_end);
+            memcpy(rb->buf, buf + bytes_till_end, n - bytes_till_end);
         }
-        add_tail(rb, buf[i]);
+        rb->avail += n;
     }
-    return i;
+    return n;
 }
 
 int ringbuffer_add_one(ringbuffer_t *restrict rb, char c)
@@ -112,17 +124,17 @@ unsigned ringbuffer_get(ringbuffer_t *restrict rb, char *buf, unsigned n)
 
 unsigned ringbuffer_remove(ringbuffer_t *restrict rb, unsigned n)
 {
-    if (n > rb->avail) {
+    if (n >= rb->avail) {
         n = rb->avail;
         rb->start = rb->avail = 0;
     }
     else {
-        rb->start -= n;
+        rb->start += n;
         rb->avail -= n;
 
-        /* compensate underflow */
-        if (rb->start > rb->size) {
-            rb->start += rb->size;
+        /* compensate overflow */
+        if (rb->start >= rb->size) {
+            rb->start -= rb->size;
         }
     }
 
@@ -140,3 +152,31 @@ unsigned ringbuffer_peek(const ringbuffer_t *restrict rb_, char *buf, unsigned n
     ringbuffer_t rb = *rb_;
     return ringbuffer_get(&rb, buf, n);
 }
+
+unsigned ringbuffer_peek_span(const ringbuffer_t *restrict rb, char **data)
+{
+    unsigned bytes_till_end = rb->size - rb->start;
+    *data = rb->buf + rb->start;
+    return (rb->avail < bytes_till_end) ? rb->avail : bytes_till_end;
+}
+
+unsigned ringbuffer_reserve_span(const ringbuffer_t *restrict rb, char **data)
+{
+    unsigned pos = rb->start + rb->avail;
+    if (pos >= rb->size) {
+        pos -= rb->size;
+    }
+    unsigned bytes_till_end = rb->size - pos;
+    unsigned free = rb->size - rb->avail;
+    *data = rb->buf + pos;
+    return (free < bytes_till_end) ? free : bytes_till_end;
+}
+
+unsigned ringbuffer_commit_write(ringbuffer_t *restrict rb, unsigned n)
+{
+    if (n > rb->size - rb->avail) {
+        n = rb->size - rb->avail;
+    }
+    rb->avail += n;
+    return n;
+}
@@ -22,20 +22,63 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #include "async_read.h"
+#include "irq.h"
 #include "native_internal.h"
 
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/**
+ * @brief   A registered file descriptor, unused slots have fd == -1
+ */
+typedef struct {
+    int fd;
+    void *arg;
+    native_async_read_callback_t cb;
+    unsigned long events;
+#ifdef __MACH__
+    pid_t sigio_child_pid;
+#endif
+} _async_read_t;
+
+static _async_read_t *_handlers;
+static int _numof;
 static int _next_index;
-static int _fds[ASYNC_READ_NUMOF];
-static void *_args[ASYNC_READ_NUMOF];
-static native_async_read_callback_t _native_async_read_callbacks[ASYNC_READ_NUMOF];
+
+#ifdef __linux__
+static int _epoll_fd = -1;
+#endif
 
 #ifdef __MACH__
-static pid_t _sigio_child_pids[ASYNC_READ_NUMOF];
-static void _sigio_child(int fd);
+static void _sigio_child(int index);
 #endif
 
+static void _dispatch(int index)
+{
+    _async_read_t *handler = &_handlers[index];
+
+    handler->events++;
+    handler->cb(handler->fd, handler->arg);
+}
+
+#ifdef __linux__
+static void _async_io_isr(void) {
+    /* room for every registered file descriptor, so a single call reports
+     * all ready ones: the set is level-triggered and the handlers do not
+     * drain their file descriptors, so calling again would not terminate */
+    struct epoll_event events[(_next_index > 0) ? _next_index : 1];
+    int n = epoll_wait(_epoll_fd, events, (_next_index > 0) ? _next_index : 1, 0);
+
+    for (int i = 0; i < n; i++) {
+        _dispatch(events[i].data.u32);
+    }
+}
+#else
 static void _async_io_isr(void) {
     fd_set rfds;
 
@@ -46,32 +89,60 @@ static void _async_io_isr(void) {
     struct timeval timeout = { .tv_usec = 0 };
 
     for (int i = 0; i < _next_index; i++) {
-        FD_SET(_fds[i], &rfds);
+        if (_handlers[i].fd < 0) {
+            continue;
+        }
 
-        if (max_fd < _fds[i]) {
-            max_fd = _fds[i];
+        FD_SET(_handlers[i].fd, &rfds);
+
+        if (max_fd < _handlers[i].fd) {
+            max_fd = _handlers[i].fd;
         }
     }
 
     if (real_select(max_fd + 1, &rfds, NULL, NULL, &timeout) > 0) {
         for (int i = 0; i < _next_index; i++) {
-            if (FD_ISSET(_fds[i], &rfds)) {
-                _native_async_read_callbacks[i](_fds[i], _args[i]);
+            if ((_handlers[i].fd >= 0) && FD_ISSET(_handlers[i].fd, &rfds)) {
+                _dispatch(i);
             }
         }
     }
 }
+#endif
 
 void native_async_read_setup(void) {
+#ifdef __linux__
+    if (_epoll_fd < 0) {
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll_fd == -1) {
+            err(EXIT_FAILURE, "native_async_read_setup(): epoll_create1");
+        }
+    }
+#endif
     register_interrupt(SIGIO, _async_io_isr);
 }
 
 void native_async_read_cleanup(void) {
     unregister_interrupt(SIGIO);
 
+    for (int i = 0; i < _next_index; i++) {
+        if (_handlers[i].fd >= 0) {
+            DEBUG("native_async_read: fd %d: %lu events\n", _handlers[i].fd,
+                  _handlers[i].events);
+        }
+    }
+
 #ifdef __MACH__
     for (int i = 0; i < _next_index; i++) {
-        kill(_sigio_child_pids[i], SIGKILL);
+        if (_handlers[i].fd >= 0) {
+            kill(_handlers[i].sigio_child_pid, SIGKILL);
+        }
+    }
+#endif
+#ifdef __linux__
+    if (_epoll_fd >= 0) {
+        real_close(_epoll_fd);
+        _epoll_fd = -1;
     }
 #endif
 }
@@ -80,27 +151,69 @@ void native_async_read_continue(int fd) {
     (void) fd;
 #ifdef __MACH__
     for (int i = 0; i < _next_index; i++) {
-        if (_fds[i] == fd) {
-            kill(_sigio_child_pids[i], SIGCONT);
+        if (_handlers[i].fd == fd) {
+            kill(_handlers[i].sigio_child_pid, SIGCONT);
         }
     }
 #endif
 }
 
-void native_async_read_add_handler(int fd, void *arg, native_async_read_callback_t handler) {
-    if (_next_index >= ASYNC_READ_NUMOF) {
-        err(EXIT_FAILURE, "native_async_read_add_handler(): too many callbacks");
+static int _find(int fd)
+{
+    for (int i = 0; i < _next_index; i++) {
+        if (_handlers[i].fd == fd) {
+            return i;
+        }
     }
+    return -1;
+}
+
+static int _alloc_index(void)
+{
+    int index = _find(-1);
+
+    if (index >= 0) {
+        return index;
+    }
+
+    if (_next_index >= _numof) {
+        int numof = _numof ? 2 * _numof : ASYNC_READ_NUMOF;
+        _async_read_t *handlers = real_realloc(_handlers,
+                                               numof * sizeof(_async_read_t));
+        if (handlers == NULL) {
+            err(EXIT_FAILURE, "native_async_read_add_handler(): realloc");
+        }
+        _handlers = handlers;
+        _numof = numof;
+    }
+
+    return _next_index++;
+}
 
-    _fds[_next_index] = fd;
-    _args[_next_index] = arg;
-    _native_async_read_callbacks[_next_index] = handler;
+void native_async_read_add_handler(int fd, void *arg, native_async_read_callback_t handler) {
+    /* the ISR must not see the table while it is resized */
+    unsigned state = irq_disable();
+    int index = _alloc_index();
+
+    _handlers[index] = (_async_read_t) {
+        .fd = fd,
+        .arg = arg,
+        .cb = handler,
+    };
+
+    irq_restore(state);
 
 #ifdef __MACH__
     /* tuntap signalled IO is not working in OSX,
      * * check http://sourceforge.net/p/tuntaposx/bugs/17/ */
-    _sigio_child(_next_index);
+    _sigio_child(index);
 #else
+#ifdef __linux__
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = index };
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        err(EXIT_FAILURE, "native_async_read_add_handler(): epoll_ctl");
+    }
+#endif
     /* configure fds to send signals on io */
     if (fcntl(fd, F_SETOWN, _native_pid) == -1) {
         err(EXIT_FAILURE, "native_async_read_add_handler(): fcntl(F_SETOWN)");
@@ -110,21 +223,42 @@ void native_async_read_add_handler(int fd, void *arg, native_async_read_callback
         err(EXIT_FAILURE, "native_async_read_add_handler(): fcntl(F_SETFL)");
     }
 #endif /* not OSX */
+}
+
+void native_async_read_remove_handler(int fd) {
+    unsigned state = irq_disable();
+    int index = _find(fd);
+
+    if (index >= 0) {
+#ifdef __MACH__
+        kill(_handlers[index].sigio_child_pid, SIGKILL);
+#endif
+#ifdef __linux__
+        epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+#endif
+        _handlers[index].fd = -1;
+    }
+
+    irq_restore(state);
+}
+
+unsigned long native_async_read_events(int fd) {
+    int index = _find(fd);
 
-    _next_index++;
+    return (index >= 0) ? _handlers[index].events : 0;
 }
 
 #ifdef __MACH__
 static void _sigio_child(int index)
 {
-    int fd = _fds[index];
+    int fd = _handlers[index].fd;
     pid_t parent = _native_pid;
     pid_t child;
     if ((child = real_fork()) == -1) {
         err(EXIT_FAILURE, "sigio_child: fork");
     }
     if (child > 0) {
-        _sigio_child_pids[index] = child;
+        _handlers[index].sigio_child_pid = child;
 
         /* return in parent process */
         return;
@@ -23,7 +23,10 @@ extern "C" {
 #endif
 
 /**
- * @brief   Maximum number of file descriptors
+ * @brief   Initial number of file descriptors to allocate room for
+ *
+ * The table of file descriptors starts with this many entries and doubles
+ * whenever it is full.
  */
 #ifndef ASYNC_READ_NUMOF
 #define ASYNC_READ_NUMOF 2
@@ -37,7 +40,9 @@ typedef void (*native_async_read_callback_t)(int fd, void *arg);
 /**
  * @brief   initialize asynchronus read system
  *
- * This registers SIGIO signal handler.
+ * This registers SIGIO signal handler. On Linux, the registered file
+ * descriptors are kept in an epoll instance, so a signal only dispatches the
+ * callbacks of ready file descriptors instead of polling all of them.
  */
 void native_async_read_setup(void);
 
@@ -67,6 +72,22 @@ void native_async_read_continue(int fd);
  */
 void native_async_read_add_handler(int fd, void *arg, native_async_read_callback_t handler);
 
+/**
+ * @brief   stop monitoring of file descriptor
+ *
+ * @param[in] fd  The file descriptor to stop monitoring
+ */
+void native_async_read_remove_handler(int fd);
+
+/**
+ * @brief   get the number of times the callback of a file descriptor ran
+ *
+ * @param[in] fd  The monitored file descriptor
+ *
+ * @return  number of dispatched events, 0 if @p fd is not monitored
+ */
+unsigned long native_async_read_events(int fd);
+
 #ifdef __cplusplus
 }
 #endif
@@ -153,6 +153,7 @@ extern pid_t _native_pid;
 extern pid_t _native_id;
 extern unsigned _native_rng_seed;
 extern int _native_rng_mode; /**< 0 = /dev/random, 1 = random(3) */
+extern int _native_virtual_time; /**< 1 = skip idle time, see native_timer_skip() */
 extern const char *_native_unix_socket_path;
 
 ssize_t _native_read(int fd, void *buf, size_t count);
@@ -169,6 +170,14 @@ int register_interrupt(int sig, _native_callback_t handler);
  */
 int unregister_interrupt(int sig);
 
+/**
+ * advance the timer to the earliest armed channel (virtual time mode)
+ *
+ * Must be called with interrupts disabled. Returns 1 if a channel is armed,
+ * its timer interrupt is due then.
+ */
+int native_timer_skip(void);
+
 //#include <sys/param.h>
 
 #ifdef __cplusplus
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @ingroup     netdev2
+ * @brief       IEEE 802.15.4 pseudo device for native that replays and
+ *              captures pcap files
+ * @{
+ *
+ * @file
+ * @brief       Definitions for @ref netdev2 pcap replay and capture driver
+ *
+ * Frames of a pcap file given with `-r <file>` are received by the device,
+ * either back to back as fast as the network stack takes them (the default)
+ * or at the time offsets recorded in the file (`-t`). This makes the whole
+ * RX path measurable on captured traffic. Frames sent by the device are
+ * written to the pcap file given with `-w <file>`.
+ *
+ * Supported link types are IEEE 802.15.4 with (195) and without FCS (230),
+ * written files use the latter. The device does not filter frames by
+ * address, so set its addresses to the destination of the captured traffic.
+ * When the replay ends, the number of frames and the reached frame rate are
+ * printed.
+ */
+#ifndef NETDEV2_PCAP_H
+#define NETDEV2_PCAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "net/ieee802154.h"
+#include "net/netdev2.h"
+#include "net/netdev2/ieee802154.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Delay between the initialization of the device and the first
+ *          replayed frame in microseconds
+ *
+ * Gives the network stack time to configure the interface.
+ */
+#ifndef NETDEV2_PCAP_START_DELAY
+#define NETDEV2_PCAP_START_DELAY    (1U * SEC_IN_USEC)
+#endif
+
+/**
+ * @brief   Delay in microseconds after which the event for the next frame is
+ *          posted again if the first one was lost
+ *
+ * The event is lost if the message queue of the network interface is full,
+ * e.g. while the stack is busy with the frames replayed before.
+ */
+#ifndef NETDEV2_PCAP_RETRY_DELAY
+#define NETDEV2_PCAP_RETRY_DELAY    (10U * MS_IN_USEC)
+#endif
+
+/**
+ * @brief   pcap device state
+ */
+typedef struct {
+    netdev2_ieee802154_t netdev;        /**< netdev2 parent struct */
+    const char *rx_file;                /**< file to replay, may be NULL */
+    const char *tx_file;                /**< file to capture to, may be NULL */
+    bool timed;                         /**< replay at recorded times */
+    int rx_fd;                          /**< host fd of netdev2_pcap_t::rx_file */
+    int tx_fd;                          /**< host fd of netdev2_pcap_t::tx_file */
+    bool rx_swapped;                    /**< replayed file has other byte order */
+    bool rx_nsec;                       /**< replayed file has ns timestamps */
+    bool rx_fcs;                        /**< replayed frames end with FCS */
+    uint8_t rx_len;                     /**< length of the buffered frame */
+    uint8_t rx_buf[IEEE802154_FRAME_LEN_MAX]; /**< next frame to receive */
+    uint64_t rx_ts;                     /**< recorded time of the buffered frame */
+    uint64_t rx_ts_first;               /**< recorded time of the first frame */
+    uint64_t rx_start;                  /**< host time of the first frame */
+    uint32_t rx_count;                  /**< number of replayed frames */
+    xtimer_t timer;                     /**< schedules the next frame */
+} netdev2_pcap_t;
+
+/**
+ * @brief   pcap initialization parameters
+ */
+typedef struct {
+    const char *rx_file;                /**< file to replay, may be NULL */
+    const char *tx_file;                /**< file to capture to, may be NULL */
+    bool timed;                         /**< replay at recorded times */
+} netdev2_pcap_params_t;
+
+/**
+ * @brief   global device struct, only one pcap device per process is supported
+ */
+extern netdev2_pcap_t netdev2_pcap;
+
+/**
+ * @brief   Setup netdev2_pcap_t structure
+ *
+ * @param[out] dev      the preallocated device handle to setup
+ * @param[in]  params   initialization parameters
+ */
+void netdev2_pcap_setup(netdev2_pcap_t *dev, const netdev2_pcap_params_t *params);
+
+/**
+ * @brief   Close the pcap files
+ *
+ * @param[in] dev       the device to cleanup
+ */
+void netdev2_pcap_cleanup(netdev2_pcap_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif /* NETDEV2_PCAP_H */
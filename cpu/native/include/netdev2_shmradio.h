@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @ingroup     netdev2
+ * @brief       Simulated IEEE 802.15.4 radio for native on a shared memory
+ *              medium
+ * @{
+ *
+ * @file
+ * @brief       Definitions for @ref netdev2 IEEE 802.15.4 driver for a
+ *              medium shared by many native processes
+ *
+ * All native processes started with the same `-m <medium>` argument attach
+ * to one POSIX shared memory object, which holds a broadcast ring of
+ * IEEE 802.15.4 frames (without FCS) and a link matrix. Sending a frame
+ * copies it into the next ring slot and signals the processes in range,
+ * receiving copies it from the ring into the packet buffer. No root
+ * privileges, TAP devices or bridges are needed.
+ *
+ * The link matrix gives the loss rate in percent and the latency in
+ * milliseconds for every pair of nodes and thereby the topology: a loss
+ * rate of 100 means the nodes are out of range. A freshly created medium
+ * is fully connected without loss and latency. Any node may change the
+ * matrix with netdev2_shmradio_set_link().
+ *
+ * Frames are delivered in the order they were sent. The latency uses the
+ * host clock, so it is not meaningful together with native's virtual time.
+ */
+#ifndef NETDEV2_SHMRADIO_H
+#define NETDEV2_SHMRADIO_H
+
+#include <stdint.h>
+
+#include "net/netdev2.h"
+#include "net/netdev2/ieee802154.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum number of nodes attached to a medium
+ */
+#ifndef NETDEV2_SHMRADIO_NODES_MAX
+#define NETDEV2_SHMRADIO_NODES_MAX      (256U)
+#endif
+
+/**
+ * @brief   Number of frames in the ring of a medium
+ *
+ * A node which falls behind by more frames loses the oldest ones.
+ */
+#ifndef NETDEV2_SHMRADIO_SLOTS
+#define NETDEV2_SHMRADIO_SLOTS          (1024U)
+#endif
+
+/**
+ * @brief   Loss rate of a link between two nodes out of range
+ */
+#define NETDEV2_SHMRADIO_NO_LINK        (100U)
+
+/**
+ * @brief   Shared memory layout of a medium, defined by the driver
+ */
+typedef struct netdev2_shmradio_medium netdev2_shmradio_medium_t;
+
+/**
+ * @brief   shmradio device state
+ */
+typedef struct {
+    netdev2_ieee802154_t netdev;        /**< netdev2 parent struct */
+    const char *medium_name;            /**< name of the shared memory object */
+    netdev2_shmradio_medium_t *medium;  /**< the attached medium */
+    unsigned node;                      /**< own index in the link matrix */
+    uint32_t rx_next;                   /**< number of the next frame to read */
+    uint32_t rx_slot;                   /**< slot of the frame to receive */
+    uint32_t rx_lost;                   /**< frames overwritten before read */
+    xtimer_t latency_timer;             /**< delays frames of slow links */
+} netdev2_shmradio_t;
+
+/**
+ * @brief   shmradio initialization parameters
+ */
+typedef struct {
+    const char *medium_name;            /**< name of the shared memory object */
+} netdev2_shmradio_params_t;
+
+/**
+ * @brief   global device struct, only one shmradio per process is supported
+ */
+extern netdev2_shmradio_t netdev2_shmradio;
+
+/**
+ * @brief   Setup netdev2_shmradio_t structure
+ *
+ * @param[out] dev      the preallocated device handle to setup
+ * @param[in]  params   initialization parameters
+ */
+void netdev2_shmradio_setup(netdev2_shmradio_t *dev,
+                            const netdev2_shmradio_params_t *params);
+
+/**
+ * @brief   Configure the link between two nodes of the medium
+ *
+ * @param[in] dev       an initialized device attached to the medium
+ * @param[in] src       index of the sending node
+ * @param[in] dst       index of the receiving node
+ * @param[in] loss      loss rate in percent, NETDEV2_SHMRADIO_NO_LINK to
+ *                      take @p dst out of range of @p src
+ * @param[in] latency   latency in milliseconds
+ *
+ * @return  0 on success
+ * @return  -EINVAL if a node index is out of range
+ */
+int netdev2_shmradio_set_link(netdev2_shmradio_t *dev, unsigned src,
+                              unsigned dst, uint8_t loss, uint16_t latency);
+
+/**
+ * @brief   Detach from the medium
+ *
+ * @param[in] dev       the device to cleanup
+ */
+void netdev2_shmradio_cleanup(netdev2_shmradio_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif /* NETDEV2_SHMRADIO_H */
@@ -47,6 +47,7 @@
  */
 #define TIMER_NUMOF        (1U)
 #define TIMER_0_EN         1
+#define TIMER_0_CHANNELS   (4U)
 
 /**
  * @brief xtimer configuration
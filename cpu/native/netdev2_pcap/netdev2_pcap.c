@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/*
+ * @ingroup netdev2
+ * @{
+ * @brief   pcap file replay and capture as IEEE 802.15.4 device
+ * @}
+ */
+#include <assert.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "native_internal.h"
+
+#include "byteorder.h"
+#include "net/netopt.h"
+#include "netdev2_pcap.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define _MAX_MHR_OVERHEAD   (25)
+
+#define _PCAP_MAGIC         (0xa1b2c3d4)    /**< microsecond timestamps */
+#define _PCAP_MAGIC_NSEC    (0xa1b23c4d)    /**< nanosecond timestamps */
+#define _LINKTYPE_FCS       (195)           /**< IEEE802_15_4_WITHFCS */
+#define _LINKTYPE_NOFCS     (230)           /**< IEEE802_15_4_NOFCS */
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+} _pcap_hdr_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t ts_sec;
+    uint32_t ts_frac;
+    uint32_t incl_len;
+    uint32_t orig_len;
+} _pcap_rec_t;
+
+/* support one pcap interface for now */
+netdev2_pcap_t netdev2_pcap;
+
+static int _init(netdev2_t *netdev);
+static int _send(netdev2_t *netdev, const struct iovec *vector, unsigned n);
+static int _recv(netdev2_t *netdev, void *buf, size_t len, void *info);
+static void _isr(netdev2_t *netdev);
+static int _get(netdev2_t *netdev, netopt_t opt, void *value, size_t max_len);
+static int _set(netdev2_t *netdev, netopt_t opt, void *value, size_t value_len);
+
+static const netdev2_driver_t netdev2_driver_pcap = {
+    .send = _send,
+    .recv = _recv,
+    .init = _init,
+    .isr = _isr,
+    .get = _get,
+    .set = _set,
+};
+
+static uint64_t _now_us(void)
+{
+    struct timespec ts;
+
+    real_clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * SEC_IN_USEC + ts.tv_nsec / 1000;
+}
+
+/* posts the event for the next frame, and posts it again until _isr() runs */
+static void _post_isr(netdev2_pcap_t *dev)
+{
+    xtimer_set(&dev->timer, NETDEV2_PCAP_RETRY_DELAY);
+    dev->netdev.netdev.event_callback(&dev->netdev.netdev, NETDEV2_EVENT_ISR);
+}
+
+static void _timer_cb(void *arg)
+{
+    _post_isr(arg);
+}
+
+static inline uint32_t _rx_u32(netdev2_pcap_t *dev, uint32_t val)
+{
+    return dev->rx_swapped ? byteorder_swapl(val) : val;
+}
+
+static int _read_full(int fd, void *buf, size_t len)
+{
+    uint8_t *pos = buf;
+
+    while (len) {
+        ssize_t res = real_read(fd, pos, len);
+        if (res <= 0) {
+            return -1;
+        }
+        pos += res;
+        len -= res;
+    }
+    return 0;
+}
+
+static void _open_rx(netdev2_pcap_t *dev)
+{
+    _pcap_hdr_t hdr;
+
+    dev->rx_fd = real_open(dev->rx_file, O_RDONLY);
+    if (dev->rx_fd == -1) {
+        err(EXIT_FAILURE, "netdev2_pcap: open(%s)", dev->rx_file);
+    }
+    if (_read_full(dev->rx_fd, &hdr, sizeof(hdr)) < 0) {
+        errx(EXIT_FAILURE, "netdev2_pcap: %s: no pcap header", dev->rx_file);
+    }
+
+    switch (hdr.magic) {
+        case _PCAP_MAGIC:
+            break;
+        case _PCAP_MAGIC_NSEC:
+            dev->rx_nsec = true;
+            break;
+        default:
+            dev->rx_swapped = true;
+            if (byteorder_swapl(hdr.magic) == _PCAP_MAGIC_NSEC) {
+                dev->rx_nsec = true;
+            }
+            else if (byteorder_swapl(hdr.magic) != _PCAP_MAGIC) {
+                errx(EXIT_FAILURE, "netdev2_pcap: %s: not a pcap file",
+                     dev->rx_file);
+            }
+            break;
+    }
+
+    switch (_rx_u32(dev, hdr.network)) {
+        case _LINKTYPE_FCS:
+            dev->rx_fcs = true;
+            break;
+        case _LINKTYPE_NOFCS:
+            break;
+        default:
+            errx(EXIT_FAILURE, "netdev2_pcap: %s: link type %u not supported",
+                 dev->rx_file, (unsigned)_rx_u32(dev, hdr.network));
+    }
+}
+
+static void _open_tx(netdev2_pcap_t *dev)
+{
+    _pcap_hdr_t hdr = {
+        .magic = _PCAP_MAGIC,
+        .version_major = 2,
+        .version_minor = 4,
+        .snaplen = IEEE802154_FRAME_LEN_MAX,
+        .network = _LINKTYPE_NOFCS,
+    };
+
+    dev->tx_fd = real_open(dev->tx_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (dev->tx_fd == -1) {
+        err(EXIT_FAILURE, "netdev2_pcap: open(%s)", dev->tx_file);
+    }
+    if (real_write(dev->tx_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        err(EXIT_FAILURE, "netdev2_pcap: write(%s)", dev->tx_file);
+    }
+}
+
+/* reads the next frame of a supported size into the RX buffer */
+static int _read_frame(netdev2_pcap_t *dev)
+{
+    _pcap_rec_t rec;
+
+    while (_read_full(dev->rx_fd, &rec, sizeof(rec)) == 0) {
+        uint32_t len = _rx_u32(dev, rec.incl_len);
+        uint32_t frac = _rx_u32(dev, rec.ts_frac);
+
+        if (dev->rx_nsec) {
+            frac /= 1000;
+        }
+        dev->rx_ts = (uint64_t)_rx_u32(dev, rec.ts_sec) * SEC_IN_USEC + frac;
+
+        if ((len <= IEEE802154_FRAME_LEN_MAX) &&
+            (!dev->rx_fcs || (len > IEEE802154_FCS_LEN))) {
+            if (_read_full(dev->rx_fd, dev->rx_buf, len) < 0) {
+                break;
+            }
+            dev->rx_len = dev->rx_fcs ? len - IEEE802154_FCS_LEN : len;
+            return 0;
+        }
+
+        DEBUG("netdev2_pcap: skipping frame of %u byte\n", (unsigned)len);
+        if (lseek(dev->rx_fd, len, SEEK_CUR) == -1) {
+            break;
+        }
+    }
+
+    return -1;
+}
+
+static void _replay_done(netdev2_pcap_t *dev)
+{
+    uint64_t duration = _now_us() - dev->rx_start;
+
+    real_close(dev->rx_fd);
+    dev->rx_fd = -1;
+    real_printf("netdev2_pcap: replayed %" PRIu32 " frames in %" PRIu64
+                " us (%" PRIu64 " frames/s)\n", dev->rx_count, duration,
+                duration ? (uint64_t)dev->rx_count * SEC_IN_USEC / duration : 0);
+}
+
+static int _init(netdev2_t *netdev)
+{
+    netdev2_pcap_t *dev = (netdev2_pcap_t *)netdev;
+
+    if (dev->rx_file) {
+        _open_rx(dev);
+    }
+    if (dev->tx_file) {
+        _open_tx(dev);
+    }
+
+    static const uint8_t long_addr[] = { 0x02, 'p', 'c', 'a', 'p', 0, 0, 1 };
+    memcpy(dev->netdev.long_addr, long_addr, sizeof(long_addr));
+    dev->netdev.short_addr[0] = 0;
+    dev->netdev.short_addr[1] = 1;
+    dev->netdev.pan = IEEE802154_DEFAULT_PANID;
+    dev->netdev.chan = IEEE802154_DEFAULT_CHANNEL;
+    dev->netdev.seq = 0;
+    dev->netdev.flags = 0;
+#ifdef MODULE_GNRC_SIXLOWPAN
+    dev->netdev.proto = GNRC_NETTYPE_SIXLOWPAN;
+#elif MODULE_GNRC
+    dev->netdev.proto = GNRC_NETTYPE_UNDEF;
+#endif
+
+#ifdef MODULE_NETSTATS_L2
+    memset(&netdev->stats, 0, sizeof(netstats_t));
+#endif
+
+    if (dev->rx_fd != -1) {
+        dev->timer.callback = _timer_cb;
+        dev->timer.arg = dev;
+        xtimer_set(&dev->timer, NETDEV2_PCAP_START_DELAY);
+    }
+    return 0;
+}
+
+static int _send(netdev2_t *netdev, const struct iovec *vector, unsigned n)
+{
+    netdev2_pcap_t *dev = (netdev2_pcap_t *)netdev;
+    struct iovec iov[n + 1];
+    _pcap_rec_t rec;
+    struct timespec ts;
+    size_t len = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        len += vector[i].iov_len;
+        iov[i + 1] = vector[i];
+    }
+    if (len > IEEE802154_FRAME_LEN_MAX - IEEE802154_FCS_LEN) {
+        return -EOVERFLOW;
+    }
+
+    if (dev->tx_fd != -1) {
+        real_clock_gettime(CLOCK_REALTIME, &ts);
+        rec.ts_sec = ts.tv_sec;
+        rec.ts_frac = ts.tv_nsec / 1000;
+        rec.incl_len = len;
+        rec.orig_len = len;
+        iov[0].iov_base = &rec;
+        iov[0].iov_len = sizeof(rec);
+        _native_writev(dev->tx_fd, iov, n + 1);
+    }
+
+#ifdef MODULE_NETSTATS_L2
+    netdev->stats.tx_bytes += len;
+#endif
+    if (netdev->event_callback) {
+        netdev->event_callback(netdev, NETDEV2_EVENT_TX_COMPLETE);
+    }
+    return len;
+}
+
+static void _isr(netdev2_t *netdev)
+{
+    netdev2_pcap_t *dev = (netdev2_pcap_t *)netdev;
+
+    if (dev->rx_fd == -1) {
+        return;
+    }
+    /* the event got through, no need to post it again */
+    xtimer_remove(&dev->timer);
+
+    /* the buffer is empty unless the frame waits for its recorded time */
+    if (dev->rx_len == 0) {
+        if (_read_frame(dev) < 0) {
+            _replay_done(dev);
+            return;
+        }
+        if (dev->rx_count == 0) {
+            dev->rx_start = _now_us();
+            dev->rx_ts_first = dev->rx_ts;
+        }
+    }
+
+    if (dev->timed) {
+        uint64_t due = dev->rx_start + (dev->rx_ts - dev->rx_ts_first);
+        uint64_t now = _now_us();
+        if ((dev->rx_ts > dev->rx_ts_first) && (due > now)) {
+            xtimer_set(&dev->timer, due - now);
+            return;
+        }
+    }
+
+    dev->rx_count++;
+    netdev->event_callback(netdev, NETDEV2_EVENT_RX_COMPLETE);
+    dev->rx_len = 0;
+
+    /* queue the next frame behind the messages already waiting */
+    _post_isr(dev);
+}
+
+static int _recv(netdev2_t *netdev, void *buf, size_t len, void *info)
+{
+    netdev2_pcap_t *dev = (netdev2_pcap_t *)netdev;
+
+    if (!buf) {
+        if (len > 0) {
+            /* drop the frame */
+            return 0;
+        }
+        return dev->rx_len;
+    }
+    if (len < dev->rx_len) {
+        return -ENOBUFS;
+    }
+
+    memcpy(buf, dev->rx_buf, dev->rx_len);
+    if (info) {
+        netdev2_ieee802154_rx_info_t *radio_info = info;
+        radio_info->rssi = 0;
+        radio_info->lqi = UINT8_MAX;
+    }
+#ifdef MODULE_NETSTATS_L2
+    netdev->stats.rx_count++;
+    netdev->stats.rx_bytes += dev->rx_len;
+#endif
+    return dev->rx_len;
+}
+
+static int _get(netdev2_t *netdev, netopt_t opt, void *value, size_t max_len)
+{
+    netdev2_pcap_t *dev = (netdev2_pcap_t *)netdev;
+
+    switch (opt) {
+        case NETOPT_MAX_PACKET_SIZE:
+            assert(max_len >= sizeof(uint16_t));
+            *((uint16_t *)value) = IEEE802154_FRAME_LEN_MAX -
+                                   IEEE802154_FCS_LEN - _MAX_MHR_OVERHEAD;
+            return sizeof(uint16_t);
+        case NETOPT_STATE:
+            assert(max_len >= sizeof(netopt_state_t));
+            *((netopt_state_t *)value) = NETOPT_STATE_IDLE;
+            return sizeof(netopt_state_t);
+        default:
+            return netdev2_ieee802154_get(&dev->netdev, opt, value, max_len);
+    }
+}
+
+static int _set(netdev2_t *netdev, netopt_t opt, void *value, size_t value_len)
+{
+    netdev2_pcap_t *dev = (netdev2_pcap_t *)netdev;
+
+    switch (opt) {
+        case NETOPT_STATE:
+            return sizeof(netopt_state_t);
+        default:
+            return netdev2_ieee802154_set(&dev->netdev, opt, value, value_len);
+    }
+}
+
+void netdev2_pcap_setup(netdev2_pcap_t *dev, const netdev2_pcap_params_t *params)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->netdev.netdev.driver = &netdev2_driver_pcap;
+    dev->rx_file = params->rx_file;
+    dev->tx_file = params->tx_file;
+    dev->timed = params->timed;
+    dev->rx_fd = -1;
+    dev->tx_fd = -1;
+}
+
+void netdev2_pcap_cleanup(netdev2_pcap_t *dev)
+{
+    if (!dev) {
+        return;
+    }
+
+    if (dev->rx_fd != -1) {
+        real_close(dev->rx_fd);
+        dev->rx_fd = -1;
+    }
+    if (dev->tx_fd != -1) {
+        real_close(dev->tx_fd);
+        dev->tx_fd = -1;
+    }
+}
@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/*
+ * @ingroup netdev2
+ * @{
+ * @brief   Simulated IEEE 802.15.4 radio on a shared memory medium
+ * @}
+ */
+#include <assert.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "native_internal.h"
+
+#include "byteorder.h"
+#include "net/ieee802154.h"
+#include "net/netdev2.h"
+#include "net/netdev2/ieee802154.h"
+#include "net/netopt.h"
+#include "netdev2_shmradio.h"
+#include "random.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define _MAX_MHR_OVERHEAD   (25)
+#define _FRAME_LEN_MAX      (IEEE802154_FRAME_LEN_MAX - IEEE802154_FCS_LEN)
+
+/* signal used to notify the nodes in range of a new frame */
+#define _SIG_RX             (SIGUSR2)
+
+/**
+ * @brief   A frame in the ring of the medium
+ *
+ * seq is the number of the frame + 1 once it is completely written, 0 while
+ * it is written.
+ */
+typedef struct {
+    uint32_t seq;
+    uint16_t src;
+    uint8_t chan;
+    uint8_t len;
+    uint64_t sent_ms;
+    uint8_t psdu[_FRAME_LEN_MAX];
+} _frame_t;
+
+struct netdev2_shmradio_medium {
+    uint32_t head;                      /* number of frames ever sent */
+    pid_t pids[NETDEV2_SHMRADIO_NODES_MAX];
+    uint8_t loss[NETDEV2_SHMRADIO_NODES_MAX][NETDEV2_SHMRADIO_NODES_MAX];
+    uint16_t latency[NETDEV2_SHMRADIO_NODES_MAX][NETDEV2_SHMRADIO_NODES_MAX];
+    _frame_t frames[NETDEV2_SHMRADIO_SLOTS];
+};
+
+/* support one shmradio interface for now */
+netdev2_shmradio_t netdev2_shmradio;
+
+static int _init(netdev2_t *netdev);
+static int _send(netdev2_t *netdev, const struct iovec *vector, unsigned n);
+static int _recv(netdev2_t *netdev, void *buf, size_t len, void *info);
+static void _isr(netdev2_t *netdev);
+static int _get(netdev2_t *netdev, netopt_t opt, void *value, size_t max_len);
+static int _set(netdev2_t *netdev, netopt_t opt, void *value, size_t value_len);
+
+static const netdev2_driver_t netdev2_driver_shmradio = {
+    .send = _send,
+    .recv = _recv,
+    .init = _init,
+    .isr = _isr,
+    .get = _get,
+    .set = _set,
+};
+
+static uint64_t _now_ms(void)
+{
+    struct timespec ts;
+
+    real_clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void _signal_isr(netdev2_shmradio_t *dev)
+{
+    netdev2_t *netdev = (netdev2_t *)dev;
+
+    if (netdev->event_callback) {
+        netdev->event_callback(netdev, NETDEV2_EVENT_ISR);
+    }
+}
+
+static void _rx_signal(void)
+{
+    _signal_isr(&netdev2_shmradio);
+}
+
+static void _latency_cb(void *arg)
+{
+    _signal_isr(arg);
+}
+
+static int _attach(netdev2_shmradio_t *dev)
+{
+    int fd = shm_open(dev->medium_name, O_RDWR | O_CREAT, 0600);
+
+    if (fd == -1) {
+        err(EXIT_FAILURE, "netdev2_shmradio: shm_open(%s)", dev->medium_name);
+    }
+    /* a new object is zero filled, i.e. fully connected without loss */
+    if (ftruncate(fd, sizeof(netdev2_shmradio_medium_t)) == -1) {
+        err(EXIT_FAILURE, "netdev2_shmradio: ftruncate");
+    }
+    dev->medium = mmap(NULL, sizeof(netdev2_shmradio_medium_t),
+                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    real_close(fd);
+    if (dev->medium == MAP_FAILED) {
+        err(EXIT_FAILURE, "netdev2_shmradio: mmap");
+    }
+
+    /* claim a free node index, also reclaim those of dead processes */
+    for (unsigned i = 0; i < NETDEV2_SHMRADIO_NODES_MAX; i++) {
+        pid_t pid = __atomic_load_n(&dev->medium->pids[i], __ATOMIC_ACQUIRE);
+
+        if ((pid != 0) && ((kill(pid, 0) == 0) || (errno != ESRCH))) {
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&dev->medium->pids[i], &pid,
+                                        _native_pid, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE)) {
+            dev->node = i;
+            dev->rx_next = __atomic_load_n(&dev->medium->head, __ATOMIC_ACQUIRE);
+            return 0;
+        }
+    }
+
+    return -ENOSPC;
+}
+
+static int _init(netdev2_t *netdev)
+{
+    netdev2_shmradio_t *dev = (netdev2_shmradio_t *)netdev;
+
+    if (_attach(dev) < 0) {
+        errx(EXIT_FAILURE, "netdev2_shmradio: medium %s is full",
+             dev->medium_name);
+    }
+    DEBUG("netdev2_shmradio: attached to %s as node %u\n", dev->medium_name,
+          dev->node);
+
+    /* addresses derived from the node index, so they are reproducible */
+    uint8_t long_addr[] = { 0x02, 'R', 'I', 'O', 'T', 0,
+                            dev->node >> 8, dev->node & 0xff };
+    memcpy(dev->netdev.long_addr, long_addr, sizeof(long_addr));
+    dev->netdev.short_addr[0] = dev->node >> 8;
+    dev->netdev.short_addr[1] = dev->node & 0xff;
+    dev->netdev.pan = IEEE802154_DEFAULT_PANID;
+    dev->netdev.chan = IEEE802154_DEFAULT_CHANNEL;
+    dev->netdev.seq = 0;
+    dev->netdev.flags = 0;
+#ifdef MODULE_GNRC_SIXLOWPAN
+    dev->netdev.proto = GNRC_NETTYPE_SIXLOWPAN;
+#elif MODULE_GNRC
+    dev->netdev.proto = GNRC_NETTYPE_UNDEF;
+#endif
+    dev->latency_timer.callback = _latency_cb;
+    dev->latency_timer.arg = dev;
+
+    register_interrupt(_SIG_RX, _rx_signal);
+
+#ifdef MODULE_NETSTATS_L2
+    memset(&netdev->stats, 0, sizeof(netstats_t));
+#endif
+    return 0;
+}
+
+static int _send(netdev2_t *netdev, const struct iovec *vector, unsigned n)
+{
+    netdev2_shmradio_t *dev = (netdev2_shmradio_t *)netdev;
+    netdev2_shmradio_medium_t *medium = dev->medium;
+    size_t len = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        len += vector[i].iov_len;
+    }
+    if (len > _FRAME_LEN_MAX) {
+        return -EOVERFLOW;
+    }
+
+    uint32_t num = __atomic_fetch_add(&medium->head, 1, __ATOMIC_ACQ_REL);
+    _frame_t *frame = &medium->frames[num % NETDEV2_SHMRADIO_SLOTS];
+
+    /* invalidate the slot for readers of the frame overwritten now */
+    __atomic_store_n(&frame->seq, 0, __ATOMIC_RELEASE);
+    frame->src = dev->node;
+    frame->chan = dev->netdev.chan;
+    frame->len = len;
+    frame->sent_ms = _now_ms();
+    uint8_t *pos = frame->psdu;
+    for (unsigned i = 0; i < n; i++) {
+        memcpy(pos, vector[i].iov_base, vector[i].iov_len);
+        pos += vector[i].iov_len;
+    }
+    __atomic_store_n(&frame->seq, num + 1, __ATOMIC_RELEASE);
+
+    /* wake up the nodes in range */
+    for (unsigned i = 0; i < NETDEV2_SHMRADIO_NODES_MAX; i++) {
+        pid_t pid = __atomic_load_n(&medium->pids[i], __ATOMIC_ACQUIRE);
+        if ((pid != 0) && (i != dev->node) &&
+            (medium->loss[dev->node][i] < NETDEV2_SHMRADIO_NO_LINK)) {
+            kill(pid, _SIG_RX);
+        }
+    }
+
+#ifdef MODULE_NETSTATS_L2
+    netdev->stats.tx_bytes += len;
+#endif
+    if (netdev->event_callback) {
+        netdev->event_callback(netdev, NETDEV2_EVENT_TX_COMPLETE);
+    }
+    return len;
+}
+
+/* checks address and PAN like a radio's frame filter does */
+static bool _accept(netdev2_shmradio_t *dev, const _frame_t *frame)
+{
+    uint8_t dst[IEEE802154_LONG_ADDRESS_LEN];
+    le_uint16_t dst_pan;
+    int dst_len;
+
+    if (dev->netdev.flags & NETDEV2_IEEE802154_RAW) {
+        return true;
+    }
+
+    dst_len = ieee802154_get_dst(frame->psdu, dst, &dst_pan);
+    if (dst_len <= 0) {
+        /* no destination, e.g. a beacon */
+        return dst_len == 0;
+    }
+    uint16_t pan = byteorder_ntohs(byteorder_ltobs(dst_pan));
+    if ((pan != dev->netdev.pan) && (pan != 0xffff)) {
+        return false;
+    }
+    if (dst_len == IEEE802154_SHORT_ADDRESS_LEN) {
+        return (memcmp(dst, ieee802154_addr_bcast, dst_len) == 0) ||
+               (memcmp(dst, dev->netdev.short_addr, dst_len) == 0);
+    }
+    return memcmp(dst, dev->netdev.long_addr, dst_len) == 0;
+}
+
+static void _isr(netdev2_t *netdev)
+{
+    netdev2_shmradio_t *dev = (netdev2_shmradio_t *)netdev;
+    netdev2_shmradio_medium_t *medium = dev->medium;
+    uint32_t head = __atomic_load_n(&medium->head, __ATOMIC_ACQUIRE);
+
+    while (dev->rx_next != head) {
+        uint32_t slot = dev->rx_next % NETDEV2_SHMRADIO_SLOTS;
+        _frame_t *frame = &medium->frames[slot];
+        uint32_t seq = __atomic_load_n(&frame->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == 0 || (int32_t)(seq - (dev->rx_next + 1)) < 0) {
+            /* still being written, its sender signals once it is done */
+            break;
+        }
+        if (seq != dev->rx_next + 1) {
+            /* overwritten, we fell behind by a whole ring */
+            dev->rx_lost++;
+            dev->rx_next++;
+            continue;
+        }
+
+        unsigned src = frame->src;
+        if ((src == dev->node) || (frame->chan != dev->netdev.chan) ||
+            (medium->loss[src][dev->node] >= NETDEV2_SHMRADIO_NO_LINK)) {
+            dev->rx_next++;
+            continue;
+        }
+
+        uint64_t due = frame->sent_ms + medium->latency[src][dev->node];
+        uint64_t now = _now_ms();
+        if (due > now) {
+            /* keep the order of the frames, wait for this one */
+            xtimer_set(&dev->latency_timer, (due - now) * MS_IN_USEC);
+            break;
+        }
+
+        dev->rx_next++;
+        if ((medium->loss[src][dev->node] > 0) &&
+            ((random_uint32() % 100) < medium->loss[src][dev->node])) {
+            continue;
+        }
+        if (!_accept(dev, frame)) {
+            continue;
+        }
+
+        dev->rx_slot = slot;
+        netdev->event_callback(netdev, NETDEV2_EVENT_RX_COMPLETE);
+    }
+}
+
+static int _recv(netdev2_t *netdev, void *buf, size_t len, void *info)
+{
+    netdev2_shmradio_t *dev = (netdev2_shmradio_t *)netdev;
+    _frame_t *frame = &dev->medium->frames[dev->rx_slot];
+    uint32_t seq = dev->rx_next;
+    size_t frame_len = frame->len;
+
+    if (!buf) {
+        if (len > 0) {
+            /* frame dropped, it stays in the ring */
+            return 0;
+        }
+        return frame_len;
+    }
+    if (len < frame_len) {
+        return -ENOBUFS;
+    }
+
+    memcpy(buf, frame->psdu, frame_len);
+
+    /* the sender of a later frame may have overwritten it meanwhile */
+    if (__atomic_load_n(&frame->seq, __ATOMIC_ACQUIRE) != seq) {
+        dev->rx_lost++;
+        return -EAGAIN;
+    }
+
+    if (info) {
+        netdev2_ieee802154_rx_info_t *radio_info = info;
+        radio_info->rssi = 0;
+        radio_info->lqi = UINT8_MAX;
+    }
+#ifdef MODULE_NETSTATS_L2
+    netdev->stats.rx_count++;
+    netdev->stats.rx_bytes += frame_len;
+#endif
+    return frame_len;
+}
+
+static int _get(netdev2_t *netdev, netopt_t opt, void *value, size_t max_len)
+{
+    netdev2_shmradio_t *dev = (netdev2_shmradio_t *)netdev;
+
+    switch (opt) {
+        case NETOPT_MAX_PACKET_SIZE:
+            assert(max_len >= sizeof(uint16_t));
+            *((uint16_t *)value) = _FRAME_LEN_MAX - _MAX_MHR_OVERHEAD;
+            return sizeof(uint16_t);
+        case NETOPT_STATE:
+            assert(max_len >= sizeof(netopt_state_t));
+            *((netopt_state_t *)value) = NETOPT_STATE_IDLE;
+            return sizeof(netopt_state_t);
+        case NETOPT_IS_CHANNEL_CLR:
+            assert(max_len >= sizeof(netopt_enable_t));
+            *((netopt_enable_t *)value) = NETOPT_ENABLE;
+            return sizeof(netopt_enable_t);
+        default:
+            return netdev2_ieee802154_get(&dev->netdev, opt, value, max_len);
+    }
+}
+
+static int _set(netdev2_t *netdev, netopt_t opt, void *value, size_t value_len)
+{
+    netdev2_shmradio_t *dev = (netdev2_shmradio_t *)netdev;
+
+    switch (opt) {
+        case NETOPT_STATE:
+            /* the medium has no states, always listening */
+            return sizeof(netopt_state_t);
+        default:
+            return netdev2_ieee802154_set(&dev->netdev, opt, value, value_len);
+    }
+}
+
+void netdev2_shmradio_setup(netdev2_shmradio_t *dev,
+                            const netdev2_shmradio_params_t *params)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->netdev.netdev.driver = &netdev2_driver_shmradio;
+    dev->medium_name = params->medium_name;
+}
+
+int netdev2_shmradio_set_link(netdev2_shmradio_t *dev, unsigned src,
+                              unsigned dst, uint8_t loss, uint16_t latency)
+{
+    if ((src >= NETDEV2_SHMRADIO_NODES_MAX) ||
+        (dst >= NETDEV2_SHMRADIO_NODES_MAX) ||
+        (loss > NETDEV2_SHMRADIO_NO_LINK)) {
+        return -EINVAL;
+    }
+
+    dev->medium->loss[src][dst] = loss;
+    dev->medium->latency[src][dst] = latency;
+    return 0;
+}
+
+void netdev2_shmradio_cleanup(netdev2_shmradio_t *dev)
+{
+    if (!dev || !dev->medium) {
+        return;
+    }
+
+    unregister_interrupt(_SIG_RX);
+    __atomic_store_n(&dev->medium->pids[dev->node], 0, __ATOMIC_RELEASE);
+    munmap(dev->medium, sizeof(netdev2_shmradio_medium_t));
+    dev->medium = NULL;
+}
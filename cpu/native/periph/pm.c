@@ -20,9 +20,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "irq.h"
 #include "periph/pm.h"
 #include "native_internal.h"
 #include "netdev2_tap.h"
+#ifdef MODULE_NETDEV2_SHMRADIO
+#include "netdev2_shmradio.h"
+#endif
+#ifdef MODULE_NETDEV2_PCAP
+#include "netdev2_pcap.h"
+#endif
 #include "tty_uart.h"
 
 #define ENABLE_DEBUG (0)
@@ -30,6 +37,22 @@
 
 void pm_set_lowest(void)
 {
+    if (_native_virtual_time) {
+        unsigned state = irq_disable();
+        int skipped = native_timer_skip();
+        if (skipped) {
+            /* the timer is due now, raise its interrupt instead of waiting */
+            int sig = SIGALRM;
+            real_write(_sig_pipefd[1], &sig, sizeof(int));
+            _native_sigpend++;
+        }
+        irq_restore(state);
+
+        if (skipped) {
+            return;
+        }
+    }
+
     _native_in_syscall++; // no switching here
     real_pause();
     _native_in_syscall--;
@@ -53,6 +76,12 @@ void pm_reboot(void)
 #ifdef MODULE_NETDEV2_TAP
     netdev2_tap_cleanup(&netdev2_tap);
 #endif
+#ifdef MODULE_NETDEV2_SHMRADIO
+    netdev2_shmradio_cleanup(&netdev2_shmradio);
+#endif
+#ifdef MODULE_NETDEV2_PCAP
+    netdev2_pcap_cleanup(&netdev2_pcap);
+#endif
 
     uart_cleanup();
 
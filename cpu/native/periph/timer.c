@@ -14,11 +14,21 @@
  * @file
  * @brief Native CPU periph/timer.h implementation
  *
- * Uses POSIX realtime clock and POSIX itimer to mimic hardware.
+ * Uses POSIX realtime clock and a POSIX timer (Linux) or itimer to mimic
+ * hardware.
  *
  * This is based on native's hwtimer implementation by Ludwig Knüpfer.
  * I removed the multiplexing, as xtimer does the same. (kaspar)
  *
+ * The channels are emulated on top of the single host timer, which is
+ * always armed for the earliest channel. On Linux, it is a
+ * timer_create(CLOCK_MONOTONIC) timer armed with absolute deadlines, so
+ * offsets are neither clamped to NATIVE_TIMER_MIN_RES nor skewed by the
+ * time passing between reading the clock and arming the timer.
+ *
+ * In virtual time mode (`-v`), the idle thread calls native_timer_skip() to
+ * advance the clock to the earliest armed channel instead of sleeping.
+ *
  * @}
  */
 
@@ -41,6 +51,7 @@
 
 #include "cpu.h"
 #include "cpu_conf.h"
+#include "irq.h"
 #include "native_internal.h"
 #include "periph/timer.h"
 
@@ -49,20 +60,62 @@
 
 #define NATIVE_TIMER_SPEED 1000000
 
-static unsigned long time_null;
+/* time skipped in virtual time mode */
+static uint64_t _skipped;
+/* host time at timer_init(), the reference all channel deadlines refer to */
+static struct timespec _real_start;
 
 static timer_cb_t _callback;
 static void *_cb_arg;
 
+static unsigned int _targets[TIMER_0_CHANNELS];
+static unsigned _armed;
+
+#ifdef __linux__
+static timer_t _host_timer;
+static int _host_timer_created;
+#else
 static struct itimerval itv;
+#endif
+
+static void do_timer_set(uint64_t now, unsigned int offset);
 
 /**
- * returns ticks for give timespec
+ * reads the host's monotonic clock
  */
-static unsigned long ts2ticks(struct timespec *tp)
+static void _host_now(struct timespec *t)
 {
-    /* TODO: check for overflow */
-    return((tp->tv_sec * NATIVE_TIMER_SPEED) + (tp->tv_nsec / 1000));
+    _native_syscall_enter();
+#ifdef __MACH__
+    clock_serv_t cclock;
+    mach_timespec_t mts;
+    host_get_clock_service(mach_host_self(), SYSTEM_CLOCK, &cclock);
+    clock_get_time(cclock, &mts);
+    mach_port_deallocate(mach_task_self(), cclock);
+    t->tv_sec = mts.tv_sec;
+    t->tv_nsec = mts.tv_nsec;
+#else
+    if (real_clock_gettime(CLOCK_MONOTONIC, t) == -1) {
+        err(EXIT_FAILURE, "timer_read: clock_gettime");
+    }
+#endif
+    _native_syscall_leave();
+}
+
+/**
+ * returns the 64 bit virtual time, i.e. the ticks since timer_init() plus
+ * the time skipped in virtual time mode
+ */
+static uint64_t _now64(void)
+{
+    struct timespec t;
+
+    _host_now(&t);
+
+    int64_t elapsed = (int64_t)(t.tv_sec - _real_start.tv_sec) * NATIVE_TIMER_SPEED +
+                      (t.tv_nsec - _real_start.tv_nsec) / 1000;
+
+    return (uint64_t)elapsed + _skipped;
 }
 
 /**
@@ -70,11 +123,78 @@ static unsigned long ts2ticks(struct timespec *tp)
  *
  * set new system timer, call timer interrupt handler
  */
+static void _rearm(void)
+{
+    if (!_armed) {
+        do_timer_set(0, 0);
+        return;
+    }
+
+    uint64_t now = _now64();
+    int earliest = INT32_MAX;
+
+    for (unsigned i = 0; i < TIMER_0_CHANNELS; i++) {
+        int diff = (int)(_targets[i] - (unsigned int)now);
+        if ((_armed & (1 << i)) && (diff < earliest)) {
+            earliest = diff;
+        }
+    }
+
+    /* expired channels fire right away */
+    do_timer_set(now, (earliest > 0) ? (unsigned)earliest : 1);
+}
+
 void native_isr_timer(void)
 {
     DEBUG("%s\n", __func__);
 
-    _callback(_cb_arg, 0);
+    unsigned int now = timer_read(0);
+
+    for (unsigned i = 0; i < TIMER_0_CHANNELS; i++) {
+        if ((_armed & (1 << i)) && ((int)(_targets[i] - now) <= 0)) {
+            _armed &= ~(1 << i);
+            _callback(_cb_arg, i);
+        }
+    }
+
+    _rearm();
+}
+
+static void _print_speedup(void)
+{
+    struct timespec now;
+
+    _host_now(&now);
+
+    double real = (now.tv_sec - _real_start.tv_sec) +
+                  (now.tv_nsec - _real_start.tv_nsec) / 1e9;
+    double virtual = real + _skipped / 1e6;
+
+    real_printf("native: %.3f s virtual time in %.3f s real time, speedup %.1fx\n",
+                virtual, real, (real > 0) ? virtual / real : 0.0);
+}
+
+int native_timer_skip(void)
+{
+    if (!_armed) {
+        return 0;
+    }
+
+    unsigned int now = timer_read(0);
+    int earliest = INT32_MAX;
+
+    for (unsigned i = 0; i < TIMER_0_CHANNELS; i++) {
+        int diff = (int)(_targets[i] - now);
+        if ((_armed & (1 << i)) && (diff < earliest)) {
+            earliest = diff;
+        }
+    }
+
+    if (earliest > 0) {
+        _skipped += earliest;
+    }
+
+    return 1;
 }
 
 int timer_init(tim_t dev, unsigned long freq, timer_cb_t cb, void *arg)
@@ -88,9 +208,27 @@ int timer_init(tim_t dev, unsigned long freq, timer_cb_t cb, void *arg)
         return -1;
     }
 
+#ifdef __linux__
+    if (!_host_timer_created) {
+        struct sigevent sev = {
+            .sigev_notify = SIGEV_SIGNAL,
+            .sigev_signo = SIGALRM,
+        };
+        if (timer_create(CLOCK_MONOTONIC, &sev, &_host_timer) == -1) {
+            err(EXIT_FAILURE, "timer_init: timer_create");
+        }
+        _host_timer_created = 1;
+    }
+#endif
+
     /* initialize time delta */
-    time_null = 0;
-    time_null = timer_read(0);
+    _skipped = 0;
+    _host_now(&_real_start);
+    _armed = 0;
+
+    if (_native_virtual_time) {
+        atexit(_print_speedup);
+    }
 
     timer_irq_disable(dev);
     _callback = cb;
@@ -100,8 +238,42 @@ int timer_init(tim_t dev, unsigned long freq, timer_cb_t cb, void *arg)
     return 0;
 }
 
-static void do_timer_set(unsigned int offset)
+#ifdef __linux__
+static void do_timer_set(uint64_t now, unsigned int offset)
+{
+    DEBUG("%s\n", __func__);
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+
+    if (offset) {
+        /* arm with an absolute deadline derived from the same reference as
+         * the virtual time (_real_start plus the virtual target minus the
+         * skipped time), so neither the time spent until the timer is armed
+         * nor a second clock read skews it */
+        uint64_t target = now + offset - _skipped;
+        its.it_value.tv_sec = _real_start.tv_sec + target / NATIVE_TIMER_SPEED;
+        its.it_value.tv_nsec = _real_start.tv_nsec + (target % NATIVE_TIMER_SPEED) * 1000;
+        if (its.it_value.tv_nsec >= 1000000000) {
+            its.it_value.tv_nsec -= 1000000000;
+            its.it_value.tv_sec++;
+        }
+    }
+
+    _native_syscall_enter();
+
+    DEBUG("timer_set(): setting %u.%09u\n", (unsigned)its.it_value.tv_sec,
+          (unsigned)its.it_value.tv_nsec);
+
+    if (timer_settime(_host_timer, TIMER_ABSTIME, &its, NULL) == -1) {
+        err(EXIT_FAILURE, "timer_arm: timer_settime");
+    }
+    _native_syscall_leave();
+}
+#else
+static void do_timer_set(uint64_t now, unsigned int offset)
 {
+    (void)now;
     DEBUG("%s\n", __func__);
 
     if (offset && offset < NATIVE_TIMER_MIN_RES) {
@@ -120,37 +292,43 @@ static void do_timer_set(unsigned int offset)
     }
     _native_syscall_leave();
 }
+#endif
 
 int timer_set(tim_t dev, int channel, unsigned int offset)
+{
+    return timer_set_absolute(dev, channel, timer_read(dev) + offset);
+}
+
+int timer_set_absolute(tim_t dev, int channel, unsigned int value)
 {
     (void)dev;
     DEBUG("%s\n", __func__);
 
-    if (channel != 0) {
+    if ((channel < 0) || (channel >= (int)TIMER_0_CHANNELS)) {
         return -1;
     }
 
-    if (!offset) {
-        offset = NATIVE_TIMER_MIN_RES;
-    }
-
-    do_timer_set(offset);
+    unsigned state = irq_disable();
+    _targets[channel] = value;
+    _armed |= (1 << channel);
+    _rearm();
+    irq_restore(state);
 
     return 1;
 }
 
-int timer_set_absolute(tim_t dev, int channel, unsigned int value)
-{
-    uint32_t now = timer_read(dev);
-    return timer_set(dev, channel, value - now);
-}
-
 int timer_clear(tim_t dev, int channel)
 {
     (void)dev;
-    (void)channel;
 
-    do_timer_set(0);
+    if ((channel < 0) || (channel >= (int)TIMER_0_CHANNELS)) {
+        return -1;
+    }
+
+    unsigned state = irq_disable();
+    _armed &= ~(1 << channel);
+    _rearm();
+    irq_restore(state);
 
     return 1;
 }
@@ -197,27 +375,7 @@ unsigned int timer_read(tim_t dev)
         return 0;
     }
 
-    struct timespec t;
-
     DEBUG("timer_read()\n");
 
-    _native_syscall_enter();
-#ifdef __MACH__
-    clock_serv_t cclock;
-    mach_timespec_t mts;
-    host_get_clock_service(mach_host_self(), SYSTEM_CLOCK, &cclock);
-    clock_get_time(cclock, &mts);
-    mach_port_deallocate(mach_task_self(), cclock);
-    t.tv_sec = mts.tv_sec;
-    t.tv_nsec = mts.tv_nsec;
-#else
-
-    if (real_clock_gettime(CLOCK_MONOTONIC, &t) == -1) {
-        err(EXIT_FAILURE, "timer_read: clock_gettime");
-    }
-
-#endif
-    _native_syscall_leave();
-
-    return ts2ticks(&t) - time_null;
+    return (unsigned int)_now64();
 }
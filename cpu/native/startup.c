@@ -46,12 +46,19 @@ pid_t _native_pid;
 pid_t _native_id;
 unsigned _native_rng_seed = 0;
 int _native_rng_mode = 0;
+int _native_virtual_time = 0;
 const char *_native_unix_socket_path = NULL;
 
 #ifdef MODULE_NETDEV2_TAP
 #include "netdev2_tap.h"
 extern netdev2_tap_t netdev2_tap;
 #endif
+#ifdef MODULE_NETDEV2_SHMRADIO
+#include "netdev2_shmradio.h"
+#endif
+#ifdef MODULE_NETDEV2_PCAP
+#include "netdev2_pcap.h"
+#endif
 
 /**
  * initialize _native_null_in_pipe to allow for reading from stdin
@@ -202,7 +209,14 @@ void usage_exit(void)
     real_printf(" <tap interface>");
 #endif
 
-    real_printf(" [-i <id>] [-d] [-e|-E] [-o] [-c <tty device>]\n");
+    real_printf(" [-i <id>] [-d] [-e|-E] [-o] [-v] [-c <tty device>]");
+#if defined(MODULE_NETDEV2_SHMRADIO)
+    real_printf(" [-m <medium>]");
+#endif
+#if defined(MODULE_NETDEV2_PCAP)
+    real_printf(" [-r <pcap file>] [-w <pcap file>] [-t]");
+#endif
+    real_printf("\n");
 
     real_printf(" help: %s -h\n", _progname);
 
@@ -219,7 +233,20 @@ void usage_exit(void)
             daemon/socket io)\n\
 -o          redirect stdout to file (/tmp/riot.stdout.PID) when not attached\n\
             to socket\n\
+-v          virtual time: when all threads are idle, skip ahead to the next\n\
+            timer instead of sleeping (use with -s for reproducible runs)\n\
 -c          specify TTY device for UART\n");
+#if defined(MODULE_NETDEV2_SHMRADIO)
+    real_printf("\
+-m <medium> name of the shared memory radio medium to attach to (default:\n\
+            /riot-shmradio), all instances given the same name share it\n");
+#endif
+#if defined(MODULE_NETDEV2_PCAP)
+    real_printf("\
+-r <file>   replay the IEEE 802.15.4 frames of a pcap file as received\n\
+-w <file>   write sent frames to a pcap file\n\
+-t          replay frames at their recorded times instead of back to back\n");
+#endif
 
     real_printf("\n\
 The order of command line arguments matters.\n");
@@ -243,6 +270,12 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
     char *stdouttype = "stdio";
     char *stdiotype = "stdio";
     int uart = 0;
+#ifdef MODULE_NETDEV2_SHMRADIO
+    const char *medium = "/riot-shmradio";
+#endif
+#ifdef MODULE_NETDEV2_PCAP
+    netdev2_pcap_params_t pcap_params = { NULL, NULL, false };
+#endif
 
 #if defined(MODULE_NETDEV2_TAP)
     if (
@@ -301,6 +334,9 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
         else if (strcmp("-o", arg) == 0) {
             stdouttype = "file";
         }
+        else if (strcmp("-v", arg) == 0) {
+            _native_virtual_time = 1;
+        }
         else if (strcmp("-c", arg) == 0) {
             if (argp + 1 < argc) {
                 argp++;
@@ -311,6 +347,36 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
 
             tty_uart_setup(uart++, argv[argp]);
         }
+#ifdef MODULE_NETDEV2_SHMRADIO
+        else if (strcmp("-m", arg) == 0) {
+            if (argp + 1 < argc) {
+                argp++;
+            }
+            else {
+                usage_exit();
+            }
+            medium = argv[argp];
+        }
+#endif
+#ifdef MODULE_NETDEV2_PCAP
+        else if ((strcmp("-r", arg) == 0) || (strcmp("-w", arg) == 0)) {
+            if (argp + 1 < argc) {
+                argp++;
+            }
+            else {
+                usage_exit();
+            }
+            if (arg[1] == 'r') {
+                pcap_params.rx_file = argv[argp];
+            }
+            else {
+                pcap_params.tx_file = argv[argp];
+            }
+        }
+        else if (strcmp("-t", arg) == 0) {
+            pcap_params.timed = true;
+        }
+#endif
         else {
             usage_exit();
         }
@@ -331,6 +397,13 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
     p.tap_name = &(argv[1]);
     netdev2_tap_setup(&netdev2_tap, &p);
 #endif
+#ifdef MODULE_NETDEV2_SHMRADIO
+    netdev2_shmradio_params_t shmradio_params = { .medium_name = medium };
+    netdev2_shmradio_setup(&netdev2_shmradio, &shmradio_params);
+#endif
+#ifdef MODULE_NETDEV2_PCAP
+    netdev2_pcap_setup(&netdev2_pcap, &pcap_params);
+#endif
 
     board_init();
 
@@ -18,6 +18,7 @@
  * @}
  */
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,10 +29,13 @@
 
 static void _resp_handler(unsigned req_state, coap_pkt_t* pdu);
 static ssize_t _stats_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len);
+static ssize_t _alphabet_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len);
+static void _notify_observers(void);
 
 /* CoAP resources */
 static const coap_resource_t _resources[] = {
     { "/cli/stats", COAP_GET, _stats_handler },
+    { "/cli/alphabet", COAP_GET, _alphabet_handler },
 };
 static gcoap_listener_t _listener = {
     (coap_resource_t *)&_resources[0],
@@ -93,6 +97,53 @@ static ssize_t _stats_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len)
     return gcoap_finish(pdu, payload_len, COAP_FORMAT_TEXT);
 }
 
+/*
+ * Generates the block of /cli/alphabet at offset: ALPHABET_LINES lines of the
+ * alphabet, too long for a single response.
+ */
+#define ALPHABET_LINES  (32U)
+
+static ssize_t _alphabet_read(uint8_t *dst, size_t offset, size_t size,
+                              void *arg)
+{
+    size_t total = ALPHABET_LINES * 27;
+    size_t i;
+    (void)arg;
+
+    for (i = 0; (i < size) && (offset + i < total); i++) {
+        unsigned pos = (offset + i) % 27;
+        dst[i] = (pos == 26) ? '\n' : 'a' + pos;
+    }
+    return i;
+}
+
+/*
+ * Server callback for /cli/alphabet. Streams the resource block-wise.
+ */
+static ssize_t _alphabet_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len)
+{
+    return gcoap_block2_respond(pdu, buf, len, COAP_FORMAT_TEXT,
+                                _alphabet_read, NULL);
+}
+
+/*
+ * Notifies observers of /cli/stats about a new count.
+ */
+static void _notify_observers(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+
+    if (gcoap_obs_init(&pdu, &buf[0], GCOAP_PDU_BUF_SIZE,
+                       &_resources[0]) == GCOAP_OBS_INIT_OK) {
+        size_t payload_len = fmt_u16_dec((char *)pdu.payload, req_count);
+        ssize_t len = gcoap_finish(&pdu, payload_len, COAP_FORMAT_TEXT);
+        if (len > 0) {
+            gcoap_obs_send(&buf[0], len, &_resources[0]);
+        }
+    }
+}
+
 static size_t _send(uint8_t *buf, size_t len, char *addr_str, char *port_str)
 {
     ipv6_addr_t addr;
@@ -114,6 +165,7 @@ static size_t _send(uint8_t *buf, size_t len, char *addr_str, char *port_str)
     bytes_sent = gcoap_req_send(buf, len, &addr, port, _resp_handler);
     if (bytes_sent > 0) {
         req_count++;
+        _notify_observers();
     }
     return bytes_sent;
 }
@@ -133,25 +185,32 @@ int gcoap_cli_cmd(int argc, char **argv)
 
     for (size_t i = 0; i < sizeof(method_codes) / sizeof(char*); i++) {
         if (strcmp(argv[1], method_codes[i]) == 0) {
-            if (argc == 5 || argc == 6) {
-                if (argc == 6) {
-                    gcoap_req_init(&pdu, &buf[0], GCOAP_PDU_BUF_SIZE, i+1, argv[4]);
-                    memcpy(pdu.payload, argv[5], strlen(argv[5]));
-                    len = gcoap_finish(&pdu, strlen(argv[5]), COAP_FORMAT_TEXT);
+            /* optional flag for a confirmable request */
+            int apos = 2;
+            if ((argc > apos) && (strcmp(argv[apos], "-c") == 0)) {
+                apos++;
+            }
+            if (argc == apos + 3 || argc == apos + 4) {
+                gcoap_req_init(&pdu, &buf[0], GCOAP_PDU_BUF_SIZE, i+1, argv[apos+2]);
+                if (apos == 3) {
+                    gcoap_hdr_set_type(pdu.hdr, COAP_TYPE_CON);
+                }
+                if (argc == apos + 4) {
+                    memcpy(pdu.payload, argv[apos+3], strlen(argv[apos+3]));
+                    len = gcoap_finish(&pdu, strlen(argv[apos+3]), COAP_FORMAT_TEXT);
                 }
                 else {
-                    len = gcoap_request(&pdu, &buf[0], GCOAP_PDU_BUF_SIZE, i+1,
-                                                                           argv[4]);
+                    len = gcoap_finish(&pdu, 0, COAP_FORMAT_NONE);
                 }
                 printf("gcoap_cli: sending msg ID %u, %u bytes\n", coap_get_id(&pdu),
                                                                    (unsigned) len);
-                if (!_send(&buf[0], len, argv[2], argv[3])) {
+                if (!_send(&buf[0], len, argv[apos], argv[apos+1])) {
                     puts("gcoap_cli: msg send failed");
                 }
                 return 0;
             }
             else {
-                printf("usage: %s <get|post|put> <addr> <port> <path> [data]\n",
+                printf("usage: %s <get|post|put> [-c] <addr> <port> <path> [data]\n",
                                                                        argv[0]);
                 return 1;
             }
@@ -161,11 +220,25 @@ int gcoap_cli_cmd(int argc, char **argv)
     if (strcmp(argv[1], "info") == 0) {
         if (argc == 2) {
             uint8_t open_reqs;
+            gcoap_con_stats_t stats;
             gcoap_op_state(&open_reqs);
+            gcoap_con_stats(&stats);
 
             printf("CoAP server is listening on port %u\n", GCOAP_PORT);
             printf(" CLI requests sent: %u\n", req_count);
             printf("CoAP open requests: %u\n", open_reqs);
+            printf(" CON requests sent: %" PRIu32 ", retransmissions: %" PRIu32
+                   ", timeouts: %" PRIu32 "\n", stats.con_sent,
+                   stats.retransmissions, stats.con_timeouts);
+            printf("      last RTT (us): %" PRIu32 "\n", stats.rtt_last);
+            printf("duplicate requests: %" PRIu32 "\n", stats.duplicates);
+#ifdef MODULE_GCOAP_PROXY
+            gcoap_proxy_stats_t proxy;
+            gcoap_proxy_stats(&proxy);
+            printf("  proxy cache hits: %" PRIu32 ", misses: %" PRIu32
+                   ", coalesced: %" PRIu32 "\n", proxy.hits, proxy.misses,
+                   proxy.coalesced);
+#endif
             return 0;
         }
     }
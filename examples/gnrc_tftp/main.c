@@ -29,7 +29,7 @@
 extern int tftp_client_cmd(int argc, char * *argv);
 extern int tftp_server_cmd(int argc, char * *argv);
 
-#define MAIN_QUEUE_SIZE     (4)
+#define MAIN_QUEUE_SIZE     (8)
 static msg_t _main_msg_queue[MAIN_QUEUE_SIZE];
 
 static const shell_command_t shell_commands[] = {
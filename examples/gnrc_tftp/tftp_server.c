@@ -27,7 +27,7 @@
 #include "net/gnrc/tftp.h"
 
 /* the message queues */
-#define TFTP_QUEUE_SIZE     (4)
+#define TFTP_QUEUE_SIZE     (8)
 static msg_t _tftp_msg_queue[TFTP_QUEUE_SIZE];
 
 /* allocate the stack */
@@ -224,6 +224,16 @@ void auto_init(void)
     auto_init_netdev2_tap();
 #endif
 
+#ifdef MODULE_NETDEV2_SHMRADIO
+    extern void auto_init_netdev2_shmradio(void);
+    auto_init_netdev2_shmradio();
+#endif
+
+#ifdef MODULE_NETDEV2_PCAP
+    extern void auto_init_netdev2_pcap(void);
+    auto_init_netdev2_pcap();
+#endif
+
 #ifdef MODULE_NORDIC_SOFTDEVICE_BLE
     extern void gnrc_nordic_ble_6lowpan_init(void);
     gnrc_nordic_ble_6lowpan_init();
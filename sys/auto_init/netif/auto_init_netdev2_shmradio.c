@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ */
+
+/*
+ * @ingroup     auto_init_gnrc_netif
+ * @{
+ *
+ * @file
+ * @brief       Auto initialization for the native shared memory radio
+ */
+
+#ifdef MODULE_NETDEV2_SHMRADIO
+
+#include "net/gnrc/netdev2.h"
+#include "net/gnrc/netdev2/ieee802154.h"
+#include "net/gnrc.h"
+
+#include "netdev2_shmradio.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+/**
+ * @brief   MAC layer stack parameters
+ * @{
+ */
+#define SHMRADIO_MAC_STACKSIZE      (THREAD_STACKSIZE_DEFAULT + DEBUG_EXTRA_STACKSIZE)
+#ifndef SHMRADIO_MAC_PRIO
+#define SHMRADIO_MAC_PRIO           (GNRC_NETDEV2_MAC_PRIO)
+#endif
+/** @} */
+
+static gnrc_netdev2_t _gnrc_adpt;
+static char _shmradio_stack[SHMRADIO_MAC_STACKSIZE];
+
+void auto_init_netdev2_shmradio(void)
+{
+    int res = gnrc_netdev2_ieee802154_init(&_gnrc_adpt,
+                                           (netdev2_ieee802154_t *)&netdev2_shmradio);
+
+    if (res < 0) {
+        DEBUG("Error initializing shmradio device!\n");
+    }
+    else {
+        gnrc_netdev2_init(_shmradio_stack, SHMRADIO_MAC_STACKSIZE,
+                          SHMRADIO_MAC_PRIO, "shmradio", &_gnrc_adpt);
+    }
+}
+
+#else
+typedef int dont_be_pedantic;
+#endif /* MODULE_NETDEV2_SHMRADIO */
+/** @} */
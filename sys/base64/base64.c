@@ -18,42 +18,197 @@
  *
  */
 
+#include <string.h>
+
 #include "base64.h"
 
-#define BASE64_CAPITAL_UPPER_BOUND     (25)     /**< base64 'Z'           */
-#define BASE64_SMALL_UPPER_BOUND       (51)     /**< base64 'z'           */
-#define BASE64_NUMBER_UPPER_BOUND      (61)     /**< base64 '9'           */
-#define BASE64_PLUS                    (62)     /**< base64 '+'           */
-#define BASE64_SLASH                   (63)     /**< base64 '/'           */
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
 #define BASE64_EQUALS                  (0xFE)   /**< no base64 symbol '=' */
 #define BASE64_NOT_DEFINED             (0xFF)   /**< no base64 symbol     */
 
 /*
- * returns the corresponding ascii symbol value for the given base64 code
+ * base64 code -> ascii symbol
+ */
+static const char symbols[64] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define XX BASE64_NOT_DEFINED
+#define EQ BASE64_EQUALS
+
+/*
+ * ascii symbol -> base64 code, characters >= 0x80 are no symbols
+ */
+static const uint8_t codes[128] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, 62, XX, XX, XX, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, EQ, XX, XX,
+    XX,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, XX, XX, XX, XX, XX,
+    XX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, XX, XX, XX, XX, XX,
+};
+
+#undef XX
+#undef EQ
+
+#ifdef __SSSE3__
+/*
+ * Encodes 12 bytes into 16 symbols, reads 16 bytes from @p in.
+ * See W. Muła, D. Lemire: "Faster Base64 Encoding and Decoding using AVX2
+ * Instructions"
+ */
+static void encode_block(const unsigned char *in, unsigned char *out)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)in);
+
+    /* spread each group of 3 bytes over 4 bytes, then move the 6 bit
+     * fields into the lower bits of each byte */
+    v = _mm_shuffle_epi8(v, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                         4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i ac = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i bd = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                                 _mm_set1_epi32(0x01000010));
+    __m128i idx = _mm_or_si128(ac, bd);
+
+    /* map the code ranges 0..25, 26..51, 52..61, 62, 63 to their offsets */
+    __m128i range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    __m128i offset = _mm_shuffle_epi8(_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '+' - 62,
+                                                    '/' - 63, 'A', 0, 0),
+                                      range);
+
+    _mm_storeu_si128((__m128i *)out, _mm_add_epi8(idx, offset));
+}
+
+/*
+ * Decodes 16 symbols into 12 bytes, writes 16 bytes to @p out.
+ * Returns 0 if a character is no base64 symbol, nothing is written then.
  */
-static char getsymbol(unsigned char code)
+static int decode_block(const unsigned char *in, unsigned char *out)
 {
-    if (code == BASE64_SLASH) {
-        return '/';
+    __m128i v = _mm_loadu_si128((const __m128i *)in);
+    __m128i hi = _mm_and_si128(_mm_srli_epi32(v, 4), _mm_set1_epi8(0x0f));
+    __m128i lo = _mm_and_si128(v, _mm_set1_epi8(0x0f));
+
+    /* a character is valid if its nibbles share no bit in these tables */
+    __m128i lo_bits = _mm_shuffle_epi8(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11,
+                                                     0x11, 0x11, 0x11, 0x11,
+                                                     0x11, 0x11, 0x13, 0x1a,
+                                                     0x1b, 0x1b, 0x1b, 0x1a),
+                                       lo);
+    __m128i hi_bits = _mm_shuffle_epi8(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02,
+                                                     0x04, 0x08, 0x04, 0x08,
+                                                     0x10, 0x10, 0x10, 0x10,
+                                                     0x10, 0x10, 0x10, 0x10),
+                                       hi);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo_bits, hi_bits),
+                                         _mm_setzero_si128()))) {
+        return 0;
     }
 
-    if (code == BASE64_PLUS) {
-        return '+';
+    /* translate to codes by an offset per high nibble, '/' is special */
+    __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    __m128i offset = _mm_shuffle_epi8(_mm_setr_epi8(0, 16, 19, 4, -65, -65,
+                                                    -71, -71, 0, 0, 0, 0,
+                                                    0, 0, 0, 0),
+                                      _mm_add_epi8(slash, hi));
+    v = _mm_add_epi8(v, offset);
+
+    /* pack 4 * 6 bit into 3 bytes */
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    v = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                          14, 13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128((__m128i *)out, v);
+
+    return 1;
+}
+#endif
+
+static void encode_group(const unsigned char *in, unsigned char *out)
+{
+    uint32_t bits = ((uint32_t)in[0] << 16) | ((uint32_t)in[1] << 8) | in[2];
+
+    out[0] = symbols[bits >> 18];
+    out[1] = symbols[(bits >> 12) & 0x3f];
+    out[2] = symbols[(bits >> 6) & 0x3f];
+    out[3] = symbols[bits & 0x3f];
+}
+
+void base64_encode_init(base64_encoder_t *enc)
+{
+    enc->rest_len = 0;
+}
+
+size_t base64_encode_update(base64_encoder_t *enc, const unsigned char *data_in,
+                            size_t data_in_size, unsigned char *base64_out)
+{
+    const unsigned char *end = data_in + data_in_size;
+    unsigned char *out = base64_out;
+
+    /* complete the group of the previous chunk */
+    if (enc->rest_len) {
+        unsigned char group[3];
+
+        if (enc->rest_len + data_in_size < 3) {
+            memcpy(&enc->rest[enc->rest_len], data_in, data_in_size);
+            enc->rest_len += data_in_size;
+            return 0;
+        }
+        memcpy(group, enc->rest, enc->rest_len);
+        memcpy(&group[enc->rest_len], data_in, 3 - enc->rest_len);
+        data_in += 3 - enc->rest_len;
+        encode_group(group, out);
+        out += 4;
     }
 
-    if (code <= BASE64_CAPITAL_UPPER_BOUND) {
-        return (code + 'A');
+#ifdef __SSSE3__
+    while (end - data_in >= 16) {
+        encode_block(data_in, out);
+        data_in += 12;
+        out += 16;
     }
+#endif
 
-    if (code <= BASE64_SMALL_UPPER_BOUND) {
-        return (code + ('z' - BASE64_SMALL_UPPER_BOUND));
+    while (end - data_in >= 3) {
+        encode_group(data_in, out);
+        data_in += 3;
+        out += 4;
     }
 
-    if (code <= BASE64_NUMBER_UPPER_BOUND) {
-        return (code + ('9' - BASE64_NUMBER_UPPER_BOUND));
+    enc->rest_len = end - data_in;
+    memcpy(enc->rest, data_in, enc->rest_len);
+
+    return out - base64_out;
+}
+
+size_t base64_encode_final(base64_encoder_t *enc, unsigned char *base64_out)
+{
+    if (!enc->rest_len) {
+        return 0;
+    }
+
+    unsigned char group[3] = { enc->rest[0], 0, 0 };
+    if (enc->rest_len == 2) {
+        group[1] = enc->rest[1];
+    }
+    encode_group(group, base64_out);
+    base64_out[3] = '=';
+    if (enc->rest_len == 1) {
+        base64_out[2] = '=';
     }
+    enc->rest_len = 0;
 
-    return (char)BASE64_NOT_DEFINED;
+    return 4;
 }
 
 int base64_encode(unsigned char *data_in, size_t data_in_size, \
@@ -78,85 +233,112 @@ int base64_encode(unsigned char *data_in, size_t data_in_size, \
         return BASE64_ERROR_BUFFER_OUT;
     }
 
-    int iterate_base64_buffer = 0;
-    unsigned char nNum = 0;
-    int nLst = 0;
-    int njump = 0;
-
-    for (int i = 0; i < (int)(data_in_size); ++i) {
-        unsigned char tmpval;
-        njump++;
-        tmpval = *(data_in + i);
-
-        nNum = (tmpval >> (2 * njump));
-
-        if (njump == 4) {
-            nNum = nLst << (8 - 2 * njump);
-            njump = 0;
-            nLst = 0;
-            --i;
-        }
-        else {
-            nNum += nLst << (8 - 2 * njump);
-            nLst =  tmpval & ((1 << njump * 2) - 1);
-        }
-
-        base64_out[iterate_base64_buffer++] = getsymbol(nNum);
-    }
-
-    /* The last character is not finished yet */
-    njump++;
+    base64_encoder_t enc;
+    base64_encode_init(&enc);
 
-    nNum = nLst << (8 - 2 * njump);
-    base64_out[iterate_base64_buffer++] = getsymbol(nNum);
+    size_t len = base64_encode_update(&enc, data_in, data_in_size, base64_out);
+    len += base64_encode_final(&enc, base64_out + len);
+    *base64_out_size = len;
 
-    /* if required we append '=' for the required dividability */
-    while (iterate_base64_buffer % 4) {
-        base64_out[iterate_base64_buffer++] = '=';
-    }
+    return BASE64_SUCCESS;
+}
 
-    *base64_out_size = iterate_base64_buffer;
+static uint8_t getcode(unsigned char symbol)
+{
+    return (symbol < sizeof(codes)) ? codes[symbol] : BASE64_NOT_DEFINED;
+}
 
-    return BASE64_SUCCESS;
+void base64_decode_init(base64_decoder_t *dec)
+{
+    dec->bits = 0;
+    dec->num = 0;
 }
 
 /*
- *  returns the corresponding base64 code for the given ascii symbol
+ * Decodes at most @p data_out_size bytes, returns the number of bytes written.
+ * Stops early (without consuming the rest of the input) if the output is full.
  */
-static int getcode(char symbol)
+static size_t decode(base64_decoder_t *dec, const unsigned char **base64_in,
+                     const unsigned char *in_end, unsigned char *data_out,
+                     size_t data_out_size)
 {
-    if (symbol == '/') {
-        return BASE64_SLASH;
-    }
+    const unsigned char *in = *base64_in;
+    unsigned char *out = data_out, *out_end = data_out + data_out_size;
+
+    while (in < in_end) {
+        if (dec->num == 0) {
+#ifdef __SSSE3__
+            if ((in_end - in >= 16) && (out_end - out >= 16) &&
+                decode_block(in, out)) {
+                in += 16;
+                out += 12;
+                continue;
+            }
+#endif
+            /* fast path for a complete group without any ignored characters */
+            if ((in_end - in >= 4) && (out_end - out >= 3)) {
+                uint8_t a = getcode(in[0]), b = getcode(in[1]);
+                uint8_t c = getcode(in[2]), d = getcode(in[3]);
+                if (!((a | b | c | d) & 0xc0)) {
+                    out[0] = (a << 2) | (b >> 4);
+                    out[1] = (b << 4) | (c >> 2);
+                    out[2] = (c << 6) | d;
+                    in += 4;
+                    out += 3;
+                    continue;
+                }
+            }
+        }
 
-    if (symbol == '+') {
-        return BASE64_PLUS;
+        uint8_t code = getcode(*in);
+        if (code & 0xc0) {
+            /* '=' or no base64 symbol, ignore it */
+            in++;
+            continue;
+        }
+        if ((dec->num == 3) && (out_end - out < 3)) {
+            break;
+        }
+        in++;
+        dec->bits = (dec->bits << 6) | code;
+        if (++dec->num == 4) {
+            out[0] = dec->bits >> 16;
+            out[1] = dec->bits >> 8;
+            out[2] = dec->bits;
+            out += 3;
+            dec->bits = 0;
+            dec->num = 0;
+        }
     }
 
-    if (symbol == '=') {
-        /* indicates a padded base64 end */
-        return BASE64_EQUALS;
-    }
+    *base64_in = in;
+    return out - data_out;
+}
 
-    if (symbol < '0') {
-        /* indicates that the given symbol is not base64 and should be ignored */
-        return BASE64_NOT_DEFINED;
-    }
+size_t base64_decode_update(base64_decoder_t *dec, const unsigned char *base64_in,
+                            size_t base64_in_size, unsigned char *data_out)
+{
+    return decode(dec, &base64_in, base64_in + base64_in_size, data_out,
+                  BASE64_DECODE_UPDATE_SIZE(base64_in_size));
+}
 
-    if (symbol <= '9' && symbol >= '0') {
-        return (symbol + (BASE64_NUMBER_UPPER_BOUND - '9'));
-    }
+size_t base64_decode_final(base64_decoder_t *dec, unsigned char *data_out)
+{
+    size_t len = 0;
 
-    if (symbol <= 'Z' && symbol >= 'A') {
-        return (symbol - 'A');
+    /* a single dangling symbol carries less than a byte and is dropped */
+    if (dec->num == 2) {
+        data_out[0] = dec->bits >> 4;
+        len = 1;
     }
-
-    if (symbol <= 'z' && symbol >= 'a') {
-        return (symbol + (BASE64_SMALL_UPPER_BOUND - 'z'));
+    else if (dec->num == 3) {
+        data_out[0] = dec->bits >> 10;
+        data_out[1] = dec->bits >> 2;
+        len = 2;
     }
+    base64_decode_init(dec);
 
-    /* indicates that the given symbol is not base64 and should be ignored */
-    return BASE64_NOT_DEFINED;
+    return len;
 }
 
 int base64_decode(unsigned char *base64_in, size_t base64_in_size, \
@@ -181,34 +363,20 @@ int base64_decode(unsigned char *base64_in, size_t base64_in_size, \
         return BASE64_ERROR_BUFFER_OUT;
     }
 
-    int iterate_data_buffer = 0;
-    unsigned char nNum = 0;
-    int nLst = getcode(base64_in[0]) << 2;
-    int code = 0;
+    base64_decoder_t dec;
+    base64_decode_init(&dec);
 
-    int mask = 2;
+    const unsigned char *in = base64_in, *in_end = base64_in + base64_in_size;
+    size_t len = decode(&dec, &in, in_end, data_out, *data_out_size);
 
-    for (int i = 1; i < (int)(base64_in_size); i++) {
-        code = getcode(base64_in[i]);
-
-        if (code == BASE64_NOT_DEFINED || code == BASE64_EQUALS) {
-            continue;
-        }
-
-        int nm = (0xFF << (2 * mask));
-
-        nNum = nLst + ((code & (0xFF & nm)) >> (2 * mask));
-        nLst = (code & (0xFF & ~nm)) << (8 - (2 * mask));
-
-        (mask != 3) ? data_out[iterate_data_buffer++] = nNum : nNum;
-        (mask == 0) ? mask = 3 : mask--;
+    /* unpadded input may decode to more than the estimated size */
+    if ((in != in_end) || (*data_out_size - len < (size_t)(dec.num ? dec.num - 1 : 0))) {
+        *data_out_size = BASE64_DECODE_UPDATE_SIZE(base64_in_size);
+        return BASE64_ERROR_BUFFER_OUT_SIZE;
     }
 
-    if (code == BASE64_EQUALS) {
-        /* add the last character to the data_out buffer */
-        data_out[iterate_data_buffer] = nNum;
-    }
+    len += base64_decode_final(&dec, data_out + len);
+    *data_out_size = len;
 
-    *data_out_size = iterate_data_buffer;
     return BASE64_SUCCESS;
 }
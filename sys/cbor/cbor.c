@@ -786,6 +786,550 @@ bool cbor_at_end(const cbor_stream_t *s, size_t offset)
     return s ? offset >= s->pos - 1 : true;
 }
 
+/**
+ * Encode the initial byte and the following length bytes of an item into @p out
+ *
+ * @return Number of bytes written to @p out (at most 9)
+ */
+static size_t encode_head(unsigned char *out, unsigned char major_type, uint64_t val)
+{
+    unsigned char additional_info = uint_additional_info(val);
+    unsigned char bytes_follow = uint_bytes_follow(additional_info);
+
+    out[0] = major_type | additional_info;
+
+    for (int i = bytes_follow - 1; i >= 0; --i) {
+        out[bytes_follow - i] = (val >> (8 * i)) & 0xff;
+    }
+
+    return bytes_follow + 1;
+}
+
+void cbor_writer_init(cbor_writer_t *writer, unsigned char *buf, size_t size,
+                      cbor_writer_cb_t cb, void *arg)
+{
+    writer->buf = buf;
+    writer->size = size;
+    writer->pos = 0;
+    writer->len = 0;
+    writer->cb = cb;
+    writer->arg = arg;
+}
+
+void cbor_writer_set_buffer(cbor_writer_t *writer, unsigned char *buf, size_t size)
+{
+    writer->len += writer->pos;
+    writer->buf = buf;
+    writer->size = size;
+    writer->pos = 0;
+}
+
+size_t cbor_writer_raw(cbor_writer_t *w, const void *data, size_t length)
+{
+    const unsigned char *in = data;
+    size_t left = length;
+
+    while (left) {
+        if (w->pos >= w->size) {
+            /* ask for the next buffer, stop if none (or an empty one) is given */
+            if (!w->cb || (w->cb(w, w->arg) < 0) || (w->pos >= w->size)) {
+                return 0;
+            }
+        }
+
+        size_t chunk = w->size - w->pos;
+
+        if (chunk > left) {
+            chunk = left;
+        }
+
+        memcpy(&w->buf[w->pos], in, chunk);
+        w->pos += chunk;
+        in += chunk;
+        left -= chunk;
+    }
+
+    return length;
+}
+
+static size_t writer_head(cbor_writer_t *w, unsigned char major_type, uint64_t val)
+{
+    unsigned char head[9];
+
+    return cbor_writer_raw(w, head, encode_head(head, major_type, val));
+}
+
+static size_t writer_byte(cbor_writer_t *w, unsigned char byte)
+{
+    return cbor_writer_raw(w, &byte, 1);
+}
+
+static size_t writer_string(cbor_writer_t *w, unsigned char major_type,
+                            const void *val, size_t length)
+{
+    size_t head = writer_head(w, major_type, length);
+
+    if (!head || (cbor_writer_raw(w, val, length) != length)) {
+        return 0;
+    }
+
+    return head + length;
+}
+
+size_t cbor_writer_uint(cbor_writer_t *writer, uint64_t val)
+{
+    return writer_head(writer, CBOR_UINT, val);
+}
+
+size_t cbor_writer_int(cbor_writer_t *writer, int64_t val)
+{
+    if (val >= 0) {
+        return writer_head(writer, CBOR_UINT, val);
+    }
+
+    return writer_head(writer, CBOR_NEGINT, -1 - val);
+}
+
+size_t cbor_writer_bool(cbor_writer_t *writer, bool val)
+{
+    return writer_byte(writer, val ? CBOR_TRUE : CBOR_FALSE);
+}
+
+size_t cbor_writer_bytes(cbor_writer_t *writer, const void *val, size_t length)
+{
+    return writer_string(writer, CBOR_BYTES, val, length);
+}
+
+size_t cbor_writer_text(cbor_writer_t *writer, const char *val, size_t length)
+{
+    return writer_string(writer, CBOR_TEXT, val, length);
+}
+
+size_t cbor_writer_bytes_header(cbor_writer_t *writer, size_t length)
+{
+    return writer_head(writer, CBOR_BYTES, length);
+}
+
+size_t cbor_writer_array(cbor_writer_t *writer, size_t array_length)
+{
+    return writer_head(writer, CBOR_ARRAY, array_length);
+}
+
+size_t cbor_writer_array_indefinite(cbor_writer_t *writer)
+{
+    return writer_byte(writer, CBOR_ARRAY | CBOR_VAR_FOLLOWS);
+}
+
+size_t cbor_writer_map(cbor_writer_t *writer, size_t map_length)
+{
+    return writer_head(writer, CBOR_MAP, map_length);
+}
+
+size_t cbor_writer_map_indefinite(cbor_writer_t *writer)
+{
+    return writer_byte(writer, CBOR_MAP | CBOR_VAR_FOLLOWS);
+}
+
+#ifndef CBOR_NO_SEMANTIC_TAGGING
+size_t cbor_writer_tag(cbor_writer_t *writer, uint64_t tag)
+{
+    return writer_head(writer, CBOR_TAG, tag);
+}
+#endif /* CBOR_NO_SEMANTIC_TAGGING */
+
+size_t cbor_writer_break(cbor_writer_t *writer)
+{
+    return writer_byte(writer, CBOR_BREAK);
+}
+
+void cbor_reader_init(cbor_reader_t *reader, const unsigned char *buffer, size_t size)
+{
+    reader->data = buffer;
+    reader->size = size;
+    reader->pos = 0;
+}
+
+size_t cbor_reader_next(cbor_reader_t *r, cbor_item_t *item)
+{
+    if (r->pos >= r->size) {
+        return 0;
+    }
+
+    const unsigned char *in = &r->data[r->pos];
+    size_t left = r->size - r->pos;
+    unsigned char major_type = in[0] & CBOR_TYPE_MASK;
+    unsigned char additional_info = in[0] & CBOR_INFO_MASK;
+    unsigned char bytes_follow = uint_bytes_follow(additional_info);
+
+    item->type = (cbor_item_type_t)(major_type >> 5);
+    item->indefinite = false;
+    item->size = 0;
+    item->val = 0;
+    item->ptr = NULL;
+
+    if ((additional_info > CBOR_UINT64_FOLLOWS) && (additional_info < CBOR_VAR_FOLLOWS)) {
+        return 0;   /* reserved values */
+    }
+
+    if ((size_t)bytes_follow + 1 > left) {
+        return 0;   /* truncated */
+    }
+
+    if (bytes_follow == 0) {
+        item->val = additional_info;
+    }
+
+    for (unsigned i = 1; i <= bytes_follow; i++) {
+        item->val = (item->val << 8) | in[i];
+    }
+
+    size_t consumed = bytes_follow + 1;
+
+    switch (major_type) {
+        case CBOR_UINT:
+        case CBOR_NEGINT:
+        case CBOR_TAG:
+            if (additional_info == CBOR_VAR_FOLLOWS) {
+                return 0;
+            }
+            break;
+
+        case CBOR_BYTES:
+        case CBOR_TEXT:
+            if (additional_info == CBOR_VAR_FOLLOWS) {
+                item->indefinite = true;
+                item->val = 0;
+                break;
+            }
+
+            if (item->val > left - consumed) {
+                return 0;   /* truncated */
+            }
+
+            item->ptr = &in[consumed];
+            consumed += (size_t)item->val;
+            break;
+
+        case CBOR_ARRAY:
+        case CBOR_MAP:
+            if (additional_info == CBOR_VAR_FOLLOWS) {
+                item->indefinite = true;
+                item->val = 0;
+            }
+            break;
+
+        default: /* CBOR_7 */
+            if (additional_info == CBOR_VAR_FOLLOWS) {
+                item->type = CBOR_ITEM_BREAK;
+                item->val = 0;
+            }
+            else if (additional_info >= CBOR_UINT16_FOLLOWS) {
+                item->type = CBOR_ITEM_FLOAT;
+                item->size = bytes_follow;
+            }
+            else {
+                item->type = CBOR_ITEM_SIMPLE;
+            }
+            break;
+    }
+
+    r->pos += consumed;
+    return consumed;
+}
+
+static size_t reader_skip(cbor_reader_t *r, unsigned depth)
+{
+    size_t start = r->pos;
+    cbor_item_t item;
+
+    if ((depth > CBOR_READER_MAX_DEPTH) || !cbor_reader_next(r, &item)) {
+        return 0;
+    }
+
+    uint64_t nested = item.val;
+
+    switch (item.type) {
+        case CBOR_ITEM_MAP:
+            nested *= 2;
+            /* fall through */
+        case CBOR_ITEM_ARRAY:
+            break;
+
+        case CBOR_ITEM_BYTES:
+        case CBOR_ITEM_TEXT:
+            if (!item.indefinite) {
+                return r->pos - start;
+            }
+            break;
+
+        case CBOR_ITEM_TAG:
+            nested = 1;
+            break;
+
+        case CBOR_ITEM_BREAK:
+            return 0;   /* unexpected break */
+
+        default:
+            return r->pos - start;
+    }
+
+    if (item.indefinite) {
+        /* skip items until the matching break */
+        while ((r->pos < r->size) && (r->data[r->pos] != CBOR_BREAK)) {
+            if (!reader_skip(r, depth + 1)) {
+                return 0;
+            }
+        }
+
+        if (r->pos >= r->size) {
+            return 0;
+        }
+
+        r->pos++;
+    }
+    else {
+        while (nested--) {
+            if (!reader_skip(r, depth + 1)) {
+                return 0;
+            }
+        }
+    }
+
+    return r->pos - start;
+}
+
+size_t cbor_reader_skip(cbor_reader_t *reader)
+{
+    size_t start = reader->pos;
+    size_t skipped = reader_skip(reader, 0);
+
+    if (!skipped) {
+        reader->pos = start;
+    }
+
+    return skipped;
+}
+
+static unsigned head_size(uint64_t val)
+{
+    return uint_bytes_follow(uint_additional_info(val)) + 1;
+}
+
+static size_t text_len(const struct_codec_field_t *field, const char *text)
+{
+    const char *end = memchr(text, '\0', field->size);
+
+    return end ? (size_t)(end - text) : field->size;
+}
+
+/**
+ * Get major type and head value of an integer or text member
+ *
+ * @return Number of content bytes following the head
+ */
+static size_t field_head(const struct_codec_field_t *field, const void *member,
+                         unsigned char *major_type, uint64_t *val)
+{
+    int64_t sval;
+
+    *major_type = CBOR_UINT;
+
+    switch (field->type) {
+        case STRUCT_CODEC_INT32:
+            sval = *(const int32_t *)member;
+            break;
+        case STRUCT_CODEC_INT64:
+            sval = *(const int64_t *)member;
+            break;
+        case STRUCT_CODEC_UINT32:
+            *val = *(const uint32_t *)member;
+            return 0;
+        case STRUCT_CODEC_UINT64:
+            *val = *(const uint64_t *)member;
+            return 0;
+        default: /* STRUCT_CODEC_TEXT */
+            *major_type = CBOR_TEXT;
+            *val = text_len(field, member);
+            return (size_t)*val;
+    }
+
+    if (sval < 0) {
+        *major_type = CBOR_NEGINT;
+        *val = -1 - sval;
+    }
+    else {
+        *val = sval;
+    }
+
+    return 0;
+}
+
+size_t cbor_codec_size(const struct_codec_t *codec, const void *val)
+{
+    size_t size = head_size(codec->numof);
+
+    for (unsigned i = 0; i < codec->numof; i++) {
+        const struct_codec_field_t *field = &codec->fields[i];
+        const unsigned char *member = (const unsigned char *)val + field->offset;
+        unsigned char major_type;
+        uint64_t head;
+
+        size += head_size(field->key_len) + field->key_len;
+
+        switch (field->type) {
+            case STRUCT_CODEC_BOOL:
+                size += 1;
+                break;
+            case STRUCT_CODEC_FLOAT:
+                size += 5;
+                break;
+            default:
+                size += field_head(field, member, &major_type, &head);
+                size += head_size(head);
+                break;
+        }
+    }
+
+    return size;
+}
+
+size_t cbor_codec_encode(const struct_codec_t *codec, const void *val,
+                         unsigned char *buf, size_t size)
+{
+    size_t len = cbor_codec_size(codec, val);
+
+    if (len > size) {
+        return 0;
+    }
+
+    /* the whole map fits, no need to check the size anymore */
+    unsigned char *out = buf + encode_head(buf, CBOR_MAP, codec->numof);
+
+    for (unsigned i = 0; i < codec->numof; i++) {
+        const struct_codec_field_t *field = &codec->fields[i];
+        const unsigned char *member = (const unsigned char *)val + field->offset;
+        unsigned char major_type;
+        uint64_t head;
+        uint32_t bits;
+        size_t content;
+
+        out += encode_head(out, CBOR_TEXT, field->key_len);
+        memcpy(out, field->key, field->key_len);
+        out += field->key_len;
+
+        switch (field->type) {
+            case STRUCT_CODEC_BOOL:
+                *(out++) = *(const bool *)member ? CBOR_TRUE : CBOR_FALSE;
+                break;
+            case STRUCT_CODEC_FLOAT:
+                memcpy(&bits, member, sizeof(bits));
+                *(out++) = CBOR_FLOAT32;
+                for (int j = 3; j >= 0; --j) {
+                    *(out++) = (bits >> (8 * j)) & 0xff;
+                }
+                break;
+            default:
+                content = field_head(field, member, &major_type, &head);
+                out += encode_head(out, major_type, head);
+                memcpy(out, member, content);
+                out += content;
+                break;
+        }
+    }
+
+    return len;
+}
+
+static int decode_int64(const cbor_item_t *item, int64_t *val)
+{
+    if (((item->type != CBOR_ITEM_UINT) && (item->type != CBOR_ITEM_NEGINT)) ||
+        (item->val > INT64_MAX)) {
+        return -1;
+    }
+
+    *val = (item->type == CBOR_ITEM_UINT) ? (int64_t)item->val : -1 - (int64_t)item->val;
+    return 0;
+}
+
+size_t cbor_codec_decode(const struct_codec_t *codec, void *val,
+                         const unsigned char *buf, size_t size)
+{
+    cbor_reader_t reader;
+    cbor_item_t item;
+
+    cbor_reader_init(&reader, buf, size);
+
+    if (!cbor_reader_next(&reader, &item) || (item.type != CBOR_ITEM_MAP) ||
+        (item.val != codec->numof)) {
+        return 0;
+    }
+
+    for (unsigned i = 0; i < codec->numof; i++) {
+        const struct_codec_field_t *field = &codec->fields[i];
+        unsigned char *member = (unsigned char *)val + field->offset;
+        int64_t sval;
+        uint32_t bits;
+
+        if (!cbor_reader_next(&reader, &item) || (item.type != CBOR_ITEM_TEXT) ||
+            (item.val != field->key_len) ||
+            (memcmp(item.ptr, field->key, field->key_len) != 0) ||
+            !cbor_reader_next(&reader, &item)) {
+            return 0;
+        }
+
+        switch (field->type) {
+            case STRUCT_CODEC_INT32:
+                if ((decode_int64(&item, &sval) < 0) ||
+                    (sval < INT32_MIN) || (sval > INT32_MAX)) {
+                    return 0;
+                }
+                *(int32_t *)member = (int32_t)sval;
+                break;
+            case STRUCT_CODEC_INT64:
+                if (decode_int64(&item, (int64_t *)member) < 0) {
+                    return 0;
+                }
+                break;
+            case STRUCT_CODEC_UINT32:
+                if ((item.type != CBOR_ITEM_UINT) || (item.val > UINT32_MAX)) {
+                    return 0;
+                }
+                *(uint32_t *)member = (uint32_t)item.val;
+                break;
+            case STRUCT_CODEC_UINT64:
+                if (item.type != CBOR_ITEM_UINT) {
+                    return 0;
+                }
+                *(uint64_t *)member = item.val;
+                break;
+            case STRUCT_CODEC_BOOL:
+                if ((item.type != CBOR_ITEM_SIMPLE) ||
+                    ((item.val != (CBOR_TRUE & CBOR_INFO_MASK)) &&
+                     (item.val != (CBOR_FALSE & CBOR_INFO_MASK)))) {
+                    return 0;
+                }
+                *(bool *)member = (item.val == (CBOR_TRUE & CBOR_INFO_MASK));
+                break;
+            case STRUCT_CODEC_FLOAT:
+                if ((item.type != CBOR_ITEM_FLOAT) || (item.size != sizeof(bits))) {
+                    return 0;
+                }
+                bits = (uint32_t)item.val;
+                memcpy(member, &bits, sizeof(bits));
+                break;
+            default: /* STRUCT_CODEC_TEXT */
+                if ((item.type != CBOR_ITEM_TEXT) || (item.val >= field->size)) {
+                    return 0;
+                }
+                memcpy(member, item.ptr, (size_t)item.val);
+                member[item.val] = '\0';
+                break;
+        }
+    }
+
+    return reader.pos;
+}
+
 #ifndef CBOR_NO_PRINT
 /* BEGIN: Printers */
 void cbor_stream_print(const cbor_stream_t *stream)
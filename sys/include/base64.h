@@ -11,6 +11,15 @@
  * @defgroup    sys_base64 base64 encoder decoder
  * @ingroup     sys
  * @brief       base64 encoder and decoder
+ *
+ * Both directions are table driven and convert a whole group of 3 bytes /
+ * 4 symbols per iteration. If the compiler targets SSSE3 (e.g. `native`
+ * built with `CFLAGS += -mssse3`), blocks of 12 bytes / 16 symbols are
+ * converted with vector instructions.
+ *
+ * Inputs which do not fit into memory at once can be processed in chunks
+ * of arbitrary size with the streaming API, see base64_encode_update() and
+ * base64_decode_update().
  * @{
  *
  * @brief       encoding and decoding functions for base64
@@ -21,6 +30,7 @@
 #define BASE64_ENCODER_DECODER_H_
 
 #include <stddef.h> /* for size_t */
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +84,93 @@ int base64_encode(unsigned char *data_in, size_t data_in_size, \
 int base64_decode(unsigned char *base64_in, size_t base64_in_size, \
                   unsigned char *data_out, size_t *data_out_size);
 
+/**
+ * @brief   State of a streaming base64 encoder
+ */
+typedef struct {
+    unsigned char rest[2];  /**< input bytes not encoded yet */
+    uint8_t rest_len;       /**< number of bytes in base64_encoder_t::rest */
+} base64_encoder_t;
+
+/**
+ * @brief   State of a streaming base64 decoder
+ */
+typedef struct {
+    uint32_t bits;          /**< symbols not decoded yet, 6 bit each */
+    uint8_t num;            /**< number of symbols in base64_decoder_t::bits */
+} base64_decoder_t;
+
+/**
+ * @brief   Maximum number of symbols base64_encode_update() produces for
+ *          @p len input bytes
+ */
+#define BASE64_ENCODE_UPDATE_SIZE(len)  (4 * (((len) + 2) / 3))
+
+/**
+ * @brief   Maximum number of bytes base64_decode_update() produces for
+ *          @p len input symbols
+ */
+#define BASE64_DECODE_UPDATE_SIZE(len)  (3 * (((len) + 3) / 4))
+
+/**
+ * @brief           Initializes a streaming encoder
+ * @param[out]      enc     encoder state
+ */
+void base64_encode_init(base64_encoder_t *enc);
+
+/**
+ * @brief           Encodes the next chunk of a datum
+ * @details         Bytes which do not complete a group of 3 are kept in
+ *                  @p enc and encoded with the next call.
+ * @param[in,out]   enc             encoder state
+ * @param[in]       data_in         next chunk of the datum
+ * @param[in]       data_in_size    size of `data_in`
+ * @param[out]      base64_out      destination, must hold at least
+ *                                  BASE64_ENCODE_UPDATE_SIZE(data_in_size)
+ *                                  symbols
+ * @returns         number of symbols written to `base64_out`
+ */
+size_t base64_encode_update(base64_encoder_t *enc, const unsigned char *data_in,
+                            size_t data_in_size, unsigned char *base64_out);
+
+/**
+ * @brief           Encodes the remaining bytes including the '=' padding
+ * @param[in,out]   enc         encoder state
+ * @param[out]      base64_out  destination, must hold at least 4 symbols
+ * @returns         number of symbols written to `base64_out`
+ */
+size_t base64_encode_final(base64_encoder_t *enc, unsigned char *base64_out);
+
+/**
+ * @brief           Initializes a streaming decoder
+ * @param[out]      dec     decoder state
+ */
+void base64_decode_init(base64_decoder_t *dec);
+
+/**
+ * @brief           Decodes the next chunk of a base64 string
+ * @details         Like base64_decode(), characters which are no base64
+ *                  symbols (including '=') are ignored. Symbols which do not
+ *                  complete a group of 4 are kept in @p dec.
+ * @param[in,out]   dec             decoder state
+ * @param[in]       base64_in       next chunk of the base64 string
+ * @param[in]       base64_in_size  size of `base64_in`
+ * @param[out]      data_out        destination, must hold at least
+ *                                  BASE64_DECODE_UPDATE_SIZE(base64_in_size)
+ *                                  bytes
+ * @returns         number of bytes written to `data_out`
+ */
+size_t base64_decode_update(base64_decoder_t *dec, const unsigned char *base64_in,
+                            size_t base64_in_size, unsigned char *data_out);
+
+/**
+ * @brief           Decodes the remaining symbols
+ * @param[in,out]   dec         decoder state
+ * @param[out]      data_out    destination, must hold at least 2 bytes
+ * @returns         number of bytes written to `data_out`
+ */
+size_t base64_decode_final(base64_decoder_t *dec, unsigned char *data_out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -105,6 +105,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "struct_codec.h"
+
 #ifndef CBOR_NO_CTIME
 #include <time.h>
 #endif /* CBOR_NO_CTIME */
@@ -637,6 +639,412 @@ bool cbor_at_break(const cbor_stream_t *stream, size_t offset);
  */
 bool cbor_at_end(const cbor_stream_t *stream, size_t offset);
 
+/**
+ * @name    Streaming writer
+ *
+ * The streaming writer emits CBOR directly into a chain of output buffers,
+ * e.g. the payload snips of a pktbuf packet, instead of one contiguous
+ * buffer. Whenever the current buffer is full the writer calls a
+ * user-supplied callback that either installs the next buffer with
+ * cbor_writer_set_buffer() or refuses to continue (back-pressure), in which
+ * case the current write fails.
+ *
+ * Writing into a chain of pktbuf snips:
+ * @code
+ * static int _next_snip(cbor_writer_t *writer, void *arg)
+ * {
+ *     gnrc_pktsnip_t **snip = arg;
+ *
+ *     if ((*snip = (*snip)->next) == NULL) {
+ *         return -1;
+ *     }
+ *     cbor_writer_set_buffer(writer, (*snip)->data, (*snip)->size);
+ *     return 0;
+ * }
+ *
+ * gnrc_pktsnip_t *snip = pkt;
+ * cbor_writer_t writer;
+ * cbor_writer_init(&writer, snip->data, snip->size, _next_snip, &snip);
+ * cbor_writer_map(&writer, 1);
+ * cbor_writer_text(&writer, "temp", 4);
+ * cbor_writer_int(&writer, -5);
+ * @endcode
+ *
+ * All `cbor_writer_*()` functions return the number of bytes written, or 0
+ * if the callback refused to supply more space. In the latter case the bytes
+ * that did fit are already part of the output.
+ * @{
+ */
+
+/**
+ * @brief   Forward declaration of the streaming writer
+ */
+typedef struct cbor_writer cbor_writer_t;
+
+/**
+ * @brief   Callback called when the current buffer of a writer is full
+ *
+ * @param[in] writer    The writer that needs more space
+ * @param[in] arg       Argument given in cbor_writer_init()
+ *
+ * @return  0, if a new buffer was set with cbor_writer_set_buffer()
+ * @return  < 0, to stop writing
+ */
+typedef int (*cbor_writer_cb_t)(cbor_writer_t *writer, void *arg);
+
+/**
+ * @brief   CBOR streaming writer
+ */
+struct cbor_writer {
+    unsigned char *buf;     /**< current output buffer */
+    size_t size;            /**< size of @ref cbor_writer_t::buf */
+    size_t pos;             /**< write position in @ref cbor_writer_t::buf */
+    size_t len;             /**< bytes written to previous buffers */
+    cbor_writer_cb_t cb;    /**< called when @ref cbor_writer_t::buf is full */
+    void *arg;              /**< argument for @ref cbor_writer_t::cb */
+};
+
+/**
+ * @brief   Initialize a streaming writer
+ *
+ * @param[out] writer   The writer to initialize
+ * @param[in] buf       First output buffer
+ * @param[in] size      Size of @p buf
+ * @param[in] cb        Callback to get the next buffer, may be NULL
+ * @param[in] arg       Argument for @p cb
+ */
+void cbor_writer_init(cbor_writer_t *writer, unsigned char *buf, size_t size,
+                      cbor_writer_cb_t cb, void *arg);
+
+/**
+ * @brief   Continue writing into a new buffer
+ *
+ * Typically called from within a @ref cbor_writer_cb_t.
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] buf           The next output buffer
+ * @param[in] size          Size of @p buf
+ */
+void cbor_writer_set_buffer(cbor_writer_t *writer, unsigned char *buf,
+                            size_t size);
+
+/**
+ * @brief   Get the total number of bytes written by @p writer
+ *
+ * @param[in] writer    The writer
+ *
+ * @return  Number of bytes written over all buffers
+ */
+static inline size_t cbor_writer_len(const cbor_writer_t *writer)
+{
+    return writer->len + writer->pos;
+}
+
+/**
+ * @brief   Write an unsigned integer
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] val           The value
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_uint(cbor_writer_t *writer, uint64_t val);
+
+/**
+ * @brief   Write a signed integer
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] val           The value
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_int(cbor_writer_t *writer, int64_t val);
+
+/**
+ * @brief   Write a boolean value
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] val           The value
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_bool(cbor_writer_t *writer, bool val);
+
+/**
+ * @brief   Write a byte string
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] val           The bytes
+ * @param[in] length        Number of bytes in @p val
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_bytes(cbor_writer_t *writer, const void *val,
+                         size_t length);
+
+/**
+ * @brief   Write a text string
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] val           The string, need not be NULL terminated
+ * @param[in] length        Length of @p val in bytes
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_text(cbor_writer_t *writer, const char *val, size_t length);
+
+/**
+ * @brief   Write the header of a byte string of @p length bytes
+ *
+ * The content is then written with (several calls to) cbor_writer_raw(), so
+ * it can be gathered from several sources without an intermediate buffer.
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] length        Length of the byte string that follows
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_bytes_header(cbor_writer_t *writer, size_t length);
+
+/**
+ * @brief   Write raw, already encoded data
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] data          The data
+ * @param[in] length        Length of @p data
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_raw(cbor_writer_t *writer, const void *data, size_t length);
+
+/**
+ * @brief   Write the header of an array of @p array_length items
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] array_length  Number of items that follow
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_array(cbor_writer_t *writer, size_t array_length);
+
+/**
+ * @brief   Write the header of an array of indefinite length
+ *
+ * Terminate the array with cbor_writer_break().
+ *
+ * @param[in,out] writer    The writer
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_array_indefinite(cbor_writer_t *writer);
+
+/**
+ * @brief   Write the header of a map of @p map_length key-value pairs
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] map_length    Number of key-value pairs that follow
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_map(cbor_writer_t *writer, size_t map_length);
+
+/**
+ * @brief   Write the header of a map of indefinite length
+ *
+ * Terminate the map with cbor_writer_break().
+ *
+ * @param[in,out] writer    The writer
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_map_indefinite(cbor_writer_t *writer);
+
+#ifndef CBOR_NO_SEMANTIC_TAGGING
+/**
+ * @brief   Write a semantic tag for the next item
+ *
+ * @param[in,out] writer    The writer
+ * @param[in] tag           The tag
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_tag(cbor_writer_t *writer, uint64_t tag);
+#endif /* CBOR_NO_SEMANTIC_TAGGING */
+
+/**
+ * @brief   Write a break symbol, terminating an indefinite length item
+ *
+ * @param[in,out] writer    The writer
+ *
+ * @return  Number of bytes written
+ */
+size_t cbor_writer_break(cbor_writer_t *writer);
+/** @} */
+
+/**
+ * @name    Pull parser
+ *
+ * The pull parser walks a CBOR encoded buffer item by item. Byte and text
+ * strings are returned as a view into the input buffer, no data is copied.
+ *
+ * @code
+ * cbor_reader_t reader;
+ * cbor_item_t item;
+ * cbor_reader_init(&reader, pkt->data, pkt->size);
+ * while (cbor_reader_next(&reader, &item)) {
+ *     if (item.type == CBOR_ITEM_TEXT) {
+ *         handle(item.ptr, (size_t)item.val);
+ *     }
+ * }
+ * @endcode
+ * @{
+ */
+
+/**
+ * @brief   Maximum nesting depth handled by cbor_reader_skip()
+ */
+#ifndef CBOR_READER_MAX_DEPTH
+#define CBOR_READER_MAX_DEPTH   (8U)
+#endif
+
+/**
+ * @brief   Item types returned by the pull parser
+ */
+typedef enum {
+    CBOR_ITEM_UINT,     /**< unsigned integer, value in cbor_item_t::val */
+    CBOR_ITEM_NEGINT,   /**< negative integer -1 - cbor_item_t::val */
+    CBOR_ITEM_BYTES,    /**< byte string of cbor_item_t::val bytes */
+    CBOR_ITEM_TEXT,     /**< text string of cbor_item_t::val bytes */
+    CBOR_ITEM_ARRAY,    /**< array of cbor_item_t::val items */
+    CBOR_ITEM_MAP,      /**< map of cbor_item_t::val pairs */
+    CBOR_ITEM_TAG,      /**< semantic tag cbor_item_t::val */
+    CBOR_ITEM_SIMPLE,   /**< simple value (false, true, null, ...) */
+    CBOR_ITEM_FLOAT,    /**< float, raw IEEE 754 bits in cbor_item_t::val */
+    CBOR_ITEM_BREAK,    /**< end of an indefinite length item */
+} cbor_item_type_t;
+
+/**
+ * @brief   Item returned by the pull parser
+ */
+typedef struct {
+    cbor_item_type_t type;      /**< type of the item */
+    bool indefinite;            /**< item has indefinite length */
+    uint8_t size;               /**< size of a float in bytes (2, 4 or 8) */
+    uint64_t val;               /**< value, length or count (see type) */
+    const unsigned char *ptr;   /**< content of byte and text strings */
+} cbor_item_t;
+
+/**
+ * @brief   CBOR pull parser
+ */
+typedef struct {
+    const unsigned char *data;  /**< input buffer */
+    size_t size;                /**< size of @ref cbor_reader_t::data */
+    size_t pos;                 /**< offset of the next item */
+} cbor_reader_t;
+
+/**
+ * @brief   Initialize a pull parser
+ *
+ * @note Does *not* take ownership of @p buffer
+ *
+ * @param[out] reader   The reader to initialize
+ * @param[in] buffer    CBOR encoded data
+ * @param[in] size      Size of @p buffer
+ */
+void cbor_reader_init(cbor_reader_t *reader, const unsigned char *buffer,
+                      size_t size);
+
+/**
+ * @brief   Read the next item
+ *
+ * For arrays, maps and tags only the header is consumed, so the next call
+ * returns the first contained item.
+ *
+ * @param[in,out] reader    The reader
+ * @param[out] item         The item read
+ *
+ * @return  Number of bytes consumed from the input
+ * @return  0 at the end of the input or if the input is malformed
+ */
+size_t cbor_reader_next(cbor_reader_t *reader, cbor_item_t *item);
+
+/**
+ * @brief   Skip the next item, including all items nested in it
+ *
+ * @param[in,out] reader    The reader
+ *
+ * @return  Number of bytes skipped
+ * @return  0 at the end of the input, if the input is malformed or nested
+ *          deeper than @ref CBOR_READER_MAX_DEPTH
+ */
+size_t cbor_reader_skip(cbor_reader_t *reader);
+
+/**
+ * @brief   Whether @p reader consumed all its input
+ *
+ * @param[in] reader    The reader
+ *
+ * @return  True in case there is no more input
+ */
+static inline bool cbor_reader_at_end(const cbor_reader_t *reader)
+{
+    return reader->pos >= reader->size;
+}
+/** @} */
+
+/**
+ * @name    Struct codec
+ *
+ * Serialize structs described by a @ref sys_struct_codec schema as a CBOR
+ * map with the member names as text keys.
+ * @{
+ */
+
+/**
+ * @brief   Get the size of the CBOR encoding of @p val
+ *
+ * @param[in] codec     Schema of the struct
+ * @param[in] val       The struct to encode
+ *
+ * @return  Number of bytes needed to encode @p val
+ */
+size_t cbor_codec_size(const struct_codec_t *codec, const void *val);
+
+/**
+ * @brief   Encode @p val into @p buf
+ *
+ * The size is computed once up-front, all members are then written without
+ * further bounds checks.
+ *
+ * @param[in] codec     Schema of the struct
+ * @param[in] val       The struct to encode
+ * @param[out] buf      Output buffer
+ * @param[in] size      Size of @p buf
+ *
+ * @return  Number of bytes written to @p buf
+ * @return  0 if @p buf is too small
+ */
+size_t cbor_codec_encode(const struct_codec_t *codec, const void *val,
+                         unsigned char *buf, size_t size);
+
+/**
+ * @brief   Decode a struct from @p buf into @p val
+ *
+ * The members are expected in the order of the schema.
+ *
+ * @param[in] codec     Schema of the struct
+ * @param[out] val      The decoded struct
+ * @param[in] buf       CBOR encoded input
+ * @param[in] size      Size of @p buf
+ *
+ * @return  Number of bytes read from @p buf
+ * @return  0 if @p buf does not contain a struct matching @p codec
+ */
+size_t cbor_codec_decode(const struct_codec_t *codec, void *val,
+                         const unsigned char *buf, size_t size);
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif
@@ -64,6 +64,47 @@ void isrpipe_init(isrpipe_t *isrpipe, char *buf, size_t bufsize);
  */
 int isrpipe_write_one(isrpipe_t *isrpipe, char c);
 
+/**
+ * @brief   Put several characters into the isrpipe's buffer
+ *
+ * Wakes a waiting reader only once for the whole chunk.
+ *
+ * @param[in]   isrpipe     isrpipe object to operate on
+ * @param[in]   buf         characters to add to isrpipe buffer
+ * @param[in]   count       number of characters in @p buf
+ *
+ * @returns     number of characters added, less than @p count if the
+ *              buffer was full
+ */
+int isrpipe_write(isrpipe_t *isrpipe, const char *buf, size_t count);
+
+/**
+ * @brief   Get the contiguous free part of the isrpipe's buffer
+ *
+ * Characters written to @p data, e.g. by a DMA, become readable with
+ * isrpipe_commit_write(). Only the writer may call this function.
+ *
+ * @param[in]   isrpipe     isrpipe object to operate on
+ * @param[out]  data        start of the free space
+ *
+ * @returns     number of characters writable at @p data
+ */
+unsigned isrpipe_reserve_write(isrpipe_t *isrpipe, char **data);
+
+/**
+ * @brief   Make characters written directly into the isrpipe's buffer
+ *          readable
+ *
+ * The characters have to be written to the span returned by
+ * isrpipe_reserve_write() before. Wakes a waiting reader if @p count is not
+ * 0.
+ *
+ * @param[in]   isrpipe     isrpipe object to operate on
+ * @param[in]   count       number of characters written, must not exceed
+ *                          the span returned by isrpipe_reserve_write()
+ */
+void isrpipe_commit_write(isrpipe_t *isrpipe, size_t count);
+
 /**
  * @brief   Read data from isrpipe (blocking)
  *
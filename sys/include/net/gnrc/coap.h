@@ -31,6 +31,13 @@
  * gcoap itself defines a resource for `/.well-known/core` discovery, which
  * lists all of the registered paths.
  *
+ * A resource path whose last segment is a single asterisk is a wildcard, which
+ * matches any path below its prefix. The wildcard with prefix `/dev` matches
+ * `/dev/a` and `/dev/a/b`, but not `/dev`. The handler reads the full path
+ * from the coap_pkt_t _url_ attribute. A resource
+ * with exactly the requested path takes precedence over a wildcard, and a
+ * wildcard with a longer prefix over one with a shorter prefix.
+ *
  * ### Creating a response ###
  *
  * An application resource includes a callback function, a coap_handler_t. After
@@ -54,11 +61,79 @@
  * -# Call gcoap_finish() to complete the PDU after writing the payload,
  *    and return the result. gcoap will send the message.
  *
+ * The response to a confirmable request is piggybacked on the ACK. gcoap
+ * remembers the last GCOAP_DUP_CACHE_SIZE requests, so a duplicate request
+ * is answered with the same response, and not passed to the callback again.
+ *
  * If no payload, call only gcoap_response() to write the full response.
  * Alternatively, you still can use gcoap_resp_init() and gcoap_finish(), as
  * described above. In fact, the gcoap_response() function is inline, and uses
  * those two functions.
  *
+ * ### Block-wise transfer ###
+ *
+ * A resource too large for a single response, like a firmware image or a
+ * log, is transferred in blocks (RFC 7959), without ever being held in RAM as
+ * a whole. The callback for a GET request calls gcoap_block2_respond(), which
+ * asks a gcoap_block_read_t callback for the block at an offset. The callback
+ * writes the block directly into the response, e.g. from flash or from a
+ * generator. Likewise, the callback for a PUT or POST request calls
+ * gcoap_block1_receive(), which passes each block of the request payload to a
+ * gcoap_block_write_t callback.
+ *
+ * gcoap picks the block size from the request, the PDU buffer, and the
+ * maximum packet size of the interface the request came from, so a block
+ * fits into a single link layer frame where possible. See
+ * GCOAP_BLOCK_NET_OVERHEAD. Each block is a separate request, so the
+ * callbacks must not depend on the blocks arriving in order.
+ *
+ * ## Observe ##
+ *
+ * A client may observe a resource of the server (RFC 7641). gcoap registers
+ * the client as an observer when it sends a GET with an Observe option of
+ * value 0, and the callback for the resource creates a successful response.
+ * gcoap adds the Observe option to that response. A GET with Observe value 1,
+ * or a RST in reply to a notification, removes the registration. gcoap keeps
+ * up to GCOAP_OBS_REGISTRATIONS_MAX registrations across all resources.
+ *
+ * When the state of an observed resource changes, the application notifies
+ * the observers:
+ *
+ * -# Call gcoap_obs_init() to initialize the notification. Skip the following
+ *    steps if it returns GCOAP_OBS_INIT_UNUSED, so there are no observers.
+ * -# Write the payload, as for a response.
+ * -# Call gcoap_finish() to complete the notification.
+ * -# Call gcoap_obs_send() to send it.
+ *
+ * gcoap serializes the notification once and shares it among the observers;
+ * only the header with the token of an observer is allocated per observer.
+ * An observer receives at most one notification per GCOAP_OBS_MIN_INTERVAL,
+ * or per smoothed round-trip time to the observer if longer. A notification
+ * which comes sooner waits, and is replaced by any newer notification, so an
+ * observer always receives the latest state.
+ *
+ * ## Forward proxy ##
+ *
+ * With module `gcoap_proxy`, gcoap acts as a forward proxy (RFC 7252,
+ * section 5.7), e.g. on a border router between cloud clients and
+ * constrained servers. gcoap forwards a GET request with a Proxy-Uri option of
+ * the form `coap://[address]:port/path?query` to the origin server, and
+ * relays the response. Other methods and schemes are answered with 5.05
+ * (Proxying Not Supported). Without the module, gcoap answers any request
+ * with Proxy-Uri option that way.
+ *
+ * A 2.05 (Content) response is cached for its Max-Age, keyed by the origin
+ * server, the path, the query, and the other options of the request. Cached
+ * responses are stored in the packet buffer and take at most
+ * GCOAP_PROXY_CACHE_SIZE bytes; the least recently used one is evicted first.
+ * A request for a response which already is being fetched from the origin
+ * server does not cause another upstream request, but waits for the same
+ * response.
+ *
+ * A response from the cache is piggybacked on the ACK of a confirmable
+ * request. Otherwise the response is separate, and non-confirmable. See
+ * gcoap_proxy_stats() to monitor the cache.
+ *
  * ## Client Operation ##
  *
  * gcoap uses RIOT's asynchronous messaging facility to send and receive
@@ -88,6 +163,23 @@
  * Finally, call gcoap_req_send() with the destination host and port, as well
  * as a callback function for the host's response.
  *
+ * ### Confirmable requests ###
+ *
+ * gcoap_req_init() creates a non-confirmable (NON) request. To send a
+ * confirmable (CON) request instead, call gcoap_hdr_set_type() with
+ * COAP_TYPE_CON after gcoap_req_init(). gcoap retransmits a CON request until
+ * the server acknowledges it, at most GCOAP_MAX_RETRANSMIT times, and backs off
+ * exponentially between retransmissions. If the server acknowledges the
+ * request with an empty ACK, gcoap waits another GCOAP_NON_TIMEOUT for the
+ * separate response.
+ *
+ * The first timeout for a request is the retransmission timeout (RTO) of the
+ * destination, estimated per peer from the round-trip times of earlier
+ * exchanges as in CoCoA (draft-ietf-core-cocoa). The back-off factor is 3 for
+ * an RTO below 1 sec, 1.5 for an RTO above 3 sec, and 2 otherwise. See
+ * gcoap_con_stats() and gcoap_peer_rto() to monitor retransmissions and
+ * round-trip times.
+ *
  * ### Handling the response ###
  *
  * When gcoap receives the response to a request, it executes the callback from
@@ -116,6 +208,15 @@
  * gcoap_finish(). We trade some inefficiency/work in the buffer for
  * simplicity for the user.
  *
+ * ### Finding a resource ###
+ *
+ * gcoap_register_listener() adds the paths of the resources to a hash table
+ * of GCOAP_RESOURCE_INDEX_SIZE entries, so finding the resource for a request
+ * does not depend on the number of registered resources. If the table is
+ * full, gcoap falls back to scanning all listeners, which is only visible as a
+ * DEBUG message. Define GCOAP_RESOURCE_INDEX_SIZE to at least the total number
+ * of resources, including `/.well-known/core`, to avoid this.
+ *
  * ### Waiting for a response ###
  *
  * We take advantage of RIOT's GNRC stack by using an xtimer to wait for a
@@ -124,6 +225,14 @@
  * times out. We track the response with an entry in the
  * `_coap_state.open_reqs` array.
  *
+ * Up to GCOAP_REQ_WAITING_MAX requests may wait for a response at the same
+ * time. Unused entries are kept in a free list, and waiting entries in a hash
+ * table by token, so neither sending a request nor matching a response scans
+ * the array. All waiting entries share a single xtimer, which fires at the
+ * earliest deadline in a queue ordered by deadline. Raise
+ * GCOAP_REQ_INDEX_SIZE along with GCOAP_REQ_WAITING_MAX to keep the hash
+ * buckets short.
+ *
  * @{
  *
  * @file
@@ -138,6 +247,7 @@
 #include "net/gnrc.h"
 #include "net/gnrc/ipv6.h"
 #include "net/gnrc/udp.h"
+#include "mutex.h"
 #include "nanocoap.h"
 #include "xtimer.h"
 
@@ -153,8 +263,14 @@ extern "C" {
 #define GCOAP_PORT  (5683)
 #endif
 
-/** @brief Size of the buffer used to build a CoAP request or response. */
+/**
+ * @brief Size of the buffer used to build a CoAP request or response.
+ *
+ * Also limits the size of a block in a block-wise transfer.
+ */
+#ifndef GCOAP_PDU_BUF_SIZE
 #define GCOAP_PDU_BUF_SIZE  (128)
+#endif
 
 /**
  * @brief Size of the buffer used to write options, other than Uri-Path, in a
@@ -167,12 +283,42 @@ extern "C" {
 /**
  * @brief Size of the buffer used to write options in a response.
  *
- * Accommodates Content-Format.
+ * Accommodates Content-Format, and Block1 or Block2.
  */
 #define GCOAP_RESP_OPTIONS_BUF  (8)
 
+/**
+ * @brief Number of entries in the hash table of resource paths; must be a
+ *        power of 2
+ *
+ * Resources that do not fit are still found, by scanning all listeners for
+ * every request. gcoap_register_listener() does not fail in this case, so
+ * size the table for all resources, including `/.well-known/core`.
+ */
+#ifndef GCOAP_RESOURCE_INDEX_SIZE
+#define GCOAP_RESOURCE_INDEX_SIZE   (16)
+#endif
+#if (GCOAP_RESOURCE_INDEX_SIZE < 1) || \
+    ((GCOAP_RESOURCE_INDEX_SIZE & (GCOAP_RESOURCE_INDEX_SIZE - 1)) != 0)
+#error "GCOAP_RESOURCE_INDEX_SIZE must be a power of 2"
+#endif
+
 /** @brief Maximum number of requests awaiting a response */
+#ifndef GCOAP_REQ_WAITING_MAX
 #define GCOAP_REQ_WAITING_MAX   (2)
+#endif
+
+/**
+ * @brief Number of buckets in each hash table of requests awaiting a
+ *        response, by token and by message ID; must be a power of 2
+ */
+#ifndef GCOAP_REQ_INDEX_SIZE
+#define GCOAP_REQ_INDEX_SIZE    (4)
+#endif
+#if (GCOAP_REQ_INDEX_SIZE < 1) || \
+    ((GCOAP_REQ_INDEX_SIZE & (GCOAP_REQ_INDEX_SIZE - 1)) != 0)
+#error "GCOAP_REQ_INDEX_SIZE must be a power of 2"
+#endif
 
 /** @brief Maximum length in bytes for a token */
 #define GCOAP_TOKENLEN_MAX      (8)
@@ -206,15 +352,166 @@ extern "C" {
  */
 #define GCOAP_NON_TIMEOUT    (5000000U)
 
+/**
+ * @name Confirmable messaging parameters
+ * @{
+ */
+/** @brief Initial retransmission timeout for an unknown peer, in usec */
+#ifndef GCOAP_ACK_TIMEOUT
+#define GCOAP_ACK_TIMEOUT       (2000000U)
+#endif
+
+/** @brief Maximum number of retransmissions of a confirmable request */
+#ifndef GCOAP_MAX_RETRANSMIT
+#define GCOAP_MAX_RETRANSMIT    (4)
+#endif
+
+/** @brief Upper limit for the retransmission timeout of a peer, in usec */
+#define GCOAP_RTO_MAX           (60000000U)
+
+/** @brief Number of peers to estimate the retransmission timeout for */
+#ifndef GCOAP_RTO_PEERS_MAX
+#define GCOAP_RTO_PEERS_MAX     (2)
+#endif
+
+/** @brief Number of recent requests remembered to detect duplicates */
+#ifndef GCOAP_DUP_CACHE_SIZE
+#define GCOAP_DUP_CACHE_SIZE    (2)
+#endif
+
+/** @brief Time a request is remembered, in usec; EXCHANGE_LIFETIME of RFC 7252 */
+#ifndef GCOAP_DUP_LIFETIME
+#define GCOAP_DUP_LIFETIME      (247000000U)
+#endif
+/** @} */
+
+/**
+ * @name Observe parameters
+ * @{
+ */
+/** @brief Maximum number of observers, across all resources */
+#ifndef GCOAP_OBS_REGISTRATIONS_MAX
+#define GCOAP_OBS_REGISTRATIONS_MAX     (2)
+#endif
+
+/** @brief Minimum time between two notifications to an observer, in usec */
+#ifndef GCOAP_OBS_MIN_INTERVAL
+#define GCOAP_OBS_MIN_INTERVAL          (1000000U)
+#endif
+/** @} */
+
+/**
+ * @name Return values for gcoap_obs_init()
+ * @{
+ */
+#define GCOAP_OBS_INIT_OK       (0)     /**< Notification initialized */
+#define GCOAP_OBS_INIT_ERR      (-1)    /**< Initialization failed */
+#define GCOAP_OBS_INIT_UNUSED   (-2)    /**< Resource has no observers */
+/** @} */
+
+/**
+ * @name Block-wise transfer parameters
+ * @{
+ */
+/**
+ * @brief Bytes of a packet reserved for the IPv6 and UDP headers, when sizing
+ *        a block for the link MTU
+ *
+ * Assumes uncompressed headers. Lower it if 6LoWPAN header compression is
+ * known to be effective, to allow larger blocks.
+ */
+#ifndef GCOAP_BLOCK_NET_OVERHEAD
+#define GCOAP_BLOCK_NET_OVERHEAD    (sizeof(ipv6_hdr_t) + sizeof(udp_hdr_t))
+#endif
+
+/** @brief Exponent of the largest block size, 1024 bytes, RFC 7959 */
+#define GCOAP_BLOCK_SZX_MAX         (6)
+/** @} */
+
+/**
+ * @name Forward proxy parameters, for module gcoap_proxy
+ * @{
+ */
+/** @brief Bytes of the packet buffer used by the proxy for cached responses */
+#ifndef GCOAP_PROXY_CACHE_SIZE
+#define GCOAP_PROXY_CACHE_SIZE      (512U)
+#endif
+
+/** @brief Maximum number of cached responses and upstream requests */
+#ifndef GCOAP_PROXY_ENTRIES_MAX
+#define GCOAP_PROXY_ENTRIES_MAX     (4)
+#endif
+
+/** @brief Maximum number of client requests waiting for a response */
+#ifndef GCOAP_PROXY_WAITERS_MAX
+#define GCOAP_PROXY_WAITERS_MAX     (4)
+#endif
+
+/** @brief Maximum length of a Proxy-Uri */
+#ifndef GCOAP_PROXY_URI_MAXLEN
+#define GCOAP_PROXY_URI_MAXLEN      (64)
+#endif
+
+/** @brief Max-Age of a response without Max-Age option, in sec */
+#define GCOAP_PROXY_MAX_AGE_DEFAULT (60U)
+/** @} */
+
+#ifndef COAP_OPT_OBSERVE
+/** @brief Observe option number, RFC 7641 */
+#define COAP_OPT_OBSERVE        (6)
+#endif
+
+#ifndef COAP_OPT_URI_PORT
+/** @brief Uri-Port option number */
+#define COAP_OPT_URI_PORT       (7)
+#endif
+
+#ifndef COAP_OPT_MAX_AGE
+/** @brief Max-Age option number */
+#define COAP_OPT_MAX_AGE        (14)
+#endif
+
+#ifndef COAP_OPT_URI_QUERY
+/** @brief Uri-Query option number */
+#define COAP_OPT_URI_QUERY      (15)
+#endif
+
+#ifndef COAP_OPT_PROXY_URI
+/** @brief Proxy-Uri option number */
+#define COAP_OPT_PROXY_URI      (35)
+#endif
+
+#ifndef COAP_OPT_PROXY_SCHEME
+/** @brief Proxy-Scheme option number */
+#define COAP_OPT_PROXY_SCHEME   (39)
+#endif
+
+#ifndef COAP_OPT_BLOCK2
+/** @brief Block2 option number, RFC 7959 */
+#define COAP_OPT_BLOCK2         (23)
+#endif
+
+#ifndef COAP_OPT_BLOCK1
+/** @brief Block1 option number, RFC 7959 */
+#define COAP_OPT_BLOCK1         (27)
+#endif
+
+#ifndef COAP_CODE_CONTINUE
+/** @brief 2.31 Continue response code, RFC 7959 */
+#define COAP_CODE_CONTINUE      ((2 << 5) | 31)
+#endif
+
 /** @brief Identifies a gcoap-specific timeout IPC message */
 #define GCOAP_NETAPI_MSG_TYPE_TIMEOUT    (0x1501)
 
+/** @brief Identifies a gcoap-specific IPC message to send notifications */
+#define GCOAP_NETAPI_MSG_TYPE_OBS        (0x1502)
+
 /**
  * @brief  A modular collection of resources for a server
  */
 typedef struct gcoap_listener {
-    coap_resource_t *resources;   /**< First element in the array of resources;
-                                       must order alphabetically */
+    coap_resource_t *resources;   /**< First element in the array of resources */
     size_t resources_len;         /**< Length of array */
     struct gcoap_listener *next;  /**< Next listener in list */
 } gcoap_listener_t;
@@ -227,18 +524,173 @@ typedef struct gcoap_listener {
  */
 typedef void (*gcoap_resp_handler_t)(unsigned req_state, coap_pkt_t* pdu);
 
+/**
+ * @brief  Reads a block of a resource for gcoap_block2_respond().
+ *
+ * @param[out] dst Payload of the response, to write the block to
+ * @param[in] offset Offset of the block within the representation
+ * @param[in] size Size of the block
+ * @param[in] arg Argument given to gcoap_block2_respond()
+ *
+ * After a full block, gcoap asks for a single byte at the offset of the next
+ * block, to find out whether it is the last block. So the callback must
+ * return 0 for an @p offset at or past the end of the representation.
+ *
+ * @return number of bytes written; less than @p size for the last block
+ * @return < 0 on error
+ */
+typedef ssize_t (*gcoap_block_read_t)(uint8_t *dst, size_t offset, size_t size,
+                                      void *arg);
+
+/**
+ * @brief  Writes a block of a request payload for gcoap_block1_receive().
+ *
+ * @param[in] src Payload of the request
+ * @param[in] offset Offset of the block within the representation
+ * @param[in] len Length of the block
+ * @param[in] more False for the last block
+ * @param[in] arg Argument given to gcoap_block1_receive()
+ *
+ * @return 0 on success
+ * @return < 0 on error
+ */
+typedef int (*gcoap_block_write_t)(const uint8_t *src, size_t offset,
+                                   size_t len, bool more, void *arg);
+
 /**
  * @brief  Memo to handle a response for a request
  */
-typedef struct {
+typedef struct gcoap_request_memo {
     unsigned state;                     /**< State of this memo, a GCOAP_MEMO... */
     uint8_t hdr_buf[GCOAP_HEADER_MAXLEN];
                                         /**< Stores a copy of the request header */
     gcoap_resp_handler_t resp_handler;  /**< Callback for the response */
-    xtimer_t response_timer;            /**< Limits wait for response */
-    msg_t timeout_msg;                  /**< For response timer */
+    uint32_t deadline;                  /**< End of current timeout, in usec */
+    gnrc_pktsnip_t *msg;                /**< Copy of an unacknowledged
+                                             confirmable request, or NULL */
+    ipv6_addr_t addr;                   /**< Destination of the request */
+    uint16_t port;                      /**< Destination port */
+    uint8_t retransmits;                /**< Retransmissions so far */
+    uint32_t timeout;                   /**< Current timeout, in usec */
+    uint32_t sent;                      /**< Time of first transmission */
+    struct gcoap_request_memo *next;    /**< Next memo in hash bucket by token,
+                                             or in free list */
+    struct gcoap_request_memo *id_next; /**< Next memo in hash bucket by
+                                             message ID */
+    struct gcoap_request_memo *tprev;   /**< Previous memo in timeout queue */
+    struct gcoap_request_memo *tnext;   /**< Next memo in timeout queue */
 } gcoap_request_memo_t;
 
+/**
+ * @brief  Round-trip time estimator, as in RFC 6298
+ */
+typedef struct {
+    uint32_t srtt;                      /**< Smoothed RTT in usec, 0 if no
+                                             sample yet */
+    uint32_t rttvar;                    /**< RTT variation in usec */
+} gcoap_rtt_est_t;
+
+/**
+ * @brief  Retransmission timeout (RTO) state for a peer
+ */
+typedef struct {
+    ipv6_addr_t addr;                   /**< Peer address; unspecified if
+                                             unused */
+    gcoap_rtt_est_t strong;             /**< For exchanges without
+                                             retransmission */
+    gcoap_rtt_est_t weak;               /**< For exchanges with one or two
+                                             retransmissions */
+    uint32_t rto;                       /**< Overall RTO in usec */
+    uint32_t updated;                   /**< Time of last change of rto */
+    uint32_t last_used;                 /**< Time of last use */
+} gcoap_peer_t;
+
+/**
+ * @brief  Recent request, to detect duplicates
+ */
+typedef struct {
+    ipv6_addr_t addr;                   /**< Source of the request */
+    uint16_t port;                      /**< Source port; 0 if unused */
+    uint16_t id;                        /**< Message ID */
+    uint32_t time;                      /**< Time of receipt */
+    gnrc_pktsnip_t *resp;               /**< Copy of the response to a
+                                             confirmable request, or NULL */
+} gcoap_dup_entry_t;
+
+/**
+ * @brief  Statistics on confirmable messaging
+ */
+typedef struct {
+    uint32_t con_sent;                  /**< Confirmable requests sent */
+    uint32_t retransmissions;           /**< Retransmissions of confirmable
+                                             requests */
+    uint32_t con_timeouts;              /**< Confirmable requests never
+                                             acknowledged */
+    uint32_t rtt_samples;               /**< RTT samples used for the RTO */
+    uint32_t rtt_last;                  /**< Last measured RTT in usec */
+    uint32_t duplicates;                /**< Duplicate requests received */
+} gcoap_con_stats_t;
+
+/**
+ * @brief  Registration of an observer for a resource
+ */
+typedef struct {
+    const coap_resource_t *resource;    /**< Observed resource; NULL if
+                                             unused */
+    ipv6_addr_t addr;                   /**< Address of the observer */
+    uint16_t port;                      /**< Port of the observer */
+    uint8_t token[GCOAP_TOKENLEN_MAX];  /**< Token of the registration */
+    uint8_t token_len;                  /**< Length of token */
+    uint8_t pending_code;               /**< Response code for pending */
+    uint16_t last_id;                   /**< Message ID of last notification */
+    uint32_t last_sent;                 /**< Time of last notification */
+    gnrc_pktsnip_t *pending;            /**< Body of a notification waiting for
+                                             the minimum interval, or NULL */
+} gcoap_observe_t;
+
+/**
+ * @brief  Client request waiting for the response of an origin server
+ */
+typedef struct gcoap_proxy_waiter {
+    ipv6_addr_t addr;                   /**< Address of the client */
+    uint16_t port;                      /**< Port of the client; 0 if unused */
+    uint8_t token[GCOAP_TOKENLEN_MAX];  /**< Token of the request */
+    uint8_t token_len;                  /**< Length of token */
+    struct gcoap_proxy_waiter *next;    /**< Next client waiting for the same
+                                             response */
+} gcoap_proxy_waiter_t;
+
+/**
+ * @brief  Proxy cache entry, for a cached response or an upstream request
+ */
+typedef struct {
+    ipv6_addr_t addr;                   /**< Origin server */
+    uint16_t port;                      /**< Port of the origin server */
+    uint16_t key_len;                   /**< Length of the request options at
+                                             the start of data */
+    uint32_t hash;                      /**< Hash of origin and request options */
+    uint8_t code;                       /**< Response code */
+    uint8_t token[GCOAP_TOKENLEN_MAX];  /**< Token of the upstream request */
+    uint64_t expires;                   /**< End of freshness, in usec */
+    uint32_t last_used;                 /**< Time of last use, in usec */
+    gnrc_pktsnip_t *data;               /**< Request options, followed by the
+                                             response options and payload
+                                             once cached; NULL if unused */
+    gcoap_proxy_waiter_t *waiters;      /**< Clients waiting for the response
+                                             of the origin server; NULL once
+                                             cached */
+} gcoap_proxy_entry_t;
+
+/**
+ * @brief  Statistics of the forward proxy
+ */
+typedef struct {
+    uint32_t hits;                      /**< Requests answered from the cache */
+    uint32_t misses;                    /**< Requests forwarded to the origin */
+    uint32_t coalesced;                 /**< Requests answered by the response
+                                             to an earlier forwarded request */
+} gcoap_proxy_stats_t;
+
 /**
  * @brief  Container for the state of gcoap itself
  */
@@ -246,10 +698,46 @@ typedef struct {
     gnrc_netreg_entry_t netreg_port;   /**< Registration for IP port */
     gcoap_listener_t *listeners;       /**< List of registered listeners */
     gcoap_request_memo_t open_reqs[GCOAP_REQ_WAITING_MAX];
-                                       /**< Storage for open requests; if first
-                                            byte of an entry is zero, the entry
-                                            is available */
-    uint16_t last_message_id;          /**< Last message ID used */
+                                       /**< Storage for open requests */
+    gcoap_request_memo_t *req_index[GCOAP_REQ_INDEX_SIZE];
+                                       /**< Open requests, hashed by token */
+    gcoap_request_memo_t *id_index[GCOAP_REQ_INDEX_SIZE];
+                                       /**< Open requests, hashed by message
+                                            ID */
+    gcoap_request_memo_t *req_free;    /**< Unused entries of open_reqs */
+    gcoap_request_memo_t *timeout_queue;
+                                       /**< Open requests, ordered by deadline */
+    unsigned open_reqs_numof;          /**< Number of open requests */
+    xtimer_t timeout_timer;            /**< Fires at the first deadline */
+    msg_t timeout_msg;                 /**< For timeout_timer */
+    gcoap_peer_t peers[GCOAP_RTO_PEERS_MAX];
+                                       /**< RTO state of recent peers */
+    gcoap_dup_entry_t dups[GCOAP_DUP_CACHE_SIZE];
+                                       /**< Recent requests received */
+    gcoap_con_stats_t con_stats;       /**< Confirmable messaging statistics */
+    gcoap_observe_t observers[GCOAP_OBS_REGISTRATIONS_MAX];
+                                       /**< Observe registrations */
+    uint32_t obs_seq;                  /**< Last Observe sequence number */
+    xtimer_t obs_timer;                /**< Fires when a waiting notification
+                                            may be sent */
+    msg_t obs_msg;                     /**< For obs_timer */
+    mutex_t lock;                      /**< Protects open requests, peers,
+                                            observers and message IDs */
+#ifdef MODULE_GCOAP_PROXY
+    gcoap_proxy_entry_t proxy_cache[GCOAP_PROXY_ENTRIES_MAX];
+                                       /**< Proxy cache */
+    gcoap_proxy_waiter_t proxy_waiters[GCOAP_PROXY_WAITERS_MAX];
+                                       /**< Clients waiting for the proxy */
+    size_t proxy_cache_used;           /**< Bytes used by proxy_cache */
+    gcoap_proxy_stats_t proxy_stats;   /**< Forward proxy statistics;
+                                            protected by lock */
+#endif
+    uint8_t *rcv_end;                  /**< End of the message being handled
+                                            by a callback */
+    kernel_pid_t req_iface;            /**< Interface of the request being
+                                            handled */
+    uint16_t last_message_id;          /**< Last message ID used; protected by
+                                            lock */
 } gcoap_state_t;
 
 /**
@@ -266,6 +754,9 @@ kernel_pid_t gcoap_init(void);
 /**
  * @brief   Starts listening for resource paths.
  *
+ * The resources may be given in any order. Several resources may share a
+ * path if they handle different methods.
+ *
  * @param listener Listener containing the resources.
  */
 void gcoap_register_listener(gcoap_listener_t *listener);
@@ -337,10 +828,22 @@ static inline ssize_t gcoap_request(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 size_t gcoap_req_send(uint8_t *buf, size_t len, ipv6_addr_t *addr, uint16_t port,
                                                 gcoap_resp_handler_t resp_handler);
 
+/**
+ * @brief  Sets the message type of a CoAP header.
+ *
+ * @param[in] hdr Header to change
+ * @param[in] type Message type, a COAP_TYPE... constant
+ */
+static inline void gcoap_hdr_set_type(coap_hdr_t *hdr, unsigned type)
+{
+    hdr->ver_t_tkl = (hdr->ver_t_tkl & ~0x30) | ((type & 0x3) << 4);
+}
+
 /**
  * @brief  Initializes a CoAP response packet on a buffer.
  *
- * Initializes payload location within the buffer based on packet setup.
+ * Initializes payload location within the buffer based on packet setup. The
+ * response to a confirmable request is an ACK.
  *
  * @param[in] pdu Response metadata
  * @param[in] buf Buffer containing the PDU
@@ -371,15 +874,154 @@ static inline ssize_t gcoap_response(coap_pkt_t *pdu, uint8_t *buf, size_t len,
                 : -1;
 }
 
+/**
+ * @brief  Writes a complete response with one block of a resource.
+ *
+ * Use from a resource callback for a GET request. Reads the block requested
+ * with the Block2 option of the request, or the first block, through @p read
+ * directly into the payload of a 2.05 (Content) response. The block size is
+ * the smaller of the size requested and the largest which fits into the
+ * buffer and into a packet for the interface the request came from.
+ *
+ * @param[in] pdu Request metadata, becomes the response metadata
+ * @param[in] buf Buffer containing the PDU
+ * @param[in] len Length of the buffer
+ * @param[in] format Format code for the payload
+ * @param[in] read Callback to read the block
+ * @param[in] arg Argument for @p read
+ *
+ * @return size of the PDU within the buffer
+ * @return < 0 on error
+ */
+ssize_t gcoap_block2_respond(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             unsigned format, gcoap_block_read_t read, void *arg);
+
+/**
+ * @brief  Passes one block of a request payload to @p write, and writes a
+ *         complete response.
+ *
+ * Use from a resource callback for a PUT or POST request. A request without
+ * Block1 option is a single, last block at offset 0. The response is 2.31
+ * (Continue) for all but the last block, and @p code for the last block. It
+ * asks the client for smaller blocks if the blocks of the client do not fit
+ * into the buffer or into a packet for the interface the request came from.
+ *
+ * @param[in] pdu Request metadata, becomes the response metadata
+ * @param[in] buf Buffer containing the PDU
+ * @param[in] len Length of the buffer
+ * @param[in] code Response code for the last block
+ * @param[in] write Callback to write the block
+ * @param[in] arg Argument for @p write
+ *
+ * @return size of the PDU within the buffer
+ * @return < 0 on error, including an error from @p write
+ */
+ssize_t gcoap_block1_receive(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             unsigned code, gcoap_block_write_t write, void *arg);
+
+/**
+ * @brief  Initializes a notification for the observers of a resource.
+ *
+ * The notification has the response code 2.05 (Content). Use
+ * coap_hdr_set_code() to change it.
+ *
+ * @param[out] pdu Notification metadata
+ * @param[in] buf Buffer for the notification
+ * @param[in] len Length of the buffer
+ * @param[in] resource Resource which has changed
+ *
+ * @return GCOAP_OBS_INIT_OK on success
+ * @return GCOAP_OBS_INIT_ERR on error
+ * @return GCOAP_OBS_INIT_UNUSED if the resource has no observers
+ */
+int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                   const coap_resource_t *resource);
+
+/**
+ * @brief  Sends a notification to all observers of a resource.
+ *
+ * Observers notified within their minimum interval receive the notification
+ * later, unless a newer notification replaces it.
+ *
+ * @param[in] buf Buffer with the notification, finished with gcoap_finish()
+ * @param[in] len Length of the notification
+ * @param[in] resource Resource which has changed
+ *
+ * @return number of observers notified or to be notified later
+ * @return -ENOMEM if the notification does not fit into the packet buffer
+ */
+int gcoap_obs_send(const uint8_t *buf, size_t len,
+                   const coap_resource_t *resource);
+
 /**
  * @brief Provides important operational statistics.
  *
  * Useful for monitoring.
  *
- * @param[out] open_reqs Count of unanswered requests
+ * @param[out] open_reqs Count of unanswered requests, at most UINT8_MAX
  */
 void gcoap_op_state(uint8_t *open_reqs);
 
+/**
+ * @brief Provides statistics on confirmable messaging.
+ *
+ * @param[out] stats Copy of the statistics
+ */
+void gcoap_con_stats(gcoap_con_stats_t *stats);
+
+/**
+ * @brief Provides the retransmission timeout estimated for a peer.
+ *
+ * @param[in] addr Address of the peer
+ *
+ * @return RTO in usec, GCOAP_ACK_TIMEOUT if unknown
+ */
+uint32_t gcoap_peer_rto(const ipv6_addr_t *addr);
+
+#if defined(MODULE_GCOAP_PROXY) || defined(DOXYGEN)
+/**
+ * @brief Provides statistics of the forward proxy.
+ *
+ * Only available with module `gcoap_proxy`.
+ *
+ * @param[out] stats Copy of the statistics
+ */
+void gcoap_proxy_stats(gcoap_proxy_stats_t *stats);
+#endif
+
+/* for testing */
+#ifdef TEST_SUITES
+/**
+ * @brief   Returns gcoap to the state right after gcoap_init()
+ *
+ * Releases all buffered packets, stops the timers and removes all listeners
+ * but the default one.
+ */
+void gcoap_reset(void);
+
+/**
+ * @brief   Handles a message as the gcoap thread would
+ *
+ * @param[in] msg   Message of type GNRC_NETAPI_MSG_TYPE_RCV, or one of the
+ *                  internal timer messages
+ */
+void gcoap_handle_msg(msg_t *msg);
+
+/**
+ * @brief   Provides access to the internal state of gcoap
+ *
+ * @return  The state
+ */
+gcoap_state_t *gcoap_get_state(void);
+
+/**
+ * @brief   Checks if a resource did not fit in the resource index
+ *
+ * @return  true, if requests fall back to scanning all listeners
+ */
+bool gcoap_resource_index_full(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
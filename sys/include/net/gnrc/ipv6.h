@@ -68,6 +68,28 @@ extern "C" {
 #define GNRC_IPV6_MSG_QUEUE_SIZE    (8U)
 #endif
 
+/**
+ * @brief   Number of worker threads packets to forward are handed to
+ *
+ * With the default of 0 the IPv6 thread forwards packets itself. Otherwise
+ * the IPv6 thread only parses the header of a packet to forward and hands it
+ * to one of the workers, chosen by a hash of source, destination and flow
+ * label, so the packets of a flow keep their order. A flow whose next hop
+ * interface is busy then does not hold up the other flows and the local
+ * traffic.
+ *
+ * The workers run at @ref GNRC_IPV6_PRIO. They still interleave with the
+ * IPv6 thread wherever one of them blocks, so the next hop resolution of a
+ * worker and the message handling of the IPv6 thread (NDP, neighbor cache
+ * timers) are serialized by a lock, to keep the neighbor cache at a single
+ * writer. The FIB has its own lock.
+ *
+ * @note    Only used with the `gnrc_ipv6_router` module.
+ */
+#ifndef GNRC_IPV6_FWD_WORKERS
+#define GNRC_IPV6_FWD_WORKERS       (0U)
+#endif
+
 /**
  * @brief   The PID to the IPv6 thread.
  *
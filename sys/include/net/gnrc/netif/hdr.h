@@ -82,6 +82,10 @@ typedef struct {
     uint8_t flags;              /**< flags as defined above */
     uint8_t rssi;               /**< rssi of received packet (optional) */
     uint8_t lqi;                /**< lqi of received packet (optional) */
+#if defined(MODULE_GNRC_RXTRACE) || defined(DOXYGEN)
+    uint32_t rxtrace;           /**< time of last tracepoint, see
+                                 *   @ref net_gnrc_rxtrace */
+#endif
 } gnrc_netif_hdr_t;
 
 /**
@@ -100,6 +104,9 @@ static inline void gnrc_netif_hdr_init(gnrc_netif_hdr_t *hdr, uint8_t src_l2addr
     hdr->rssi = 0;
     hdr->lqi = 0;
     hdr->flags = 0;
+#ifdef MODULE_GNRC_RXTRACE
+    hdr->rxtrace = 0;
+#endif
 }
 
 /**
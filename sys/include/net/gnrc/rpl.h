@@ -29,6 +29,12 @@
  *   USEMODULE += auto_init_gnrc_rpl
  *   ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  *
+ * - Adapt the DIO redundancy constant and minimum interval to the neighbor
+ *   density and consistency, see @ref sys_trickle
+ *   ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ {.mk}
+ *   USEMODULE += trickle_adaptive
+ *   ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
  * Auto-Initialization
  * -------------------
  *
@@ -151,7 +157,8 @@ extern "C" {
 #define GNRC_RPL_ALL_NODES_ADDR {{ 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1a }}
 
 /**
- * @brief   Message type for lifetime updates
+ * @brief   Message type for lifetime updates, sent when the earliest parent or
+ *          DODAG deadline is due
  */
 #define GNRC_RPL_MSG_TYPE_LIFETIME_UPDATE     (0x0900)
 
@@ -416,7 +423,11 @@ static inline bool GNRC_RPL_COUNTER_GREATER_THAN(uint8_t A, uint8_t B)
 #define GNRC_RPL_ICMPV6_CODE_DAO_ACK (0x03)
 
 /**
- * @brief Update interval of the lifetime update function
+ * @brief Lifetime margin in seconds
+ *
+ * A parent is asked for a DIO this long before it is removed, which happens
+ * this long before its lifetime ends. P2P-RPL DODAGs are updated in steps of
+ * this length.
  */
 #define GNRC_RPL_LIFETIME_UPDATE_STEP (2)
 
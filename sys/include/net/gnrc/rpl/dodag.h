@@ -156,6 +156,16 @@ void gnrc_rpl_parent_update(gnrc_rpl_dodag_t *dodag, gnrc_rpl_parent_t *parent);
  */
 void gnrc_rpl_local_repair(gnrc_rpl_dodag_t *dodag);
 
+/**
+ * @brief   Schedule the removal of an instance after GNRC_RPL_CLEANUP_TIME.
+ *
+ * The instance is only removed if its DODAG is still without parents and of
+ * infinite rank by then.
+ *
+ * @param[in] inst      Pointer to the instance
+ */
+void gnrc_rpl_instance_cleanup_start(gnrc_rpl_instance_t *inst);
+
 /**
  * @brief   Operate as leaf.
  *
@@ -169,8 +169,14 @@ void gnrc_rpl_p2p_recv_DRO(gnrc_pktsnip_t *pkt, ipv6_addr_t *src);
 
 /**
  * @brief Updates the lifetime of the P2P Dodag and the delay of the DRO
+ *
+ * Called every GNRC_RPL_LIFETIME_UPDATE_STEP seconds as long as P2P-RPL
+ * DODAG extensions exist.
+ *
+ * @return  true, if P2P-RPL DODAG extensions are left to update
+ * @return  false, otherwise
  */
-void gnrc_rpl_p2p_update(void);
+bool gnrc_rpl_p2p_update(void);
 
 #ifdef __cplusplus
 }
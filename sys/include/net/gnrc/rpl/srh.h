@@ -13,6 +13,12 @@
  * @see <a href="https://tools.ietf.org/html/rfc6554">
  *          RFC 6554
  *      </a>
+ *
+ * With `USEMODULE += gnrc_rpl_srh_cache` a root keeps the compressed
+ * source routing headers of recently used destinations, built from the
+ * source routes of a @ref net_fib table. A cached header is reused until the
+ * source route expires or gnrc_rpl_srh_cache_invalidate() is called for an
+ * address on its path, e.g. when a DAO for that address was received.
  * @{
  *
  * @file
@@ -25,6 +31,9 @@
 
 #include "net/ipv6/hdr.h"
 #include "net/ipv6/addr.h"
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+#include "net/fib.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +44,21 @@ extern "C" {
  */
 #define GNRC_RPL_SRH_TYPE   (3U)
 
+/**
+ * @brief   Number of destinations in the source routing header cache
+ */
+#ifndef GNRC_RPL_SRH_CACHE_SIZE
+#define GNRC_RPL_SRH_CACHE_SIZE (8)
+#endif
+
+/**
+ * @brief   Maximum number of hops of a cached source route, including the
+ *          destination
+ */
+#ifndef GNRC_RPL_SRH_CACHE_HOPS_MAX
+#define GNRC_RPL_SRH_CACHE_HOPS_MAX (8)
+#endif
+
 /**
  * @brief   The RPL Source routing header.
  *
@@ -66,6 +90,56 @@ typedef struct __attribute__((packed)) {
  */
 int gnrc_rpl_srh_process(ipv6_hdr_t *ipv6, gnrc_rpl_srh_t *rh);
 
+/**
+ * @brief   Build a RPL source routing header with elided prefixes.
+ *
+ * The IPv6 destination of the packet has to be set to @p route[0]. CmprI and
+ * CmprE are chosen as the number of prefix octets the addresses share with
+ * @p route[0]. gnrc_rpl_srh_t::nh is left to the caller.
+ *
+ * @param[in] route     The hops of the source route, the destination last.
+ * @param[in] route_len Number of addresses in @p route, at least 2.
+ * @param[out] buf      Buffer for the source routing header.
+ * @param[in] size      Size of @p buf.
+ *
+ * @return  Length of the source routing header in bytes.
+ * @return  -EINVAL, if @p route_len is too small or too large.
+ * @return  -ENOBUFS, if @p buf is too small.
+ */
+int gnrc_rpl_srh_build(const ipv6_addr_t *route, size_t route_len, void *buf, size_t size);
+
+#if defined(MODULE_GNRC_RPL_SRH_CACHE) || defined(DOXYGEN)
+/**
+ * @brief   Get the source routing header to @p dst.
+ *
+ * The header is taken from the cache or built from the source route to
+ * @p dst in @p table.
+ *
+ * @param[in] table     FIB table of type FIB_TABLE_TYPE_SR.
+ * @param[in] dst       The destination of the packet.
+ * @param[out] next_hop The IPv6 destination of the packet.
+ * @param[out] buf      Buffer for the source routing header.
+ * @param[in] size      Size of @p buf.
+ *
+ * @return  Length of the source routing header in bytes, 0 if @p dst is the
+ *          first hop and no header is needed.
+ * @return  -EHOSTUNREACH, if there is no source route to @p dst.
+ * @return  -ENOMEM, if the route has more than GNRC_RPL_SRH_CACHE_HOPS_MAX hops.
+ * @return  -ENOBUFS, if @p buf is too small.
+ */
+int gnrc_rpl_srh_cache_get(fib_table_t *table, const ipv6_addr_t *dst,
+                           ipv6_addr_t *next_hop, void *buf, size_t size);
+
+/**
+ * @brief   Drop the cached source routing headers to or via @p addr.
+ *
+ * Has to be called whenever the source route of @p addr changed.
+ *
+ * @param[in] addr      The address whose route changed, NULL to drop all.
+ */
+void gnrc_rpl_srh_cache_invalidate(const ipv6_addr_t *addr);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@ extern "C" {
 
 #include "net/gnrc/ipv6/netif.h"
 #include "net/ipv6/addr.h"
+#include "priority_queue.h"
 #include "xtimer.h"
 #include "trickle.h"
 
@@ -214,7 +215,9 @@ struct gnrc_rpl_parent {
     uint8_t dtsn;                   /**< last seen dtsn of this parent */
     uint16_t rank;                  /**< rank of the parent */
     gnrc_rpl_dodag_t *dodag;        /**< DODAG the parent belongs to */
-    uint32_t lifetime;              /**< lifetime of this parent in seconds */
+    uint32_t lifetime;              /**< end of the lifetime of this parent in
+                                         seconds since boot */
+    priority_queue_node_t deadline; /**< next lifetime event of this parent */
     double  link_metric;            /**< metric of the link */
     uint8_t link_metric_type;       /**< type of the metric */
 };
@@ -258,7 +261,9 @@ struct gnrc_rpl_dodag {
     bool dao_ack_received;          /**< flag to check for DAO-ACK */
     uint8_t dio_opts;               /**< options in the next DIO
                                          (see @ref GNRC_RPL_REQ_DIO_OPTS "DIO Options") */
-    uint8_t dao_time;               /**< time to schedule a DAO in seconds */
+    uint32_t dao_time;              /**< time to send the next DAO in seconds
+                                         since boot */
+    priority_queue_node_t deadline; /**< next DAO or cleanup event */
     trickle_t trickle;              /**< trickle representation */
 };
 
@@ -273,7 +278,8 @@ struct gnrc_rpl_instance {
     gnrc_rpl_of_t *of;              /**< configured Objective Function */
     uint16_t min_hop_rank_inc;      /**< minimum hop rank increase */
     uint16_t max_rank_inc;          /**< max increase in the rank */
-    int8_t cleanup;                 /**< cleanup time in seconds */
+    uint32_t cleanup;               /**< time of the cleanup in seconds since
+                                         boot, 0 if none is scheduled */
 };
 
 #ifdef __cplusplus
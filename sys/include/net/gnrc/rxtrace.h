@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_rxtrace Receive path latency tracing
+ * @ingroup     net_gnrc
+ * @brief       Timestamps received packets as they pass the layers of GNRC
+ *
+ * With the `gnrc_rxtrace` module, the receive path of GNRC has tracepoints
+ * in @ref net_gnrc_netdev2, @ref net_gnrc_sixlowpan, @ref net_gnrc_ipv6,
+ * @ref net_gnrc_udp and the sock receive functions. Every tracepoint records
+ * the time since the previous tracepoint the packet passed, i.e. the time
+ * spent queued for and in the previous layer, in a ring buffer and a
+ * histogram of its own. The time of the previous tracepoint is kept in the
+ * @ref gnrc_netif_hdr_t of the packet, packets without one (e.g. reassembled
+ * 6LoWPAN fragments, loopback) are not traced beyond that point.
+ *
+ * Without the module the tracepoints compile to nothing.
+ *
+ * The shell command `rxtrace` prints the histograms, `rxtrace dump` the
+ * ring buffers in the binary format below as hex lines (`xxd -r -p` turns
+ * them back into binary). Every entry is a record of
+ * @ref GNRC_RXTRACE_RECORD_SIZE bytes:
+ *
+ * | offset | size | content                                          |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 1    | tracepoint (@ref gnrc_rxtrace_hop_t)             |
+ * | 1      | 1    | reserved, 0                                      |
+ * | 2      | 4    | time of the tracepoint in us, little endian      |
+ * | 6      | 4    | time since previous tracepoint in us, little endian |
+ *
+ * @{
+ *
+ * @file
+ * @brief       Receive path latency tracing definitions
+ */
+#ifndef GNRC_RXTRACE_H
+#define GNRC_RXTRACE_H
+
+#include <stdint.h>
+
+#include "net/gnrc/pkt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of entries in the ring buffer of each tracepoint
+ *
+ * @note    Must be a power of two.
+ */
+#ifndef GNRC_RXTRACE_RING_SIZE
+#define GNRC_RXTRACE_RING_SIZE      (32U)
+#endif
+
+/**
+ * @brief   Number of buckets of the histograms
+ *
+ * Bucket `i > 0` counts latencies of `2^(i-1)` to `2^i - 1` us, bucket 0
+ * those of 0 us and the last one also all longer latencies.
+ */
+#define GNRC_RXTRACE_HIST_BUCKETS   (16U)
+
+/**
+ * @brief   Size of a record of the binary dump format
+ */
+#define GNRC_RXTRACE_RECORD_SIZE    (10U)
+
+/**
+ * @brief   Tracepoints in the order a packet passes them
+ */
+typedef enum {
+    GNRC_RXTRACE_NETDEV2 = 0,   /**< received by a network device */
+    GNRC_RXTRACE_SIXLOWPAN,     /**< entered 6LoWPAN */
+    GNRC_RXTRACE_IPV6,          /**< entered IPv6 */
+    GNRC_RXTRACE_UDP,           /**< entered UDP */
+    GNRC_RXTRACE_SOCK,          /**< returned by the sock receive function */
+    GNRC_RXTRACE_NUMOF,         /**< number of tracepoints */
+} gnrc_rxtrace_hop_t;
+
+/**
+ * @brief   An entry of a ring buffer
+ */
+typedef struct {
+    uint32_t time;              /**< time of the tracepoint in us */
+    uint32_t delta;             /**< time since the previous tracepoint in us */
+} gnrc_rxtrace_entry_t;
+
+#if defined(MODULE_GNRC_RXTRACE) || defined(DOXYGEN)
+/**
+ * @brief   Records that @p pkt passes tracepoint @p hop
+ *
+ * @param[in] pkt   a received packet
+ * @param[in] hop   the tracepoint
+ */
+void gnrc_rxtrace_point(gnrc_pktsnip_t *pkt, gnrc_rxtrace_hop_t hop);
+
+/**
+ * @brief   Copies the ring buffer of a tracepoint, oldest entry first
+ *
+ * @param[in]  hop      the tracepoint
+ * @param[out] entries  the entries
+ * @param[in]  max      maximum number of entries to copy
+ *
+ * @return  number of entries copied
+ */
+unsigned gnrc_rxtrace_read(gnrc_rxtrace_hop_t hop,
+                           gnrc_rxtrace_entry_t *entries, unsigned max);
+
+/**
+ * @brief   Copies the histogram of a tracepoint
+ *
+ * @param[in]  hop      the tracepoint
+ * @param[out] hist     the histogram buckets
+ */
+void gnrc_rxtrace_hist(gnrc_rxtrace_hop_t hop,
+                       uint32_t hist[GNRC_RXTRACE_HIST_BUCKETS]);
+
+/**
+ * @brief   Clears all ring buffers and histograms
+ */
+void gnrc_rxtrace_reset(void);
+#else
+#define gnrc_rxtrace_point(pkt, hop)    (void)0
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNRC_RXTRACE_H */
+/** @} */
@@ -29,6 +29,9 @@
  *  - https://tools.ietf.org/html/rfc2349
  *     (RFC2349 TFTP Timeout Interval and Transfer Size Options)
  *
+ *  - https://tools.ietf.org/html/rfc7440
+ *     (RFC7440 TFTP Windowsize Option)
+ *
  * @author      Nick van IJzendoorn <nijzendoorn@engineering-spirit.nl>
  */
 
@@ -74,6 +77,18 @@ extern "C" {
 #define GNRC_TFTP_MAX_TRANSFER_UNIT         (512)
 #endif
 
+/**
+ * @brief The maximum number of data blocks sent without waiting for an ACK
+ *
+ * The client asks for this window size and the server accepts at most this
+ * window size, see RFC 7440. A window of one block is the lock-step transfer
+ * of RFC 1350. The thread running a transfer needs a message queue which can
+ * hold a whole window, otherwise blocks get dropped on arrival.
+ */
+#ifndef GNRC_TFTP_WINDOW_SIZE
+#define GNRC_TFTP_WINDOW_SIZE               (4)
+#endif
+
 /**
  * @brief The number of retries that must be made before stopping a transfer
  */
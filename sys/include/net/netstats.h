@@ -53,6 +53,79 @@ typedef struct {
     uint32_t rx_bytes;          /**< received bytes */
 } netstats_t;
 
+/**
+ * @name    Drop counters
+ *
+ * With the `netstats_drop` module every layer of GNRC counts the packets it
+ * loses by reason. A packet is counted at the layer that lost it, e.g. a
+ * packet that IPv6 cannot hand to UDP because the UDP thread's message
+ * queue is full, as @ref NETSTATS_DROP_QUEUE_FULL at
+ * @ref NETSTATS_DROP_AT_UDP.
+ *
+ * The counters are incremented without locks to keep the fast path cheap.
+ * Concurrent increments of the same counter from two threads may lose one,
+ * so the counters are exact only as long as a single thread drops packets
+ * for a given layer and reason.
+ * @{
+ */
+
+/**
+ * @brief   Layers that count drops
+ */
+typedef enum {
+    NETSTATS_DROP_AT_L2 = 0,        /**< network device adaption */
+    NETSTATS_DROP_AT_SIXLOWPAN,     /**< 6LoWPAN */
+    NETSTATS_DROP_AT_IPV6,          /**< IPv6 (including NDP) */
+    NETSTATS_DROP_AT_UDP,           /**< UDP */
+    NETSTATS_DROP_AT_SOCK,          /**< sock receive queues */
+    NETSTATS_DROP_AT_NUMOF,         /**< number of layers */
+} netstats_drop_layer_t;
+
+/**
+ * @brief   Reasons to drop a packet
+ */
+typedef enum {
+    NETSTATS_DROP_NOMEM = 0,        /**< packet buffer full */
+    NETSTATS_DROP_QUEUE_FULL,       /**< message queue of receiver full */
+    NETSTATS_DROP_NO_SUBSCRIBER,    /**< no one registered for the packet */
+    NETSTATS_DROP_NC_INCOMPLETE,    /**< next hop address not resolved (yet) */
+    NETSTATS_DROP_REASS_TIMEOUT,    /**< fragments not completed in time */
+    NETSTATS_DROP_CHECKSUM,         /**< checksum error */
+    NETSTATS_DROP_INVALID,          /**< malformed packet */
+    NETSTATS_DROP_NUMOF,            /**< number of reasons */
+} netstats_drop_reason_t;
+
+#if defined(MODULE_NETSTATS_DROP) || defined(DOXYGEN)
+/**
+ * @brief   The drop counters
+ */
+extern uint32_t netstats_drop[NETSTATS_DROP_AT_NUMOF][NETSTATS_DROP_NUMOF];
+
+/**
+ * @brief   Counts a dropped packet, compiles to nothing without the
+ *          `netstats_drop` module
+ *
+ * @param[in] layer     layer that dropped the packet (netstats_drop_layer_t)
+ * @param[in] reason    reason of the drop (netstats_drop_reason_t)
+ */
+#define NETSTATS_DROP(layer, reason)    (netstats_drop[layer][reason]++)
+
+/**
+ * @brief   Copies all drop counters at once
+ *
+ * @param[out] counters     the counters
+ */
+void netstats_drop_snapshot(uint32_t counters[NETSTATS_DROP_AT_NUMOF][NETSTATS_DROP_NUMOF]);
+
+/**
+ * @brief   Resets all drop counters
+ */
+void netstats_drop_reset(void);
+#else
+#define NETSTATS_DROP(layer, reason)    (void)0
+#endif
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif
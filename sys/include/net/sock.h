@@ -152,6 +152,15 @@ extern "C" {
  */
 #define SOCK_NO_TIMEOUT     (UINT32_MAX)
 
+#if defined(MODULE_SOCK_ASYNC) || defined(DOXYGEN)
+/**
+ * @brief   Events reported to the callback of a sock with `sock_async`
+ */
+typedef enum {
+    SOCK_ASYNC_MSG_RECV = 0x01,     /**< a packet can be received */
+} sock_async_flags_t;
+#endif
+
 /**
  * @brief   Abstract IP end point and end point for a raw IP sock object
  */
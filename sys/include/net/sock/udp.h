@@ -433,6 +433,40 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
 ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
                       const sock_udp_ep_t *remote);
 
+#if defined(MODULE_SOCK_ASYNC) || defined(DOXYGEN)
+/**
+ * @brief   Callback to notify about events on a UDP sock
+ *
+ * @param[in] sock      The sock the event happened on
+ * @param[in] flags     The events that happened
+ * @param[in] arg       The argument given to sock_udp_set_cb()
+ */
+typedef void (*sock_udp_cb_t)(sock_udp_t *sock, sock_async_flags_t flags,
+                              void *arg);
+
+/**
+ * @brief   Sets the callback to notify about events on a UDP sock
+ *
+ * With a callback, one thread can serve many socks instead of blocking one
+ * thread per sock in sock_udp_recv(): on @ref SOCK_ASYNC_MSG_RECV the
+ * packet is queued and can be fetched with sock_udp_recv() and a timeout
+ * of 0.
+ *
+ * @note    Only available with `sock_async`.
+ *
+ * @warning The callback may be called in the context of the network stack,
+ *          so it must not block. It is best used to wake the thread
+ *          serving the sock, e.g. with msg_try_send().
+ *
+ * @pre `(sock != NULL)`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[in] cb        The callback, `NULL` to remove it.
+ * @param[in] arg       Argument for @p cb.
+ */
+void sock_udp_set_cb(sock_udp_t *sock, sock_udp_cb_t cb, void *arg);
+#endif
+
 #include "sock_types.h"
 
 #ifdef __cplusplus
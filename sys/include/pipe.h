@@ -25,6 +25,31 @@
  *              It sends the calling thread to sleep if the ringbuffer is full
  *              or empty, respectively. It can be used in ISRs, too.
  *
+ *              A blocked reader is only woken once the pipe holds at least
+ *              pipe_t::lowat bytes, a blocked writer only once the pipe
+ *              drained to pipe_t::hiwat bytes or less (see
+ *              pipe_set_watermarks()). This saves context switches when
+ *              the producer writes in small chunks.
+ *
+ *              pipe_splice_to() and pipe_splice_from() hand the contiguous
+ *              part of the ringbuffer to a sink or source function, so data
+ *              can be moved between a pipe and e.g. a socket or UART without
+ *              an intermediate buffer:
+ *
+ * @code
+ * static ssize_t _udp_sink(void *arg, const void *data, size_t len)
+ * {
+ *     return sock_udp_send(arg, data, len, NULL);
+ * }
+ *
+ * static ssize_t _stdio_sink(void *arg, const void *data, size_t len)
+ * {
+ *     (void)arg;
+ *     return uart_stdio_write(data, len);
+ * }
+ *
+ * pipe_splice_to(&pipe, _udp_sink, &sock, SIZE_MAX);
+ * @endcode
  *
  * @{
  * @file
@@ -60,8 +85,32 @@ typedef struct riot_pipe {
                                          empty pipe. */
     void (*free)(void *);           /**< Function to call by pipe_free(). Used like
                                          `pipe->free(pipe)`. */
+    unsigned lowat;                 /**< Minimum fill level to wake a blocked
+                                         reader. */
+    unsigned hiwat;                 /**< Maximum fill level to wake a blocked
+                                         writer. */
     } pipe_t;
 
+/**
+ * @brief        Sink for pipe_splice_to().
+ * @param        arg    Argument given to pipe_splice_to().
+ * @param[in]    data   Data inside the pipe's ringbuffer.
+ * @param        len    Number of bytes available at @p data.
+ * @returns      Number of bytes consumed, `<= 0` on error. More than @p len
+ *               counts as @p len.
+ */
+typedef ssize_t (*pipe_sink_t)(void *arg, const void *data, size_t len);
+
+/**
+ * @brief        Source for pipe_splice_from().
+ * @param        arg    Argument given to pipe_splice_from().
+ * @param[out]   data   Free space inside the pipe's ringbuffer.
+ * @param        len    Number of bytes available at @p data.
+ * @returns      Number of bytes produced, `<= 0` on error. More than @p len
+ *               counts as @p len.
+ */
+typedef ssize_t (*pipe_source_t)(void *arg, void *data, size_t len);
+
 /**
  * @brief        Initialize a pipe.
  * @param[out]   pipe   Datum to initialize.
@@ -71,6 +120,22 @@ typedef struct riot_pipe {
  */
 void pipe_init(pipe_t *pipe, ringbuffer_t *rb, void (*free)(void *));
 
+/**
+ * @brief        Set the wakeup watermarks of a pipe.
+ * @details      The defaults after pipe_init() are `lowat = 1` and
+ *               `hiwat = size - 1`, i.e. every transfer wakes the other side.
+ *               With a higher @p lowat the writer must eventually fill the
+ *               pipe up to @p lowat bytes, a reader is not woken for less.
+ *               Lowering the watermarks wakes a blocked thread whose
+ *               watermark is met, e.g. to flush the last bytes of a stream.
+ * @param[in]    pipe   Pipe to configure.
+ * @param        lowat  Wake a blocked reader once the pipe holds at least
+ *                      this many bytes. Clamped to `1 .. size`.
+ * @param        hiwat  Wake a blocked writer once the pipe holds at most this
+ *                      many bytes. Clamped to `0 .. size - 1`.
+ */
+void pipe_set_watermarks(pipe_t *pipe, unsigned lowat, unsigned hiwat);
+
 /**
  * @brief        Read from a pipe.
  * @details      Only one thread may access the pipe readingly at once.
@@ -99,6 +164,40 @@ ssize_t pipe_read(pipe_t *pipe, void *buf, size_t n);
  */
 ssize_t pipe_write(pipe_t *pipe, const void *buf, size_t n);
 
+/**
+ * @brief        Hand data of a pipe to a sink without copying it out.
+ * @details      Blocks like pipe_read() while the pipe is empty. Then
+ *               @p sink is called with interrupts enabled on the contiguous
+ *               readable part of the ringbuffer, and the bytes it consumed
+ *               are removed from the pipe. Only one thread may read from the
+ *               pipe at once, by pipe_read() or pipe_splice_to().
+ * @param[in]    pipe   Pipe to read from.
+ * @param        sink   Function consuming the data.
+ * @param        arg    Argument for @p sink.
+ * @param        n      Maximum number of bytes to pass to @p sink.
+ * @returns      `> 0` number of bytes consumed by @p sink.
+ *               `== 0` if the pipe is empty and isISR().
+ *               `< 0` the error returned by @p sink.
+ */
+ssize_t pipe_splice_to(pipe_t *pipe, pipe_sink_t sink, void *arg, size_t n);
+
+/**
+ * @brief        Let a source fill a pipe without copying the data in.
+ * @details      Blocks like pipe_write() while the pipe is full. Then
+ *               @p source is called with interrupts enabled on the contiguous
+ *               free part of the ringbuffer, and the bytes it produced are
+ *               added to the pipe. Only one thread may write to the pipe at
+ *               once, by pipe_write() or pipe_splice_from().
+ * @param[in]    pipe   Pipe to write to.
+ * @param        source Function producing the data.
+ * @param        arg    Argument for @p source.
+ * @param        n      Maximum number of bytes to request from @p source.
+ * @returns      `> 0` number of bytes produced by @p source.
+ *               `== 0` if the pipe is full and isISR().
+ *               `< 0` the error returned by @p source.
+ */
+ssize_t pipe_splice_from(pipe_t *pipe, pipe_source_t source, void *arg, size_t n);
+
 /**
  * @brief      Dynamically allocate a pipe with room for `size` bytes.
  * @details    This function uses `malloc()` and may break real-time behaviors.
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_struct_codec Struct codec schemas
+ * @ingroup     sys
+ * @brief       Compile-time schemas to serialize C structs with
+ *              @ref cbor or @ref sys_ubjson
+ *
+ * The layout of a struct is described once as an X-macro. From that
+ * description STRUCT_CODEC() generates a constant field table, which the
+ * serializers use to compute the encoded size of a struct up-front and then
+ * encode or decode all fields in one go, without the per-field bounds checks
+ * of the hand-written `cbor_serialize_*()` / `ubjson_write_*()` sequence.
+ *
+ * A struct is encoded as a map (CBOR) or object (UBJSON) with the field
+ * names as text keys, in the order given in the schema.
+ *
+ * @code
+ * typedef struct {
+ *     int32_t temp;
+ *     uint32_t seq;
+ *     char name[8];
+ * } sensor_t;
+ *
+ * #define SENSOR_FIELDS(X, T) \
+ *     X(T, INT32, temp)       \
+ *     X(T, UINT32, seq)       \
+ *     X(T, TEXT, name)
+ *
+ * STRUCT_CODEC(sensor_codec, sensor_t, SENSOR_FIELDS);
+ *
+ * size_t len = cbor_codec_encode(&sensor_codec, &sensor, buf, sizeof(buf));
+ * @endcode
+ *
+ * @{
+ *
+ * @file
+ * @brief       Struct codec schema definitions
+ */
+#ifndef STRUCT_CODEC_H
+#define STRUCT_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Types of struct members supported by the codecs
+ */
+typedef enum {
+    STRUCT_CODEC_INT32,     /**< int32_t */
+    STRUCT_CODEC_UINT32,    /**< uint32_t */
+    STRUCT_CODEC_INT64,     /**< int64_t */
+    STRUCT_CODEC_UINT64,    /**< uint64_t */
+    STRUCT_CODEC_BOOL,      /**< bool */
+    STRUCT_CODEC_FLOAT,     /**< float */
+    STRUCT_CODEC_TEXT,      /**< NULL terminated char array */
+} struct_codec_type_t;
+
+/**
+ * @brief   Description of a single struct member
+ */
+typedef struct {
+    const char *key;        /**< name of the member, used as key */
+    uint8_t key_len;        /**< length of struct_codec_field_t::key */
+    uint8_t type;           /**< type of the member (struct_codec_type_t) */
+    uint16_t offset;        /**< offset of the member within the struct */
+    uint16_t size;          /**< size of the member in bytes */
+} struct_codec_field_t;
+
+/**
+ * @brief   Schema of a struct
+ */
+typedef struct {
+    const struct_codec_field_t *fields; /**< members of the struct */
+    uint8_t numof;                      /**< number of members */
+} struct_codec_t;
+
+/**
+ * @brief   Generates the description of member @p name of struct type @p T
+ *
+ * Used as `X` argument to the X-macro given to STRUCT_CODEC().
+ */
+#define STRUCT_CODEC_FIELD(T, type, name)                                   \
+    { #name, sizeof(#name) - 1, STRUCT_CODEC_ ## type, offsetof(T, name),   \
+      sizeof(((T *)0)->name) },
+
+/**
+ * @brief   Defines the constant schema @p codec for the struct type @p T
+ *
+ * @param[in] codec     Name of the generated @ref struct_codec_t
+ * @param[in] T         The struct type
+ * @param[in] FIELDS    X-macro with the signature `FIELDS(X, T)` that
+ *                      expands `X(T, <type>, <member>)` for every member,
+ *                      `<type>` being a @ref struct_codec_type_t without the
+ *                      `STRUCT_CODEC_` prefix
+ */
+#define STRUCT_CODEC(codec, T, FIELDS)                                      \
+    static const struct_codec_field_t codec ## _fields[] = {                \
+        FIELDS(STRUCT_CODEC_FIELD, T)                                       \
+    };                                                                      \
+    static const struct_codec_t codec = {                                  \
+        .fields = codec ## _fields,                                         \
+        .numof = sizeof(codec ## _fields) / sizeof(codec ## _fields[0]),    \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STRUCT_CODEC_H */
+/** @} */
@@ -11,6 +11,21 @@
 /**
  * @defgroup sys_trickle Trickle Timer
  * @ingroup sys
+ *
+ * With the `trickle_adaptive` module, the redundancy constant and the
+ * minimum interval adapt to the neighborhood:
+ *
+ * - The number of neighbors is estimated from the consistent messages heard
+ *   per interval and the rate of our own suppressed transmissions. Above
+ *   @ref TRICKLE_ADAPTIVE_DENSITY neighbors, k shrinks proportionally down
+ *   to 1, so a dense neighborhood sends fewer redundant messages.
+ * - While intervals are frequently cut short by inconsistencies, a sparse
+ *   neighborhood restarts with half the minimum interval to converge faster,
+ *   and a dense one with twice the minimum interval to spread the burst of
+ *   messages following a reset.
+ *
+ * The configured k and Imin remain the upper and base values of the
+ * adaptation.
  * @{
  */
 
@@ -38,6 +53,39 @@ typedef struct {
     void *args;                 /**< a generic parameter for the callback function pointer */
 } trickle_callback_t;
 
+#ifndef TRICKLE_ADAPTIVE_DENSITY
+/**
+ * @brief   Number of neighbors up to which the configured k is used
+ */
+#define TRICKLE_ADAPTIVE_DENSITY        (8U)
+#endif
+
+#ifndef TRICKLE_ADAPTIVE_INCONSISTENT
+/**
+ * @brief   Share of intervals ended by a reset, in 1/256, from which on the
+ *          neighborhood counts as inconsistent
+ */
+#define TRICKLE_ADAPTIVE_INCONSISTENT   (64U)
+#endif
+
+/** @brief statistics of a trickle timer */
+typedef struct {
+    uint32_t transmitted;           /**< callbacks called */
+    uint32_t suppressed;            /**< callbacks suppressed as c >= k */
+    uint32_t resets;                /**< interval resets */
+} trickle_stats_t;
+
+#if defined(MODULE_TRICKLE_ADAPTIVE) || defined(DOXYGEN)
+/** @brief state of the adaptation of k and Imin */
+typedef struct {
+    uint8_t k;                      /**< redundancy constant in use */
+    uint16_t heard;                 /**< average of c per interval, in 1/8 */
+    uint16_t suppression;           /**< share of suppressed callbacks, in 1/256 */
+    uint16_t inconsistency;         /**< share of intervals ended by a reset,
+                                         in 1/256 */
+} trickle_adaptive_t;
+#endif
+
 /** @brief all state variables for a trickle timer */
 typedef struct {
     uint8_t k;                      /**< redundancy constant */
@@ -57,6 +105,11 @@ typedef struct {
     uint64_t msg_callback_time;     /**< callback interval in ms */
     xtimer_t msg_callback_timer;    /**< xtimer to send a msg_t to the target thread
                                          for a callback */
+    trickle_stats_t stats;          /**< statistics, kept by trickle_start() */
+#if defined(MODULE_TRICKLE_ADAPTIVE) || defined(DOXYGEN)
+    trickle_adaptive_t adaptive;    /**< adaptation of k and Imin, kept by
+                                         trickle_start() */
+#endif
 } trickle_t;
 
 /**
@@ -69,6 +122,9 @@ void trickle_reset_timer(trickle_t *trickle);
 /**
  * @brief start the trickle timer
  *
+ * The statistics and the adaptation state are not touched, the trickle
+ * timer must be zeroed before its first start.
+ *
  * @param[in] pid                   target thread
  * @param[in] trickle               trickle timer
  * @param[in] interval_msg_type     msg_t.type for interval messages
@@ -108,6 +164,24 @@ void trickle_interval(trickle_t *trickle);
  */
 void trickle_callback(trickle_t *trickle);
 
+/**
+ * @brief get the redundancy constant currently in use
+ *
+ * @param[in] trickle   trickle timer
+ *
+ * @return  the adapted k with the `trickle_adaptive` module, the configured
+ *          one otherwise
+ */
+static inline uint8_t trickle_get_k(const trickle_t *trickle)
+{
+#ifdef MODULE_TRICKLE_ADAPTIVE
+    if (trickle->adaptive.k && trickle->k) {
+        return trickle->adaptive.k;
+    }
+#endif
+    return trickle->k;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,20 @@
  * This ringbuffer implementation can be used without locking if
  * there's only one producer and one consumer.
  *
+ * Besides copying functions, the contiguous span API gives direct access to
+ * the buffer, e.g. to let a DMA or memcpy() fill it:
+ *
+ * @code
+ * char *data;
+ * unsigned len = tsrb_reserve_span(&rb, &data);
+ * len = my_dev_read(dev, data, len);
+ * tsrb_commit_write(&rb, len);
+ * @endcode
+ *
+ * The counters are only updated after the buffer content was accessed, with
+ * a memory barrier in between, so the lock-free single producer / single
+ * consumer guarantee also holds for the span API and on multi-core hosts.
+ *
  * @note Buffer size must be a power of two!
  *
  * @author      Kaspar Schleiser <kaspar@schleiser.de>
@@ -146,6 +160,46 @@ int tsrb_add_one(tsrb_t *rb, char c);
  */
 int tsrb_add(tsrb_t *rb, const char *src, size_t n);
 
+/**
+ * @brief       Get the contiguous readable part of the ringbuffer
+ *
+ * The data stays in the ringbuffer until tsrb_commit_read() is called. Only
+ * the consumer may call this function.
+ *
+ * @param[in]   rb      Ringbuffer to operate on
+ * @param[out]  data    start of the readable data
+ * @return      nr of bytes readable at @p data, may be less than
+ *              tsrb_avail() if the data wraps around
+ */
+unsigned tsrb_peek_span(const tsrb_t *rb, char **data);
+
+/**
+ * @brief       Remove bytes obtained by tsrb_peek_span() from the ringbuffer
+ * @param[in]   rb  Ringbuffer to operate on
+ * @param[in]   n   nr of bytes to remove, must not exceed tsrb_avail()
+ */
+void tsrb_commit_read(tsrb_t *rb, unsigned n);
+
+/**
+ * @brief       Get the contiguous writable part of the ringbuffer
+ *
+ * Data written to @p data becomes readable with tsrb_commit_write(). Only
+ * the producer may call this function.
+ *
+ * @param[in]   rb      Ringbuffer to operate on
+ * @param[out]  data    start of the free space
+ * @return      nr of bytes writable at @p data, may be less than
+ *              tsrb_free() if the free space wraps around
+ */
+unsigned tsrb_reserve_span(const tsrb_t *rb, char **data);
+
+/**
+ * @brief       Make bytes written to a span from tsrb_reserve_span() readable
+ * @param[in]   rb  Ringbuffer to operate on
+ * @param[in]   n   nr of bytes written, must not exceed tsrb_free()
+ */
+void tsrb_commit_write(tsrb_t *rb, unsigned n);
+
 #ifdef __cplusplus
 }
 #endif
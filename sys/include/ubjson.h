@@ -36,6 +36,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "struct_codec.h"
+
 #if defined(MODULE_MSP430_COMMON)
 #   include "msp430_types.h"
 #elif !defined(__linux__)
@@ -577,6 +579,49 @@ ssize_t ubjson_write_key(ubjson_cookie_t *__restrict cookie, const void *value,
  */
 ssize_t ubjson_close_object(ubjson_cookie_t *__restrict cookie);
 
+/* ***************************************************************************
+ * STRUCT CODEC
+ *************************************************************************** */
+
+/**
+ * @brief         Get the size of the UBJSON encoding of a struct.
+ * @details       The struct is encoded as an object with the member names as keys,
+ *                see @ref sys_struct_codec.
+ * @param[in]     codec      The schema of the struct.
+ * @param[in]     val        The struct.
+ * @returns       @arg `>= 0` the number of bytes needed.
+ *                @arg `-EINVAL` if a member cannot be represented in UBJSON.
+ */
+ssize_t ubjson_codec_size(const struct_codec_t *codec, const void *val);
+
+/**
+ * @brief         Encode a struct into a buffer.
+ * @details       The size is computed once up-front, all members are then
+ *                written without invoking a @ref ubjson_write_t function.
+ * @param[in]     codec      The schema of the struct.
+ * @param[in]     val        The struct.
+ * @param[out]    buf        The output buffer.
+ * @param[in]     size       The size of the output buffer.
+ * @returns       @arg `> 0` the number of bytes written.
+ *                @arg `-EINVAL` if a member cannot be represented in UBJSON.
+ *                @arg `-ENOBUFS` if @p buf is too small.
+ */
+ssize_t ubjson_codec_encode(const struct_codec_t *codec, const void *val,
+                            void *buf, size_t size);
+
+/**
+ * @brief         Decode a struct from a buffer.
+ * @details       The members are expected in the order of the schema.
+ * @param[in]     codec      The schema of the struct.
+ * @param[out]    val        The struct.
+ * @param[in]     buf        The UBJSON serialized data.
+ * @param[in]     size       The size of @p buf.
+ * @returns       @arg `> 0` the number of bytes read.
+ *                @arg `-EBADMSG` if @p buf does not contain a matching object.
+ */
+ssize_t ubjson_codec_decode(const struct_codec_t *codec, void *val,
+                            const void *buf, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
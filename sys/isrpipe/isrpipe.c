@@ -40,6 +40,32 @@ int isrpipe_write_one(isrpipe_t *isrpipe, char c)
     return res;
 }
 
+int isrpipe_write(isrpipe_t *isrpipe, const char *buf, size_t count)
+{
+    int res = tsrb_add(&isrpipe->tsrb, buf, count);
+
+    if (res) {
+        mutex_unlock(&isrpipe->mutex);
+    }
+
+    return res;
+}
+
+unsigned isrpipe_reserve_write(isrpipe_t *isrpipe, char **data)
+{
+    return tsrb_reserve_span(&isrpipe->tsrb, data);
+}
+
+void isrpipe_commit_write(isrpipe_t *isrpipe, size_t count)
+{
+    if (count) {
+        tsrb_commit_write(&isrpipe->tsrb, count);
+        /* the reader only waits on the mutex for new data, so like
+         * isrpipe_write(), wake it only if there is some */
+        mutex_unlock(&isrpipe->mutex);
+    }
+}
+
 int isrpipe_read(isrpipe_t *isrpipe, char *buffer, size_t count)
 {
     int res;
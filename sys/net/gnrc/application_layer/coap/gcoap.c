@@ -22,26 +22,123 @@
 #include "net/gnrc/coap.h"
 #include "random.h"
 #include "thread.h"
+#include "utlist.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
 /** @brief Stack size for module thread */
+#ifdef MODULE_GCOAP_PROXY
+/* the proxy builds the upstream request on the stack */
+#define GCOAP_STACK_SIZE (THREAD_STACKSIZE_DEFAULT + DEBUG_EXTRA_STACKSIZE \
+                          + GCOAP_PDU_BUF_SIZE + GCOAP_PROXY_URI_MAXLEN)
+#else
 #define GCOAP_STACK_SIZE (THREAD_STACKSIZE_DEFAULT + DEBUG_EXTRA_STACKSIZE)
+#endif
+
+/**
+ * @brief Maximum length of an Observe option, followed by the re-encoded
+ *        header of the next option
+ */
+#define GCOAP_OBS_OPTION_MAXLEN (9)
+
+/**
+ * @brief Number of retransmissions collected under the lock before sending
+ *        them; bounds the stack use independent of GCOAP_REQ_WAITING_MAX
+ */
+#define GCOAP_RESEND_BATCH      (4)
 
 /* Internal functions */
 static void *_event_loop(void *arg);
+static void _handle_msg(msg_t *msg);
+static void _init_reqs(void);
 static int _register_port(gnrc_netreg_entry_t *netreg_port, uint16_t port);
 static void _receive(gnrc_pktsnip_t *pkt, ipv6_addr_t *src, uint16_t port);
 static size_t _send(gnrc_pktsnip_t *coap_snip, ipv6_addr_t *addr, uint16_t port);
 static ssize_t _well_known_core_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len);
-static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len);
-static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len);
-static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len);
+static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned block_opt, uint32_t block_val);
+static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                          uint8_t *opt_end, ipv6_addr_t *src, uint16_t port);
+static uint32_t _hash(uint32_t hash, const void *data, size_t len);
+static void _index_listener(gcoap_listener_t *listener);
+static coap_resource_t *_index_find(const char *path, size_t len, bool wildcard,
+                                    unsigned method_flag);
+static coap_resource_t *_find_resource(const char *path, unsigned method_flag);
+static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                           unsigned block_opt, uint32_t block_val);
 static size_t _send_buf( uint8_t *buf, size_t len, ipv6_addr_t *src, uint16_t port);
-static void _expire_request(gcoap_request_memo_t *memo);
+static void _expire_requests(void);
 static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *pdu,
                                                             uint8_t *buf, size_t len);
+static gcoap_request_memo_t **_req_bucket(uint8_t *token, size_t token_len);
+static gcoap_request_memo_t **_id_bucket(uint16_t id);
+static void _open_req(gcoap_request_memo_t *memo, uint32_t timeout);
+static void _close_req(gcoap_request_memo_t *memo);
+static void _release_req(gcoap_request_memo_t *memo);
+static void _queue_req(gcoap_request_memo_t *memo, uint32_t timeout);
+static void _dequeue_req(gcoap_request_memo_t *memo);
+static void _set_req_timer(void);
+static void _handle_empty(coap_pkt_t *pdu, ipv6_addr_t *src, uint16_t port);
+static void _send_empty_ack(coap_pkt_t *pdu, ipv6_addr_t *src, uint16_t port);
+static gcoap_peer_t *_find_peer(const ipv6_addr_t *addr, bool create);
+static uint32_t _initial_rto(const ipv6_addr_t *addr);
+static void _update_rto(gcoap_request_memo_t *memo);
+static gcoap_dup_entry_t *_find_dup(ipv6_addr_t *src, uint16_t port, uint16_t id);
+static void _add_dup(ipv6_addr_t *src, uint16_t port, uint16_t id,
+                     uint8_t *resp, size_t resp_len);
+static size_t _opt_hdr_get(const uint8_t *pos, const uint8_t *end,
+                           unsigned *delta, unsigned *len);
+static size_t _opt_hdr_put(uint8_t *out, unsigned delta, unsigned len);
+static uint8_t *_opt_find(uint8_t *pos, uint8_t *end, unsigned num, size_t *len);
+static uint32_t _opt_uint(const uint8_t *val, size_t len);
+static size_t _opt_uint_put(uint8_t *out, unsigned delta, uint32_t value);
+static size_t _put_observe(uint8_t *out, uint32_t seq, const uint8_t *opt,
+                           const uint8_t *end, size_t *skip);
+static gcoap_observe_t *_obs_find(const coap_resource_t *resource,
+                                  ipv6_addr_t *addr, uint16_t port);
+static bool _obs_register(const coap_resource_t *resource, ipv6_addr_t *addr,
+                          uint16_t port, uint8_t *token, size_t token_len);
+static void _obs_notify(gcoap_observe_t *obs, gnrc_pktsnip_t *body, uint8_t code);
+static uint32_t _obs_interval(gcoap_observe_t *obs);
+static void _obs_set_timer(void);
+static void _obs_send_pending(void);
+static int _block_get(coap_pkt_t *pdu, unsigned num, uint32_t *blknum,
+                      bool *more, unsigned *szx);
+static int _block_szx(coap_pkt_t *pdu);
+static bool _send_body(gnrc_pktsnip_t *body, ipv6_addr_t *addr, uint16_t port,
+                       const uint8_t *token, size_t token_len, uint8_t code,
+                       uint16_t id);
+static uint16_t _next_id(void);
+#ifdef MODULE_GCOAP_PROXY
+static ssize_t _proxy_handle(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             uint8_t *opt_end, const uint8_t *uri,
+                             size_t uri_len, ipv6_addr_t *src, uint16_t port);
+static int _proxy_parse_uri(const char *uri, size_t len, ipv6_addr_t *addr,
+                            uint16_t *port, const char **path);
+static uint8_t *_proxy_opt_put(uint8_t *pos, const uint8_t *end,
+                               unsigned *last, unsigned num,
+                               const uint8_t *val, size_t len);
+static uint8_t *_proxy_put_segments(uint8_t *pos, const uint8_t *end,
+                                    unsigned *last, unsigned num,
+                                    const char *str, const char *str_end,
+                                    char sep);
+static ssize_t _proxy_build_opts(uint8_t *out, size_t len, const char *path,
+                                 size_t path_len, uint8_t *opt, uint8_t *opt_end);
+static gcoap_proxy_entry_t *_proxy_find(uint32_t hash, ipv6_addr_t *addr,
+                                        uint16_t port, const uint8_t *key,
+                                        size_t key_len);
+static bool _proxy_evict(size_t size);
+static gcoap_proxy_entry_t *_proxy_take_entry(void);
+static void _proxy_release(gcoap_proxy_entry_t *entry);
+static bool _proxy_add_waiter(gcoap_proxy_entry_t *entry, coap_pkt_t *pdu,
+                              ipv6_addr_t *src, uint16_t port);
+static ssize_t _proxy_serve(gcoap_proxy_entry_t *entry, coap_pkt_t *pdu,
+                            uint8_t *buf, size_t len);
+static void _proxy_resp_handler(unsigned req_state, coap_pkt_t* pdu);
+static void _proxy_reply(gcoap_proxy_entry_t *entry, gnrc_pktsnip_t *body,
+                         uint8_t code);
+#endif
 
 /* Internal variables */
 const coap_resource_t _default_resources[] = {
@@ -57,8 +154,14 @@ static gcoap_listener_t _default_listener = {
 static gcoap_state_t _coap_state = {
     .netreg_port = GNRC_NETREG_ENTRY_INIT_PID(0, KERNEL_PID_UNDEF),
     .listeners   = &_default_listener,
+    .lock        = MUTEX_INIT,
 };
 
+/* Hashed index over the paths of all registered resources */
+static coap_resource_t *_resource_index[GCOAP_RESOURCE_INDEX_SIZE];
+/* Set when a resource did not fit into _resource_index */
+static bool _resource_index_full = false;
+
 static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 static char _msg_stack[GCOAP_STACK_SIZE];
 
@@ -67,234 +170,1769 @@ static char _msg_stack[GCOAP_STACK_SIZE];
 static void *_event_loop(void *arg)
 {
     msg_t msg_rcvd, msg_queue[GCOAP_MSG_QUEUE_SIZE];
-    gnrc_pktsnip_t *pkt, *udp_snip, *ipv6_snip;
-    ipv6_addr_t *src_addr;
-    uint16_t port;
 
     (void)arg;
     msg_init_queue(msg_queue, GCOAP_MSG_QUEUE_SIZE);
 
     while (1) {
         msg_receive(&msg_rcvd);
+        _handle_msg(&msg_rcvd);
+    }
+    return 0;
+}
 
-        switch (msg_rcvd.type) {
-            case GNRC_NETAPI_MSG_TYPE_RCV:
-                /* find client from UDP destination port */
-                DEBUG("coap: GNRC_NETAPI_MSG_TYPE_RCV\n");
-                pkt = (gnrc_pktsnip_t *)msg_rcvd.content.ptr;
-                if (pkt->type != GNRC_NETTYPE_UNDEF) {
-                    gnrc_pktbuf_release(pkt);
-                    break;
-                }
-                udp_snip = pkt->next;
-                if (udp_snip->type != GNRC_NETTYPE_UDP) {
-                    gnrc_pktbuf_release(pkt);
-                    break;
+/* Handles a message received by the gcoap thread. */
+static void _handle_msg(msg_t *msg)
+{
+    gnrc_pktsnip_t *pkt, *udp_snip, *ipv6_snip;
+    ipv6_addr_t *src_addr;
+    uint16_t port;
+
+    switch (msg->type) {
+        case GNRC_NETAPI_MSG_TYPE_RCV:
+            /* find client from UDP destination port */
+            DEBUG("coap: GNRC_NETAPI_MSG_TYPE_RCV\n");
+            pkt = (gnrc_pktsnip_t *)msg->content.ptr;
+            if (pkt->type != GNRC_NETTYPE_UNDEF) {
+                gnrc_pktbuf_release(pkt);
+                break;
+            }
+            udp_snip = pkt->next;
+            if (udp_snip->type != GNRC_NETTYPE_UDP) {
+                gnrc_pktbuf_release(pkt);
+                break;
+            }
+
+            /* read source port and address */
+            port = byteorder_ntohs(((udp_hdr_t *)udp_snip->data)->src_port);
+
+            LL_SEARCH_SCALAR(udp_snip, ipv6_snip, type, GNRC_NETTYPE_IPV6);
+            assert(ipv6_snip != NULL);
+            src_addr = &((ipv6_hdr_t *)ipv6_snip->data)->src;
+
+            _receive(pkt, src_addr, port);
+            break;
+
+        case GCOAP_NETAPI_MSG_TYPE_TIMEOUT:
+            _expire_requests();
+            break;
+
+        case GCOAP_NETAPI_MSG_TYPE_OBS:
+            _obs_send_pending();
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Handles incoming network IPC message. */
+static void _receive(gnrc_pktsnip_t *pkt, ipv6_addr_t *src, uint16_t port)
+{
+    coap_pkt_t pdu;
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    size_t pdu_len = 0;
+    gcoap_request_memo_t *memo = NULL;
+
+    /* If too big, handle below based on request vs. response */
+    size_t pkt_size = (pkt->size > sizeof(buf))
+                            ? sizeof(buf) : pkt->size;
+
+    /* Copy request into temporary buffer, and parse it as CoAP. */
+    memcpy(buf, pkt->data, pkt_size);
+
+    /* empty message: ping, or ACK or RST for a confirmable request */
+    if ((pkt_size >= sizeof(coap_hdr_t)) && (buf[1] == 0)) {
+        pdu.hdr = (coap_hdr_t *)buf;
+        _handle_empty(&pdu, src, port);
+        goto exit;
+    }
+
+    int result = coap_parse(&pdu, buf, pkt_size);
+    if (result < 0) {
+        DEBUG("gcoap: parse failure: %d\n", result);
+        /* If a response, can't clear memo, but it will timeout later. */
+        goto exit;
+    }
+
+    /* incoming request */
+    if (coap_get_code_class(&pdu) == COAP_CLASS_REQ) {
+        uint16_t id = coap_get_id(&pdu);
+        bool confirmable = (coap_get_type(&pdu) == COAP_TYPE_CON);
+
+        gcoap_dup_entry_t *dup = _find_dup(src, port, id);
+        if (dup) {
+            DEBUG("gcoap: duplicate request %u\n", id);
+            _coap_state.con_stats.duplicates++;
+            if (dup->resp) {
+                _send_buf(dup->resp->data, dup->resp->size, src, port);
+            }
+            goto exit;
+        }
+
+        gnrc_pktsnip_t *netif_snip;
+        LL_SEARCH_SCALAR(pkt, netif_snip, type, GNRC_NETTYPE_NETIF);
+        _coap_state.req_iface = (netif_snip)
+                        ? ((gnrc_netif_hdr_t *)netif_snip->data)->if_pid
+                        : KERNEL_PID_UNDEF;
+
+        if (pkt->size > sizeof(buf)) {
+            DEBUG("gcoap: request too big: %u\n", pkt->size);
+            /* suggest a block size for a block-wise request instead */
+            gcoap_resp_init(&pdu, buf, sizeof(buf),
+                            COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
+            int szx = _block_szx(&pdu);
+            pdu.payload_len = 0;
+            pdu_len = _finish_pdu(&pdu, buf, sizeof(buf),
+                                  (szx >= 0) ? COAP_OPT_BLOCK1 : 0, szx);
+        } else {
+            _coap_state.rcv_end = buf + pkt_size;
+            pdu_len = _handle_req(&pdu, buf, sizeof(buf), buf + pkt_size,
+                                  src, port);
+            _coap_state.rcv_end = NULL;
+        }
+        if (pdu_len > 0) {
+            _send_buf(buf, pdu_len, src, port);
+        }
+        /* keep the piggybacked response to resend it for a duplicate */
+        _add_dup(src, port, id, buf, (confirmable) ? pdu_len : 0);
+    }
+    /* incoming response */
+    else {
+        mutex_lock(&_coap_state.lock);
+        _find_req_memo(&memo, &pdu, buf, sizeof(buf));
+        if (memo) {
+            if (memo->msg && (coap_get_type(&pdu) == COAP_TYPE_ACK)) {
+                _update_rto(memo);
+            }
+            _close_req(memo);
+            memo->state = GCOAP_MEMO_RESP;
+        }
+        mutex_unlock(&_coap_state.lock);
+
+        /* separate response */
+        if (coap_get_type(&pdu) == COAP_TYPE_CON) {
+            _send_empty_ack(&pdu, src, port);
+        }
+
+        if (memo) {
+            if (pkt->size > sizeof(buf)) {
+                memo->state = GCOAP_MEMO_ERR;
+                DEBUG("gcoap: response too big: %u\n", pkt->size);
+            }
+            _coap_state.rcv_end = buf + pkt_size;
+            memo->resp_handler(memo->state, &pdu);
+            _coap_state.rcv_end = NULL;
+
+            mutex_lock(&_coap_state.lock);
+            _release_req(memo);
+            mutex_unlock(&_coap_state.lock);
+        }
+    }
+
+exit:
+    gnrc_pktbuf_release(pkt);
+}
+
+/*
+ * Main request handler: generates response PDU in the provided buffer.
+ * Registers or deregisters an observer for a GET with Observe option. Passes
+ * a request with Proxy-Uri option to the forward proxy.
+ *
+ * Caller must finish the PDU and send it.
+ *
+ * opt_end End of the request in buf
+ */
+static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                          uint8_t *opt_end, ipv6_addr_t *src, uint16_t port)
+{
+    unsigned method_flag = coap_method2flag(coap_get_code_detail(pdu));
+
+    size_t uri_len;
+    uint8_t *uri = _opt_find(buf + coap_get_total_hdr_len(pdu), opt_end,
+                             COAP_OPT_PROXY_URI, &uri_len);
+    if (uri) {
+#ifdef MODULE_GCOAP_PROXY
+        return _proxy_handle(pdu, buf, len, opt_end, uri, uri_len, src, port);
+#else
+        return gcoap_response(pdu, buf, len, COAP_CODE_PROXYING_NOT_SUPPORTED);
+#endif
+    }
+
+    coap_resource_t *resource = _find_resource((char *)&pdu->url[0], method_flag);
+    if (resource) {
+        uint8_t token[GCOAP_TOKENLEN_MAX];
+        size_t token_len = coap_get_token_len(pdu);
+        int observe = -1;
+
+        if ((method_flag == COAP_GET) && (token_len <= GCOAP_TOKENLEN_MAX)) {
+            size_t obs_len;
+            uint8_t *obs_val = _opt_find(buf + coap_get_total_hdr_len(pdu),
+                                         opt_end, COAP_OPT_OBSERVE, &obs_len);
+            if (obs_val) {
+                observe = _opt_uint(obs_val, obs_len);
+                memcpy(token, pdu->token, token_len);
+            }
+        }
+        if (observe == 1) {
+            mutex_lock(&_coap_state.lock);
+            gcoap_observe_t *obs = _obs_find(resource, src, port);
+            if (obs) {
+                DEBUG("gcoap: deregistered observer\n");
+                if (obs->pending) {
+                    gnrc_pktbuf_release(obs->pending);
                 }
+                memset(obs, 0, sizeof(*obs));
+            }
+            mutex_unlock(&_coap_state.lock);
+        }
+
+        ssize_t pdu_len = resource->handler(pdu, buf, len);
+        if (pdu_len < 0) {
+            pdu_len = gcoap_response(pdu, buf, len,
+                                     COAP_CODE_INTERNAL_SERVER_ERROR);
+        }
+
+        /* only a successful response starts an observation */
+        if ((observe == 0) && (pdu_len > 0) &&
+            (coap_get_code_class(pdu) == COAP_CLASS_SUCCESS)) {
+            uint8_t *opt = buf + coap_get_total_hdr_len(pdu);
+            uint8_t obs_opt[GCOAP_OBS_OPTION_MAXLEN];
+            size_t skip;
+
+            mutex_lock(&_coap_state.lock);
+            size_t obs_len = _put_observe(obs_opt, _coap_state.obs_seq, opt,
+                                          buf + pdu_len, &skip);
+            if ((pdu_len - skip + obs_len <= len) &&
+                _obs_register(resource, src, port, token, token_len)) {
+                memmove(opt + obs_len, opt + skip, buf + pdu_len - (opt + skip));
+                memcpy(opt, obs_opt, obs_len);
+                pdu_len += obs_len - skip;
+            }
+            mutex_unlock(&_coap_state.lock);
+        }
+        return pdu_len;
+    }
+    /* resource not found */
+    return gcoap_response(pdu, buf, len, COAP_CODE_PATH_NOT_FOUND);
+}
+
+/*
+ * FNV-1a hash over len bytes of data, continuing from hash.
+ */
+static uint32_t _hash(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/*
+ * Adds the resources of a listener to _resource_index. Uses linear probing;
+ * resources which do not fit only are reachable by a scan of all listeners.
+ */
+static void _index_listener(gcoap_listener_t *listener)
+{
+    for (size_t i = 0; i < listener->resources_len; i++) {
+        coap_resource_t *resource = &listener->resources[i];
+        uint32_t hash = _hash(2166136261U, resource->path,
+                                   strlen(resource->path));
+        unsigned j;
+
+        for (j = 0; j < GCOAP_RESOURCE_INDEX_SIZE; j++) {
+            unsigned pos = (hash + j) & (GCOAP_RESOURCE_INDEX_SIZE - 1);
+            if (_resource_index[pos] == NULL) {
+                _resource_index[pos] = resource;
+                break;
+            }
+        }
+        if (j == GCOAP_RESOURCE_INDEX_SIZE) {
+            /* only costs time; see GCOAP_RESOURCE_INDEX_SIZE */
+            DEBUG("gcoap: resource index full, scanning for %s\n", resource->path);
+            _resource_index_full = true;
+        }
+    }
+}
+
+/*
+ * Looks up the resource for the first len characters of path in
+ * _resource_index. If wildcard is set, looks for the wildcard resource for that
+ * prefix instead, i.e. the prefix followed by a '*' segment.
+ */
+static coap_resource_t *_index_find(const char *path, size_t len, bool wildcard,
+                                    unsigned method_flag)
+{
+    uint32_t hash = _hash(2166136261U, path, len);
+    if (wildcard) {
+        hash = _hash(hash, "/*", 2);
+    }
+
+    for (unsigned j = 0; j < GCOAP_RESOURCE_INDEX_SIZE; j++) {
+        coap_resource_t *resource;
+        resource = _resource_index[(hash + j) & (GCOAP_RESOURCE_INDEX_SIZE - 1)];
+        if (resource == NULL) {
+            break;
+        }
+        const char *rpath = resource->path;
+        if ((strncmp(rpath, path, len) == 0) &&
+            (wildcard ? (strcmp(&rpath[len], "/*") == 0) : (rpath[len] == '\0')) &&
+            (resource->methods & method_flag)) {
+            return resource;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Finds the resource for a request path. An exact match takes precedence over
+ * the wildcard resource with the longest matching prefix.
+ */
+static coap_resource_t *_find_resource(const char *path, unsigned method_flag)
+{
+    coap_resource_t *match = NULL;
+    size_t match_len = 0;
+    size_t len = strlen(path);
+
+    if (!_resource_index_full) {
+        match = _index_find(path, len, false, method_flag);
+        /* try wildcards at each segment boundary, longest prefix first */
+        while (!match && (len > 0)) {
+            while ((len > 0) && (path[--len] != '/')) {}
+            match = _index_find(path, len, true, method_flag);
+        }
+        return match;
+    }
+
+    /* index incomplete; scan all listeners */
+    gcoap_listener_t *listener = _coap_state.listeners;
+    while (listener) {
+        for (size_t i = 0; i < listener->resources_len; i++) {
+            coap_resource_t *resource = &listener->resources[i];
+            if (!(resource->methods & method_flag)) {
+                continue;
+            }
+
+            size_t rlen = strlen(resource->path);
+            if (strcmp(path, resource->path) == 0) {
+                return resource;
+            }
+            /* wildcard prefix must end at a segment boundary in path */
+            if ((rlen >= 2) && (strcmp(&resource->path[rlen - 2], "/*") == 0) &&
+                (rlen - 2 < len) && (path[rlen - 2] == '/') &&
+                (strncmp(path, resource->path, rlen - 2) == 0) &&
+                (!match || (rlen > match_len))) {
+                match = resource;
+                match_len = rlen;
+            }
+        }
+        listener = listener->next;
+    }
+    return match;
+}
+
+/*
+ * Finishes handling a PDU -- write options and reposition payload. Adds the
+ * Block1 or Block2 option with value block_val if block_opt is set.
+ *
+ * Returns the size of the PDU within the buffer, or < 0 on error.
+ */
+static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                           unsigned block_opt, uint32_t block_val)
+{
+    ssize_t hdr_len = _write_options(pdu, buf, len, block_opt, block_val);
+    DEBUG("gcoap: header length: %u\n", hdr_len);
+
+    if (hdr_len > 0) {
+        /* move payload over unused space after options */
+        if (pdu->payload_len) {
+            memmove(buf + hdr_len, pdu->payload, pdu->payload_len);
+        }
+
+        return hdr_len + pdu->payload_len;
+    }
+    else {
+        return -1;      /* generic failure code */
+    }
+}
+
+/*
+ * Returns the bucket of _coap_state.req_index for a token.
+ */
+static gcoap_request_memo_t **_req_bucket(uint8_t *token, size_t token_len)
+{
+    uint32_t hash = _hash(2166136261U, token, token_len);
+
+    return &_coap_state.req_index[hash & (GCOAP_REQ_INDEX_SIZE - 1)];
+}
+
+/*
+ * Returns the bucket of _coap_state.id_index for a message ID. We assign IDs
+ * sequentially, so the low bits spread them well.
+ */
+static gcoap_request_memo_t **_id_bucket(uint16_t id)
+{
+    return &_coap_state.id_index[id & (GCOAP_REQ_INDEX_SIZE - 1)];
+}
+
+/*
+ * Finds the memo for an outstanding request in _coap_state.req_index. Matches
+ * on token. Caller must hold _coap_state.lock.
+ *
+ * src_pdu Source for the match token
+ */
+static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *src_pdu,
+                                                            uint8_t *buf, size_t len)
+{
+    gcoap_request_memo_t *memo;
+    coap_pkt_t memo_pdu;
+    size_t token_len = coap_get_token_len(src_pdu);
+    (void) buf;
+    (void) len;
+
+    memo = *_req_bucket(src_pdu->token, token_len);
+    while (memo) {
+        memo_pdu.hdr = (coap_hdr_t *) &memo->hdr_buf[0];
+        if ((coap_get_token_len(&memo_pdu) == token_len) &&
+            (memcmp(&memo_pdu.hdr->data[0], src_pdu->token, token_len) == 0)) {
+            *memo_ptr = memo;
+            return;
+        }
+        memo = memo->next;
+    }
+}
+
+/*
+ * Adds a memo to the indexes by token and by message ID and, unless timeout
+ * is 0, to the timeout queue. Caller must hold _coap_state.lock.
+ */
+static void _open_req(gcoap_request_memo_t *memo, uint32_t timeout)
+{
+    coap_pkt_t memo_pdu = { .hdr = (coap_hdr_t *) &memo->hdr_buf[0] };
+    gcoap_request_memo_t **bucket = _req_bucket(&memo_pdu.hdr->data[0],
+                                                coap_get_token_len(&memo_pdu));
+
+    memo->next = *bucket;
+    *bucket = memo;
+    bucket = _id_bucket(coap_get_id(&memo_pdu));
+    memo->id_next = *bucket;
+    *bucket = memo;
+    _coap_state.open_reqs_numof++;
+
+    memo->tprev = NULL;
+    if (timeout > 0) {
+        _queue_req(memo, timeout);
+    }
+}
+
+/*
+ * Removes a memo from the indexes and the timeout queue, so the memo no longer
+ * matches a response. Caller must hold _coap_state.lock.
+ */
+static void _close_req(gcoap_request_memo_t *memo)
+{
+    coap_pkt_t memo_pdu = { .hdr = (coap_hdr_t *) &memo->hdr_buf[0] };
+    gcoap_request_memo_t **bucket = _req_bucket(&memo_pdu.hdr->data[0],
+                                                coap_get_token_len(&memo_pdu));
+
+    LL_DELETE(*bucket, memo);
+    bucket = _id_bucket(coap_get_id(&memo_pdu));
+    LL_DELETE2(*bucket, memo, id_next);
+    _coap_state.open_reqs_numof--;
+    _dequeue_req(memo);
+}
+
+/*
+ * Returns a closed memo to the free list. Caller must hold _coap_state.lock.
+ */
+static void _release_req(gcoap_request_memo_t *memo)
+{
+    if (memo->msg) {
+        gnrc_pktbuf_release(memo->msg);
+        memo->msg = NULL;
+    }
+    memo->state = GCOAP_MEMO_UNUSED;
+    memo->next = _coap_state.req_free;
+    _coap_state.req_free = memo;
+}
+
+/*
+ * Adds a memo to the timeout queue, to expire timeout usec from now. Caller
+ * must hold _coap_state.lock.
+ */
+static void _queue_req(gcoap_request_memo_t *memo, uint32_t timeout)
+{
+    gcoap_request_memo_t *head = _coap_state.timeout_queue;
+
+    /* queue is ordered by deadline; a new memo normally goes to the end */
+    memo->deadline = xtimer_now_usec() + timeout;
+    if (!head) {
+        DL_APPEND2(_coap_state.timeout_queue, memo, tprev, tnext);
+    }
+    else {
+        gcoap_request_memo_t *el = head->tprev;
+        while ((el != head) && ((int32_t)(el->deadline - memo->deadline) > 0)) {
+            el = el->tprev;
+        }
+        if ((int32_t)(el->deadline - memo->deadline) > 0) {
+            /* el is head */
+            DL_PREPEND2(_coap_state.timeout_queue, memo, tprev, tnext);
+        }
+        else if (el->tnext == NULL) {
+            DL_APPEND2(_coap_state.timeout_queue, memo, tprev, tnext);
+        }
+        else {
+            memo->tprev = el;
+            memo->tnext = el->tnext;
+            el->tnext->tprev = memo;
+            el->tnext = memo;
+        }
+    }
+    if (_coap_state.timeout_queue == memo) {
+        _set_req_timer();
+    }
+}
+
+/*
+ * Removes a memo from the timeout queue, if queued. Caller must hold
+ * _coap_state.lock.
+ */
+static void _dequeue_req(gcoap_request_memo_t *memo)
+{
+    if (memo->tprev == NULL) {
+        return;
+    }
+
+    bool was_head = (_coap_state.timeout_queue == memo);
+    DL_DELETE2(_coap_state.timeout_queue, memo, tprev, tnext);
+    memo->tprev = NULL;
+    if (was_head) {
+        _set_req_timer();
+    }
+}
 
-                /* read source port and address */
-                port = byteorder_ntohs(((udp_hdr_t *)udp_snip->data)->src_port);
+/*
+ * Sets the timer for the deadline of the first memo in the timeout queue.
+ * Caller must hold _coap_state.lock.
+ */
+static void _set_req_timer(void)
+{
+    gcoap_request_memo_t *head = _coap_state.timeout_queue;
+
+    if (!head) {
+        xtimer_remove(&_coap_state.timeout_timer);
+        return;
+    }
+    int32_t offset = (int32_t)(head->deadline - xtimer_now_usec());
+    _coap_state.timeout_msg.type = GCOAP_NETAPI_MSG_TYPE_TIMEOUT;
+    xtimer_set_msg(&_coap_state.timeout_timer, (offset > 0) ? (uint32_t)offset : 0,
+                                               &_coap_state.timeout_msg, _pid);
+}
+
+/*
+ * Retransmits confirmable requests which were not acknowledged in time, and
+ * calls handler callback for each request which timed out.
+ */
+static void _expire_requests(void)
+{
+    gcoap_request_memo_t *expired = NULL, *memo;
+    coap_pkt_t req;
+    /* retransmissions, sent in batches after releasing the lock */
+    struct {
+        gnrc_pktsnip_t *msg;
+        ipv6_addr_t addr;
+        uint16_t port;
+    } resend[GCOAP_RESEND_BATCH];
+    unsigned resend_numof;
+
+    DEBUG("coap: received timeout message\n");
+    /* a full batch may leave expired requests in the queue for another round */
+    do {
+        resend_numof = 0;
+        mutex_lock(&_coap_state.lock);
+        uint32_t now = xtimer_now_usec();
+        while ((resend_numof < GCOAP_RESEND_BATCH) &&
+               (memo = _coap_state.timeout_queue) &&
+               ((int32_t)(memo->deadline - now) <= 0)) {
+            if (memo->msg && (memo->retransmits < GCOAP_MAX_RETRANSMIT)) {
+                /* back off faster for short timeouts, slower for long ones */
+                if (memo->timeout < 1000000U) {
+                    memo->timeout *= 3;
+                }
+                else if (memo->timeout > 3000000U) {
+                    memo->timeout += memo->timeout / 2;
+                }
+                else {
+                    memo->timeout *= 2;
+                }
+                memo->retransmits++;
+                _coap_state.con_stats.retransmissions++;
+                DEBUG("gcoap: retransmission %u, timeout %" PRIu32 " usec\n",
+                      memo->retransmits, memo->timeout);
+
+                _dequeue_req(memo);
+                _queue_req(memo, memo->timeout);
+                gnrc_pktbuf_hold(memo->msg, 1);
+                resend[resend_numof].msg  = memo->msg;
+                resend[resend_numof].addr = memo->addr;
+                resend[resend_numof].port = memo->port;
+                resend_numof++;
+                continue;
+            }
+            if (memo->msg) {
+                _coap_state.con_stats.con_timeouts++;
+            }
+            _close_req(memo);
+            memo->state = GCOAP_MEMO_TIMEOUT;
+            memo->next = expired;
+            expired = memo;
+        }
+        mutex_unlock(&_coap_state.lock);
+
+        for (unsigned i = 0; i < resend_numof; i++) {
+            _send_buf(resend[i].msg->data, resend[i].msg->size, &resend[i].addr,
+                      resend[i].port);
+            gnrc_pktbuf_release(resend[i].msg);
+        }
+    } while (resend_numof == GCOAP_RESEND_BATCH);
+
+    while ((memo = expired)) {
+        expired = memo->next;
+        /* Pass response to handler */
+        if (memo->resp_handler) {
+            req.hdr = (coap_hdr_t *)&memo->hdr_buf[0];   /* for reference */
+            memo->resp_handler(memo->state, &req);
+        }
+
+        mutex_lock(&_coap_state.lock);
+        _release_req(memo);
+        mutex_unlock(&_coap_state.lock);
+    }
+}
+
+/*
+ * Handles an empty message. Answers a ping with RST. An ACK for a confirmable
+ * request stops retransmission while waiting for the separate response; a RST
+ * ends the request.
+ */
+static void _handle_empty(coap_pkt_t *pdu, ipv6_addr_t *src, uint16_t port)
+{
+    gcoap_request_memo_t *memo = NULL;
+    unsigned type = coap_get_type(pdu);
+    coap_pkt_t memo_pdu;
+
+    if (type == COAP_TYPE_CON) {
+        DEBUG("gcoap: ping\n");
+        gcoap_hdr_set_type(pdu->hdr, COAP_TYPE_RST);
+        _send_buf((uint8_t *)pdu->hdr, sizeof(coap_hdr_t), src, port);
+        return;
+    }
+    else if (type == COAP_TYPE_NON) {
+        return;
+    }
+
+    /* Empty messages carry no token; match on message ID and peer. */
+    mutex_lock(&_coap_state.lock);
+    gcoap_request_memo_t *el;
+    LL_FOREACH2(*_id_bucket(coap_get_id(pdu)), el, id_next) {
+        memo_pdu.hdr = (coap_hdr_t *)&el->hdr_buf[0];
+        if (el->msg && (coap_get_id(&memo_pdu) == coap_get_id(pdu)) &&
+            (el->port == port) && ipv6_addr_equal(&el->addr, src)) {
+            memo = el;
+            break;
+        }
+    }
+    if (!memo && (type == COAP_TYPE_RST)) {
+        /* observer rejected a notification */
+        for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+            gcoap_observe_t *obs = &_coap_state.observers[i];
+            if (obs->resource && (obs->last_id == coap_get_id(pdu)) &&
+                (obs->port == port) && ipv6_addr_equal(&obs->addr, src)) {
+                DEBUG("gcoap: observer reset notification\n");
+                if (obs->pending) {
+                    gnrc_pktbuf_release(obs->pending);
+                }
+                memset(obs, 0, sizeof(*obs));
+            }
+        }
+    }
+    else if (memo && (type == COAP_TYPE_ACK)) {
+        _update_rto(memo);
+        gnrc_pktbuf_release(memo->msg);
+        memo->msg = NULL;
+        _dequeue_req(memo);
+        if (GCOAP_NON_TIMEOUT > 0) {
+            _queue_req(memo, GCOAP_NON_TIMEOUT);
+        }
+        memo = NULL;
+    }
+    else if (memo) {
+        _close_req(memo);
+        memo->state = GCOAP_MEMO_ERR;
+    }
+    mutex_unlock(&_coap_state.lock);
+
+    if (memo) {
+        memo_pdu.hdr = (coap_hdr_t *)&memo->hdr_buf[0];   /* for reference */
+        memo->resp_handler(memo->state, &memo_pdu);
+
+        mutex_lock(&_coap_state.lock);
+        _release_req(memo);
+        mutex_unlock(&_coap_state.lock);
+    }
+}
+
+/* Acknowledges a confirmable response with an empty ACK. */
+static void _send_empty_ack(coap_pkt_t *pdu, ipv6_addr_t *src, uint16_t port)
+{
+    coap_hdr_t ack;
+
+    /* keep version, drop token */
+    ack.ver_t_tkl = pdu->hdr->ver_t_tkl & 0xf0;
+    ack.code      = 0;
+    ack.id        = pdu->hdr->id;
+    gcoap_hdr_set_type(&ack, COAP_TYPE_ACK);
+
+    _send_buf((uint8_t *)&ack, sizeof(ack), src, port);
+}
+
+/*
+ * Finds the RTO state for a peer. If create is set, allocates the state for
+ * an unknown peer, replacing the least recently used one. Caller must hold
+ * _coap_state.lock.
+ */
+static gcoap_peer_t *_find_peer(const ipv6_addr_t *addr, bool create)
+{
+    gcoap_peer_t *lru = NULL;
+    uint32_t now = xtimer_now_usec();
+
+    for (int i = 0; i < GCOAP_RTO_PEERS_MAX; i++) {
+        gcoap_peer_t *peer = &_coap_state.peers[i];
+        if (ipv6_addr_equal(&peer->addr, addr)) {
+            peer->last_used = now;
+            return peer;
+        }
+        /* prefer an unused entry */
+        if (!lru || (!ipv6_addr_is_unspecified(&lru->addr) &&
+                     (ipv6_addr_is_unspecified(&peer->addr) ||
+                      ((now - peer->last_used) > (now - lru->last_used))))) {
+            lru = peer;
+        }
+    }
+    if (!create || ipv6_addr_is_unspecified(addr)) {
+        return NULL;
+    }
+
+    memset(lru, 0, sizeof(*lru));
+    lru->addr      = *addr;
+    lru->rto       = GCOAP_ACK_TIMEOUT;
+    lru->updated   = now;
+    lru->last_used = now;
+    return lru;
+}
+
+/*
+ * Returns the timeout for the first transmission of a confirmable request to
+ * a peer: the peer's RTO, aged if not updated recently, and dithered by up to
+ * 50%. Caller must hold _coap_state.lock.
+ */
+static uint32_t _initial_rto(const ipv6_addr_t *addr)
+{
+    gcoap_peer_t *peer = _find_peer(addr, false);
+    uint32_t rto = GCOAP_ACK_TIMEOUT;
+
+    if (peer) {
+        uint32_t now = xtimer_now_usec();
+        uint32_t age = now - peer->updated;
+
+        /* a short RTO may not fit anymore, a long one may be stale */
+        if ((peer->rto < 1000000U) && (age > 16 * peer->rto)) {
+            peer->rto *= 2;
+            peer->updated = now;
+        }
+        else if ((peer->rto > 3000000U) && (age > 4 * peer->rto)) {
+            peer->rto = (GCOAP_ACK_TIMEOUT + peer->rto) / 2;
+            peer->updated = now;
+        }
+        rto = peer->rto;
+    }
+    return rto + random_uint32_range(0, rto / 2 + 1);
+}
+
+/*
+ * Feeds the RTT sample of an acknowledged confirmable request into the RTO
+ * estimators of the peer, as in CoCoA: a strong sample from an exchange
+ * without retransmission, a weak one from an exchange with one or two
+ * retransmissions. Caller must hold _coap_state.lock.
+ */
+static void _update_rto(gcoap_request_memo_t *memo)
+{
+    uint32_t rtt = xtimer_now_usec() - memo->sent;
+    bool strong = (memo->retransmits == 0);
+
+    _coap_state.con_stats.rtt_last = rtt;
+    if (memo->retransmits > 2) {
+        return;
+    }
+    _coap_state.con_stats.rtt_samples++;
+
+    gcoap_peer_t *peer = _find_peer(&memo->addr, true);
+    if (!peer) {
+        return;
+    }
+    gcoap_rtt_est_t *est = (strong) ? &peer->strong : &peer->weak;
+
+    /* RFC 6298 with alpha = 1/8 and beta = 1/4 */
+    if (est->srtt == 0) {
+        est->srtt   = rtt;
+        est->rttvar = rtt / 2;
+    }
+    else {
+        uint32_t delta = (est->srtt > rtt) ? est->srtt - rtt : rtt - est->srtt;
+        est->rttvar = est->rttvar - est->rttvar / 4 + delta / 4;
+        est->srtt   = est->srtt - est->srtt / 8 + rtt / 8;
+    }
+
+    /* K is 4 for the strong, 1 for the weak estimator */
+    uint32_t rto_est = est->srtt + ((strong) ? 4 : 1) * est->rttvar;
+    if (strong) {
+        peer->rto = (peer->rto + rto_est) / 2;
+    }
+    else {
+        peer->rto = (3 * peer->rto + rto_est) / 4;
+    }
+    if (peer->rto > GCOAP_RTO_MAX) {
+        peer->rto = GCOAP_RTO_MAX;
+    }
+    peer->updated = xtimer_now_usec();
+    DEBUG("gcoap: RTT %" PRIu32 " usec, RTO %" PRIu32 " usec\n", rtt, peer->rto);
+}
+
+/*
+ * Finds a recent request from the same endpoint with the same message ID.
+ * Only used by the gcoap thread.
+ */
+static gcoap_dup_entry_t *_find_dup(ipv6_addr_t *src, uint16_t port, uint16_t id)
+{
+    uint32_t now = xtimer_now_usec();
+
+    for (int i = 0; i < GCOAP_DUP_CACHE_SIZE; i++) {
+        gcoap_dup_entry_t *dup = &_coap_state.dups[i];
+        if ((dup->port == port) && (dup->id == id) &&
+            ((now - dup->time) < GCOAP_DUP_LIFETIME) &&
+            ipv6_addr_equal(&dup->addr, src)) {
+            return dup;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Remembers a request, replacing the oldest entry, and keeps a copy of its
+ * response if resp_len is not 0. Only used by the gcoap thread.
+ */
+static void _add_dup(ipv6_addr_t *src, uint16_t port, uint16_t id,
+                     uint8_t *resp, size_t resp_len)
+{
+    gcoap_dup_entry_t *dup = &_coap_state.dups[0];
+    uint32_t now = xtimer_now_usec();
+
+    for (int i = 1; i < GCOAP_DUP_CACHE_SIZE; i++) {
+        if ((now - _coap_state.dups[i].time) > (now - dup->time)) {
+            dup = &_coap_state.dups[i];
+        }
+    }
+    if (dup->resp) {
+        gnrc_pktbuf_release(dup->resp);
+    }
+
+    dup->addr = *src;
+    dup->port = port;
+    dup->id   = id;
+    dup->time = now;
+    dup->resp = (resp_len > 0) ? gnrc_pktbuf_add(NULL, resp, resp_len,
+                                                 GNRC_NETTYPE_UNDEF)
+                               : NULL;
+}
+
+/*
+ * Reads the header of the option at pos. Returns the size of the header, or 0
+ * at the payload marker, at end, or if the header is malformed.
+ */
+static size_t _opt_hdr_get(const uint8_t *pos, const uint8_t *end,
+                           unsigned *delta, unsigned *len)
+{
+    const uint8_t *start = pos;
+    unsigned *field[] = { delta, len };
+    unsigned nibble[2];
+
+    if ((pos >= end) || (*pos == GCOAP_PAYLOAD_MARKER)) {
+        return 0;
+    }
+    nibble[0] = *pos >> 4;
+    nibble[1] = *pos++ & 0xf;
+
+    for (int i = 0; i < 2; i++) {
+        switch (nibble[i]) {
+            case 13:
+                if (pos + 1 > end) {
+                    return 0;
+                }
+                *field[i] = 13 + *pos++;
+                break;
+            case 14:
+                if (pos + 2 > end) {
+                    return 0;
+                }
+                *field[i] = 269 + ((pos[0] << 8) | pos[1]);
+                pos += 2;
+                break;
+            case 15:
+                return 0;
+            default:
+                *field[i] = nibble[i];
+                break;
+        }
+    }
+    return pos - start;
+}
+
+/* Writes an option header to out. Returns the size of the header. */
+static size_t _opt_hdr_put(uint8_t *out, unsigned delta, unsigned len)
+{
+    unsigned value[] = { delta, len };
+    uint8_t *pos = out + 1;
+
+    *out = 0;
+    for (int i = 0; i < 2; i++) {
+        unsigned nibble;
+        if (value[i] < 13) {
+            nibble = value[i];
+        }
+        else if (value[i] < 269) {
+            nibble = 13;
+            *pos++ = value[i] - 13;
+        }
+        else {
+            nibble = 14;
+            *pos++ = (value[i] - 269) >> 8;
+            *pos++ = (value[i] - 269) & 0xff;
+        }
+        *out |= (i == 0) ? (nibble << 4) : nibble;
+    }
+    return pos - out;
+}
+
+/*
+ * Finds the first option num among the options from pos to end. Returns a
+ * pointer to its value and sets len, or returns NULL if not found.
+ */
+static uint8_t *_opt_find(uint8_t *pos, uint8_t *end, unsigned num, size_t *len)
+{
+    unsigned optnum = 0, delta, optlen;
+    size_t hdr_len;
+
+    while ((hdr_len = _opt_hdr_get(pos, end, &delta, &optlen))) {
+        pos += hdr_len;
+        optnum += delta;
+        if ((optnum > num) || (pos + optlen > end)) {
+            break;
+        }
+        if (optnum == num) {
+            *len = optlen;
+            return pos;
+        }
+        pos += optlen;
+    }
+    return NULL;
+}
+
+/* Reads the value of an unsigned integer option. */
+static uint32_t _opt_uint(const uint8_t *val, size_t len)
+{
+    uint32_t value = 0;
+
+    for (size_t i = 0; (i < len) && (i < sizeof(value)); i++) {
+        value = (value << 8) | val[i];
+    }
+    return value;
+}
+
+/*
+ * Writes an unsigned integer option with the shortest encoding of value to
+ * out. Returns the size of the option.
+ */
+static size_t _opt_uint_put(uint8_t *out, unsigned delta, uint32_t value)
+{
+    size_t len = 0;
+    uint8_t *pos = out;
+
+    for (uint32_t tmp = value; tmp; tmp >>= 8) {
+        len++;
+    }
+    pos += _opt_hdr_put(pos, delta, len);
+    for (int i = len - 1; i >= 0; i--) {
+        *pos++ = (value >> (8 * i)) & 0xff;
+    }
+    return pos - out;
+}
+
+/*
+ * Writes an Observe option with value seq to out, followed by the header of
+ * the first option of a response at opt, re-encoded relative to Observe. The
+ * caller skips the original header, whose size is returned in skip. The
+ * options of a gcoap response all have numbers above Observe.
+ *
+ * Returns the number of bytes written, at most GCOAP_OBS_OPTION_MAXLEN.
+ */
+static size_t _put_observe(uint8_t *out, uint32_t seq, const uint8_t *opt,
+                           const uint8_t *end, size_t *skip)
+{
+    unsigned delta, len;
+    uint8_t *pos = out;
+
+    pos += _opt_uint_put(pos, COAP_OPT_OBSERVE, seq & 0xffffff);
+
+    *skip = _opt_hdr_get(opt, end, &delta, &len);
+    if (*skip) {
+        assert(delta >= COAP_OPT_OBSERVE);
+        pos += _opt_hdr_put(pos, delta - COAP_OPT_OBSERVE, len);
+    }
+    return pos - out;
+}
+
+/*
+ * Finds the registration of an observer for a resource. Caller must hold
+ * _coap_state.lock.
+ */
+static gcoap_observe_t *_obs_find(const coap_resource_t *resource,
+                                  ipv6_addr_t *addr, uint16_t port)
+{
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_observe_t *obs = &_coap_state.observers[i];
+        if ((obs->resource == resource) && (obs->port == port) &&
+            ipv6_addr_equal(&obs->addr, addr)) {
+            return obs;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Registers an observer for a resource, or updates the token of an existing
+ * registration. Caller must hold _coap_state.lock.
+ *
+ * Returns false if there is no space for a new registration.
+ */
+static bool _obs_register(const coap_resource_t *resource, ipv6_addr_t *addr,
+                          uint16_t port, uint8_t *token, size_t token_len)
+{
+    gcoap_observe_t *obs = _obs_find(resource, addr, port);
+
+    for (int i = 0; !obs && (i < GCOAP_OBS_REGISTRATIONS_MAX); i++) {
+        if (_coap_state.observers[i].resource == NULL) {
+            obs = &_coap_state.observers[i];
+            obs->resource  = resource;
+            obs->addr      = *addr;
+            obs->port      = port;
+            obs->last_sent = xtimer_now_usec();
+        }
+    }
+    if (!obs) {
+        DEBUG("gcoap: no space for observer\n");
+        return false;
+    }
+    memcpy(obs->token, token, token_len);
+    obs->token_len = token_len;
+    return true;
+}
+
+/*
+ * Sends a notification to an observer. The notification consists of a header
+ * with the observer's token, and the body shared by all observers: the
+ * options, starting with Observe, and the payload. Caller must hold
+ * _coap_state.lock.
+ */
+static void _obs_notify(gcoap_observe_t *obs, gnrc_pktsnip_t *body, uint8_t code)
+{
+    uint16_t id = _next_id();
+
+    if (!_send_body(body, &obs->addr, obs->port, obs->token, obs->token_len,
+                    code, id)) {
+        DEBUG("gcoap: no space for notification\n");
+        return;
+    }
+    obs->last_id   = id;
+    obs->last_sent = xtimer_now_usec();
+}
+
+/*
+ * Returns the minimum time between notifications to an observer: at least
+ * GCOAP_OBS_MIN_INTERVAL, and at least the smoothed RTT of the observer, if
+ * known. Caller must hold _coap_state.lock.
+ */
+static uint32_t _obs_interval(gcoap_observe_t *obs)
+{
+    gcoap_peer_t *peer = _find_peer(&obs->addr, false);
+
+    if (peer && (peer->strong.srtt > GCOAP_OBS_MIN_INTERVAL)) {
+        return peer->strong.srtt;
+    }
+    return GCOAP_OBS_MIN_INTERVAL;
+}
+
+/*
+ * Sets the timer for the first coalesced notification which may be sent.
+ * Caller must hold _coap_state.lock.
+ */
+static void _obs_set_timer(void)
+{
+    uint32_t now = xtimer_now_usec();
+    uint32_t next = UINT32_MAX;
+
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_observe_t *obs = &_coap_state.observers[i];
+        if (obs->pending) {
+            int32_t wait = _obs_interval(obs) - (now - obs->last_sent);
+            if (wait <= 0) {
+                next = 0;
+                break;
+            }
+            if ((uint32_t)wait < next) {
+                next = wait;
+            }
+        }
+    }
+    if (next != UINT32_MAX) {
+        _coap_state.obs_msg.type = GCOAP_NETAPI_MSG_TYPE_OBS;
+        xtimer_set_msg(&_coap_state.obs_timer, next, &_coap_state.obs_msg, _pid);
+    }
+}
+
+/*
+ * Sends the coalesced notifications whose observers may be notified again.
+ */
+static void _obs_send_pending(void)
+{
+    mutex_lock(&_coap_state.lock);
+    uint32_t now = xtimer_now_usec();
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_observe_t *obs = &_coap_state.observers[i];
+        if (obs->pending &&
+            ((now - obs->last_sent) >= _obs_interval(obs))) {
+            _obs_notify(obs, obs->pending, obs->pending_code);
+            gnrc_pktbuf_release(obs->pending);
+            obs->pending = NULL;
+        }
+    }
+    _obs_set_timer();
+    mutex_unlock(&_coap_state.lock);
+}
+
+/*
+ * Sends a NON message with message ID id, and the options and payload in body,
+ * which may be shared with other messages, and stays with its other users
+ * after sending. Returns false if the header can not be allocated.
+ */
+static bool _send_body(gnrc_pktsnip_t *body, ipv6_addr_t *addr, uint16_t port,
+                       const uint8_t *token, size_t token_len, uint8_t code,
+                       uint16_t id)
+{
+    gnrc_pktsnip_t *hdr_snip = gnrc_pktbuf_add(body, NULL,
+                                               sizeof(coap_hdr_t) + token_len,
+                                               GNRC_NETTYPE_UNDEF);
+    if (!hdr_snip) {
+        return false;
+    }
+    gnrc_pktbuf_hold(body, 1);
+
+    coap_build_hdr(hdr_snip->data, COAP_TYPE_NON, (uint8_t *)token, token_len,
+                   code, id);
+
+    _send(hdr_snip, addr, port);
+    return true;
+}
+
+/*
+ * Reads the Block1 or Block2 option num of the request being handled by a
+ * resource callback. Returns 1 if found, 0 if not, or -EBADMSG if malformed.
+ */
+static int _block_get(coap_pkt_t *pdu, unsigned num, uint32_t *blknum,
+                      bool *more, unsigned *szx)
+{
+    size_t len;
+
+    assert(_coap_state.rcv_end != NULL);
+    uint8_t *val = _opt_find((uint8_t *)pdu->hdr + coap_get_total_hdr_len(pdu),
+                             _coap_state.rcv_end, num, &len);
+    if (!val) {
+        return 0;
+    }
+
+    uint32_t value = _opt_uint(val, len);
+    if ((len > 3) || ((value & 0x7) > GCOAP_BLOCK_SZX_MAX)) {
+        return -EBADMSG;
+    }
+    *blknum = value >> 4;
+    *more   = (value & 0x8);
+    *szx    = value & 0x7;
+    return 1;
+}
+
+/*
+ * Finds the largest block size for a response initialized with
+ * gcoap_resp_init(), which fits into the payload space of the buffer and into
+ * a packet for the interface of the request. Returns the SZX for the block
+ * size, or -1 if even the smallest block does not fit.
+ */
+static int _block_szx(coap_pkt_t *pdu)
+{
+    size_t avail = pdu->payload_len;
+    uint16_t mtu;
+
+    if ((_coap_state.req_iface != KERNEL_PID_UNDEF) &&
+        (gnrc_netapi_get(_coap_state.req_iface, NETOPT_MAX_PACKET_SIZE, 0,
+                         &mtu, sizeof(mtu)) > 0)) {
+        size_t overhead = GCOAP_BLOCK_NET_OVERHEAD
+                          + (pdu->payload - (uint8_t *)pdu->hdr);
+        if (mtu < overhead + avail) {
+            avail = (mtu > overhead) ? mtu - overhead : 0;
+        }
+    }
+
+    for (int szx = GCOAP_BLOCK_SZX_MAX; szx >= 0; szx--) {
+        if ((16U << szx) <= avail) {
+            return szx;
+        }
+    }
+    return -1;
+}
+
+#ifdef MODULE_GCOAP_PROXY
+/*
+ * Forward proxy: answers a GET with Proxy-Uri option from the cache, or
+ * forwards it to the origin server. Requests for a response already being
+ * fetched wait for that response. Only runs in the gcoap thread.
+ *
+ * Returns the size of the response in buf, or 0 if the response follows
+ * later.
+ */
+static ssize_t _proxy_handle(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             uint8_t *opt_end, const uint8_t *uri,
+                             size_t uri_len, ipv6_addr_t *src, uint16_t port)
+{
+    uint8_t req[GCOAP_PDU_BUF_SIZE];
+    /* header of the upstream request has a fixed size */
+    uint8_t *key = &req[sizeof(coap_hdr_t) + GCOAP_TOKENLEN];
+    char uri_str[GCOAP_PROXY_URI_MAXLEN + 1];
+    ipv6_addr_t addr;
+    uint16_t origin_port;
+    const char *path;
+
+    if (coap_get_code_detail(pdu) != COAP_METHOD_GET) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_PROXYING_NOT_SUPPORTED);
+    }
+    if ((uri_len > GCOAP_PROXY_URI_MAXLEN) ||
+        (coap_get_token_len(pdu) > GCOAP_TOKENLEN_MAX)) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+    memcpy(uri_str, uri, uri_len);
+    uri_str[uri_len] = '\0';
+
+    int res = _proxy_parse_uri(uri_str, uri_len, &addr, &origin_port, &path);
+    if (res == -ENOTSUP) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_PROXYING_NOT_SUPPORTED);
+    }
+    else if (res < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+
+    ssize_t key_len = _proxy_build_opts(key, &req[sizeof(req)] - key, path,
+                                        &uri_str[uri_len] - path,
+                                        buf + coap_get_total_hdr_len(pdu),
+                                        opt_end);
+    if (key_len < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+
+    uint32_t hash = _hash(2166136261U, &addr, sizeof(addr));
+    hash = _hash(hash, &origin_port, sizeof(origin_port));
+    hash = _hash(hash, key, key_len);
+
+    gcoap_proxy_entry_t *entry = _proxy_find(hash, &addr, origin_port, key,
+                                             key_len);
+    if (entry && !entry->waiters && (entry->expires > xtimer_now_usec64())) {
+        DEBUG("gcoap: proxy cache hit\n");
+        mutex_lock(&_coap_state.lock);
+        _coap_state.proxy_stats.hits++;
+        mutex_unlock(&_coap_state.lock);
+        entry->last_used = xtimer_now_usec();
+        ssize_t pdu_len = _proxy_serve(entry, pdu, buf, len);
+        return (pdu_len > 0)
+                ? pdu_len
+                : gcoap_response(pdu, buf, len, COAP_CODE_INTERNAL_SERVER_ERROR);
+    }
+
+    uint8_t type = coap_get_type(pdu);
+    if (entry && entry->waiters) {
+        /* coalesce with the upstream request on its way */
+        if (!_proxy_add_waiter(entry, pdu, src, port)) {
+            return gcoap_response(pdu, buf, len, COAP_CODE_SERVICE_UNAVAILABLE);
+        }
+        mutex_lock(&_coap_state.lock);
+        _coap_state.proxy_stats.coalesced++;
+        mutex_unlock(&_coap_state.lock);
+    }
+    else {
+        /* stale, or not cached */
+        if (entry) {
+            _proxy_release(entry);
+        }
+        if (!_proxy_evict(key_len) || !(entry = _proxy_take_entry())) {
+            return gcoap_response(pdu, buf, len, COAP_CODE_SERVICE_UNAVAILABLE);
+        }
+        entry->data = gnrc_pktbuf_add(NULL, key, key_len, GNRC_NETTYPE_UNDEF);
+        if (!entry->data) {
+            return gcoap_response(pdu, buf, len, COAP_CODE_SERVICE_UNAVAILABLE);
+        }
+        _coap_state.proxy_cache_used += key_len;
+        entry->addr      = addr;
+        entry->port      = origin_port;
+        entry->hash      = hash;
+        entry->key_len   = key_len;
+        entry->last_used = xtimer_now_usec();
+        if (!_proxy_add_waiter(entry, pdu, src, port)) {
+            _proxy_release(entry);
+            return gcoap_response(pdu, buf, len, COAP_CODE_SERVICE_UNAVAILABLE);
+        }
+
+        /* header goes in front of the options already in place */
+        coap_pkt_t req_pdu;
+        gcoap_req_init(&req_pdu, req, sizeof(req), COAP_METHOD_GET, "");
+        gcoap_hdr_set_type(req_pdu.hdr, (type == COAP_TYPE_CON)
+                                        ? COAP_TYPE_CON : COAP_TYPE_NON);
+        memcpy(entry->token, req_pdu.hdr->data, GCOAP_TOKENLEN);
+
+        DEBUG("gcoap: proxy cache miss, forwarding\n");
+        mutex_lock(&_coap_state.lock);
+        _coap_state.proxy_stats.misses++;
+        mutex_unlock(&_coap_state.lock);
+        if (!gcoap_req_send(req, key + key_len - req, &addr, origin_port,
+                            _proxy_resp_handler)) {
+            _proxy_release(entry);
+            return gcoap_response(pdu, buf, len, COAP_CODE_BAD_GATEWAY);
+        }
+    }
+
+    /* response follows separately; acknowledge a confirmable request now */
+    if (type == COAP_TYPE_CON) {
+        coap_hdr_t *ack = (coap_hdr_t *)buf;
+        ack->ver_t_tkl = ack->ver_t_tkl & 0xf0;
+        ack->code      = 0;
+        gcoap_hdr_set_type(ack, COAP_TYPE_ACK);
+        return sizeof(coap_hdr_t);
+    }
+    return 0;
+}
+
+/*
+ * Parses a Proxy-Uri of the form coap://[address]:port/path?query, where port
+ * is optional. Sets path to the start of the path, which extends to the end
+ * of uri.
+ *
+ * Returns 0 on success, -ENOTSUP for another scheme, or -EINVAL if malformed.
+ */
+static int _proxy_parse_uri(const char *uri, size_t len, ipv6_addr_t *addr,
+                            uint16_t *port, const char **path)
+{
+    static const char scheme[] = "coap://";
+    char addr_str[IPV6_ADDR_MAX_STR_LEN];
+
+    if (strncmp(uri, scheme, sizeof(scheme) - 1) != 0) {
+        return (strstr(uri, "://")) ? -ENOTSUP : -EINVAL;
+    }
+    const char *host = uri + sizeof(scheme) - 1;
+    const char *host_end = memchr(host, ']', len - (host - uri));
+    if ((*host != '[') || !host_end ||
+        ((size_t)(host_end - host - 1) >= sizeof(addr_str))) {
+        return -EINVAL;
+    }
+    memcpy(addr_str, host + 1, host_end - host - 1);
+    addr_str[host_end - host - 1] = '\0';
+    if (!ipv6_addr_from_str(addr, addr_str)) {
+        return -EINVAL;
+    }
+
+    const char *pos = host_end + 1;
+    *port = GCOAP_PORT;
+    if (*pos == ':') {
+        uint32_t value = 0;
+        while ((*++pos >= '0') && (*pos <= '9') && (value <= UINT16_MAX)) {
+            value = value * 10 + (*pos - '0');
+        }
+        if ((value == 0) || (value > UINT16_MAX)) {
+            return -EINVAL;
+        }
+        *port = value;
+    }
+    if ((*pos != '\0') && (*pos != '/') && (*pos != '?')) {
+        return -EINVAL;
+    }
+    *path = pos;
+    return 0;
+}
+
+/*
+ * Writes option num with the value val to pos, where last is the number of
+ * the previous option, and updates last. Returns the position after the
+ * option, or NULL if it does not fit before end.
+ */
+static uint8_t *_proxy_opt_put(uint8_t *pos, const uint8_t *end,
+                               unsigned *last, unsigned num,
+                               const uint8_t *val, size_t len)
+{
+    /* longest option header */
+    if (!pos || (pos + 5 + len > end)) {
+        return NULL;
+    }
+    pos += _opt_hdr_put(pos, num - *last, len);
+    memcpy(pos, val, len);
+    *last = num;
+    return pos + len;
+}
+
+/*
+ * Writes an option num for each segment of str, separated by sep. Skips empty
+ * segments.
+ */
+static uint8_t *_proxy_put_segments(uint8_t *pos, const uint8_t *end,
+                                    unsigned *last, unsigned num,
+                                    const char *str, const char *str_end,
+                                    char sep)
+{
+    while (str < str_end) {
+        const char *seg_end = memchr(str, sep, str_end - str);
+        if (!seg_end) {
+            seg_end = str_end;
+        }
+        if (seg_end > str) {
+            pos = _proxy_opt_put(pos, end, last, num, (const uint8_t *)str,
+                                 seg_end - str);
+        }
+        str = seg_end + 1;
+    }
+    return pos;
+}
 
-                LL_SEARCH_SCALAR(udp_snip, ipv6_snip, type, GNRC_NETTYPE_IPV6);
-                assert(ipv6_snip != NULL);
-                src_addr = &((ipv6_hdr_t *)ipv6_snip->data)->src;
+/*
+ * Writes the options of the upstream request to out: Uri-Path and Uri-Query
+ * from path, merged with the options of the client request from opt to
+ * opt_end, except the ones addressing the proxy. These options also are the
+ * cache key, together with the origin server.
+ *
+ * Returns the length of the options, or < 0 on error.
+ */
+static ssize_t _proxy_build_opts(uint8_t *out, size_t len, const char *path,
+                                 size_t path_len, uint8_t *opt, uint8_t *opt_end)
+{
+    const char *path_end = path + path_len;
+    const char *query = memchr(path, '?', path_len);
+    uint8_t *pos = out, *end = out + len;
+    unsigned last = 0, num = 0, delta, optlen;
+    bool path_done = false, query_done = false;
+    size_t hdr_len;
+
+    if (!query) {
+        query = path_end;
+    }
 
-                _receive(pkt, src_addr, port);
-                break;
+    while (true) {
+        hdr_len = _opt_hdr_get(opt, opt_end, &delta, &optlen);
+        if (hdr_len) {
+            num += delta;
+            if (opt + hdr_len + optlen > opt_end) {
+                return -EBADMSG;
+            }
+        }
+        /* Uri-Path and Uri-Query in place; at the end at the latest */
+        if (!path_done && (!hdr_len || (num > COAP_OPT_URI_PATH))) {
+            pos = _proxy_put_segments(pos, end, &last, COAP_OPT_URI_PATH,
+                                      path, query, '/');
+            path_done = true;
+        }
+        if (!query_done && (!hdr_len || (num > COAP_OPT_URI_QUERY))) {
+            pos = _proxy_put_segments(pos, end, &last, COAP_OPT_URI_QUERY,
+                                      query + 1, path_end, '&');
+            query_done = true;
+        }
+        if (!hdr_len) {
+            break;
+        }
 
-            case GCOAP_NETAPI_MSG_TYPE_TIMEOUT:
-                _expire_request((gcoap_request_memo_t *)msg_rcvd.content.ptr);
+        switch (num) {
+            case COAP_OPT_URI_HOST:
+            case COAP_OPT_OBSERVE:
+            case COAP_OPT_URI_PORT:
+            case COAP_OPT_URI_PATH:
+            case COAP_OPT_URI_QUERY:
+            case COAP_OPT_PROXY_URI:
+            case COAP_OPT_PROXY_SCHEME:
                 break;
-
             default:
+                pos = _proxy_opt_put(pos, end, &last, num, opt + hdr_len,
+                                     optlen);
                 break;
         }
+        opt += hdr_len + optlen;
     }
-    return 0;
+    return (pos) ? pos - out : -ENOBUFS;
 }
 
-/* Handles incoming network IPC message. */
-static void _receive(gnrc_pktsnip_t *pkt, ipv6_addr_t *src, uint16_t port)
+/* Finds the cache entry for a request to an origin server. */
+static gcoap_proxy_entry_t *_proxy_find(uint32_t hash, ipv6_addr_t *addr,
+                                        uint16_t port, const uint8_t *key,
+                                        size_t key_len)
 {
-    coap_pkt_t pdu;
-    uint8_t buf[GCOAP_PDU_BUF_SIZE];
-    size_t pdu_len = 0;
-    gcoap_request_memo_t *memo = NULL;
-
-    /* If too big, handle below based on request vs. response */
-    size_t pkt_size = (pkt->size > sizeof(buf))
-                            ? sizeof(buf) : pkt->size;
-
-    /* Copy request into temporary buffer, and parse it as CoAP. */
-    memcpy(buf, pkt->data, pkt_size);
-
-    int result = coap_parse(&pdu, buf, pkt_size);
-    if (result < 0) {
-        DEBUG("gcoap: parse failure: %d\n", result);
-        /* If a response, can't clear memo, but it will timeout later. */
-        goto exit;
-    }
-
-    /* incoming request */
-    if (coap_get_code_class(&pdu) == COAP_CLASS_REQ) {
-        if (pkt->size > sizeof(buf)) {
-            DEBUG("gcoap: request too big: %u\n", pkt->size);
-            pdu_len = gcoap_response(&pdu, buf, sizeof(buf),
-                                           COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
-        } else {
-            pdu_len = _handle_req(&pdu, buf, sizeof(buf));
-        }
-        if (pdu_len > 0) {
-            _send_buf(buf, pdu_len, src, port);
+    for (int i = 0; i < GCOAP_PROXY_ENTRIES_MAX; i++) {
+        gcoap_proxy_entry_t *entry = &_coap_state.proxy_cache[i];
+        if (entry->data && (entry->hash == hash) && (entry->port == port) &&
+            (entry->key_len == key_len) && ipv6_addr_equal(&entry->addr, addr) &&
+            (memcmp(entry->data->data, key, key_len) == 0)) {
+            return entry;
         }
     }
-    /* incoming response */
-    else {
-        _find_req_memo(&memo, &pdu, buf, sizeof(buf));
-        if (memo) {
-            xtimer_remove(&memo->response_timer);
-            if (pkt->size > sizeof(buf)) {
-                memo->state = GCOAP_MEMO_ERR;
-                DEBUG("gcoap: response too big: %u\n", pkt->size);
+    return NULL;
+}
+
+/*
+ * Evicts the least recently used cached responses until size more bytes fit
+ * into GCOAP_PROXY_CACHE_SIZE. Entries waiting for a response stay. Returns
+ * false if not enough space can be made.
+ */
+static bool _proxy_evict(size_t size)
+{
+    uint32_t now = xtimer_now_usec();
+
+    while (_coap_state.proxy_cache_used + size > GCOAP_PROXY_CACHE_SIZE) {
+        gcoap_proxy_entry_t *lru = NULL;
+        for (int i = 0; i < GCOAP_PROXY_ENTRIES_MAX; i++) {
+            gcoap_proxy_entry_t *entry = &_coap_state.proxy_cache[i];
+            if (entry->data && !entry->waiters &&
+                (!lru || ((now - entry->last_used) > (now - lru->last_used)))) {
+                lru = entry;
             }
-            memo->resp_handler(memo->state, &pdu);
-            memo->state = GCOAP_MEMO_UNUSED;
         }
+        if (!lru) {
+            return false;
+        }
+        _proxy_release(lru);
     }
-
-exit:
-    gnrc_pktbuf_release(pkt);
+    return true;
 }
 
 /*
- * Main request handler: generates response PDU in the provided buffer.
- *
- * Caller must finish the PDU and send it.
+ * Provides an unused cache entry, evicting the least recently used cached
+ * response if necessary. Returns NULL if all entries wait for a response.
  */
-static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+static gcoap_proxy_entry_t *_proxy_take_entry(void)
 {
-    unsigned method_flag = coap_method2flag(coap_get_code_detail(pdu));
+    uint32_t now = xtimer_now_usec();
+    gcoap_proxy_entry_t *lru = NULL;
 
-    /* Find path for CoAP msg among listener resources and execute callback. */
-    gcoap_listener_t *listener = _coap_state.listeners;
-    while (listener) {
-        coap_resource_t *resource = listener->resources;
-        for (size_t i = 0; i < listener->resources_len; i++) {
-            if (i) {
-                resource++;
-            }
-            if (! (resource->methods & method_flag)) {
-                continue;
-            }
+    for (int i = 0; i < GCOAP_PROXY_ENTRIES_MAX; i++) {
+        gcoap_proxy_entry_t *entry = &_coap_state.proxy_cache[i];
+        if (!entry->data) {
+            return entry;
+        }
+        if (!entry->waiters &&
+            (!lru || ((now - entry->last_used) > (now - lru->last_used)))) {
+            lru = entry;
+        }
+    }
+    if (lru) {
+        _proxy_release(lru);
+    }
+    return lru;
+}
 
-            int res = strcmp((char *)&pdu->url[0], resource->path);
-            if (res > 0) {
-                continue;
-            }
-            else if (res < 0) {
-                /* resources expected in alphabetical order */
-                break;
-            }
-            else {
-                ssize_t pdu_len = resource->handler(pdu, buf, len);
-                if (pdu_len < 0) {
-                    pdu_len = gcoap_response(pdu, buf, len,
-                                             COAP_CODE_INTERNAL_SERVER_ERROR);
-                }
-                return pdu_len;
-            }
+/* Frees a cache entry, and the clients waiting for it. */
+static void _proxy_release(gcoap_proxy_entry_t *entry)
+{
+    gcoap_proxy_waiter_t *waiter, *tmp;
+
+    LL_FOREACH_SAFE(entry->waiters, waiter, tmp) {
+        waiter->port = 0;
+    }
+    if (entry->data) {
+        _coap_state.proxy_cache_used -= entry->data->size;
+        gnrc_pktbuf_release(entry->data);
+    }
+    memset(entry, 0, sizeof(*entry));
+}
+
+/* Adds the client of a request to the clients waiting for a response. */
+static bool _proxy_add_waiter(gcoap_proxy_entry_t *entry, coap_pkt_t *pdu,
+                              ipv6_addr_t *src, uint16_t port)
+{
+    for (int i = 0; i < GCOAP_PROXY_WAITERS_MAX; i++) {
+        gcoap_proxy_waiter_t *waiter = &_coap_state.proxy_waiters[i];
+        if (waiter->port == 0) {
+            waiter->addr      = *src;
+            waiter->port      = port;
+            waiter->token_len = coap_get_token_len(pdu);
+            memcpy(waiter->token, pdu->token, waiter->token_len);
+            LL_PREPEND(entry->waiters, waiter);
+            return true;
         }
-        listener = listener->next;
     }
-    /* resource not found */
-    return gcoap_response(pdu, buf, len, COAP_CODE_PATH_NOT_FOUND);
+    DEBUG("gcoap: proxy has no space for waiting client\n");
+    return false;
 }
 
 /*
- * Finishes handling a PDU -- write options and reposition payload.
- *
- * Returns the size of the PDU within the buffer, or < 0 on error.
+ * Writes a response from the cache, with the Max-Age option set to the
+ * remaining freshness. Returns the size of the response in buf, or < 0 if it
+ * does not fit.
  */
-static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+static ssize_t _proxy_serve(gcoap_proxy_entry_t *entry, coap_pkt_t *pdu,
+                            uint8_t *buf, size_t len)
 {
-    ssize_t hdr_len = _write_options(pdu, buf, len);
-    DEBUG("gcoap: header length: %u\n", hdr_len);
+    uint8_t *opt = (uint8_t *)entry->data->data + entry->key_len;
+    uint8_t *opt_end = (uint8_t *)entry->data->data + entry->data->size;
+    uint32_t max_age = (entry->expires - xtimer_now_usec64()) / SEC_IN_USEC;
+    uint8_t age[4] = { max_age >> 24, max_age >> 16, max_age >> 8, max_age };
+    unsigned age_len = 0, last = 0, num = 0, delta, optlen;
+    bool aged = false;
+    size_t hdr_len;
+
+    for (uint32_t tmp = max_age; tmp; tmp >>= 8) {
+        age_len++;
+    }
 
-    if (hdr_len > 0) {
-        /* move payload over unused space after options */
-        if (pdu->payload_len) {
-            memmove(buf + hdr_len, pdu->payload, pdu->payload_len);
-        }
+    gcoap_resp_init(pdu, buf, len, entry->code);
+    uint8_t *pos = buf + coap_get_total_hdr_len(pdu), *end = buf + len;
 
-        return hdr_len + pdu->payload_len;
+    /* copy the options, replacing Max-Age */
+    while ((hdr_len = _opt_hdr_get(opt, opt_end, &delta, &optlen))) {
+        num += delta;
+        if (!aged && (num >= COAP_OPT_MAX_AGE)) {
+            pos = _proxy_opt_put(pos, end, &last, COAP_OPT_MAX_AGE,
+                                 &age[4 - age_len], age_len);
+            aged = true;
+        }
+        if (num != COAP_OPT_MAX_AGE) {
+            pos = _proxy_opt_put(pos, end, &last, num, opt + hdr_len, optlen);
+        }
+        opt += hdr_len + optlen;
     }
-    else {
-        return -1;      /* generic failure code */
+    if (!aged) {
+        pos = _proxy_opt_put(pos, end, &last, COAP_OPT_MAX_AGE,
+                             &age[4 - age_len], age_len);
+    }
+
+    /* payload marker and payload */
+    if (!pos || (pos + (opt_end - opt) > end)) {
+        return -ENOBUFS;
     }
+    memcpy(pos, opt, opt_end - opt);
+    return pos + (opt_end - opt) - buf;
 }
 
 /*
- * Finds the memo for an outstanding request within the _coap_state.open_reqs
- * array. Matches on token.
- *
- * src_pdu Source for the match token
+ * Handles the response of an origin server: forwards it to the waiting
+ * clients, and caches a 2.05 (Content) response for its Max-Age.
  */
-static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *src_pdu,
-                                                            uint8_t *buf, size_t len)
+static void _proxy_resp_handler(unsigned req_state, coap_pkt_t* pdu)
 {
-    gcoap_request_memo_t *memo;
-    coap_pkt_t memo_pdu = { .token = NULL };
-    (void) buf;
-    (void) len;
+    gcoap_proxy_entry_t *entry = NULL;
+    /* pdu only has a header on timeout */
+    uint8_t *token = pdu->hdr->data;
+
+    for (int i = 0; i < GCOAP_PROXY_ENTRIES_MAX; i++) {
+        gcoap_proxy_entry_t *el = &_coap_state.proxy_cache[i];
+        if (el->waiters && (coap_get_token_len(pdu) == GCOAP_TOKENLEN) &&
+            (memcmp(el->token, token, GCOAP_TOKENLEN) == 0)) {
+            entry = el;
+            break;
+        }
+    }
+    if (!entry) {
+        return;
+    }
+    if (req_state != GCOAP_MEMO_RESP) {
+        _proxy_reply(entry, NULL, (req_state == GCOAP_MEMO_TIMEOUT)
+                                  ? COAP_CODE_GATEWAY_TIMEOUT
+                                  : COAP_CODE_BAD_GATEWAY);
+        _proxy_release(entry);
+        return;
+    }
 
-    for (int i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
-        if (_coap_state.open_reqs[i].state == GCOAP_MEMO_UNUSED)
-            continue;
+    assert(_coap_state.rcv_end != NULL);
+    uint8_t *opt = (uint8_t *)pdu->hdr + coap_get_total_hdr_len(pdu);
+    size_t body_len = _coap_state.rcv_end - opt;
+    size_t age_len;
+    uint8_t *age = _opt_find(opt, _coap_state.rcv_end, COAP_OPT_MAX_AGE,
+                             &age_len);
+    uint32_t max_age = (age) ? _opt_uint(age, age_len)
+                             : GCOAP_PROXY_MAX_AGE_DEFAULT;
+    size_t key_len = entry->key_len;
+
+    /* make space while the waiting clients protect entry from eviction */
+    bool cache = (pdu->hdr->code == COAP_CODE_CONTENT) && (max_age > 0) &&
+                 _proxy_evict(body_len);
+
+    gnrc_pktsnip_t *body = gnrc_pktbuf_add(NULL, opt, body_len,
+                                           GNRC_NETTYPE_UNDEF);
+    _proxy_reply(entry, body, pdu->hdr->code);
+    if (body) {
+        gnrc_pktbuf_release(body);
+    }
 
-        /* setup memo PDU from memo header */
-        memo                 = &_coap_state.open_reqs[i];
-        coap_hdr_t *memo_hdr = (coap_hdr_t *) &memo->hdr_buf[0];
-        memo_pdu.hdr         = memo_hdr;
-        if (coap_get_token_len(&memo_pdu)) {
-            memo_pdu.token = &memo_hdr->data[0];
-        }
-        /* match on token */
-        if (coap_get_token_len(src_pdu) == coap_get_token_len(&memo_pdu)) {
-            uint8_t *src_byte  = src_pdu->token;
-            uint8_t *memo_byte = memo_pdu.token;
-            size_t j;
-            for (j = 0; j < coap_get_token_len(src_pdu); j++) {
-                if (*src_byte++ != *memo_byte++) {
-                    break;      /* token mismatch */
-                }
-            }
-            if (j == coap_get_token_len(src_pdu)) {
-                *memo_ptr = memo;
-            }
-        }
+    /* keep the request options as key, followed by the response */
+    if (!cache || gnrc_pktbuf_realloc_data(entry->data, key_len + body_len)) {
+        _proxy_release(entry);
+        return;
     }
+    memcpy((uint8_t *)entry->data->data + key_len, opt, body_len);
+    _coap_state.proxy_cache_used += body_len;
+    entry->code    = pdu->hdr->code;
+    entry->expires = xtimer_now_usec64() + (uint64_t)max_age * SEC_IN_USEC;
+    entry->last_used = xtimer_now_usec();
 }
 
-/* Calls handler callback on receipt of a timeout message. */
-static void _expire_request(gcoap_request_memo_t *memo)
+/*
+ * Sends a response with the options and payload in body to the clients
+ * waiting for entry, or an empty response with code if body is NULL.
+ */
+static void _proxy_reply(gcoap_proxy_entry_t *entry, gnrc_pktsnip_t *body,
+                         uint8_t code)
 {
-    coap_pkt_t req;
-
-    DEBUG("coap: received timeout message\n");
-    if (memo->state == GCOAP_MEMO_WAIT) {
-        memo->state = GCOAP_MEMO_TIMEOUT;
-        /* Pass response to handler */
-        if (memo->resp_handler) {
-            req.hdr = (coap_hdr_t *)&memo->hdr_buf[0];   /* for reference */
-            memo->resp_handler(memo->state, &req);
+    gcoap_proxy_waiter_t *waiter, *tmp;
+    uint16_t id;
+
+    LL_FOREACH_SAFE(entry->waiters, waiter, tmp) {
+        mutex_lock(&_coap_state.lock);
+        id = _next_id();
+        mutex_unlock(&_coap_state.lock);
+        if (body) {
+            _send_body(body, &waiter->addr, waiter->port, waiter->token,
+                       waiter->token_len, code, id);
         }
-        memo->state = GCOAP_MEMO_UNUSED;
-    }
-    else {
-        /* Response already handled; timeout must have fired while response */
-        /* was in queue. */
+        else {
+            uint8_t resp[GCOAP_HEADER_MAXLEN];
+            ssize_t resp_len = coap_build_hdr((coap_hdr_t *)resp, COAP_TYPE_NON,
+                                              waiter->token, waiter->token_len,
+                                              code, id);
+            _send_buf(resp, resp_len, &waiter->addr, waiter->port);
+        }
+        waiter->port = 0;
     }
+    entry->waiters = NULL;
 }
+#endif /* MODULE_GCOAP_PROXY */
 
 /* Registers receive/send port with GNRC registry. */
 static int _register_port(gnrc_netreg_entry_t *netreg_port, uint16_t port)
@@ -411,7 +2049,8 @@ static ssize_t _well_known_core_handler(coap_pkt_t* pdu, uint8_t *buf, size_t le
  *
  * Returns length of header + options, or -EINVAL on illegal path.
  */
-static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned block_opt, uint32_t block_val)
 {
     uint8_t last_optnum = 0;
     (void)len;
@@ -433,8 +2072,12 @@ static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len)
     /* Content-Format */
     if (pdu->content_type != COAP_FORMAT_NONE) {
         bufpos += coap_put_option_ct(bufpos, last_optnum, pdu->content_type);
-        /* uncomment when add an option after Content-Format */
-        /* last_optnum = COAP_OPT_CONTENT_FORMAT; */
+        last_optnum = COAP_OPT_CONTENT_FORMAT;
+    }
+
+    /* Block1 or Block2 */
+    if (block_opt) {
+        bufpos += _opt_uint_put(bufpos, block_opt - last_optnum, block_val);
     }
 
     /* write payload marker */
@@ -453,6 +2096,8 @@ kernel_pid_t gcoap_init(void)
     if (_pid != KERNEL_PID_UNDEF) {
         return -EEXIST;
     }
+    _index_listener(&_default_listener);
+
     _pid = thread_create(_msg_stack, sizeof(_msg_stack), THREAD_PRIORITY_MAIN - 1,
                             THREAD_CREATE_STACKTEST, _event_loop, NULL, "coap");
 
@@ -460,12 +2105,29 @@ kernel_pid_t gcoap_init(void)
     if (_register_port(&_coap_state.netreg_port, GCOAP_PORT) < 0) {
         return -EINVAL;
     }
-    /* Blank list of open requests so we know if an entry is available. */
+    _init_reqs();
+
+    return _pid;
+}
+
+/* Puts all memos for open requests into the free list. */
+static void _init_reqs(void)
+{
     memset(&_coap_state.open_reqs[0], 0, sizeof(_coap_state.open_reqs));
+    for (int i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
+        _coap_state.open_reqs[i].next = _coap_state.req_free;
+        _coap_state.req_free = &_coap_state.open_reqs[i];
+    }
     /* randomize initial value */
     _coap_state.last_message_id = random_uint32() & 0xFFFF;
+}
 
-    return _pid;
+/*
+ * Returns the message ID for a new message. Caller must hold _coap_state.lock.
+ */
+static uint16_t _next_id(void)
+{
+    return ++_coap_state.last_message_id;
 }
 
 void gcoap_register_listener(gcoap_listener_t *listener)
@@ -477,6 +2139,8 @@ void gcoap_register_listener(gcoap_listener_t *listener)
 
     listener->next = NULL;
     _last->next = listener;
+
+    _index_listener(listener);
 }
 
 int gcoap_req_init(coap_pkt_t *pdu, uint8_t *buf, size_t len, unsigned code,
@@ -495,9 +2159,11 @@ int gcoap_req_init(coap_pkt_t *pdu, uint8_t *buf, size_t len, unsigned code,
                &rand,
                (GCOAP_TOKENLEN - i >= 4) ? 4 : GCOAP_TOKENLEN - i);
     }
+    mutex_lock(&_coap_state.lock);
+    uint16_t id = _next_id();
+    mutex_unlock(&_coap_state.lock);
     hdrlen = coap_build_hdr(pdu->hdr, COAP_TYPE_NON, &token[0], GCOAP_TOKENLEN,
-                                                     code,
-                                                   ++_coap_state.last_message_id);
+                            code, id);
 
     if (hdrlen > 0) {
         /* Reserve some space between the header and payload to write options later */
@@ -524,48 +2190,81 @@ ssize_t gcoap_finish(coap_pkt_t *pdu, size_t payload_len, unsigned format)
 
     pdu->content_type = format;
     pdu->payload_len  = payload_len;
-    return _finish_pdu(pdu, (uint8_t *)pdu->hdr, len);
+    return _finish_pdu(pdu, (uint8_t *)pdu->hdr, len, 0, 0);
 }
 
 size_t gcoap_req_send(uint8_t *buf, size_t len, ipv6_addr_t *addr, uint16_t port,
                                                  gcoap_resp_handler_t resp_handler)
 {
-    gcoap_request_memo_t *memo = NULL;
+    gcoap_request_memo_t *memo;
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)buf };
+    gnrc_pktsnip_t *msg = NULL;
     assert(resp_handler != NULL);
 
-    /* Find empty slot in list of open requests. */
-    for (int i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
-        if (_coap_state.open_reqs[i].state == GCOAP_MEMO_UNUSED) {
-            memo = &_coap_state.open_reqs[i];
-            memo->state = GCOAP_MEMO_WAIT;
-            break;
+    /* keep a confirmable request for retransmission */
+    if (coap_get_type(&pdu) == COAP_TYPE_CON) {
+        msg = gnrc_pktbuf_add(NULL, buf, len, GNRC_NETTYPE_UNDEF);
+        if (!msg) {
+            DEBUG("gcoap: dropping request; no space for retransmission\n");
+            return 0;
         }
     }
+
+    /* Take memo from free list, and track it before sending, so even a fast
+     * response finds it. */
+    mutex_lock(&_coap_state.lock);
+    memo = _coap_state.req_free;
     if (memo) {
+        _coap_state.req_free = memo->next;
+        memo->state = GCOAP_MEMO_WAIT;
         memcpy(&memo->hdr_buf[0], buf, GCOAP_HEADER_MAXLEN);
         memo->resp_handler = resp_handler;
+        memo->msg          = msg;
+        memo->addr         = *addr;
+        memo->port         = port;
+        memo->retransmits  = 0;
+        memo->sent         = xtimer_now_usec();
+        if (msg) {
+            memo->timeout = _initial_rto(addr);
+            _coap_state.con_stats.con_sent++;
+        }
+        else {
+            memo->timeout = GCOAP_NON_TIMEOUT;
+        }
+        _open_req(memo, memo->timeout);
+    }
+    mutex_unlock(&_coap_state.lock);
 
+    if (memo) {
         size_t res = _send_buf(buf, len, addr, port);
-        if (res && (GCOAP_NON_TIMEOUT > 0)) {
-            /* start response wait timer */
-            memo->timeout_msg.type        = GCOAP_NETAPI_MSG_TYPE_TIMEOUT;
-            memo->timeout_msg.content.ptr = (char *)memo;
-            xtimer_set_msg(&memo->response_timer, GCOAP_NON_TIMEOUT,
-                                                  &memo->timeout_msg, _pid);
-        }
-        else if (!res) {
-            memo->state = GCOAP_MEMO_UNUSED;
+        if (!res) {
+            mutex_lock(&_coap_state.lock);
+            /* unless already expired or answered, and maybe reused for
+             * another request meanwhile; message ID and token tell */
+            if ((memo->state == GCOAP_MEMO_WAIT) &&
+                (memcmp(&memo->hdr_buf[0], buf, GCOAP_HEADER_MAXLEN) == 0)) {
+                _close_req(memo);
+                _release_req(memo);
+            }
+            mutex_unlock(&_coap_state.lock);
         }
         return res;
     } else {
         DEBUG("gcoap: dropping request; no space for response tracking\n");
+        if (msg) {
+            gnrc_pktbuf_release(msg);
+        }
         return 0;
     }
 }
 
 int gcoap_resp_init(coap_pkt_t *pdu, uint8_t *buf, size_t len, unsigned code)
 {
-    /* Assume NON type request, so response type is the same. */
+    /* Piggyback response on the ACK for a confirmable request; otherwise
+     * response type is the same as the NON request. */
+    if (coap_get_type(pdu) == COAP_TYPE_CON) {
+        gcoap_hdr_set_type(pdu->hdr, COAP_TYPE_ACK);
+    }
     coap_hdr_set_code(pdu->hdr, code);
     /* Create message ID since NON? */
 
@@ -579,15 +2278,257 @@ int gcoap_resp_init(coap_pkt_t *pdu, uint8_t *buf, size_t len, unsigned code)
     return 0;
 }
 
+ssize_t gcoap_block2_respond(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             unsigned format, gcoap_block_read_t read, void *arg)
+{
+    uint32_t blknum = 0;
+    bool more;
+    unsigned szx = GCOAP_BLOCK_SZX_MAX;
+
+    if (_block_get(pdu, COAP_OPT_BLOCK2, &blknum, &more, &szx) < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+    size_t offset = blknum << (szx + 4);
+
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    int max_szx = _block_szx(pdu);
+    if (max_szx < 0) {
+        return -ENOBUFS;
+    }
+    /* a smaller block at the same offset */
+    if ((unsigned)max_szx < szx) {
+        szx    = max_szx;
+        blknum = offset >> (szx + 4);
+    }
+
+    size_t size = 16U << szx;
+    ssize_t res = read(pdu->payload, offset, size, arg);
+    if (res < 0) {
+        return res;
+    }
+    assert((size_t)res <= size);
+    more = false;
+    if ((size_t)res == size) {
+        /* a full block may be the last one; probe for data past it */
+        uint8_t probe;
+        ssize_t next = read(&probe, offset + size, 1, arg);
+        if (next < 0) {
+            return next;
+        }
+        more = (next > 0);
+    }
+
+    pdu->content_type = format;
+    pdu->payload_len  = res;
+    return _finish_pdu(pdu, buf, len, COAP_OPT_BLOCK2,
+                       (blknum << 4) | (more << 3) | szx);
+}
+
+ssize_t gcoap_block1_receive(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                             unsigned code, gcoap_block_write_t write, void *arg)
+{
+    uint32_t blknum = 0;
+    bool more = false;
+    unsigned szx = 0;
+
+    int found = _block_get(pdu, COAP_OPT_BLOCK1, &blknum, &more, &szx);
+    /* all but the last block are full */
+    if ((found < 0) || (more && (pdu->payload_len != (16U << szx)))) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+
+    int res = write(pdu->payload, blknum << (szx + 4), pdu->payload_len, more,
+                    arg);
+    if (res < 0) {
+        return res;
+    }
+
+    gcoap_resp_init(pdu, buf, len, (more) ? COAP_CODE_CONTINUE : code);
+    if (found) {
+        /* ask for smaller blocks if necessary */
+        int max_szx = _block_szx(pdu);
+        if ((max_szx >= 0) && ((unsigned)max_szx < szx)) {
+            szx = max_szx;
+        }
+    }
+    pdu->payload_len = 0;
+    return _finish_pdu(pdu, buf, len, (found) ? COAP_OPT_BLOCK1 : 0,
+                       (blknum << 4) | (more << 3) | szx);
+}
+
 void gcoap_op_state(uint8_t *open_reqs)
 {
-    uint8_t count = 0;
+    unsigned count = _coap_state.open_reqs_numof;
+
+    *open_reqs = (count > UINT8_MAX) ? UINT8_MAX : count;
+}
+
+void gcoap_con_stats(gcoap_con_stats_t *stats)
+{
+    mutex_lock(&_coap_state.lock);
+    *stats = _coap_state.con_stats;
+    mutex_unlock(&_coap_state.lock);
+}
+
+#ifdef MODULE_GCOAP_PROXY
+void gcoap_proxy_stats(gcoap_proxy_stats_t *stats)
+{
+    mutex_lock(&_coap_state.lock);
+    *stats = _coap_state.proxy_stats;
+    mutex_unlock(&_coap_state.lock);
+}
+#endif
+
+uint32_t gcoap_peer_rto(const ipv6_addr_t *addr)
+{
+    mutex_lock(&_coap_state.lock);
+    gcoap_peer_t *peer = _find_peer(addr, false);
+    uint32_t rto = (peer) ? peer->rto : GCOAP_ACK_TIMEOUT;
+    mutex_unlock(&_coap_state.lock);
+
+    return rto;
+}
+
+int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                   const coap_resource_t *resource)
+{
+    bool observed = false;
+
+    mutex_lock(&_coap_state.lock);
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        if (_coap_state.observers[i].resource == resource) {
+            observed = true;
+            break;
+        }
+    }
+    mutex_unlock(&_coap_state.lock);
+    if (!observed) {
+        return GCOAP_OBS_INIT_UNUSED;
+    }
+
+    /* token and message ID are set per observer when sending */
+    pdu->hdr = (coap_hdr_t *)buf;
+    memset(pdu->url, 0, NANOCOAP_URL_MAX);
+    ssize_t hdrlen = coap_build_hdr(pdu->hdr, COAP_TYPE_NON, NULL, 0,
+                                    COAP_CODE_CONTENT, 0);
+    if (hdrlen <= 0) {
+        return GCOAP_OBS_INIT_ERR;
+    }
+
+    pdu->payload      = buf + hdrlen + GCOAP_RESP_OPTIONS_BUF;
+    pdu->payload_len  = len - (pdu->payload - buf);
+    pdu->content_type = COAP_FORMAT_NONE;
+    return GCOAP_OBS_INIT_OK;
+}
+
+int gcoap_obs_send(const uint8_t *buf, size_t len,
+                   const coap_resource_t *resource)
+{
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)buf };
+    const uint8_t *opt = buf + coap_get_total_hdr_len(&pdu);
+    uint8_t obs_opt[GCOAP_OBS_OPTION_MAXLEN];
+    size_t skip, obs_len;
+    int count = 0;
+    bool pending = false;
+
+    mutex_lock(&_coap_state.lock);
+    _coap_state.obs_seq = (_coap_state.obs_seq + 1) & 0xffffff;
+    obs_len = _put_observe(obs_opt, _coap_state.obs_seq, opt, buf + len, &skip);
+
+    /* serialize body once for all observers */
+    size_t rest_len = buf + len - (opt + skip);
+    gnrc_pktsnip_t *body = gnrc_pktbuf_add(NULL, NULL, obs_len + rest_len,
+                                           GNRC_NETTYPE_UNDEF);
+    if (!body) {
+        mutex_unlock(&_coap_state.lock);
+        return -ENOMEM;
+    }
+    memcpy(body->data, obs_opt, obs_len);
+    memcpy((uint8_t *)body->data + obs_len, opt + skip, rest_len);
+
+    uint32_t now = xtimer_now_usec();
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_observe_t *obs = &_coap_state.observers[i];
+        if (obs->resource != resource) {
+            continue;
+        }
+        count++;
+        if (!obs->pending && ((now - obs->last_sent) >= _obs_interval(obs))) {
+            _obs_notify(obs, body, pdu.hdr->code);
+            continue;
+        }
+        /* too soon; replace any older notification still waiting */
+        if (obs->pending) {
+            gnrc_pktbuf_release(obs->pending);
+        }
+        else {
+            pending = true;
+        }
+        gnrc_pktbuf_hold(body, 1);
+        obs->pending      = body;
+        obs->pending_code = pdu.hdr->code;
+    }
+    gnrc_pktbuf_release(body);
+    if (pending) {
+        _obs_set_timer();
+    }
+    mutex_unlock(&_coap_state.lock);
+
+    return count;
+}
+
+#ifdef TEST_SUITES
+void gcoap_reset(void)
+{
+    xtimer_remove(&_coap_state.timeout_timer);
+    xtimer_remove(&_coap_state.obs_timer);
     for (int i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
-        if (_coap_state.open_reqs[i].state != GCOAP_MEMO_UNUSED) {
-            count++;
+        if (_coap_state.open_reqs[i].msg) {
+            gnrc_pktbuf_release(_coap_state.open_reqs[i].msg);
+        }
+    }
+    for (int i = 0; i < GCOAP_DUP_CACHE_SIZE; i++) {
+        if (_coap_state.dups[i].resp) {
+            gnrc_pktbuf_release(_coap_state.dups[i].resp);
         }
     }
-    *open_reqs = count;
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        if (_coap_state.observers[i].pending) {
+            gnrc_pktbuf_release(_coap_state.observers[i].pending);
+        }
+    }
+#ifdef MODULE_GCOAP_PROXY
+    for (int i = 0; i < GCOAP_PROXY_ENTRIES_MAX; i++) {
+        _proxy_release(&_coap_state.proxy_cache[i]);
+    }
+#endif
+
+    memset(&_coap_state, 0, sizeof(_coap_state));
+    mutex_init(&_coap_state.lock);
+    _coap_state.listeners = &_default_listener;
+    _coap_state.req_iface = KERNEL_PID_UNDEF;
+    _default_listener.next = NULL;
+
+    memset(_resource_index, 0, sizeof(_resource_index));
+    _resource_index_full = false;
+    _index_listener(&_default_listener);
+    _init_reqs();
+}
+
+void gcoap_handle_msg(msg_t *msg)
+{
+    _handle_msg(msg);
+}
+
+gcoap_state_t *gcoap_get_state(void)
+{
+    return &_coap_state;
+}
+
+bool gcoap_resource_index_full(void)
+{
+    return _resource_index_full;
 }
+#endif
 
 /** @} */
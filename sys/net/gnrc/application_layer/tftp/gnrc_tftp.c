@@ -27,7 +27,7 @@
 #include "net/gnrc/ipv6.h"
 #include "random.h"
 
-#define ENABLE_DEBUG                (1)
+#define ENABLE_DEBUG                (0)
 #include "debug.h"
 
 #if ENABLE_DEBUG
@@ -111,6 +111,7 @@ typedef enum {
     TOPT_BLKSIZE,
     TOPT_TIMEOUT,
     TOPT_TSIZE,
+    TOPT_WINDOWSIZE,
 } tftp_options_t;
 
 /* ordered as @see tftp_options_t */
@@ -118,6 +119,7 @@ tftp_opt_t _tftp_options[] = {
     [TOPT_BLKSIZE] = MODE(blksize),
     [TOPT_TIMEOUT] = MODE(timeout),
     [TOPT_TSIZE]   = MODE(tsize),
+    [TOPT_WINDOWSIZE] = MODE(windowsize),
 };
 
 /**
@@ -157,8 +159,10 @@ typedef struct {
     gnrc_netreg_entry_t entry;
 
     /* transfer parameters */
-    uint16_t block_nr;
+    uint16_t block_nr;          /**< last block sent or received in order */
+    uint16_t block_acked;       /**< last block acknowledged */
     uint16_t block_size;
+    uint16_t window_size;       /**< blocks sent per ACK, RFC 7440 */
     size_t transfer_size;
     uint32_t block_timeout;
     uint32_t retries;
@@ -209,7 +213,8 @@ static int _tftp_init_ctxt(ipv6_addr_t *addr, const char *file_name,
 static void _tftp_set_default_options(tftp_context_t *ctxt);
 
 /* set the TFTP options to use */
-static int _tftp_set_opts(tftp_context_t *ctxt, size_t blksize, uint32_t timeout, size_t total_size);
+static int _tftp_set_opts(tftp_context_t *ctxt, size_t blksize, uint32_t timeout, size_t total_size,
+                          uint16_t window_size);
 
 /* this function registers the UDP port and won't return till the TFTP transfer is finished */
 static int _tftp_do_client_transfer(tftp_context_t *ctxt);
@@ -223,6 +228,12 @@ static tftp_state _tftp_send_start(tftp_context_t *ctxt, gnrc_pktsnip_t *buf);
 /* send data or and ack depending if we are reading or writing */
 static tftp_state _tftp_send_dack(tftp_context_t *ctxt, gnrc_pktsnip_t *buf, tftp_opcodes_t op);
 
+/* send the window of data blocks following the last acknowledged block */
+static tftp_state _tftp_send_window(tftp_context_t *ctxt, gnrc_pktsnip_t *buf);
+
+/* send the first unacknowledged data block again */
+static tftp_state _tftp_resend_first(tftp_context_t *ctxt, gnrc_pktsnip_t *buf);
+
 /* send and TFTP error to the client */
 static tftp_state _tftp_send_error(tftp_context_t *ctxt, gnrc_pktsnip_t *buf, tftp_err_codes_t err, const char *err_msg);
 
@@ -247,6 +258,15 @@ static int _tftp_decode_error(uint8_t *buf, tftp_err_codes_t *err, const char *
 /* TFTP super loop server */
 static int _tftp_server(tftp_context_t *ctxt);
 
+/* acknowledge the final block again while the sender repeats it */
+static bool _tftp_dally(tftp_context_t *ctxt);
+
+/* check if we are the side sending the data blocks */
+static inline bool _tftp_is_sender(tftp_context_t *ctxt)
+{
+    return (ctxt->ct == CT_CLIENT) == (ctxt->op == TO_WRQ);
+}
+
 /* get the maximum allowed transfer unit to avoid 6Lo fragmentation */
 static uint16_t _tftp_get_maximum_block_size(void)
 {
@@ -256,7 +276,12 @@ static uint16_t _tftp_get_maximum_block_size(void)
 
     if (ifnum > 0 && gnrc_netapi_get(ifs[0], NETOPT_MAX_PACKET_SIZE, 0, &tmp, sizeof(uint16_t)) >= 0) {
         /* TODO calculate proper block size */
-        return tmp - sizeof(udp_hdr_t) - sizeof(ipv6_hdr_t) - 10;
+        size_t overhead = sizeof(udp_hdr_t) + sizeof(ipv6_hdr_t) + 10;
+
+        /* our packet buffer can't hold more than GNRC_TFTP_MAX_TRANSFER_UNIT */
+        if (tmp > overhead) {
+            return MIN(tmp - overhead, GNRC_TFTP_MAX_TRANSFER_UNIT);
+        }
     }
 
     return GNRC_TFTP_MAX_TRANSFER_UNIT;
@@ -279,7 +304,8 @@ int gnrc_tftp_client_read(ipv6_addr_t *addr, const char *file_name, tftp_mode_t
     /* set the transfer options */
     uint16_t mtu = _tftp_get_maximum_block_size();
     if (!use_option_extensions ||
-        _tftp_set_opts(&ctxt, mtu, GNRC_TFTP_DEFAULT_TIMEOUT, 0) != TS_FINISHED) {
+        _tftp_set_opts(&ctxt, mtu, GNRC_TFTP_DEFAULT_TIMEOUT, 0,
+                       GNRC_TFTP_WINDOW_SIZE) != TS_FINISHED) {
         _tftp_set_default_options(&ctxt);
 
         if (use_option_extensions) {
@@ -312,7 +338,8 @@ int gnrc_tftp_client_write(ipv6_addr_t *addr, const char *file_name, tftp_mode_t
     /* set the transfer options */
     uint16_t mtu = _tftp_get_maximum_block_size();
     if (!use_option_extensions ||
-        _tftp_set_opts(&ctxt, mtu, GNRC_TFTP_DEFAULT_TIMEOUT, total_size) != TS_FINISHED) {
+        _tftp_set_opts(&ctxt, mtu, GNRC_TFTP_DEFAULT_TIMEOUT, total_size,
+                       GNRC_TFTP_WINDOW_SIZE) != TS_FINISHED) {
 
         _tftp_set_default_options(&ctxt);
 
@@ -359,6 +386,8 @@ int _tftp_init_ctxt(ipv6_addr_t *addr, const char *file_name,
 
     /* transport layer parameters */
     ctxt->block_size = GNRC_TFTP_MAX_TRANSFER_UNIT;
+    ctxt->window_size = 1;
+    ctxt->timeout = GNRC_TFTP_DEFAULT_TIMEOUT;
     ctxt->block_timeout = GNRC_TFTP_DEFAULT_TIMEOUT;
     ctxt->write_finished = false;
 
@@ -373,19 +402,22 @@ int _tftp_init_ctxt(ipv6_addr_t *addr, const char *file_name,
 void _tftp_set_default_options(tftp_context_t *ctxt)
 {
     ctxt->block_size = GNRC_TFTP_MAX_TRANSFER_UNIT;
+    ctxt->window_size = 1;
     ctxt->timeout = GNRC_TFTP_DEFAULT_TIMEOUT;
     ctxt->block_timeout = GNRC_TFTP_DEFAULT_TIMEOUT;
     ctxt->transfer_size = 0;
     ctxt->use_options = false;
 }
 
-int _tftp_set_opts(tftp_context_t *ctxt, size_t blksize, uint32_t timeout, size_t total_size)
+int _tftp_set_opts(tftp_context_t *ctxt, size_t blksize, uint32_t timeout, size_t total_size,
+                   uint16_t window_size)
 {
-    if (blksize > GNRC_TFTP_MAX_TRANSFER_UNIT || !timeout) {
+    if (blksize > GNRC_TFTP_MAX_TRANSFER_UNIT || !timeout || !window_size) {
         return TS_FAILED;
     }
 
     ctxt->block_size = blksize;
+    ctxt->window_size = window_size;
     ctxt->timeout = timeout;
     ctxt->block_timeout = timeout;
     ctxt->transfer_size = total_size;
@@ -500,6 +532,11 @@ int _tftp_server(tftp_context_t *ctxt)
             }
         }
 
+        /* the sender only finishes with our final ACK */
+        if ((ret == TS_FINISHED) && !_tftp_dally(ctxt)) {
+            active = false;
+        }
+
         /* remove any stall timers */
         xtimer_remove(&(ctxt->timer));
 
@@ -549,12 +586,57 @@ int _tftp_do_client_transfer(tftp_context_t *ctxt)
         }
     }
 
+    /* the sender only finishes with our final ACK */
+    if (ret == TS_FINISHED) {
+        _tftp_dally(ctxt);
+    }
+
     /* unregister our UDP listener on this thread */
     gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &entry);
 
     return ret;
 }
 
+bool _tftp_dally(tftp_context_t *ctxt)
+{
+    msg_t msg;
+
+    if (_tftp_is_sender(ctxt)) {
+        return true;
+    }
+
+    /* if the final ACK got lost, the sender repeats data until it arrives
+     * (RFC 1350, section 6); the timer armed by the ACK ends the wait */
+    while (true) {
+        msg_receive(&msg);
+
+        if (msg.type == TFTP_TIMEOUT_MSG) {
+            return true;
+        }
+        else if (msg.type == TFTP_STOP_SERVER_MSG) {
+            return false;
+        }
+        else if (msg.type != GNRC_NETAPI_MSG_TYPE_RCV) {
+            continue;
+        }
+
+        gnrc_pktsnip_t *pkt = msg.content.ptr;
+        gnrc_pktsnip_t *tmp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
+        udp_hdr_t *udp = (udp_hdr_t *)tmp->data;
+
+        if ((_tftp_parse_type(pkt->data) == TO_DATA) &&
+            (byteorder_ntohs(udp->src_port) == ctxt->dst_port)) {
+            DEBUG("tftp: data repeated, acknowledging the final block again\n");
+            gnrc_pktsnip_t *outbuf = gnrc_pktbuf_add(NULL, NULL, TFTP_DEFAULT_DATA_SIZE,
+                                                     GNRC_NETTYPE_UNDEF);
+            if (outbuf) {
+                _tftp_send_dack(ctxt, outbuf, TO_ACK);
+            }
+        }
+        gnrc_pktbuf_release(pkt);
+    }
+}
+
 tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
 {
     gnrc_pktsnip_t *outbuf = gnrc_pktbuf_add(NULL, NULL, TFTP_DEFAULT_DATA_SIZE,
@@ -583,11 +665,14 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
             /* we are still negotiating resent, start */
             return _tftp_send_start(ctxt, outbuf);
         }
+        else if (_tftp_is_sender(ctxt)) {
+            DEBUG("tftp: window not acknowledged, resending its first block\n");
+            /* the ACK provoked by the block tells how much of the window arrived */
+            return _tftp_resend_first(ctxt, outbuf);
+        }
         else {
-            DEBUG("tftp: last data or ack packet lost, resending\n");
-            /* we are sending / receiving data */
-            /* if we are reading resent the ACK, if writing the DATA */
-            return _tftp_send_dack(ctxt, outbuf, (ctxt->op == TO_RRQ) ? TO_ACK : TO_DATA);
+            DEBUG("tftp: rest of the window lost, acknowledging what arrived\n");
+            return _tftp_send_dack(ctxt, outbuf, TO_ACK);
         }
     }
     else if (m->type != GNRC_NETAPI_MSG_TYPE_RCV) {
@@ -606,7 +691,8 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
     ipv6_hdr_t *ip = (ipv6_hdr_t *)tmp->data;
     uint8_t *data = (uint8_t *)pkt->data;
 
-    xtimer_remove(&(ctxt->timer));
+    /* the timer keeps running for a dropped packet, sending the reply to an
+     * accepted one re-arms it */
 
     switch (_tftp_parse_type(data)) {
         case TO_RRQ:
@@ -659,7 +745,6 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
 
                 /* send the first data block */
                 if (ctxt->op == TO_RRQ) {
-                    ++(ctxt->block_nr);
                     opcode = TO_DATA;
                 }
                 else {
@@ -676,7 +761,12 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
             }
 
             /* the client send the TFTP options */
-            state = _tftp_send_dack(ctxt, outbuf, opcode);
+            if (opcode == TO_DATA) {
+                state = _tftp_send_window(ctxt, outbuf);
+            }
+            else {
+                state = _tftp_send_dack(ctxt, outbuf, opcode);
+            }
 
             /* check if the client negotiation was successful */
             if (state != TS_BUSY) {
@@ -688,7 +778,13 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
         case TO_DATA: {
             /* try to process the data */
             int proc = _tftp_process_data(ctxt, pkt);
-            if (proc < 0) {
+            if ((proc == -EAGAIN) && (ctxt->dst_port == byteorder_ntohs(udp->src_port))) {
+                DEBUG("tftp: block out of order, acknowledging the last one in order\n");
+                /* a block of the window got lost, or our ACK did: the sender
+                 * continues after the block we acknowledge */
+                return _tftp_send_dack(ctxt, outbuf, TO_ACK);
+            }
+            else if (proc < 0) {
                 DEBUG("tftp: data not accepted\n");
                 /* the data is not accepted return */
                 gnrc_pktbuf_release(outbuf);
@@ -707,14 +803,13 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
                 ctxt->dst_port = byteorder_ntohs(udp->src_port);
             }
 
-            /* wait for the next data block */
-            DEBUG("tftp: wait for the next data block\n");
             ++(ctxt->block_nr);
-            _tftp_send_dack(ctxt, outbuf, TO_ACK);
+            ctxt->retries = 0;
 
             /* check if the data transfer has finished */
             if (proc < ctxt->block_size) {
                 DEBUG("tftp: transfer finished\n");
+                _tftp_send_dack(ctxt, outbuf, TO_ACK);
 
                 if (ctxt->stop_cb) {
                     ctxt->stop_cb(TFTP_SUCCESS, NULL);
@@ -723,6 +818,19 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
                 return TS_FINISHED;
             }
 
+            /* acknowledge a complete window */
+            if ((uint16_t)(ctxt->block_nr - ctxt->block_acked) >= ctxt->window_size) {
+                DEBUG("tftp: wait for the next window\n");
+                _tftp_send_dack(ctxt, outbuf, TO_ACK);
+                return TS_BUSY;
+            }
+
+            /* wait for the rest of the window, but acknowledge early if it got
+             * lost, before the sender times out */
+            DEBUG("tftp: wait for the next data block\n");
+            gnrc_pktbuf_release(outbuf);
+            ctxt->timer_msg.type = TFTP_TIMEOUT_MSG;
+            xtimer_set_msg(&(ctxt->timer), ctxt->timeout / 2, &(ctxt->timer_msg), thread_getpid());
             return TS_BUSY;
         } break;
 
@@ -734,8 +842,11 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
                 return TS_BUSY;
             }
 
+            uint16_t block_nr = byteorder_ntohs(((tftp_packet_data_t *)data)->block_nr);
+            ctxt->retries = 0;
+
             /* check if the write action is finished */
-            if (ctxt->write_finished) {
+            if (ctxt->write_finished && (block_nr == ctxt->block_nr)) {
                 gnrc_pktbuf_release(outbuf);
 
                 if (ctxt->stop_cb) {
@@ -754,10 +865,11 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
                 ctxt->dst_port = byteorder_ntohs(udp->src_port);
             }
 
-            /* send the next data block */
-            ++(ctxt->block_nr);
+            /* send the next window, which also repeats the blocks of the last
+             * window which did not arrive */
+            ctxt->block_acked = block_nr;
 
-            return _tftp_send_dack(ctxt, outbuf, TO_DATA);
+            return _tftp_send_window(ctxt, outbuf);
         } break;
 
         case TO_ERROR: {
@@ -782,22 +894,26 @@ tftp_state _tftp_state_processes(tftp_context_t *ctxt, msg_t *m)
             if (ctxt->dst_port != byteorder_ntohs(udp->src_port)) {
                 DEBUG("tftp: TO_OACK received\n");
 
+                /* a server not knowing RFC 7440 doesn't acknowledge the
+                 * window size and expects lock-step */
+                ctxt->window_size = 1;
+
                 /* decode the options */
                 _tftp_decode_options(ctxt, pkt, 0);
 
                 /* take the new source port */
                 ctxt->dst_port = byteorder_ntohs(udp->src_port);
-
-                /* we must send block one to finish the negotiation in send mode */
-                if (ctxt->op == TO_WRQ) {
-                    ++(ctxt->block_nr);
-                }
             }
             else {
                 DEBUG("tftp: dropping double TO_OACK\n");
             }
 
-            return _tftp_send_dack(ctxt, outbuf, (ctxt->op == TO_WRQ) ? TO_DATA : TO_ACK);
+            /* we must send block one to finish the negotiation in send mode */
+            if (ctxt->op == TO_WRQ) {
+                return _tftp_send_window(ctxt, outbuf);
+            }
+
+            return _tftp_send_dack(ctxt, outbuf, TO_ACK);
         } break;
     }
 
@@ -836,6 +952,11 @@ uint32_t _tftp_append_options(tftp_context_t *ctxt, tftp_header_t *hdr, uint32_t
         offset += _tftp_add_option(hdr->data + offset, _tftp_options + TOPT_TSIZE, ctxt->transfer_size);
     }
 
+    /* a server only acknowledges a window size the client asked for */
+    if (ctxt->window_size > 1) {
+        offset += _tftp_add_option(hdr->data + offset, _tftp_options + TOPT_WINDOWSIZE, ctxt->window_size);
+    }
+
     return offset;
 }
 
@@ -892,14 +1013,61 @@ tftp_state _tftp_send_dack(tftp_context_t *ctxt, gnrc_pktsnip_t *buf, tftp_opcod
         ctxt->block_timeout = 0;
     }
     else if (op == TO_ACK) {
-        /* disable timeout*/
-        ctxt->block_timeout = 0;
+        /* the next window of the sender starts after this block */
+        ctxt->block_acked = ctxt->block_nr;
+
+        /* acknowledge again if the next data does not arrive */
+        ctxt->block_timeout = ctxt->timeout;
     }
 
     /* send the data */
     return _tftp_send(buf, ctxt, sizeof(tftp_packet_data_t) + len);
 }
 
+tftp_state _tftp_send_window(tftp_context_t *ctxt, gnrc_pktsnip_t *buf)
+{
+    tftp_state state = TS_BUSY;
+
+    ctxt->block_nr = ctxt->block_acked;
+    ctxt->write_finished = false;
+
+    /* send the blocks back-to-back, the timeout is armed by the last one */
+    for (unsigned i = 0; i < ctxt->window_size; ++i) {
+        if (i > 0) {
+            buf = gnrc_pktbuf_add(NULL, NULL, TFTP_DEFAULT_DATA_SIZE, GNRC_NETTYPE_UNDEF);
+            if (buf == NULL) {
+                /* the rest of the window is sent again after the ACK */
+                DEBUG("tftp: packet buffer full, window cut short\n");
+                break;
+            }
+        }
+
+        ++(ctxt->block_nr);
+        state = _tftp_send_dack(ctxt, buf, TO_DATA);
+
+        /* stop after the last block of the transfer */
+        if (state != TS_BUSY || ctxt->write_finished) {
+            break;
+        }
+    }
+
+    return state;
+}
+
+tftp_state _tftp_resend_first(tftp_context_t *ctxt, gnrc_pktsnip_t *buf)
+{
+    uint16_t block_nr = ctxt->block_nr;
+    bool write_finished = ctxt->write_finished;
+
+    /* the rest of the window stays in flight */
+    ctxt->block_nr = ctxt->block_acked + 1;
+    tftp_state state = _tftp_send_dack(ctxt, buf, TO_DATA);
+    ctxt->block_nr = block_nr;
+    ctxt->write_finished = write_finished;
+
+    return state;
+}
+
 tftp_state _tftp_send_error(tftp_context_t *ctxt, gnrc_pktsnip_t *buf, tftp_err_codes_t err, const char *err_msg)
 {
     int strl = err_msg
@@ -1010,8 +1178,12 @@ tftp_state _tftp_send(gnrc_pktsnip_t *buf, tftp_context_t *ctxt, size_t len)
 bool _tftp_validate_ack(tftp_context_t *ctxt, uint8_t *buf)
 {
     tftp_packet_data_t *pkt = (tftp_packet_data_t *) buf;
+    uint16_t sent = ctxt->block_nr - ctxt->block_acked;
+    uint16_t acked = byteorder_ntohs(pkt->block_nr) - ctxt->block_acked;
 
-    return ctxt->block_nr == byteorder_ntohs(pkt->block_nr);
+    /* any block of the window in flight may be acknowledged, a repeated ACK
+     * of the block before the window is a duplicate */
+    return (acked <= sent) && (acked > 0 || sent == 0);
 }
 
 int _tftp_decode_start(tftp_context_t *ctxt, uint8_t *buf, gnrc_pktsnip_t *outbuf)
@@ -1069,10 +1241,22 @@ int _tftp_decode_options(tftp_context_t *ctxt, gnrc_pktsnip_t *buf, uint32_t sta
             if (memcmp(name, _tftp_options[idx].name, _tftp_options[idx].len) == 0) {
                 /* set the option value of the known options */
                 switch (idx) {
-                    case TOPT_BLKSIZE:
-                        ctxt->block_size = atoi(value);
+                    case TOPT_BLKSIZE: {
+                        /* never exceed what fits into our packet buffer
+                         * and, unfragmented, into a frame of our interface */
+                        int blksize = atoi(value);
+                        if (blksize > 0) {
+                            ctxt->block_size = MIN(blksize, (int)_tftp_get_maximum_block_size());
+                        }
                         DEBUG("tftp: got option TOPT_BLKSIZE = %" PRIu16 "\n", ctxt->block_size);
-                        break;
+                    } break;
+
+                    case TOPT_WINDOWSIZE: {
+                        int window_size = atoi(value);
+                        ctxt->window_size = (window_size < 1)
+                                            ? 1 : MIN(window_size, GNRC_TFTP_WINDOW_SIZE);
+                        DEBUG("tftp: got option TOPT_WINDOWSIZE = %" PRIu16 "\n", ctxt->window_size);
+                    } break;
 
                     case TOPT_TSIZE:
                         ctxt->transfer_size = atoi(value);
@@ -1107,15 +1291,15 @@ int _tftp_process_data(tftp_context_t *ctxt, gnrc_pktsnip_t *buf)
     uint16_t block_nr = byteorder_ntohs(pkt->block_nr);
 
     /* check if this is the packet we are waiting for */
-    if (block_nr != (ctxt->block_nr + 1)) {
+    if (block_nr != (uint16_t)(ctxt->block_nr + 1)) {
         DEBUG("tftp: not the packet we were wating for\n");
-        return TS_BUSY;
+        return -EAGAIN;
     }
 
     /* send the user data trough to the user application */
     if (ctxt->data_cb(ctxt->block_nr * ctxt->block_size, pkt->data, buf->size - sizeof(tftp_packet_data_t)) < 0) {
         DEBUG("tftp: error in data callback\n");
-        return TS_BUSY;
+        return -EIO;
     }
 
     /* return the number of data bytes received */
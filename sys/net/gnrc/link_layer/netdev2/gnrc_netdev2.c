@@ -28,6 +28,7 @@
 #include "net/netdev2.h"
 
 #include "net/gnrc/netdev2.h"
+#include "net/gnrc/rxtrace.h"
 #include "net/ethernet/hdr.h"
 
 #define ENABLE_DEBUG    (0)
@@ -68,6 +69,7 @@ static void _event_cb(netdev2_t *dev, netdev2_event_t event)
                     gnrc_pktsnip_t *pkt = gnrc_netdev2->recv(gnrc_netdev2);
 
                     if (pkt) {
+                        gnrc_rxtrace_point(pkt, GNRC_RXTRACE_NETDEV2);
                         _pass_on_packet(pkt);
                     }
 
@@ -19,6 +19,7 @@
 #include "net/gnrc.h"
 #include "net/gnrc/netdev2.h"
 #include "net/ethernet/hdr.h"
+#include "net/netstats.h"
 
 #ifdef MODULE_GNRC_IPV6
 #include "net/ipv6/hdr.h"
@@ -42,6 +43,7 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
 
         if(!pkt) {
             DEBUG("_recv_ethernet_packet: cannot allocate pktsnip.\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_NOMEM);
 
             /* drop the packet */
             dev->driver->recv(dev, NULL, bytes_expected, NULL);
@@ -67,6 +69,7 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
         gnrc_pktsnip_t *eth_hdr = gnrc_pktbuf_mark(pkt, sizeof(ethernet_hdr_t), GNRC_NETTYPE_UNDEF);
         if (!eth_hdr) {
             DEBUG("gnrc_netdev2_eth: no space left in packet buffer\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_NOMEM);
             goto safe_out;
         }
 
@@ -83,6 +86,7 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
 
         if (netif_hdr == NULL) {
             DEBUG("gnrc_netdev2_eth: no space left in packet buffer\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_NOMEM);
             pkt = eth_hdr;
             goto safe_out;
         }
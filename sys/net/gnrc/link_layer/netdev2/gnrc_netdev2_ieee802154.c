@@ -20,6 +20,7 @@
 #include "net/ieee802154.h"
 
 #include "net/gnrc/netdev2/ieee802154.h"
+#include "net/netstats.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -78,6 +79,7 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
         pkt = gnrc_pktbuf_add(NULL, NULL, bytes_expected, GNRC_NETTYPE_UNDEF);
         if (pkt == NULL) {
             DEBUG("_recv_ieee802154: cannot allocate pktsnip.\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_NOMEM);
             return NULL;
         }
         nread = netdev->driver->recv(netdev, pkt->data, bytes_expected, &rx_info);
@@ -95,6 +97,7 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
 
             if (mhr_len == 0) {
                 DEBUG("_recv_ieee802154: illegally formatted frame received\n");
+                NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_INVALID);
                 gnrc_pktbuf_release(pkt);
                 return NULL;
             }
@@ -103,12 +106,14 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
             ieee802154_hdr = gnrc_pktbuf_mark(pkt, mhr_len, GNRC_NETTYPE_UNDEF);
             if (ieee802154_hdr == NULL) {
                 DEBUG("_recv_ieee802154: no space left in packet buffer\n");
+                NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_NOMEM);
                 gnrc_pktbuf_release(pkt);
                 return NULL;
             }
             netif_hdr = _make_netif_hdr(ieee802154_hdr->data);
             if (netif_hdr == NULL) {
                 DEBUG("_recv_ieee802154: no space left in packet buffer\n");
+                NETSTATS_DROP(NETSTATS_DROP_AT_L2, NETSTATS_DROP_NOMEM);
                 gnrc_pktbuf_release(pkt);
                 return NULL;
             }
@@ -23,6 +23,7 @@
 #include "net/gnrc/netreg.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/netapi.h"
+#include "net/netstats.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -91,6 +92,34 @@ static inline int _snd_rcv_mbox(mbox_t *mbox, uint16_t type, gnrc_pktsnip_t *pkt
 }
 #endif
 
+#ifdef MODULE_NETSTATS_DROP
+/* counts a packet of the given type the layer of that type did not get */
+static void _count_drop(gnrc_nettype_t type, netstats_drop_reason_t reason)
+{
+    switch (type) {
+#ifdef MODULE_GNRC_SIXLOWPAN
+        case GNRC_NETTYPE_SIXLOWPAN:
+            NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, reason);
+            break;
+#endif
+#ifdef MODULE_GNRC_IPV6
+        case GNRC_NETTYPE_IPV6:
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, reason);
+            break;
+#endif
+#ifdef MODULE_GNRC_UDP
+        case GNRC_NETTYPE_UDP:
+            NETSTATS_DROP(NETSTATS_DROP_AT_UDP, reason);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+#else
+#define _count_drop(type, reason)   (void)0
+#endif
+
 int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx,
                          uint16_t cmd, gnrc_pktsnip_t *pkt)
 {
@@ -108,6 +137,7 @@ int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx,
                 case GNRC_NETREG_TYPE_DEFAULT:
                     if (_snd_rcv(sendto->target.pid, cmd, pkt) < 1) {
                         /* unable to dispatch packet */
+                        _count_drop(type, NETSTATS_DROP_QUEUE_FULL);
                         release = 1;
                     }
                     break;
@@ -115,6 +145,8 @@ int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx,
                 case GNRC_NETREG_TYPE_MBOX:
                     if (_snd_rcv_mbox(sendto->target.mbox, cmd, pkt) < 1) {
                         /* unable to dispatch packet */
+                        NETSTATS_DROP(NETSTATS_DROP_AT_SOCK,
+                                      NETSTATS_DROP_QUEUE_FULL);
                         release = 1;
                     }
                     break;
@@ -135,6 +167,7 @@ int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx,
 #else
             if (_snd_rcv(sendto->target.pid, cmd, pkt) < 1) {
                 /* unable to dispatch packet */
+                _count_drop(type, NETSTATS_DROP_QUEUE_FULL);
                 gnrc_pktbuf_release(pkt);
             }
 #endif
@@ -19,12 +19,15 @@
 #include "byteorder.h"
 #include "cpu_conf.h"
 #include "kernel_types.h"
+#include "mutex.h"
 #include "net/gnrc.h"
 #include "net/gnrc/icmpv6.h"
 #include "net/gnrc/ndp.h"
+#include "net/gnrc/rxtrace.h"
 #include "net/gnrc/sixlowpan/ctx.h"
 #include "net/gnrc/sixlowpan/nd.h"
 #include "net/gnrc/sixlowpan/nd/router.h"
+#include "net/netstats.h"
 #include "net/protnum.h"
 #include "thread.h"
 #include "utlist.h"
@@ -47,6 +50,25 @@ static char _stack[GNRC_IPV6_STACK_SIZE + THREAD_EXTRA_STACKSIZE_PRINTF];
 static char _stack[GNRC_IPV6_STACK_SIZE];
 #endif
 
+#if defined(MODULE_GNRC_IPV6_ROUTER) && GNRC_IPV6_FWD_WORKERS
+#define _FWD_WORKERS        (GNRC_IPV6_FWD_WORKERS)
+
+#if ENABLE_DEBUG
+static char _fwd_stacks[_FWD_WORKERS][GNRC_IPV6_STACK_SIZE +
+                                      THREAD_EXTRA_STACKSIZE_PRINTF];
+#else
+static char _fwd_stacks[_FWD_WORKERS][GNRC_IPV6_STACK_SIZE];
+#endif
+static kernel_pid_t _fwd_pids[_FWD_WORKERS];
+/* The neighbor cache and NDP state have a single writer at a time: the IPv6
+ * thread holds this lock while it handles a message, the workers while they
+ * resolve a next hop */
+static mutex_t _nc_lock = MUTEX_INIT;
+
+/* Forwarding worker loop */
+static void *_fwd_loop(void *args);
+#endif
+
 #ifdef MODULE_FIB
 #include "net/fib.h"
 #include "net/fib/table.h"
@@ -85,6 +107,13 @@ kernel_pid_t gnrc_ipv6_init(void)
         gnrc_ipv6_pid = thread_create(_stack, sizeof(_stack), GNRC_IPV6_PRIO,
                                       THREAD_CREATE_STACKTEST,
                                       _event_loop, NULL, "ipv6");
+#ifdef _FWD_WORKERS
+        for (unsigned i = 0; i < _FWD_WORKERS; i++) {
+            _fwd_pids[i] = thread_create(_fwd_stacks[i], sizeof(_fwd_stacks[i]),
+                                         GNRC_IPV6_PRIO, THREAD_CREATE_STACKTEST,
+                                         _fwd_loop, NULL, "ipv6_fwd");
+        }
+#endif
     }
 
 #ifdef MODULE_FIB
@@ -232,6 +261,9 @@ static void _dispatch_next_header(gnrc_pktsnip_t *current, gnrc_pktsnip_t *pkt,
         if (gnrc_netapi_dispatch_receive(current->type,
                                          GNRC_NETREG_DEMUX_CTX_ALL,
                                          pkt) == 0) {
+            if (should_release) {
+                NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NO_SUBSCRIBER);
+            }
             gnrc_pktbuf_release(pkt);
         }
 
@@ -244,6 +276,9 @@ static void _dispatch_next_header(gnrc_pktsnip_t *current, gnrc_pktsnip_t *pkt,
                                      * next dispatch */
     }
     if (gnrc_netapi_dispatch_receive(GNRC_NETTYPE_IPV6, nh, pkt) == 0) {
+        if (!interested) {
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NO_SUBSCRIBER);
+        }
         gnrc_pktbuf_release(pkt);
     }
 }
@@ -268,6 +303,9 @@ static void *_event_loop(void *args)
         DEBUG("ipv6: waiting for incoming message.\n");
         msg_receive(&msg);
 
+#ifdef _FWD_WORKERS
+        mutex_lock(&_nc_lock);
+#endif
         switch (msg.type) {
             case GNRC_NETAPI_MSG_TYPE_RCV:
                 DEBUG("ipv6: GNRC_NETAPI_MSG_TYPE_RCV received\n");
@@ -364,6 +402,9 @@ static void *_event_loop(void *args)
             default:
                 break;
         }
+#ifdef _FWD_WORKERS
+        mutex_unlock(&_nc_lock);
+#endif
     }
 
     return NULL;
@@ -747,7 +788,20 @@ static void _send(gnrc_pktsnip_t *pkt, bool prep_hdr)
         uint8_t l2addr_len = GNRC_IPV6_NC_L2_ADDR_MAX;
         uint8_t l2addr[l2addr_len];
 
+#ifdef _FWD_WORKERS
+        /* the IPv6 thread already holds the lock */
+        bool worker = (sched_active_pid != gnrc_ipv6_pid);
+
+        if (worker) {
+            mutex_lock(&_nc_lock);
+        }
+#endif
         iface = _next_hop_l2addr(l2addr, &l2addr_len, iface, &hdr->dst, pkt);
+#ifdef _FWD_WORKERS
+        if (worker) {
+            mutex_unlock(&_nc_lock);
+        }
+#endif
 
         if (iface == KERNEL_PID_UNDEF) {
             DEBUG("ipv6: error determining next hop's link layer address\n");
@@ -787,6 +841,94 @@ static inline bool _pkt_not_for_me(kernel_pid_t *iface, ipv6_hdr_t *hdr)
     }
 }
 
+#ifdef MODULE_GNRC_IPV6_ROUTER
+/* sends a received packet on to its next hop, ipv6 is its IPv6 header snip */
+static void _forward(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *ipv6)
+{
+    gnrc_pktsnip_t *reversed_pkt = NULL, *ptr = pkt, *netif;
+
+    DEBUG("ipv6: forward packet to next hop\n");
+
+    /* pkt might not be writable yet, if header was given above */
+    ipv6 = gnrc_pktbuf_start_write(ipv6);
+    if (ipv6 == NULL) {
+        DEBUG("ipv6: unable to get write access to packet: dropping it\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+
+    /* remove L2 headers around IPV6 */
+    netif = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_NETIF);
+    if (netif != NULL) {
+        gnrc_pktbuf_remove_snip(pkt, netif);
+    }
+
+    /* reverse packet snip list order */
+    while (ptr != NULL) {
+        gnrc_pktsnip_t *next;
+        ptr = gnrc_pktbuf_start_write(ptr);     /* duplicate if not already done */
+        if (ptr == NULL) {
+            DEBUG("ipv6: unable to get write access to packet: dropping it\n");
+            gnrc_pktbuf_release(reversed_pkt);
+            gnrc_pktbuf_release(pkt);
+            return;
+        }
+        next = ptr->next;
+        ptr->next = reversed_pkt;
+        reversed_pkt = ptr;
+        ptr = next;
+    }
+    _send(reversed_pkt, false);
+}
+#endif
+
+#ifdef _FWD_WORKERS
+/* hashes the flow of a packet, i.e. source, destination and flow label */
+static uint32_t _flow_hash(const ipv6_hdr_t *hdr)
+{
+    uint32_t hash = byteorder_ntohl(hdr->v_tc_fl) & 0x000fffff;
+
+    for (unsigned i = 0; i < sizeof(ipv6_addr_t) / sizeof(uint32_t); i++) {
+        hash = (hash * 31) ^ hdr->src.u32[i].u32;
+        hash = (hash * 31) ^ hdr->dst.u32[i].u32;
+    }
+    /* fold the high bits in, the modulo of few workers only sees low bits */
+    return hash ^ (hash >> 16);
+}
+
+static void *_fwd_loop(void *args)
+{
+    msg_t msg, msg_q[GNRC_IPV6_MSG_QUEUE_SIZE];
+
+    (void)args;
+    msg_init_queue(msg_q, GNRC_IPV6_MSG_QUEUE_SIZE);
+
+    while (1) {
+        msg_receive(&msg);
+
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_RCV) {
+            gnrc_pktsnip_t *pkt = msg.content.ptr, *ipv6 = pkt;
+
+            /* _receive() marked the header, payload snips are not IPv6 typed
+             * or of another size */
+            while ((ipv6 != NULL) &&
+                   ((ipv6->type != GNRC_NETTYPE_IPV6) ||
+                    (ipv6->size != sizeof(ipv6_hdr_t)))) {
+                ipv6 = ipv6->next;
+            }
+            if (ipv6 == NULL) {
+                DEBUG("ipv6: no IPv6 header in packet to forward\n");
+                gnrc_pktbuf_release(pkt);
+                continue;
+            }
+            _forward(pkt, ipv6);
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 static void _receive(gnrc_pktsnip_t *pkt)
 {
     kernel_pid_t iface = KERNEL_PID_UNDEF;
@@ -795,6 +937,8 @@ static void _receive(gnrc_pktsnip_t *pkt)
 
     assert(pkt != NULL);
 
+    gnrc_rxtrace_point(pkt, GNRC_RXTRACE_IPV6);
+
     netif = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_NETIF);
 
     if (netif != NULL) {
@@ -822,6 +966,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
     if (ipv6 == NULL) {
         if (!ipv6_hdr_is(pkt->data)) {
             DEBUG("ipv6: Received packet was not IPv6, dropping packet\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_INVALID);
             gnrc_pktbuf_release(pkt);
             return;
         }
@@ -844,6 +989,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
 
         if (ipv6 == NULL) {
             DEBUG("ipv6: unable to get write access to packet, drop it\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NOMEM);
             gnrc_pktbuf_release(pkt);
             return;
         }
@@ -857,6 +1003,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
 
         if (ipv6 == NULL) {
             DEBUG("ipv6: error marking IPv6 header, dropping packet\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NOMEM);
             gnrc_pktbuf_release(pkt);
             return;
         }
@@ -891,6 +1038,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
         DEBUG("ipv6: invalid payload length: %d, actual: %d, dropping packet\n",
               (int) byteorder_ntohs(hdr->len),
               (int) (gnrc_pkt_len_upto(pkt, GNRC_NETTYPE_IPV6) - sizeof(ipv6_hdr_t)));
+        NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_INVALID);
         gnrc_pktbuf_release(pkt);
         return;
     }
@@ -920,40 +1068,19 @@ static void _receive(gnrc_pktsnip_t *pkt)
         }
         /* TODO: check if receiving interface is router */
         else if (--(hdr->hl) > 0) {  /* drop packets that *reach* Hop Limit 0 */
-            gnrc_pktsnip_t *reversed_pkt = NULL, *ptr = pkt;
-
-            DEBUG("ipv6: forward packet to next hop\n");
-
-            /* pkt might not be writable yet, if header was given above */
-            ipv6 = gnrc_pktbuf_start_write(ipv6);
-            if (ipv6 == NULL) {
-                DEBUG("ipv6: unable to get write access to packet: dropping it\n");
+#ifdef _FWD_WORKERS
+            msg_t msg;
+
+            msg.type = GNRC_NETAPI_MSG_TYPE_RCV;
+            msg.content.ptr = pkt;
+            if (msg_try_send(&msg, _fwd_pids[_flow_hash(hdr) % _FWD_WORKERS]) < 1) {
+                DEBUG("ipv6: forwarding worker is busy, dropping packet\n");
+                NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_QUEUE_FULL);
                 gnrc_pktbuf_release(pkt);
-                return;
             }
-
-            /* remove L2 headers around IPV6 */
-            netif = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_NETIF);
-            if (netif != NULL) {
-                gnrc_pktbuf_remove_snip(pkt, netif);
-            }
-
-            /* reverse packet snip list order */
-            while (ptr != NULL) {
-                gnrc_pktsnip_t *next;
-                ptr = gnrc_pktbuf_start_write(ptr);     /* duplicate if not already done */
-                if (ptr == NULL) {
-                    DEBUG("ipv6: unable to get write access to packet: dropping it\n");
-                    gnrc_pktbuf_release(reversed_pkt);
-                    gnrc_pktbuf_release(pkt);
-                    return;
-                }
-                next = ptr->next;
-                ptr->next = reversed_pkt;
-                reversed_pkt = ptr;
-                ptr = next;
-            }
-            _send(reversed_pkt, false);
+#else
+            _forward(pkt, ipv6);
+#endif
             return;
         }
         else {
@@ -21,6 +21,7 @@
 #include "net/gnrc/ndp.h"
 #include "net/gnrc/pkt.h"
 #include "net/gnrc/pktqueue.h"
+#include "net/netstats.h"
 
 #include "net/gnrc/ndp/internal.h"
 
@@ -133,6 +134,7 @@ kernel_pid_t gnrc_ndp_node_next_hop_l2addr(uint8_t *l2addr, uint8_t *l2addr_len,
 
         if (nc_entry == NULL) {
             DEBUG("ndp node: could not create neighbor cache entry\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NC_INCOMPLETE);
             return KERNEL_PID_UNDEF;
         }
 
@@ -140,6 +142,7 @@ kernel_pid_t gnrc_ndp_node_next_hop_l2addr(uint8_t *l2addr, uint8_t *l2addr_len,
 
         if (pkt_node == NULL) {
             DEBUG("ndp node: could not add packet to packet queue\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NC_INCOMPLETE);
         }
         else {
             /* prevent packet from being released by IPv6 */
@@ -172,6 +175,10 @@ kernel_pid_t gnrc_ndp_node_next_hop_l2addr(uint8_t *l2addr, uint8_t *l2addr_len,
             mutex_unlock(&ipv6_iface->mutex);
         }
     }
+    else {
+        DEBUG("ndp node: address resolution still in progress\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_IPV6, NETSTATS_DROP_NC_INCOMPLETE);
+    }
 
     return KERNEL_PID_UNDEF;
 }
@@ -22,6 +22,7 @@
 #include "net/gnrc/sixlowpan.h"
 #include "net/gnrc/sixlowpan/frag.h"
 #include "net/sixlowpan.h"
+#include "net/netstats.h"
 #include "thread.h"
 #include "xtimer.h"
 #include "utlist.h"
@@ -88,6 +89,7 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
 
     if (entry == NULL) {
         DEBUG("6lo rbuf: reassembly buffer full.\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
         return;
     }
 
@@ -264,6 +266,7 @@ static void _rbuf_gc(void)
                                          rbuf[i].dst_len),
                   (unsigned)rbuf[i].pkt->size, rbuf[i].tag);
 
+            NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_REASS_TIMEOUT);
             gnrc_pktbuf_release(rbuf[i].pkt);
             _rbuf_rem(&(rbuf[i]));
         }
@@ -312,6 +315,7 @@ static rbuf_t *_rbuf_get(const void *src, size_t src_len,
         assert(oldest != NULL);
         assert(oldest->pkt != NULL); /* if oldest->pkt == NULL, res must not be NULL */
         DEBUG("6lo rfrag: reassembly buffer full, remove oldest entry\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
         gnrc_pktbuf_release(oldest->pkt);
         _rbuf_rem(oldest);
         res = oldest;
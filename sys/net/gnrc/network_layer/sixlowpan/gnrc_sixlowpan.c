@@ -18,11 +18,13 @@
 #include "utlist.h"
 
 #include "net/gnrc/ipv6/hdr.h"
+#include "net/gnrc/rxtrace.h"
 #include "net/gnrc/sixlowpan.h"
 #include "net/gnrc/sixlowpan/frag.h"
 #include "net/gnrc/sixlowpan/iphc.h"
 #include "net/gnrc/sixlowpan/netif.h"
 #include "net/sixlowpan.h"
+#include "net/netstats.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -69,12 +71,15 @@ static void _receive(gnrc_pktsnip_t *pkt)
     gnrc_pktsnip_t *payload;
     uint8_t *dispatch;
 
+    gnrc_rxtrace_point(pkt, GNRC_RXTRACE_SIXLOWPAN);
+
     /* seize payload as a temporary variable */
     payload = gnrc_pktbuf_start_write(pkt); /* need to duplicate since pkt->next
                                              * might get replaced */
 
     if (payload == NULL) {
         DEBUG("6lo: can not get write access on received packet\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
 #if defined(DEVELHELP) && ENABLE_DEBUG
         gnrc_pktbuf_stats();
 #endif
@@ -88,6 +93,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
 
     if ((payload == NULL) || (payload->size < 1)) {
         DEBUG("6lo: Received packet has no 6LoWPAN payload\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_INVALID);
         gnrc_pktbuf_release(pkt);
         return;
     }
@@ -101,6 +107,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
 
         if (payload == NULL) {
             DEBUG("6lo: can not get write access on received packet\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
 #if defined(DEVELHELP) && ENABLE_DEBUG
             gnrc_pktbuf_stats();
 #endif
@@ -113,6 +120,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
 
         if (sixlowpan == NULL) {
             DEBUG("6lo: can not mark 6LoWPAN dispatch\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
             gnrc_pktbuf_release(pkt);
             return;
         }
@@ -138,14 +146,19 @@ static void _receive(gnrc_pktsnip_t *pkt)
                                                         &nh_len)) == 0) {
             DEBUG("6lo: error on IPHC decoding\n");
             if (dec_hdr != NULL) {
+                NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_INVALID);
                 gnrc_pktbuf_release(dec_hdr);
             }
+            else {
+                NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
+            }
             gnrc_pktbuf_release(pkt);
             return;
         }
         sixlowpan = gnrc_pktbuf_mark(pkt, dispatch_size, GNRC_NETTYPE_SIXLOWPAN);
         if (sixlowpan == NULL) {
             DEBUG("6lo: error on marking IPHC dispatch\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_NOMEM);
             gnrc_pktbuf_release(dec_hdr);
             gnrc_pktbuf_release(pkt);
             return;
@@ -160,6 +173,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
     else {
         DEBUG("6lo: dispatch %02" PRIx8 " ... is not supported\n",
               dispatch[0]);
+        NETSTATS_DROP(NETSTATS_DROP_AT_SIXLOWPAN, NETSTATS_DROP_INVALID);
         gnrc_pktbuf_release(pkt);
         return;
     }
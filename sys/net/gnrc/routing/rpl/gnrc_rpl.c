@@ -18,6 +18,7 @@
 #include "net/ipv6.h"
 #include "net/gnrc/ipv6/netif.h"
 #include "net/gnrc.h"
+#include "kernel_defines.h"
 #include "mutex.h"
 
 #include "net/gnrc/rpl.h"
@@ -25,6 +26,7 @@
 #include "net/gnrc/rpl/p2p.h"
 #include "net/gnrc/rpl/p2p_dodag.h"
 #endif
+#include "gnrc_rpl_internal/lifetime.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -32,9 +34,15 @@
 static char _stack[GNRC_RPL_STACK_SIZE];
 kernel_pid_t gnrc_rpl_pid = KERNEL_PID_UNDEF;
 const ipv6_addr_t ipv6_addr_all_rpl_nodes = GNRC_RPL_ALL_NODES_ADDR;
-static uint32_t _lt_time = GNRC_RPL_LIFETIME_UPDATE_STEP * SEC_IN_USEC;
 static xtimer_t _lt_timer;
 static msg_t _lt_msg = { .type = GNRC_RPL_MSG_TYPE_LIFETIME_UPDATE };
+/* parent and DODAG deadlines in seconds since boot, earliest first */
+static priority_queue_t _lt_queue = PRIORITY_QUEUE_INIT;
+static mutex_t _lt_mutex = MUTEX_INIT;
+#ifdef MODULE_GNRC_RPL_P2P
+static priority_queue_node_t _lt_p2p = PRIORITY_QUEUE_NODE_INIT;
+static bool _lt_p2p_queued;
+#endif
 static msg_t _msg_q[GNRC_RPL_MSG_QUEUE_SIZE];
 static gnrc_netreg_entry_t _me_reg;
 static mutex_t _inst_id_mutex = MUTEX_INIT;
@@ -47,6 +55,12 @@ gnrc_rpl_parent_t gnrc_rpl_parents[GNRC_RPL_PARENTS_NUMOF];
 netstats_rpl_t gnrc_rpl_netstats;
 #endif
 
+enum {
+    _LT_PARENT,
+    _LT_DODAG,
+    _LT_P2P,
+};
+
 static void _update_lifetime(void);
 static void _dao_handle_send(gnrc_rpl_dodag_t *dodag);
 static void _receive(gnrc_pktsnip_t *pkt);
@@ -73,7 +87,6 @@ kernel_pid_t gnrc_rpl_init(kernel_pid_t if_pid)
         gnrc_netreg_register(GNRC_NETTYPE_ICMPV6, &_me_reg);
 
         gnrc_rpl_of_manager_init();
-        xtimer_set_msg(&_lt_timer, _lt_time, &_lt_msg, gnrc_rpl_pid);
 
 #ifdef MODULE_NETSTATS_RPL
         memset(&gnrc_rpl_netstats, 0, sizeof(gnrc_rpl_netstats));
@@ -250,70 +263,184 @@ static void *_event_loop(void *args)
     return NULL;
 }
 
-void _update_lifetime(void)
+/* needs _lt_mutex */
+static void _lt_arm(void)
 {
-    uint32_t now = xtimer_now_usec();
-    uint16_t now_sec = now / SEC_IN_USEC;
-
-    gnrc_rpl_parent_t *parent;
-    gnrc_rpl_instance_t *inst;
-
-    for (uint8_t i = 0; i < GNRC_RPL_PARENTS_NUMOF; ++i) {
-        parent = &gnrc_rpl_parents[i];
-        if (parent->state != 0) {
-            if ((int32_t)(parent->lifetime - now_sec) <= GNRC_RPL_LIFETIME_UPDATE_STEP) {
-                gnrc_rpl_dodag_t *dodag = parent->dodag;
-                gnrc_rpl_parent_remove(parent);
-                gnrc_rpl_parent_update(dodag, NULL);
-                continue;
-            }
-            else if ((int32_t)(parent->lifetime - now_sec) <= (GNRC_RPL_LIFETIME_UPDATE_STEP * 2)) {
-                gnrc_rpl_send_DIS(parent->dodag->instance, &parent->addr);
-            }
-        }
+    if (_lt_queue.first == NULL) {
+        xtimer_remove(&_lt_timer);
+        return;
     }
 
-    for (int i = 0; i < GNRC_RPL_INSTANCES_NUMOF; ++i) {
-        inst = &gnrc_rpl_instances[i];
-        if (inst->state != 0) {
-            if ((inst->cleanup > 0) && (inst->dodag.parents == NULL) &&
-                (inst->dodag.my_rank == GNRC_RPL_INFINITE_RANK)) {
-                inst->cleanup -= GNRC_RPL_LIFETIME_UPDATE_STEP;
-                if (inst->cleanup <= 0) {
-                    /* no parents - delete this instance and DODAG */
-                    gnrc_rpl_instance_remove(inst);
-                    continue;
-                }
-            }
+    uint64_t now = xtimer_now_usec64();
+    uint64_t deadline = (uint64_t)_lt_queue.first->priority * SEC_IN_USEC;
 
-            if (inst->dodag.dao_time > GNRC_RPL_LIFETIME_UPDATE_STEP) {
-                inst->dodag.dao_time -= GNRC_RPL_LIFETIME_UPDATE_STEP;
-            }
-            else {
-                _dao_handle_send(&inst->dodag);
-            }
-        }
+    xtimer_set_msg64(&_lt_timer, (deadline > now) ? (deadline - now) : 0,
+                     &_lt_msg, gnrc_rpl_pid);
+}
+
+static void _lt_schedule(priority_queue_node_t *node, uint32_t deadline)
+{
+    mutex_lock(&_lt_mutex);
+    priority_queue_remove(&_lt_queue, node);
+    node->priority = deadline;
+    priority_queue_add(&_lt_queue, node);
+    _lt_arm();
+    mutex_unlock(&_lt_mutex);
+}
+
+void gnrc_rpl_lifetime_remove(priority_queue_node_t *node)
+{
+    mutex_lock(&_lt_mutex);
+    priority_queue_remove(&_lt_queue, node);
+    _lt_arm();
+    mutex_unlock(&_lt_mutex);
+}
+
+void gnrc_rpl_lifetime_parent(gnrc_rpl_parent_t *parent)
+{
+    uint32_t margin = GNRC_RPL_LIFETIME_UPDATE_STEP;
+
+    /* ask for a DIO first, if there is still time for it */
+    if ((int32_t)(parent->lifetime - gnrc_rpl_now_sec()) > (2 * GNRC_RPL_LIFETIME_UPDATE_STEP)) {
+        margin = 2 * GNRC_RPL_LIFETIME_UPDATE_STEP;
+    }
+
+    parent->deadline.data = _LT_PARENT;
+    _lt_schedule(&parent->deadline, (parent->lifetime > margin) ? (parent->lifetime - margin) : 0);
+}
+
+#ifdef MODULE_GNRC_RPL_P2P
+/* P2P-RPL DODAG extensions count down their lifetimes in steps */
+static void _lt_p2p_step(void)
+{
+    mutex_lock(&_lt_mutex);
+    if (!_lt_p2p_queued) {
+        _lt_p2p_queued = true;
+        _lt_p2p.data = _LT_P2P;
+        _lt_p2p.priority = gnrc_rpl_now_sec() + GNRC_RPL_LIFETIME_UPDATE_STEP;
+        priority_queue_add(&_lt_queue, &_lt_p2p);
+        _lt_arm();
     }
+    mutex_unlock(&_lt_mutex);
+}
+#endif
+
+void gnrc_rpl_lifetime_dodag(gnrc_rpl_dodag_t *dodag)
+{
+    uint32_t deadline = UINT32_MAX;
+    bool due = false;
 
 #ifdef MODULE_GNRC_RPL_P2P
-    gnrc_rpl_p2p_update();
+    if (dodag->instance->mop == GNRC_RPL_P2P_MOP) {
+        _lt_p2p_step();
+    }
+    else
 #endif
+    if (!dodag->dao_ack_received) {
+        deadline = dodag->dao_time;
+        due = true;
+    }
 
-    xtimer_set_msg(&_lt_timer, _lt_time, &_lt_msg, gnrc_rpl_pid);
+    if ((dodag->instance->cleanup != 0) && (dodag->instance->cleanup < deadline)) {
+        deadline = dodag->instance->cleanup;
+        due = true;
+    }
+
+    if (due) {
+        dodag->deadline.data = _LT_DODAG;
+        _lt_schedule(&dodag->deadline, deadline);
+    }
+    else {
+        gnrc_rpl_lifetime_remove(&dodag->deadline);
+    }
+}
+
+static void _parent_deadline(gnrc_rpl_parent_t *parent, uint32_t now)
+{
+    if ((int32_t)(parent->lifetime - now) <= GNRC_RPL_LIFETIME_UPDATE_STEP) {
+        gnrc_rpl_dodag_t *dodag = parent->dodag;
+        gnrc_rpl_parent_remove(parent);
+        gnrc_rpl_parent_update(dodag, NULL);
+        return;
+    }
+    else if ((int32_t)(parent->lifetime - now) <= (GNRC_RPL_LIFETIME_UPDATE_STEP * 2)) {
+        gnrc_rpl_send_DIS(parent->dodag->instance, &parent->addr);
+    }
+    gnrc_rpl_lifetime_parent(parent);
+}
+
+static void _dodag_deadline(gnrc_rpl_dodag_t *dodag, uint32_t now)
+{
+    gnrc_rpl_instance_t *inst = dodag->instance;
+
+    if ((inst->cleanup != 0) && (inst->cleanup <= now)) {
+        inst->cleanup = 0;
+        if ((dodag->parents == NULL) && (dodag->my_rank == GNRC_RPL_INFINITE_RANK)) {
+            /* no parents - delete this instance and DODAG */
+            gnrc_rpl_instance_remove(inst);
+            return;
+        }
+    }
+
+    if ((int32_t)(dodag->dao_time - now) <= 0) {
+        _dao_handle_send(dodag);
+    }
+    gnrc_rpl_lifetime_dodag(dodag);
+}
+
+void _update_lifetime(void)
+{
+    priority_queue_node_t *node;
+    uint32_t now = gnrc_rpl_now_sec();
+
+    while (1) {
+        mutex_lock(&_lt_mutex);
+        node = _lt_queue.first;
+        if ((node == NULL) || (node->priority > now)) {
+            _lt_arm();
+            mutex_unlock(&_lt_mutex);
+            break;
+        }
+        priority_queue_remove_head(&_lt_queue);
+        mutex_unlock(&_lt_mutex);
+
+        switch (node->data) {
+            case _LT_PARENT:
+                _parent_deadline(container_of(node, gnrc_rpl_parent_t, deadline), now);
+                break;
+            case _LT_DODAG:
+                _dodag_deadline(container_of(node, gnrc_rpl_dodag_t, deadline), now);
+                break;
+#ifdef MODULE_GNRC_RPL_P2P
+            case _LT_P2P:
+                mutex_lock(&_lt_mutex);
+                _lt_p2p_queued = false;
+                mutex_unlock(&_lt_mutex);
+                if (gnrc_rpl_p2p_update()) {
+                    _lt_p2p_step();
+                }
+                break;
+#endif
+            default:
+                break;
+        }
+    }
 }
 
 void gnrc_rpl_delay_dao(gnrc_rpl_dodag_t *dodag)
 {
-    dodag->dao_time = GNRC_RPL_DEFAULT_DAO_DELAY;
+    dodag->dao_time = gnrc_rpl_now_sec() + GNRC_RPL_DEFAULT_DAO_DELAY;
     dodag->dao_counter = 0;
     dodag->dao_ack_received = false;
+    gnrc_rpl_lifetime_dodag(dodag);
 }
 
 void gnrc_rpl_long_delay_dao(gnrc_rpl_dodag_t *dodag)
 {
-    dodag->dao_time = GNRC_RPL_REGULAR_DAO_INTERVAL;
+    dodag->dao_time = gnrc_rpl_now_sec() + GNRC_RPL_REGULAR_DAO_INTERVAL;
     dodag->dao_counter = 0;
     dodag->dao_ack_received = false;
+    gnrc_rpl_lifetime_dodag(dodag);
 }
 
 void _dao_handle_send(gnrc_rpl_dodag_t *dodag)
@@ -326,7 +453,7 @@ void _dao_handle_send(gnrc_rpl_dodag_t *dodag)
     if ((dodag->dao_ack_received == false) && (dodag->dao_counter < GNRC_RPL_DAO_SEND_RETRIES)) {
         dodag->dao_counter++;
         gnrc_rpl_send_DAO(dodag->instance, NULL, dodag->default_lifetime);
-        dodag->dao_time = GNRC_RPL_DEFAULT_WAIT_FOR_DAO_ACK;
+        dodag->dao_time = gnrc_rpl_now_sec() + GNRC_RPL_DEFAULT_WAIT_FOR_DAO_ACK;
     }
     else if (dodag->dao_ack_received == false) {
         gnrc_rpl_long_delay_dao(dodag);
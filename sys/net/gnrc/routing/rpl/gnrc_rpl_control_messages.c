@@ -38,6 +38,10 @@
 #include "net/gnrc/rpl/p2p.h"
 #endif
 
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+#include "net/gnrc/rpl/srh.h"
+#endif
+
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
@@ -409,6 +413,11 @@ bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt
                               sizeof(ipv6_addr_t), FIB_FLAG_RPL_ROUTE,
                               (dodag->default_lifetime * dodag->lifetime_unit) *
                               SEC_IN_MS);
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+                /* the route to the target and its sub-DODAG may have changed,
+                 * drop them only now that the FIB holds the new route */
+                gnrc_rpl_srh_cache_invalidate(&target->target);
+#endif
                 break;
 
             case (GNRC_RPL_OPT_TRANSIT):
@@ -434,6 +443,9 @@ bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt
                                       0x0 : FIB_FLAG_RPL_ROUTE),
                                      (transit->path_lifetime *
                                       dodag->lifetime_unit * SEC_IN_MS));
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+                    gnrc_rpl_srh_cache_invalidate(&first_target->target);
+#endif
                     first_target = (gnrc_rpl_opt_target_t *) (((uint8_t *) (first_target)) +
                                    sizeof(gnrc_rpl_opt_t) + first_target->length);
                 }
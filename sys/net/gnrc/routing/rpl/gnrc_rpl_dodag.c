@@ -28,6 +28,7 @@
 #include "net/gnrc/rpl/p2p.h"
 #include "net/gnrc/rpl/p2p_dodag.h"
 #endif
+#include "gnrc_rpl_internal/lifetime.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -116,6 +117,7 @@ bool gnrc_rpl_instance_remove(gnrc_rpl_instance_t *inst)
 #endif
     gnrc_rpl_dodag_remove_all_parents(dodag);
     trickle_stop(&dodag->trickle);
+    gnrc_rpl_lifetime_remove(&dodag->deadline);
     memset(inst, 0, sizeof(gnrc_rpl_instance_t));
     return true;
 }
@@ -165,6 +167,7 @@ bool gnrc_rpl_dodag_init(gnrc_rpl_instance_t *instance, ipv6_addr_t *dodag_id, k
     }
 #endif
 
+    gnrc_rpl_lifetime_dodag(dodag);
     return true;
 }
 
@@ -203,6 +206,9 @@ bool gnrc_rpl_parent_add_by_addr(gnrc_rpl_dodag_t *dodag, ipv6_addr_t *addr,
         LL_APPEND(dodag->parents, *parent);
         (*parent)->state = 1;
         (*parent)->addr = *addr;
+        /* expires right away, unless gnrc_rpl_parent_update() follows */
+        (*parent)->lifetime = gnrc_rpl_now_sec();
+        gnrc_rpl_lifetime_parent(*parent);
         return true;
     }
 
@@ -225,7 +231,7 @@ bool gnrc_rpl_parent_remove(gnrc_rpl_parent_t *parent)
 
         /* set the default route to the next parent for now */
         if (parent->next) {
-            uint32_t now = xtimer_now_usec() / SEC_IN_USEC;
+            uint32_t now = gnrc_rpl_now_sec();
             fib_add_entry(&gnrc_ipv6_fib_table,
                           dodag->iface,
                           (uint8_t *) ipv6_addr_unspecified.u8,
@@ -238,6 +244,7 @@ bool gnrc_rpl_parent_remove(gnrc_rpl_parent_t *parent)
         }
     }
     LL_DELETE(dodag->parents, parent);
+    gnrc_rpl_lifetime_remove(&parent->deadline);
     memset(parent, 0, sizeof(gnrc_rpl_parent_t));
     return true;
 }
@@ -258,16 +265,22 @@ void gnrc_rpl_local_repair(gnrc_rpl_dodag_t *dodag)
     if (dodag->my_rank != GNRC_RPL_INFINITE_RANK) {
         dodag->my_rank = GNRC_RPL_INFINITE_RANK;
         trickle_reset_timer(&dodag->trickle);
-        dodag->instance->cleanup = GNRC_RPL_CLEANUP_TIME;
+        gnrc_rpl_instance_cleanup_start(dodag->instance);
     }
 }
 
+void gnrc_rpl_instance_cleanup_start(gnrc_rpl_instance_t *inst)
+{
+    inst->cleanup = gnrc_rpl_now_sec() + GNRC_RPL_CLEANUP_TIME;
+    gnrc_rpl_lifetime_dodag(&inst->dodag);
+}
+
 void gnrc_rpl_parent_update(gnrc_rpl_dodag_t *dodag, gnrc_rpl_parent_t *parent)
 {
     /* update Parent lifetime */
     if (parent != NULL) {
-        uint32_t now = xtimer_now_usec();
-        parent->lifetime = (now / SEC_IN_USEC) + (dodag->default_lifetime * dodag->lifetime_unit);
+        parent->lifetime = gnrc_rpl_now_sec() + (dodag->default_lifetime * dodag->lifetime_unit);
+        gnrc_rpl_lifetime_parent(parent);
 #ifdef MODULE_GNRC_RPL_P2P
         if (dodag->instance->mop != GNRC_RPL_P2P_MOP) {
 #endif
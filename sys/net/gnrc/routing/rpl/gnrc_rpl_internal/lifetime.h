@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_rpl
+ * @{
+ *
+ * @file
+ * @brief       RPL parent and DODAG deadlines
+ *
+ * The next lifetime event of every parent and DODAG is kept in one queue
+ * ordered by time. The RPL thread only wakes up when the earliest of them is
+ * due.
+ */
+
+#ifndef RPL_LIFETIME_H_
+#define RPL_LIFETIME_H_
+
+#include "net/gnrc/rpl/structs.h"
+#include "priority_queue.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Seconds since boot, the time base of all deadlines
+ */
+static inline uint32_t gnrc_rpl_now_sec(void)
+{
+    return (uint32_t)(xtimer_now_usec64() / SEC_IN_USEC);
+}
+
+/**
+ * @brief   (Re-)schedule the next lifetime event of a parent
+ *
+ * The parent is asked for a DIO 2 * GNRC_RPL_LIFETIME_UPDATE_STEP seconds
+ * before gnrc_rpl_parent_t::lifetime ends and removed
+ * GNRC_RPL_LIFETIME_UPDATE_STEP seconds before.
+ *
+ * @param[in] parent    Pointer to the parent
+ */
+void gnrc_rpl_lifetime_parent(gnrc_rpl_parent_t *parent);
+
+/**
+ * @brief   (Re-)schedule the next DAO or cleanup of a DODAG
+ *
+ * @param[in] dodag     Pointer to the DODAG
+ */
+void gnrc_rpl_lifetime_dodag(gnrc_rpl_dodag_t *dodag);
+
+/**
+ * @brief   Remove a parent or DODAG from the deadlines
+ *
+ * @param[in] node      gnrc_rpl_parent_t::deadline or gnrc_rpl_dodag_t::deadline
+ */
+void gnrc_rpl_lifetime_remove(priority_queue_node_t *node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RPL_LIFETIME_H_ */
+/** @} */
@@ -46,16 +46,18 @@ static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 gnrc_rpl_p2p_ext_t gnrc_rpl_p2p_exts[GNRC_RPL_P2P_EXTS_NUMOF];
 const uint8_t gnrc_rpl_p2p_lifetime_lookup[4] = { 1, 4, 16, 64 };
 
-void gnrc_rpl_p2p_update(void)
+bool gnrc_rpl_p2p_update(void)
 {
     gnrc_rpl_p2p_ext_t *p2p_ext;
+    bool in_use = false;
     for (uint8_t i = 0; i < GNRC_RPL_P2P_EXTS_NUMOF; ++i) {
         p2p_ext = &gnrc_rpl_p2p_exts[i];
+        in_use |= (p2p_ext->state != 0);
         if ((p2p_ext->state) && (p2p_ext->lifetime_sec > 0)) {
             p2p_ext->lifetime_sec -= GNRC_RPL_LIFETIME_UPDATE_STEP;
             if (p2p_ext->lifetime_sec <= 0) {
                 gnrc_rpl_dodag_remove_all_parents(p2p_ext->dodag);
-                p2p_ext->dodag->instance->cleanup = GNRC_RPL_CLEANUP_TIME;
+                gnrc_rpl_instance_cleanup_start(p2p_ext->dodag->instance);
                 continue;
             }
             p2p_ext->dro_delay -= GNRC_RPL_LIFETIME_UPDATE_STEP;
@@ -64,6 +66,7 @@ void gnrc_rpl_p2p_update(void)
             }
         }
     }
+    return in_use;
 }
 
 gnrc_rpl_instance_t *gnrc_rpl_p2p_root_init(uint8_t instance_id, ipv6_addr_t *dodag_id,
@@ -12,9 +12,14 @@
  * @file
  */
 
+#include <errno.h>
 #include <string.h>
 #include "net/gnrc/ipv6/netif.h"
 #include "net/gnrc/rpl/srh.h"
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+#include "mutex.h"
+#include "xtimer.h"
+#endif
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -26,6 +31,29 @@ static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 #define GNRC_RPL_SRH_PADDING(X)     ((X & 0xF0) >> 4)
 #define GNRC_RPL_SRH_COMPRE(X)      (X & 0x0F)
 #define GNRC_RPL_SRH_COMPRI(X)      ((X & 0xF0) >> 4)
+/* CmprI and CmprE are 4 bit fields */
+#define GNRC_RPL_SRH_COMPR_MAX      (15U)
+
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+#define GNRC_RPL_SRH_CACHE_BUF_LEN  (sizeof(gnrc_rpl_srh_t) + \
+                                     ((GNRC_RPL_SRH_CACHE_HOPS_MAX - 1) * sizeof(ipv6_addr_t)))
+
+typedef struct {
+    ipv6_addr_t dst;                /**< destination of the source route */
+    ipv6_addr_t next_hop;           /**< first hop, the prefixes are elided
+                                         against it */
+    uint64_t expires;               /**< end of the source route's lifetime,
+                                         0 if the entry is unused */
+    uint16_t len;                   /**< length of the header in srh */
+    uint8_t srh[GNRC_RPL_SRH_CACHE_BUF_LEN]; /**< the source routing header */
+} _srh_cache_t;
+
+static _srh_cache_t _cache[GNRC_RPL_SRH_CACHE_SIZE];
+static unsigned _cache_victim;
+/* counts invalidations, so headers built meanwhile are not cached */
+static unsigned _cache_gen;
+static mutex_t _cache_mutex = MUTEX_INIT;
+#endif
 
 int gnrc_rpl_srh_process(ipv6_hdr_t *ipv6, gnrc_rpl_srh_t *rh)
 {
@@ -93,4 +121,191 @@ int gnrc_rpl_srh_process(ipv6_hdr_t *ipv6, gnrc_rpl_srh_t *rh)
     return EXT_RH_CODE_FORWARD;
 }
 
+static uint8_t _compr(const ipv6_addr_t *a, const ipv6_addr_t *b)
+{
+    uint8_t octets = ipv6_addr_match_prefix(a, b) >> 3;
+
+    return (octets > GNRC_RPL_SRH_COMPR_MAX) ? GNRC_RPL_SRH_COMPR_MAX : octets;
+}
+
+int gnrc_rpl_srh_build(const ipv6_addr_t *route, size_t route_len, void *buf, size_t size)
+{
+    if (route_len < 2) {
+        return -EINVAL;
+    }
+
+    /* route[0] goes into the IPv6 header, the rest into the routing header */
+    size_t n = route_len - 1;
+    const ipv6_addr_t *dst = &route[n];
+    uint8_t compri = GNRC_RPL_SRH_COMPR_MAX, compre = _compr(&route[0], dst);
+
+    /* every intermediate address shares CmprI octets with route[0] and thereby
+     * with any IPv6 destination it is restored from */
+    for (size_t k = 1; k < n; k++) {
+        uint8_t compr = _compr(&route[0], &route[k]);
+        if (compr < compri) {
+            compri = compr;
+        }
+    }
+    if (n == 1) {
+        compri = compre;
+    }
+    else if (compri < compre) {
+        /* dst is restored from the last intermediate address */
+        compre = compri;
+    }
+
+    size_t addr_len = ((n - 1) * (sizeof(ipv6_addr_t) - compri)) +
+                      (sizeof(ipv6_addr_t) - compre);
+    uint8_t pad = (8 - (addr_len & 0x7)) & 0x7;
+    size_t len = sizeof(gnrc_rpl_srh_t) + addr_len + pad;
+
+    if ((n > UINT8_MAX) || ((len / 8) - 1 > UINT8_MAX)) {
+        return -EINVAL;
+    }
+    if (len > size) {
+        return -ENOBUFS;
+    }
+
+    gnrc_rpl_srh_t *rh = buf;
+    uint8_t *addr_vec = (uint8_t *) (rh + 1);
+
+    memset(rh, 0, len);
+    rh->len = (len / 8) - 1;
+    rh->type = GNRC_RPL_SRH_TYPE;
+    rh->seg_left = n;
+    rh->compr = (compri << 4) | compre;
+    rh->pad_resv = pad << 4;
+
+    for (size_t k = 1; k < n; k++) {
+        memcpy(addr_vec, &route[k].u8[compri], sizeof(ipv6_addr_t) - compri);
+        addr_vec += sizeof(ipv6_addr_t) - compri;
+    }
+    memcpy(addr_vec, &dst->u8[compre], sizeof(ipv6_addr_t) - compre);
+
+    return len;
+}
+
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+/* needs _cache_mutex */
+static bool _cache_on_path(const _srh_cache_t *entry, const ipv6_addr_t *addr)
+{
+    if (ipv6_addr_equal(&entry->dst, addr) || ipv6_addr_equal(&entry->next_hop, addr)) {
+        return true;
+    }
+    if (entry->len == 0) {
+        return false;
+    }
+
+    const gnrc_rpl_srh_t *rh = (const gnrc_rpl_srh_t *) entry->srh;
+    const uint8_t *addr_vec = (const uint8_t *) (rh + 1);
+    uint8_t compri = GNRC_RPL_SRH_COMPRI(rh->compr);
+
+    /* the last address is the destination, already compared */
+    for (uint8_t k = 0; k < rh->seg_left - 1; k++) {
+        ipv6_addr_t hop = entry->next_hop;
+        memcpy(&hop.u8[compri], addr_vec, sizeof(ipv6_addr_t) - compri);
+        if (ipv6_addr_equal(&hop, addr)) {
+            return true;
+        }
+        addr_vec += sizeof(ipv6_addr_t) - compri;
+    }
+    return false;
+}
+
+/* needs _cache_mutex */
+static int _cache_copy(const _srh_cache_t *entry, ipv6_addr_t *next_hop, void *buf, size_t size)
+{
+    if (entry->len > size) {
+        return -ENOBUFS;
+    }
+    *next_hop = entry->next_hop;
+    memcpy(buf, entry->srh, entry->len);
+    return entry->len;
+}
+
+int gnrc_rpl_srh_cache_get(fib_table_t *table, const ipv6_addr_t *dst,
+                           ipv6_addr_t *next_hop, void *buf, size_t size)
+{
+    uint64_t now = xtimer_now_usec64();
+    int res;
+
+    mutex_lock(&_cache_mutex);
+    for (unsigned i = 0; i < GNRC_RPL_SRH_CACHE_SIZE; i++) {
+        if ((_cache[i].expires != 0) && ipv6_addr_equal(&_cache[i].dst, dst)) {
+            if (_cache[i].expires > now) {
+                res = _cache_copy(&_cache[i], next_hop, buf, size);
+                mutex_unlock(&_cache_mutex);
+                return res;
+            }
+            _cache[i].expires = 0;
+            break;
+        }
+    }
+    unsigned gen = _cache_gen;
+    mutex_unlock(&_cache_mutex);
+
+    DEBUG("RPL SRH: building source routing header to %s\n",
+          ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)));
+
+    ipv6_addr_t route[GNRC_RPL_SRH_CACHE_HOPS_MAX];
+    size_t route_len = GNRC_RPL_SRH_CACHE_HOPS_MAX, addr_size = sizeof(ipv6_addr_t);
+    kernel_pid_t iface;
+    uint32_t flags = 0, lifetime;
+    fib_sr_t *sr = NULL;
+
+    res = fib_sr_get_route(table, (uint8_t *) dst->u8, sizeof(ipv6_addr_t), &iface, &flags,
+                           (uint8_t *) route, &route_len, &addr_size, false, &sr);
+    if (res == -ENOBUFS) {
+        return -ENOMEM;
+    }
+    if ((res < 0) || (route_len == 0) ||
+        (fib_sr_read_head(table, sr, &iface, &flags, &lifetime) < 0)) {
+        return -EHOSTUNREACH;
+    }
+
+    _srh_cache_t entry = { .dst = *dst, .next_hop = route[0] };
+
+    entry.expires = now + lifetime + 1;
+    if (route_len > 1) {
+        res = gnrc_rpl_srh_build(route, route_len, entry.srh, sizeof(entry.srh));
+        if (res < 0) {
+            return -ENOMEM;
+        }
+        entry.len = res;
+    }
+
+    mutex_lock(&_cache_mutex);
+    if (gen == _cache_gen) {
+        _srh_cache_t *slot = &_cache[_cache_victim];
+        for (unsigned i = 0; i < GNRC_RPL_SRH_CACHE_SIZE; i++) {
+            if (_cache[i].expires == 0) {
+                slot = &_cache[i];
+                break;
+            }
+        }
+        if (slot == &_cache[_cache_victim]) {
+            _cache_victim = (_cache_victim + 1) % GNRC_RPL_SRH_CACHE_SIZE;
+        }
+        *slot = entry;
+    }
+    res = _cache_copy(&entry, next_hop, buf, size);
+    mutex_unlock(&_cache_mutex);
+
+    return res;
+}
+
+void gnrc_rpl_srh_cache_invalidate(const ipv6_addr_t *addr)
+{
+    mutex_lock(&_cache_mutex);
+    _cache_gen++;
+    for (unsigned i = 0; i < GNRC_RPL_SRH_CACHE_SIZE; i++) {
+        if ((_cache[i].expires != 0) && ((addr == NULL) || _cache_on_path(&_cache[i], addr))) {
+            _cache[i].expires = 0;
+        }
+    }
+    mutex_unlock(&_cache_mutex);
+}
+#endif
+
 /** @} */
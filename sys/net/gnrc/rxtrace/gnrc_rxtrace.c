@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_rxtrace
+ * @{
+ *
+ * @file
+ * @}
+ */
+
+#include <string.h>
+
+#include "irq.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/rxtrace.h"
+#include "xtimer.h"
+
+typedef struct {
+    uint32_t count;     /* number of entries ever recorded */
+    gnrc_rxtrace_entry_t ring[GNRC_RXTRACE_RING_SIZE];
+    uint32_t hist[GNRC_RXTRACE_HIST_BUCKETS];
+} _trace_t;
+
+static _trace_t _traces[GNRC_RXTRACE_NUMOF];
+
+static unsigned _bucket(uint32_t delta)
+{
+    unsigned bucket = 0;
+
+    while (delta && (bucket < GNRC_RXTRACE_HIST_BUCKETS - 1)) {
+        delta >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void gnrc_rxtrace_point(gnrc_pktsnip_t *pkt, gnrc_rxtrace_hop_t hop)
+{
+    gnrc_pktsnip_t *netif = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_NETIF);
+    uint32_t now = xtimer_now_usec();
+    uint32_t delta = 0;
+
+    if (netif == NULL) {
+        return;
+    }
+
+    gnrc_netif_hdr_t *hdr = netif->data;
+    if (hop != GNRC_RXTRACE_NETDEV2) {
+        if (hdr->rxtrace == 0) {
+            /* header was not created by a traced network device */
+            return;
+        }
+        delta = now - hdr->rxtrace;
+    }
+    /* 0 marks untraced headers */
+    hdr->rxtrace = now ? now : 1;
+
+    /* tracepoints of one layer can run in threads of different priority
+     * (e.g. several network devices or sock users), so entries are claimed
+     * with interrupts disabled, which unlike a lock never blocks */
+    _trace_t *trace = &_traces[hop];
+    unsigned state = irq_disable();
+    gnrc_rxtrace_entry_t *entry =
+        &trace->ring[trace->count++ & (GNRC_RXTRACE_RING_SIZE - 1)];
+    entry->time = now;
+    entry->delta = delta;
+    trace->hist[_bucket(delta)]++;
+    irq_restore(state);
+}
+
+unsigned gnrc_rxtrace_read(gnrc_rxtrace_hop_t hop,
+                           gnrc_rxtrace_entry_t *entries, unsigned max)
+{
+    _trace_t *trace = &_traces[hop];
+    unsigned state = irq_disable();
+    uint32_t count = trace->count;
+    unsigned num = (count < GNRC_RXTRACE_RING_SIZE) ? count
+                                                    : GNRC_RXTRACE_RING_SIZE;
+
+    if (num > max) {
+        num = max;
+    }
+    for (unsigned i = 0; i < num; i++) {
+        entries[i] = trace->ring[(count - num + i) & (GNRC_RXTRACE_RING_SIZE - 1)];
+    }
+    irq_restore(state);
+
+    return num;
+}
+
+void gnrc_rxtrace_hist(gnrc_rxtrace_hop_t hop,
+                       uint32_t hist[GNRC_RXTRACE_HIST_BUCKETS])
+{
+    unsigned state = irq_disable();
+
+    memcpy(hist, _traces[hop].hist, sizeof(_traces[hop].hist));
+    irq_restore(state);
+}
+
+void gnrc_rxtrace_reset(void)
+{
+    unsigned state = irq_disable();
+
+    memset(_traces, 0, sizeof(_traces));
+    irq_restore(state);
+}
@@ -15,11 +15,14 @@
 
 #include <errno.h>
 
+#include "irq.h"
 #include "net/af.h"
 #include "net/ipv6/hdr.h"
 #include "net/gnrc/ipv6/hdr.h"
 #include "net/gnrc/ipv6/netif.h"
 #include "net/gnrc/netreg.h"
+#include "net/gnrc/rxtrace.h"
+#include "net/netstats.h"
 #include "net/udp.h"
 #include "utlist.h"
 #include "xtimer.h"
@@ -44,10 +47,140 @@ static void _callback_put(void *arg)
 }
 #endif
 
+#ifdef MODULE_GNRC_SOCK_RCVBUF
+static bool _rcvbuf_charge(gnrc_sock_reg_t *reg, size_t size)
+{
+    unsigned state = irq_disable();
+    bool fits = (reg->rcvbuf_size == 0) ||
+                ((reg->rcvbuf_used + size) <= reg->rcvbuf_size);
+
+    if (fits) {
+        reg->rcvbuf_used += size;
+    }
+    irq_restore(state);
+    return fits;
+}
+
+static void _rcvbuf_uncharge(gnrc_sock_reg_t *reg, size_t size)
+{
+    unsigned state = irq_disable();
+
+    reg->rcvbuf_used -= size;
+    irq_restore(state);
+}
+
+static void _rcvbuf_drop(gnrc_sock_reg_t *reg, gnrc_pktsnip_t *pkt)
+{
+    reg->rcvbuf_drops++;
+    NETSTATS_DROP(NETSTATS_DROP_AT_SOCK, NETSTATS_DROP_QUEUE_FULL);
+    gnrc_pktbuf_release(pkt);
+}
+
+static bool _rcvbuf_drop_oldest(gnrc_sock_reg_t *reg)
+{
+    gnrc_pktsnip_t *oldest = NULL;
+    unsigned state = irq_disable();
+    unsigned queued = cib_avail(&reg->mbox.cib);
+
+    /* rotate the queue once and take out the first packet on the way, so
+     * timeout messages for the receiver keep their place */
+    for (unsigned i = 0; i < queued; i++) {
+        msg_t msg;
+
+        mbox_try_get(&reg->mbox, &msg);
+        if ((oldest == NULL) && (msg.type == GNRC_NETAPI_MSG_TYPE_RCV)) {
+            oldest = msg.content.ptr;
+        }
+        else {
+            mbox_try_put(&reg->mbox, &msg);
+        }
+    }
+    irq_restore(state);
+
+    if (oldest == NULL) {
+        return false;
+    }
+    _rcvbuf_uncharge(reg, gnrc_pkt_len(oldest));
+    _rcvbuf_drop(reg, oldest);
+    return true;
+}
+
+static bool _rcvbuf_put(gnrc_sock_reg_t *reg, msg_t *msg)
+{
+    size_t size = gnrc_pkt_len(msg->content.ptr);
+
+    do {
+        /* charge first, so the receiver never uncharges before */
+        if (_rcvbuf_charge(reg, size)) {
+            if (mbox_try_put(&reg->mbox, msg)) {
+                return true;
+            }
+            _rcvbuf_uncharge(reg, size);
+        }
+    } while ((reg->rcvbuf_policy == GNRC_SOCK_DROP_OLDEST) &&
+             _rcvbuf_drop_oldest(reg));
+    _rcvbuf_drop(reg, msg->content.ptr);
+    return false;
+}
+
+void gnrc_sock_set_rcvbuf(gnrc_sock_reg_t *reg, size_t size,
+                          gnrc_sock_rcvbuf_policy_t policy)
+{
+    reg->rcvbuf_size = size;
+    reg->rcvbuf_policy = policy;
+}
+#endif
+
+#if defined(MODULE_GNRC_SOCK_RCVBUF) || defined(MODULE_SOCK_ASYNC)
+/* runs in the thread of the layer below the sock */
+static void _put(uint16_t cmd, gnrc_pktsnip_t *pkt, void *ctx)
+{
+    gnrc_sock_reg_t *reg = ctx;
+    msg_t msg;
+
+    msg.type = cmd;
+    msg.content.ptr = pkt;
+#ifdef MODULE_GNRC_SOCK_RCVBUF
+    if (!_rcvbuf_put(reg, &msg)) {
+        return;
+    }
+#else
+    if (!mbox_try_put(&reg->mbox, &msg)) {
+        NETSTATS_DROP(NETSTATS_DROP_AT_SOCK, NETSTATS_DROP_QUEUE_FULL);
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+#endif
+#ifdef MODULE_SOCK_ASYNC
+    gnrc_sock_reg_cb_t cb = reg->async_cb;
+
+    if (cb != NULL) {
+        cb(reg, SOCK_ASYNC_MSG_RECV);
+    }
+#endif
+}
+#endif
+
 void gnrc_sock_create(gnrc_sock_reg_t *reg, gnrc_nettype_t type, uint32_t demux_ctx)
 {
     mbox_init(&reg->mbox, reg->mbox_queue, SOCK_MBOX_SIZE);
+#ifdef MODULE_GNRC_SOCK_RCVBUF
+    reg->rcvbuf_size = GNRC_SOCK_RCVBUF_SIZE;
+    reg->rcvbuf_used = 0;
+    reg->rcvbuf_drops = 0;
+    reg->rcvbuf_policy = GNRC_SOCK_DROP_NEWEST;
+#endif
+#ifdef MODULE_SOCK_ASYNC
+    /* before registering: packets may be delivered right away */
+    reg->async_cb = NULL;
+#endif
+#if defined(MODULE_GNRC_SOCK_RCVBUF) || defined(MODULE_SOCK_ASYNC)
+    reg->cbd.cb = _put;
+    reg->cbd.ctx = reg;
+    gnrc_netreg_entry_init_cb(&reg->entry, demux_ctx, &reg->cbd);
+#else
     gnrc_netreg_entry_init_mbox(&reg->entry, demux_ctx, &reg->mbox);
+#endif
     gnrc_netreg_register(type, &reg->entry);
 }
 
@@ -80,6 +213,9 @@ ssize_t gnrc_sock_recv(gnrc_sock_reg_t *reg, gnrc_pktsnip_t **pkt_out,
     switch (msg.type) {
         case GNRC_NETAPI_MSG_TYPE_RCV:
             pkt = msg.content.ptr;
+#ifdef MODULE_GNRC_SOCK_RCVBUF
+            _rcvbuf_uncharge(reg, gnrc_pkt_len(pkt));
+#endif
             break;
 #ifdef MODULE_XTIMER
         case _TIMEOUT_MSG_TYPE:
@@ -107,6 +243,7 @@ ssize_t gnrc_sock_recv(gnrc_sock_reg_t *reg, gnrc_pktsnip_t **pkt_out,
         /* TODO: use API in #5511 */
         remote->netif = (uint16_t)netif_hdr->if_pid;
     }
+    gnrc_rxtrace_point(pkt, GNRC_RXTRACE_SOCK);
     *pkt_out = pkt; /* set out parameter */
     return 0;
 }
@@ -40,6 +40,38 @@ extern "C" {
 #define SOCK_MBOX_SIZE      (8)         /**< Size for gnrc_sock_reg_t::mbox_queue */
 #endif
 
+#if defined(MODULE_GNRC_SOCK_RCVBUF) || defined(DOXYGEN)
+/**
+ * @brief   Default limit for the bytes a sock may hold in the packet buffer
+ *          with `gnrc_sock_rcvbuf`
+ *
+ * 0 means no limit other than @ref SOCK_MBOX_SIZE packets.
+ */
+#ifndef GNRC_SOCK_RCVBUF_SIZE
+#define GNRC_SOCK_RCVBUF_SIZE   (GNRC_PKTBUF_SIZE / 4)
+#endif
+
+/**
+ * @brief   Packet to drop if the receive buffer of a sock is full
+ */
+typedef enum {
+    GNRC_SOCK_DROP_NEWEST = 0,          /**< drop the arriving packet */
+    GNRC_SOCK_DROP_OLDEST,              /**< drop queued packets until the
+                                         *   arriving one fits */
+} gnrc_sock_rcvbuf_policy_t;
+#endif
+
+#if defined(MODULE_SOCK_ASYNC) || defined(DOXYGEN)
+struct gnrc_sock_reg;
+
+/**
+ * @brief   Forwards an event to the callback of the sock owning @p reg
+ * @internal
+ */
+typedef void (*gnrc_sock_reg_cb_t)(struct gnrc_sock_reg *reg,
+                                   sock_async_flags_t flags);
+#endif
+
 /**
  * @brief   sock @ref net_gnrc_netreg info
  * @internal
@@ -51,6 +83,19 @@ typedef struct gnrc_sock_reg {
     gnrc_netreg_entry_t entry;          /**< @ref net_gnrc_netreg entry for mbox */
     mbox_t mbox;                        /**< @ref core_mbox target for the sock */
     msg_t mbox_queue[SOCK_MBOX_SIZE];   /**< queue for gnrc_sock_reg_t::mbox */
+#if defined(MODULE_GNRC_SOCK_RCVBUF) || defined(MODULE_SOCK_ASYNC) || \
+    defined(DOXYGEN)
+    gnrc_netreg_entry_cbd_t cbd;        /**< callback filling gnrc_sock_reg_t::mbox */
+#endif
+#if defined(MODULE_SOCK_ASYNC) || defined(DOXYGEN)
+    gnrc_sock_reg_cb_t async_cb;        /**< event forwarder, NULL if unset */
+#endif
+#if defined(MODULE_GNRC_SOCK_RCVBUF) || defined(DOXYGEN)
+    size_t rcvbuf_size;                 /**< limit in bytes, 0 for none */
+    size_t rcvbuf_used;                 /**< bytes of the queued packets */
+    uint32_t rcvbuf_drops;              /**< packets dropped on overflow */
+    uint8_t rcvbuf_policy;              /**< gnrc_sock_rcvbuf_policy_t */
+#endif
 } gnrc_sock_reg_t;
 
 /**
@@ -62,6 +107,10 @@ struct sock_ip {
     sock_ip_ep_t local;                 /**< local end-point */
     sock_ip_ep_t remote;                /**< remote end-point */
     uint16_t flags;                     /**< option flags */
+#if defined(MODULE_SOCK_ASYNC) || defined(DOXYGEN)
+    sock_ip_cb_t async_cb;              /**< event callback */
+    void *async_cb_arg;                 /**< argument for the event callback */
+#endif
 };
 
 /**
@@ -73,8 +122,34 @@ struct sock_udp {
     sock_udp_ep_t local;                /**< local end-point */
     sock_udp_ep_t remote;               /**< remote end-point */
     uint16_t flags;                     /**< option flags */
+#if defined(MODULE_SOCK_ASYNC) || defined(DOXYGEN)
+    sock_udp_cb_t async_cb;             /**< event callback */
+    void *async_cb_arg;                 /**< argument for the event callback */
+#endif
 };
 
+#if defined(MODULE_GNRC_SOCK_RCVBUF) || defined(DOXYGEN)
+/**
+ * @brief   Limits the bytes a sock may hold in the packet buffer
+ *
+ * Packets are charged with their full length, headers included, from the
+ * moment they are queued until they are received with sock_udp_recv() or
+ * sock_ip_recv(). Packets which do not fit are dropped according to
+ * @p policy and counted in gnrc_sock_reg_t::rcvbuf_drops.
+ *
+ * @note    Only available with `gnrc_sock_rcvbuf`. The limit is reset to
+ *          @ref GNRC_SOCK_RCVBUF_SIZE when the sock is bound, so call this
+ *          after creating the sock with a local end point, e.g.
+ *          `gnrc_sock_set_rcvbuf(&sock.reg, 512, GNRC_SOCK_DROP_OLDEST)`.
+ *
+ * @param[in] reg       the sock's netreg info
+ * @param[in] size      limit in bytes, 0 for no limit
+ * @param[in] policy    packet to drop if the limit is reached
+ */
+void gnrc_sock_set_rcvbuf(gnrc_sock_reg_t *reg, size_t size,
+                          gnrc_sock_rcvbuf_policy_t policy);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
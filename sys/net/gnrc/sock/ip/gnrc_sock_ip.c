@@ -196,4 +196,24 @@ ssize_t sock_ip_send(sock_ip_t *sock, const void *data, size_t len,
     return res;
 }
 
+#ifdef MODULE_SOCK_ASYNC
+static void _async_cb(gnrc_sock_reg_t *reg, sock_async_flags_t flags)
+{
+    sock_ip_t *sock = (sock_ip_t *)reg;
+
+    sock->async_cb(sock, flags, sock->async_cb_arg);
+}
+
+void sock_ip_set_cb(sock_ip_t *sock, sock_ip_cb_t cb, void *arg)
+{
+    assert(sock != NULL);
+    sock->reg.async_cb = NULL;
+    sock->async_cb = cb;
+    sock->async_cb_arg = arg;
+    if (cb != NULL) {
+        sock->reg.async_cb = _async_cb;
+    }
+}
+#endif
+
 /** @} */
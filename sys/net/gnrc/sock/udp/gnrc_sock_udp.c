@@ -32,6 +32,10 @@
 static sock_udp_t *_udp_socks = NULL;
 #endif
 
+#ifdef MODULE_SOCK_ASYNC
+static void _async_cb(gnrc_sock_reg_t *reg, sock_async_flags_t flags);
+#endif
+
 int sock_udp_create(sock_udp_t *sock, const sock_udp_ep_t *local,
                     const sock_udp_ep_t *remote, uint16_t flags)
 {
@@ -44,6 +48,9 @@ int sock_udp_create(sock_udp_t *sock, const sock_udp_ep_t *local,
         (local->netif != remote->netif)) {
         return -EINVAL;
     }
+#ifdef MODULE_SOCK_ASYNC
+    sock->async_cb = NULL;
+#endif
     memset(&sock->local, 0, sizeof(sock_udp_ep_t));
     if (local != NULL) {
 #ifdef MODULE_GNRC_SOCK_CHECK_REUSE
@@ -233,6 +240,12 @@ ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
             _udp_socks = sock;
 #endif
             gnrc_sock_create(&sock->reg, GNRC_NETTYPE_UDP, src_port);
+#ifdef MODULE_SOCK_ASYNC
+            /* keep a callback set before the sock was bound */
+            if (sock->async_cb != NULL) {
+                sock->reg.async_cb = _async_cb;
+            }
+#endif
         }
     }
     else {
@@ -281,4 +294,24 @@ ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
     return res - sizeof(udp_hdr_t);
 }
 
+#ifdef MODULE_SOCK_ASYNC
+static void _async_cb(gnrc_sock_reg_t *reg, sock_async_flags_t flags)
+{
+    sock_udp_t *sock = (sock_udp_t *)reg;
+
+    sock->async_cb(sock, flags, sock->async_cb_arg);
+}
+
+void sock_udp_set_cb(sock_udp_t *sock, sock_udp_cb_t cb, void *arg)
+{
+    assert(sock != NULL);
+    sock->reg.async_cb = NULL;
+    sock->async_cb = cb;
+    sock->async_cb_arg = arg;
+    if (cb != NULL) {
+        sock->reg.async_cb = _async_cb;
+    }
+}
+#endif
+
 /** @} */
@@ -25,9 +25,11 @@
 #include "thread.h"
 #include "utlist.h"
 #include "net/ipv6/hdr.h"
+#include "net/gnrc/rxtrace.h"
 #include "net/gnrc/udp.h"
 #include "net/gnrc.h"
 #include "net/inet_csum.h"
+#include "net/netstats.h"
 
 
 #define ENABLE_DEBUG    (0)
@@ -104,10 +106,13 @@ static void _receive(gnrc_pktsnip_t *pkt)
     udp_hdr_t *hdr;
     uint32_t port;
 
+    gnrc_rxtrace_point(pkt, GNRC_RXTRACE_UDP);
+
     /* mark UDP header */
     udp = gnrc_pktbuf_start_write(pkt);
     if (udp == NULL) {
         DEBUG("udp: unable to get write access to packet\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_UDP, NETSTATS_DROP_NOMEM);
         gnrc_pktbuf_release(pkt);
         return;
     }
@@ -126,6 +131,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
         udp = gnrc_pktbuf_mark(pkt, sizeof(udp_hdr_t), GNRC_NETTYPE_UDP);
         if (udp == NULL) {
             DEBUG("udp: error marking UDP header, dropping packet\n");
+            NETSTATS_DROP(NETSTATS_DROP_AT_UDP, NETSTATS_DROP_NOMEM);
             gnrc_pktbuf_release(pkt);
             return;
         }
@@ -142,11 +148,13 @@ static void _receive(gnrc_pktsnip_t *pkt)
          * and should log the error."
          */
         DEBUG("udp: received packet with zero checksum, dropping it\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_UDP, NETSTATS_DROP_CHECKSUM);
         gnrc_pktbuf_release(pkt);
         return;
     }
     if (_calc_csum(udp, ipv6, pkt) != 0xFFFF) {
         DEBUG("udp: received packet with invalid checksum, dropping it\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_UDP, NETSTATS_DROP_CHECKSUM);
         gnrc_pktbuf_release(pkt);
         return;
     }
@@ -157,6 +165,7 @@ static void _receive(gnrc_pktsnip_t *pkt)
     /* send payload to receivers */
     if (!gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UDP, port, pkt)) {
         DEBUG("udp: unable to forward packet as no one is interested in it\n");
+        NETSTATS_DROP(NETSTATS_DROP_AT_UDP, NETSTATS_DROP_NO_SUBSCRIBER);
         gnrc_pktbuf_release(pkt);
     }
 }
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_netstats
+ * @{
+ *
+ * @file
+ * @brief       Drop counters
+ * @}
+ */
+
+#include <string.h>
+
+#include "irq.h"
+#include "net/netstats.h"
+
+uint32_t netstats_drop[NETSTATS_DROP_AT_NUMOF][NETSTATS_DROP_NUMOF];
+
+void netstats_drop_snapshot(uint32_t counters[NETSTATS_DROP_AT_NUMOF][NETSTATS_DROP_NUMOF])
+{
+    unsigned state = irq_disable();
+
+    memcpy(counters, netstats_drop, sizeof(netstats_drop));
+    irq_restore(state);
+}
+
+void netstats_drop_reset(void)
+{
+    unsigned state = irq_disable();
+
+    memset(netstats_drop, 0, sizeof(netstats_drop));
+    irq_restore(state);
+}
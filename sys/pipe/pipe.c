@@ -31,13 +31,71 @@
 
 typedef unsigned (*ringbuffer_op_t)(ringbuffer_t *restrict rb, char *buf, unsigned n);
 
-static ssize_t pipe_rw(ringbuffer_t *rb,
+/* Must be called with interrupts disabled. Returns the priority of the woken
+ * thread or -1 if the watermark of the other side was not reached yet. */
+static int pipe_wake_other(pipe_t *pipe, int written)
+{
+    thread_t **other_op_blocked;
+
+    if (written) {
+        if (pipe->rb->avail < pipe->lowat) {
+            return -1;
+        }
+        other_op_blocked = &pipe->read_blocked;
+    }
+    else {
+        if (pipe->rb->avail > pipe->hiwat) {
+            return -1;
+        }
+        other_op_blocked = &pipe->write_blocked;
+    }
+
+    thread_t *other_thread = *other_op_blocked;
+    if (!other_thread) {
+        return -1;
+    }
+    *other_op_blocked = NULL;
+    sched_set_status(other_thread, STATUS_PENDING);
+    return other_thread->priority;
+}
+
+/* Must be called with interrupts disabled, restores them. Returns 0 if the
+ * current thread cannot sleep. */
+static int pipe_block(thread_t **this_op_blocked, unsigned old_state)
+{
+    if (*this_op_blocked || irq_is_in()) {
+        irq_restore(old_state);
+        return 0;
+    }
+
+    *this_op_blocked = (thread_t *) sched_active_thread;
+
+    sched_set_status((thread_t *) sched_active_thread, STATUS_SLEEPING);
+    irq_restore(old_state);
+    thread_yield_higher();
+    return 1;
+}
+
+/* Must be called with interrupts disabled, restores them. */
+static void pipe_done(pipe_t *pipe, int written, unsigned old_state)
+{
+    int other_prio = pipe_wake_other(pipe, written);
+
+    irq_restore(old_state);
+
+    if (other_prio >= 0) {
+        sched_switch(other_prio);
+    }
+}
+
+static ssize_t pipe_rw(pipe_t *pipe,
                        void *buf,
                        size_t n,
-                       thread_t **other_op_blocked,
-                       thread_t **this_op_blocked,
+                       int write,
                        ringbuffer_op_t ringbuffer_op)
 {
+    thread_t **this_op_blocked = write ? &pipe->write_blocked : &pipe->read_blocked;
+
     if (n == 0) {
         return 0;
     }
@@ -45,49 +103,104 @@ static ssize_t pipe_rw(ringbuffer_t *rb,
     while (1) {
         unsigned old_state = irq_disable();
 
-        unsigned count = ringbuffer_op(rb, buf, n);
+        unsigned count = ringbuffer_op(pipe->rb, buf, n);
 
         if (count > 0) {
-            thread_t *other_thread = *other_op_blocked;
-            int other_prio = -1;
-            if (other_thread) {
-                *other_op_blocked = NULL;
-                other_prio = other_thread->priority;
-                sched_set_status(other_thread, STATUS_PENDING);
-            }
-
-            irq_restore(old_state);
-
-            if (other_prio >= 0) {
-                sched_switch(other_prio);
-            }
-
+            pipe_done(pipe, write, old_state);
             return count;
         }
-        else if (*this_op_blocked || irq_is_in()) {
-            irq_restore(old_state);
+        else if (!pipe_block(this_op_blocked, old_state)) {
             return 0;
         }
-        else {
-            *this_op_blocked = (thread_t *) sched_active_thread;
-
-            sched_set_status((thread_t *) sched_active_thread, STATUS_SLEEPING);
-            irq_restore(old_state);
-            thread_yield_higher();
-        }
     }
 }
 
 ssize_t pipe_read(pipe_t *pipe, void *buf, size_t n)
 {
-    return pipe_rw(pipe->rb, (char *) buf, n,
-                   &pipe->write_blocked, &pipe->read_blocked, ringbuffer_get);
+    return pipe_rw(pipe, (char *) buf, n, 0, ringbuffer_get);
 }
 
 ssize_t pipe_write(pipe_t *pipe, const void *buf, size_t n)
 {
-    return pipe_rw(pipe->rb, (char *) buf, n,
-                   &pipe->read_blocked, &pipe->write_blocked, (ringbuffer_op_t) ringbuffer_add);
+    return pipe_rw(pipe, (char *) buf, n, 1, (ringbuffer_op_t) ringbuffer_add);
+}
+
+ssize_t pipe_splice_to(pipe_t *pipe, pipe_sink_t sink, void *arg, size_t n)
+{
+    if (n == 0) {
+        return 0;
+    }
+
+    while (1) {
+        unsigned old_state = irq_disable();
+
+        char *data;
+        unsigned count = ringbuffer_peek_span(pipe->rb, &data);
+
+        if (count > 0) {
+            /* the writer only appends, so the span stays valid */
+            irq_restore(old_state);
+
+            size_t len = (count < n) ? count : n;
+            ssize_t res = sink(arg, data, len);
+            if (res <= 0) {
+                return res;
+            }
+            if ((size_t)res > len) {
+                /* never move the ringbuffer past the span */
+                res = len;
+            }
+
+            old_state = irq_disable();
+            ringbuffer_remove(pipe->rb, res);
+            pipe_done(pipe, 0, old_state);
+            return res;
+        }
+        else if (!pipe_block(&pipe->read_blocked, old_state)) {
+            return 0;
+        }
+    }
+}
+
+ssize_t pipe_splice_from(pipe_t *pipe, pipe_source_t source, void *arg, size_t n)
+{
+    if (n == 0) {
+        return 0;
+    }
+
+    while (1) {
+        unsigned old_state = irq_disable();
+
+        char *data;
+        unsigned count = ringbuffer_reserve_span(pipe->rb, &data);
+
+        if (count > 0) {
+            /* the reader only consumes, so the span stays free */
+            irq_restore(old_state);
+
+            size_t len = (count < n) ? count : n;
+            ssize_t res = source(arg, data, len);
+            if (res <= 0) {
+                return res;
+            }
+            if ((size_t)res > len) {
+                /* never move the ringbuffer past the span */
+                res = len;
+            }
+
+            old_state = irq_disable();
+            if (ringbuffer_empty(pipe->rb)) {
+                /* draining the pipe may have rewound it meanwhile */
+                pipe->rb->start = data - pipe->rb->buf;
+            }
+            ringbuffer_commit_write(pipe->rb, res);
+            pipe_done(pipe, 1, old_state);
+            return res;
+        }
+        else if (!pipe_block(&pipe->write_blocked, old_state)) {
+            return 0;
+        }
+    }
 }
 
 void pipe_init(pipe_t *pipe, ringbuffer_t *rb, void (*free)(void *))
@@ -97,5 +210,29 @@ void pipe_init(pipe_t *pipe, ringbuffer_t *rb, void (*free)(void *))
         .read_blocked = NULL,
         .write_blocked = NULL,
         .free = free,
+        .lowat = 1,
+        .hiwat = rb->size - 1,
     };
 }
+
+void pipe_set_watermarks(pipe_t *pipe, unsigned lowat, unsigned hiwat)
+{
+    unsigned size = pipe->rb->size;
+    unsigned old_state = irq_disable();
+
+    pipe->lowat = (lowat < 1) ? 1 : ((lowat > size) ? size : lowat);
+    pipe->hiwat = (hiwat >= size) ? size - 1 : hiwat;
+
+    /* the new watermarks may already be met */
+    int reader_prio = pipe_wake_other(pipe, 1);
+    int writer_prio = pipe_wake_other(pipe, 0);
+
+    irq_restore(old_state);
+
+    if (reader_prio >= 0) {
+        sched_switch(reader_prio);
+    }
+    if (writer_prio >= 0) {
+        sched_switch(writer_prio);
+    }
+}
@@ -259,8 +259,9 @@ int _gnrc_rpl_dodag_show(void)
 
     gnrc_rpl_dodag_t *dodag = NULL;
     char addr_str[IPV6_ADDR_MAX_STR_LEN];
-    int8_t cleanup;
+    uint32_t cleanup;
     uint64_t tc, ti, xnow = xtimer_now_usec64();
+    uint32_t now_sec = (uint32_t) (xnow / SEC_IN_USEC);
 
     for (uint8_t i = 0; i < GNRC_RPL_INSTANCES_NUMOF; ++i) {
         if (gnrc_rpl_instances[i].state == 0) {
@@ -282,15 +283,22 @@ int _gnrc_rpl_dodag_show(void)
                 | dodag->trickle.msg_interval_timer.target) - xnow;
         ti = (int64_t) ti < 0 ? 0 : ti / SEC_IN_USEC;
 
-        cleanup = dodag->instance->cleanup < 0 ? 0 : dodag->instance->cleanup;
+        cleanup = 0;
+        if ((dodag->instance->cleanup != 0) && ((int32_t) (dodag->instance->cleanup - now_sec) > 0)) {
+            cleanup = dodag->instance->cleanup - now_sec;
+        }
 
-        printf("\tdodag [%s | R: %d | OP: %s | PIO: %s | CL: %ds | "
+        printf("\tdodag [%s | R: %d | OP: %s | PIO: %s | CL: %" PRIu32 "s | "
                "TR(I=[%d,%d], k=%d, c=%d, TC=%" PRIu32 "s, TI=%" PRIu32 "s)]\n",
                ipv6_addr_to_str(addr_str, &dodag->dodag_id, sizeof(addr_str)),
                dodag->my_rank, (dodag->node_status == GNRC_RPL_LEAF_NODE ? "Leaf" : "Router"),
                ((dodag->dio_opts & GNRC_RPL_REQ_DIO_OPT_PREFIX_INFO) ? "on" : "off"),
-               (int) cleanup, (1 << dodag->dio_min), dodag->dio_interval_doubl, dodag->trickle.k,
+               cleanup, (1 << dodag->dio_min), dodag->dio_interval_doubl,
+               trickle_get_k(&dodag->trickle),
                dodag->trickle.c, (uint32_t) (tc & 0xFFFFFFFF), (uint32_t) (ti & 0xFFFFFFFF));
+        printf("\ttrickle [DIO sent: %" PRIu32 " | suppressed: %" PRIu32 " | resets: %" PRIu32 "]\n",
+               dodag->trickle.stats.transmitted, dodag->trickle.stats.suppressed,
+               dodag->trickle.stats.resets);
 
 #ifdef MODULE_GNRC_RPL_P2P
         if (dodag->instance->mop == GNRC_RPL_P2P_MOP) {
@@ -306,8 +314,8 @@ int _gnrc_rpl_dodag_show(void)
         LL_FOREACH(gnrc_rpl_instances[i].dodag.parents, parent) {
             printf("\t\tparent [addr: %s | rank: %d | lifetime: %" PRIu32 "s]\n",
                     ipv6_addr_to_str(addr_str, &parent->addr, sizeof(addr_str)),
-                    parent->rank, ((int32_t) (parent->lifetime - (((uint32_t) xnow / SEC_IN_USEC))))
-                    < 0 ? 0 : (parent->lifetime - ((uint32_t) xnow / SEC_IN_USEC)));
+                    parent->rank, ((int32_t) (parent->lifetime - now_sec))
+                    < 0 ? 0 : (parent->lifetime - now_sec));
         }
     }
     return 0;
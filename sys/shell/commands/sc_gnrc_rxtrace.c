@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command to show the receive path latencies
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/gnrc/rxtrace.h"
+
+static const char *_hop_names[GNRC_RXTRACE_NUMOF] = {
+    "netdev2", "6lowpan", "ipv6", "udp", "sock"
+};
+
+static void _usage(char *cmd)
+{
+    printf("usage: * %s\n", cmd);
+    puts("         Prints per tracepoint latency histograms (us since the "
+         "previous tracepoint).");
+    printf("       * %s dump\n", cmd);
+    puts("         Prints the recorded entries in binary format as hex.");
+    printf("       * %s reset\n", cmd);
+    puts("         Clears all entries and histograms.");
+}
+
+static void _print_hist(void)
+{
+    uint32_t hist[GNRC_RXTRACE_NUMOF][GNRC_RXTRACE_HIST_BUCKETS];
+
+    printf("%8s", "< us");
+    for (unsigned hop = GNRC_RXTRACE_SIXLOWPAN; hop < GNRC_RXTRACE_NUMOF; hop++) {
+        gnrc_rxtrace_hist(hop, hist[hop]);
+        printf(" %10s", _hop_names[hop]);
+    }
+    puts("");
+
+    for (unsigned i = 0; i < GNRC_RXTRACE_HIST_BUCKETS; i++) {
+        if (i < GNRC_RXTRACE_HIST_BUCKETS - 1) {
+            printf("%8" PRIu32, (uint32_t)1 << i);
+        }
+        else {
+            printf("%8s", "more");
+        }
+        for (unsigned hop = GNRC_RXTRACE_SIXLOWPAN; hop < GNRC_RXTRACE_NUMOF; hop++) {
+            printf(" %10" PRIu32, hist[hop][i]);
+        }
+        puts("");
+    }
+}
+
+static void _put_le32(uint8_t *buf, uint32_t val)
+{
+    for (unsigned i = 0; i < 4; i++) {
+        buf[i] = val >> (8 * i);
+    }
+}
+
+static void _dump(void)
+{
+    gnrc_rxtrace_entry_t entries[GNRC_RXTRACE_RING_SIZE];
+    uint8_t record[GNRC_RXTRACE_RECORD_SIZE];
+
+    for (unsigned hop = 0; hop < GNRC_RXTRACE_NUMOF; hop++) {
+        unsigned num = gnrc_rxtrace_read(hop, entries, GNRC_RXTRACE_RING_SIZE);
+
+        for (unsigned i = 0; i < num; i++) {
+            record[0] = hop;
+            record[1] = 0;
+            _put_le32(&record[2], entries[i].time);
+            _put_le32(&record[6], entries[i].delta);
+            for (unsigned j = 0; j < sizeof(record); j++) {
+                printf("%02x", record[j]);
+            }
+            puts("");
+        }
+    }
+}
+
+int _gnrc_rxtrace(int argc, char **argv)
+{
+    if (argc < 2) {
+        _print_hist();
+    }
+    else if (strcmp("dump", argv[1]) == 0) {
+        _dump();
+    }
+    else if (strcmp("reset", argv[1]) == 0) {
+        gnrc_rxtrace_reset();
+    }
+    else {
+        _usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
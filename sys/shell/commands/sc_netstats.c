@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command to show the per layer drop counters
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/netstats.h"
+
+static const char *_layer_names[NETSTATS_DROP_AT_NUMOF] = {
+    "l2", "6lowpan", "ipv6", "udp", "sock"
+};
+
+static const char *_reason_names[NETSTATS_DROP_NUMOF] = {
+    "nomem", "queue", "no_sub", "nc_inc", "reass", "csum", "invalid"
+};
+
+static void _print(void)
+{
+    uint32_t counters[NETSTATS_DROP_AT_NUMOF][NETSTATS_DROP_NUMOF];
+
+    netstats_drop_snapshot(counters);
+
+    printf("%8s", "");
+    for (unsigned reason = 0; reason < NETSTATS_DROP_NUMOF; reason++) {
+        printf(" %10s", _reason_names[reason]);
+    }
+    puts("");
+
+    for (unsigned layer = 0; layer < NETSTATS_DROP_AT_NUMOF; layer++) {
+        printf("%8s", _layer_names[layer]);
+        for (unsigned reason = 0; reason < NETSTATS_DROP_NUMOF; reason++) {
+            printf(" %10" PRIu32, counters[layer][reason]);
+        }
+        puts("");
+    }
+}
+
+int _netstats_drop(int argc, char **argv)
+{
+    if (argc < 2) {
+        _print();
+    }
+    else if (strcmp("reset", argv[1]) == 0) {
+        netstats_drop_reset();
+    }
+    else {
+        printf("usage: %s [reset]\n", argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -122,6 +122,14 @@ extern int _gnrc_6ctx(int argc, char **argv);
 #endif
 #endif
 
+#ifdef MODULE_GNRC_RXTRACE
+extern int _gnrc_rxtrace(int argc, char **argv);
+#endif
+
+#ifdef MODULE_NETSTATS_DROP
+extern int _netstats_drop(int argc, char **argv);
+#endif
+
 #ifdef MODULE_CCN_LITE_UTILS
 extern int _ccnl_open(int argc, char **argv);
 extern int _ccnl_content(int argc, char **argv);
@@ -209,6 +217,12 @@ const shell_command_t _shell_command_list[] = {
     {"6ctx", "6LoWPAN context configuration tool", _gnrc_6ctx },
 #endif
 #endif
+#ifdef MODULE_GNRC_RXTRACE
+    {"rxtrace", "receive path latencies ('rxtrace [dump|reset|help]')", _gnrc_rxtrace },
+#endif
+#ifdef MODULE_NETSTATS_DROP
+    {"netstats", "dropped packets per layer and reason ('netstats [reset]')", _netstats_drop },
+#endif
 #ifdef MODULE_SAUL_REG
     {"saul", "interact with sensors and actuators using SAUL", _saul },
 #endif
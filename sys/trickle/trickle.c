@@ -24,15 +24,77 @@
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
+#ifdef MODULE_TRICKLE_ADAPTIVE
+/* exponentially weighted moving average with a weight of 1/8 for the sample,
+ * given in units of 1/8 of the average */
+static inline uint16_t _ewma(uint16_t avg, uint16_t sample)
+{
+    return avg - (avg / 8) + sample;
+}
+
+/* estimated number of neighbors in 1/8: we hear c messages per interval while
+ * sending our own with a probability of (1 - suppression) */
+static uint32_t _neighbors(trickle_t *trickle)
+{
+    uint32_t tx_share = 256 - trickle->adaptive.suppression;
+
+    return ((uint32_t)trickle->adaptive.heard * 256) / (tx_share ? tx_share : 1);
+}
+
+static void _adapt_interval_end(trickle_t *trickle)
+{
+    trickle_adaptive_t *a = &trickle->adaptive;
+    uint32_t neighbors;
+
+    a->heard = _ewma(a->heard, (trickle->c > UINT8_MAX) ? UINT8_MAX : trickle->c);
+    a->inconsistency = _ewma(a->inconsistency, 0);
+
+    /* shrink k proportionally to the neighbors beyond TRICKLE_ADAPTIVE_DENSITY */
+    neighbors = _neighbors(trickle);
+    a->k = trickle->k;
+    if (neighbors > TRICKLE_ADAPTIVE_DENSITY * 8) {
+        uint32_t k = (trickle->k * TRICKLE_ADAPTIVE_DENSITY * 8) / neighbors;
+        a->k = (k > 0) ? k : 1;
+    }
+
+    DEBUG("trickle: neighbors == %" PRIu32 "/8, k == %u\n", neighbors, a->k);
+}
+
+static uint32_t _adapt_imin(trickle_t *trickle, uint32_t Imin)
+{
+    uint32_t neighbors = _neighbors(trickle);
+
+    if (trickle->adaptive.inconsistency < TRICKLE_ADAPTIVE_INCONSISTENT) {
+        return Imin;
+    }
+    if (neighbors > TRICKLE_ADAPTIVE_DENSITY * 8) {
+        return Imin * 2;
+    }
+    return (Imin > 1) ? (Imin / 2) : Imin;
+}
+#endif
+
 void trickle_callback(trickle_t *trickle)
 {
+    uint8_t k = trickle_get_k(trickle);
+
     /* Handle k=0 like k=infinity (according to RFC6206, section 6.5) */
-    if ((trickle->c < trickle->k) || (trickle->k == 0)) {
+    if ((trickle->c < k) || (k == 0)) {
+        trickle->stats.transmitted++;
+#ifdef MODULE_TRICKLE_ADAPTIVE
+        trickle->adaptive.suppression = _ewma(trickle->adaptive.suppression, 0);
+#endif
         (*trickle->callback.func)(trickle->callback.args);
     }
+    else {
+        trickle->stats.suppressed++;
+#ifdef MODULE_TRICKLE_ADAPTIVE
+        trickle->adaptive.suppression = _ewma(trickle->adaptive.suppression, 32);
+#endif
+    }
 }
 
-void trickle_interval(trickle_t *trickle)
+static void _trickle_next_interval(trickle_t *trickle)
 {
     uint32_t max_interval;
 
@@ -57,8 +119,20 @@ void trickle_interval(trickle_t *trickle)
                      &trickle->msg_interval, trickle->pid);
 }
 
+void trickle_interval(trickle_t *trickle)
+{
+#ifdef MODULE_TRICKLE_ADAPTIVE
+    _adapt_interval_end(trickle);
+#endif
+    _trickle_next_interval(trickle);
+}
+
 void trickle_reset_timer(trickle_t *trickle)
 {
+    trickle->stats.resets++;
+#ifdef MODULE_TRICKLE_ADAPTIVE
+    trickle->adaptive.inconsistency = _ewma(trickle->adaptive.inconsistency, 32);
+#endif
     trickle_stop(trickle);
     trickle_start(trickle->pid, trickle, trickle->msg_interval.type, trickle->msg_callback.type,
                   trickle->Imin, trickle->Imax, trickle->k);
@@ -73,14 +147,17 @@ void trickle_start(kernel_pid_t pid, trickle_t *trickle, uint16_t interval_msg_t
     trickle->k = k;
     trickle->Imin = Imin;
     trickle->Imax = Imax;
-    trickle->I = trickle->Imin + random_uint32_range(0, 4 * trickle->Imin);
+#ifdef MODULE_TRICKLE_ADAPTIVE
+    Imin = _adapt_imin(trickle, Imin);
+#endif
+    trickle->I = Imin + random_uint32_range(0, 4 * Imin);
     trickle->pid = pid;
     trickle->msg_interval.content.ptr = trickle;
     trickle->msg_interval.type = interval_msg_type;
     trickle->msg_callback.content.ptr = trickle;
     trickle->msg_callback.type = callback_msg_type;
 
-    trickle_interval(trickle);
+    _trickle_next_interval(trickle);
 }
 
 void trickle_stop(trickle_t *trickle)
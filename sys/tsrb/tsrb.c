@@ -17,21 +17,39 @@
  * @}
  */
 
+#include <string.h>
+
 #include "tsrb.h"
 
+/* Orders the accesses to the buffer content against the update of the
+ * read/write counters, so one producer and one consumer can run concurrently
+ * (e.g. thread and ISR, or two host threads on native). Targets without
+ * hardware atomics are single core, a compiler barrier suffices there. */
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && (__GCC_ATOMIC_INT_LOCK_FREE == 2)
+#define _barrier()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define _barrier()  __asm__ volatile ("" : : : "memory")
+#endif
+
 static void _push(tsrb_t *rb, char c)
 {
-    rb->buf[rb->writes++ & (rb->size - 1)] = c;
+    rb->buf[rb->writes & (rb->size - 1)] = c;
+    _barrier();
+    rb->writes++;
 }
 
 static char _pop(tsrb_t *rb)
 {
-    return rb->buf[rb->reads++ & (rb->size - 1)];
+    char c = rb->buf[rb->reads & (rb->size - 1)];
+    _barrier();
+    rb->reads++;
+    return c;
 }
 
 int tsrb_get_one(tsrb_t *rb)
 {
     if (!tsrb_empty(rb)) {
+        _barrier();
         return _pop(rb);
     }
     else {
@@ -41,17 +59,36 @@ int tsrb_get_one(tsrb_t *rb)
 
 int tsrb_get(tsrb_t *rb, char *dst, size_t n)
 {
-    size_t tmp = n;
-    while (tmp && !tsrb_empty(rb)) {
-        *dst++ = _pop(rb);
-        tmp--;
+    unsigned avail = tsrb_avail(rb);
+
+    if (n > avail) {
+        n = avail;
+    }
+    if (n == 0) {
+        return 0;
     }
-    return (n - tmp);
+    _barrier();
+
+    unsigned start = rb->reads & (rb->size - 1);
+    size_t chunk = rb->size - start;
+
+    if (chunk >= n) {
+        memcpy(dst, &rb->buf[start], n);
+    }
+    else {
+        memcpy(dst, &rb->buf[start], chunk);
+        memcpy(dst + chunk, rb->buf, n - chunk);
+    }
+
+    _barrier();
+    rb->reads += n;
+    return n;
 }
 
 int tsrb_add_one(tsrb_t *rb, char c)
 {
     if (!tsrb_full(rb)) {
+        _barrier();
         _push(rb, c);
         return 0;
     }
@@ -62,10 +99,62 @@ int tsrb_add_one(tsrb_t *rb, char c)
 
 int tsrb_add(tsrb_t *rb, const char *src, size_t n)
 {
-    size_t tmp = n;
-    while (tmp && !tsrb_full(rb)) {
-        _push(rb, *src++);
-        tmp--;
+    unsigned space = tsrb_free(rb);
+
+    if (n > space) {
+        n = space;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    _barrier();
+
+    unsigned start = rb->writes & (rb->size - 1);
+    size_t chunk = rb->size - start;
+
+    if (chunk >= n) {
+        memcpy(&rb->buf[start], src, n);
     }
-    return (n - tmp);
+    else {
+        memcpy(&rb->buf[start], src, chunk);
+        memcpy(rb->buf, src + chunk, n - chunk);
+    }
+
+    _barrier();
+    rb->writes += n;
+    return n;
+}
+
+unsigned tsrb_peek_span(const tsrb_t *rb, char **data)
+{
+    unsigned avail = tsrb_avail(rb);
+    unsigned start = rb->reads & (rb->size - 1);
+
+    _barrier();
+    *data = &rb->buf[start];
+    return (avail < rb->size - start) ? avail : rb->size - start;
+}
+
+void tsrb_commit_read(tsrb_t *rb, unsigned n)
+{
+    assert(n <= tsrb_avail(rb));
+    _barrier();
+    rb->reads += n;
+}
+
+unsigned tsrb_reserve_span(const tsrb_t *rb, char **data)
+{
+    unsigned space = tsrb_free(rb);
+    unsigned start = rb->writes & (rb->size - 1);
+
+    _barrier();
+    *data = &rb->buf[start];
+    return (space < rb->size - start) ? space : rb->size - start;
+}
+
+void tsrb_commit_write(tsrb_t *rb, unsigned n)
+{
+    assert(n <= tsrb_free(rb));
+    _barrier();
+    rb->writes += n;
 }
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_ubjson
+ * @{
+ * @file
+ * @brief       Schema based struct serializer for UBJSON
+ * @}
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "ubjson-internal.h"
+#include "ubjson.h"
+
+static size_t _text_len(const struct_codec_field_t *field, const char *text)
+{
+    const char *end = memchr(text, '\0', field->size);
+
+    return end ? (size_t)(end - text) : field->size;
+}
+
+/**
+ * Encodes @p value with the smallest integer marker into @p out
+ *
+ * @return  Number of bytes needed, nothing is written if @p out is NULL
+ */
+static size_t _put_int(uint8_t *out, int64_t value)
+{
+    uint8_t marker;
+    unsigned len;
+
+    if ((INT8_MIN <= value) && (value <= INT8_MAX)) {
+        marker = UBJSON_MARKER_INT8;
+        len = 1;
+    }
+    else if ((0 <= value) && (value <= UINT8_MAX)) {
+        marker = UBJSON_MARKER_UINT8;
+        len = 1;
+    }
+    else if ((INT16_MIN <= value) && (value <= INT16_MAX)) {
+        marker = UBJSON_MARKER_INT16;
+        len = 2;
+    }
+    else if ((INT32_MIN <= value) && (value <= INT32_MAX)) {
+        marker = UBJSON_MARKER_INT32;
+        len = 4;
+    }
+    else {
+        marker = UBJSON_MARKER_INT64;
+        len = 8;
+    }
+
+    if (out) {
+        *(out++) = marker;
+        for (int i = len - 1; i >= 0; --i) {
+            *(out++) = ((uint64_t)value >> (8 * i)) & 0xff;
+        }
+    }
+
+    return len + 1;
+}
+
+/**
+ * Decodes an integer of any width from @p in
+ *
+ * @return  Number of bytes read, 0 on error
+ */
+static size_t _get_int(const uint8_t *in, size_t left, int64_t *value)
+{
+    unsigned len;
+
+    if (left < 1) {
+        return 0;
+    }
+
+    switch (in[0]) {
+        case UBJSON_MARKER_INT8:
+        case UBJSON_MARKER_UINT8:
+            len = 1;
+            break;
+        case UBJSON_MARKER_INT16:
+            len = 2;
+            break;
+        case UBJSON_MARKER_INT32:
+            len = 4;
+            break;
+        case UBJSON_MARKER_INT64:
+            len = 8;
+            break;
+        default:
+            return 0;
+    }
+
+    if (left < len + 1) {
+        return 0;
+    }
+
+    uint64_t raw = 0;
+    for (unsigned i = 1; i <= len; i++) {
+        raw = (raw << 8) | in[i];
+    }
+
+    switch (in[0]) {
+        case UBJSON_MARKER_INT8:
+            *value = (int8_t)raw;
+            break;
+        case UBJSON_MARKER_INT16:
+            *value = (int16_t)raw;
+            break;
+        case UBJSON_MARKER_INT32:
+            *value = (int32_t)raw;
+            break;
+        default:
+            *value = (int64_t)raw;
+            break;
+    }
+
+    return len + 1;
+}
+
+/**
+ * Gets the integer value of integer member @p member
+ *
+ * @return  0 on success, -EINVAL if the value does not fit into an int64_t
+ */
+static int _member_int(const struct_codec_field_t *field, const void *member,
+                       int64_t *value)
+{
+    switch (field->type) {
+        case STRUCT_CODEC_INT32:
+            *value = *(const int32_t *)member;
+            break;
+        case STRUCT_CODEC_UINT32:
+            *value = *(const uint32_t *)member;
+            break;
+        case STRUCT_CODEC_INT64:
+            *value = *(const int64_t *)member;
+            break;
+        default: /* STRUCT_CODEC_UINT64 */
+            if (*(const uint64_t *)member > INT64_MAX) {
+                return -EINVAL;
+            }
+            *value = (int64_t)*(const uint64_t *)member;
+            break;
+    }
+
+    return 0;
+}
+
+ssize_t ubjson_codec_size(const struct_codec_t *codec, const void *val)
+{
+    /* object start and end markers */
+    ssize_t size = 2;
+
+    for (unsigned i = 0; i < codec->numof; i++) {
+        const struct_codec_field_t *field = &codec->fields[i];
+        const uint8_t *member = (const uint8_t *)val + field->offset;
+        int64_t value;
+        size_t len;
+
+        size += _put_int(NULL, field->key_len) + field->key_len;
+
+        switch (field->type) {
+            case STRUCT_CODEC_BOOL:
+                size += 1;
+                break;
+            case STRUCT_CODEC_FLOAT:
+                size += 5;
+                break;
+            case STRUCT_CODEC_TEXT:
+                len = _text_len(field, (const char *)member);
+                size += 1 + _put_int(NULL, len) + len;
+                break;
+            default:
+                if (_member_int(field, member, &value) < 0) {
+                    return -EINVAL;
+                }
+                size += _put_int(NULL, value);
+                break;
+        }
+    }
+
+    return size;
+}
+
+ssize_t ubjson_codec_encode(const struct_codec_t *codec, const void *val,
+                            void *buf, size_t size)
+{
+    ssize_t res = ubjson_codec_size(codec, val);
+
+    if (res < 0) {
+        return res;
+    }
+    if ((size_t)res > size) {
+        return -ENOBUFS;
+    }
+
+    /* the whole object fits, no need to check the size anymore */
+    uint8_t *out = buf;
+
+    *(out++) = UBJSON_MARKER_OBJECT_START;
+    for (unsigned i = 0; i < codec->numof; i++) {
+        const struct_codec_field_t *field = &codec->fields[i];
+        const uint8_t *member = (const uint8_t *)val + field->offset;
+        int64_t value;
+        uint32_t bits;
+        size_t len;
+
+        out += _put_int(out, field->key_len);
+        memcpy(out, field->key, field->key_len);
+        out += field->key_len;
+
+        switch (field->type) {
+            case STRUCT_CODEC_BOOL:
+                *(out++) = *(const bool *)member ? UBJSON_MARKER_TRUE
+                                                 : UBJSON_MARKER_FALSE;
+                break;
+            case STRUCT_CODEC_FLOAT:
+                memcpy(&bits, member, sizeof(bits));
+                *(out++) = UBJSON_MARKER_FLOAT32;
+                for (int j = 3; j >= 0; --j) {
+                    *(out++) = (bits >> (8 * j)) & 0xff;
+                }
+                break;
+            case STRUCT_CODEC_TEXT:
+                len = _text_len(field, (const char *)member);
+                *(out++) = UBJSON_MARKER_STRING;
+                out += _put_int(out, len);
+                memcpy(out, member, len);
+                out += len;
+                break;
+            default:
+                _member_int(field, member, &value);
+                out += _put_int(out, value);
+                break;
+        }
+    }
+    *(out++) = UBJSON_MARKER_OBJECT_END;
+
+    return res;
+}
+
+ssize_t ubjson_codec_decode(const struct_codec_t *codec, void *val,
+                            const void *buf, size_t size)
+{
+    const uint8_t *in = buf, *end = in + size;
+
+    if ((size < 2) || (*(in++) != UBJSON_MARKER_OBJECT_START)) {
+        return -EBADMSG;
+    }
+
+    for (unsigned i = 0; i < codec->numof; i++) {
+        const struct_codec_field_t *field = &codec->fields[i];
+        uint8_t *member = (uint8_t *)val + field->offset;
+        int64_t value;
+        uint32_t bits;
+        size_t read;
+
+        /* key */
+        read = _get_int(in, end - in, &value);
+        if (!read || (value != field->key_len) ||
+            ((size_t)(end - in) < read + field->key_len + 1) ||
+            (memcmp(in + read, field->key, field->key_len) != 0)) {
+            return -EBADMSG;
+        }
+        in += read + field->key_len;
+
+        /* value, at least one byte is available */
+        switch (field->type) {
+            case STRUCT_CODEC_BOOL:
+                if ((*in != UBJSON_MARKER_TRUE) && (*in != UBJSON_MARKER_FALSE)) {
+                    return -EBADMSG;
+                }
+                *(bool *)member = (*(in++) == UBJSON_MARKER_TRUE);
+                break;
+            case STRUCT_CODEC_FLOAT:
+                if ((*in != UBJSON_MARKER_FLOAT32) || (end - in < 5)) {
+                    return -EBADMSG;
+                }
+                bits = ((uint32_t)in[1] << 24) | ((uint32_t)in[2] << 16) |
+                       ((uint32_t)in[3] << 8) | in[4];
+                memcpy(member, &bits, sizeof(bits));
+                in += 5;
+                break;
+            case STRUCT_CODEC_TEXT:
+                if (*(in++) != UBJSON_MARKER_STRING) {
+                    return -EBADMSG;
+                }
+                read = _get_int(in, end - in, &value);
+                if (!read || (value < 0) || (value >= field->size) ||
+                    ((size_t)(end - in) - read < (size_t)value)) {
+                    return -EBADMSG;
+                }
+                memcpy(member, in + read, (size_t)value);
+                member[value] = '\0';
+                in += read + value;
+                break;
+            default:
+                read = _get_int(in, end - in, &value);
+                if (!read) {
+                    return -EBADMSG;
+                }
+                switch (field->type) {
+                    case STRUCT_CODEC_INT32:
+                        if ((value < INT32_MIN) || (value > INT32_MAX)) {
+                            return -EBADMSG;
+                        }
+                        *(int32_t *)member = (int32_t)value;
+                        break;
+                    case STRUCT_CODEC_UINT32:
+                        if ((value < 0) || (value > UINT32_MAX)) {
+                            return -EBADMSG;
+                        }
+                        *(uint32_t *)member = (uint32_t)value;
+                        break;
+                    case STRUCT_CODEC_INT64:
+                        *(int64_t *)member = value;
+                        break;
+                    default: /* STRUCT_CODEC_UINT64 */
+                        if (value < 0) {
+                            return -EBADMSG;
+                        }
+                        *(uint64_t *)member = (uint64_t)value;
+                        break;
+                }
+                in += read;
+                break;
+        }
+    }
+
+    if ((in >= end) || (*(in++) != UBJSON_MARKER_OBJECT_END)) {
+        return -EBADMSG;
+    }
+
+    return in - (const uint8_t *)buf;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup   tests
+ * @{
+ *
+ * @file
+ * @brief     Measures the throughput of the base64 encoder and decoder
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "base64.h"
+#include "xtimer.h"
+
+#define TIMEOUT_S (2ul)
+#define TIMEOUT (TIMEOUT_S * SEC_IN_USEC)
+
+#define BLOB_SIZE (768U)
+#define CHUNK_SIZE (100U)
+
+static unsigned char blob[BLOB_SIZE];
+static unsigned char encoded[BASE64_ENCODE_UPDATE_SIZE(BLOB_SIZE)];
+static unsigned char decoded[BLOB_SIZE];
+
+static void encode(void)
+{
+    size_t size = sizeof(encoded);
+    base64_encode(blob, sizeof(blob), encoded, &size);
+}
+
+static void decode(void)
+{
+    size_t size = sizeof(decoded);
+    base64_decode(encoded, sizeof(encoded), decoded, &size);
+}
+
+static void encode_chunked(void)
+{
+    base64_encoder_t enc;
+    size_t len = 0;
+
+    base64_encode_init(&enc);
+    for (unsigned pos = 0; pos < BLOB_SIZE; pos += CHUNK_SIZE) {
+        unsigned n = (BLOB_SIZE - pos < CHUNK_SIZE) ? BLOB_SIZE - pos : CHUNK_SIZE;
+        len += base64_encode_update(&enc, &blob[pos], n, &encoded[len]);
+    }
+    base64_encode_final(&enc, &encoded[len]);
+}
+
+static void decode_chunked(void)
+{
+    base64_decoder_t dec;
+    size_t len = 0;
+
+    base64_decode_init(&dec);
+    for (unsigned pos = 0; pos < sizeof(encoded); pos += CHUNK_SIZE) {
+        unsigned n = (sizeof(encoded) - pos < CHUNK_SIZE) ? sizeof(encoded) - pos
+                                                          : CHUNK_SIZE;
+        len += base64_decode_update(&dec, &encoded[pos], n, &decoded[len]);
+    }
+    base64_decode_final(&dec, &decoded[len]);
+}
+
+static void callback(void *done_)
+{
+    volatile int *done = done_;
+    *done = 1;
+}
+
+static void run_test(const char *name, void (*test)(void))
+{
+    volatile int done = 0;
+    unsigned long count = 0;
+
+    xtimer_t xtimer;
+    xtimer.callback = callback;
+    xtimer.arg = (void *) &done;
+
+    xtimer_set(&xtimer, TIMEOUT);
+
+    do {
+        test();
+        ++count;
+    } while (done == 0);
+
+    printf("+ %s: %lu bytes per second\n", name,
+           (count * BLOB_SIZE) / TIMEOUT_S);
+}
+
+#define run_test(test) run_test(#test, test)
+
+int main(void)
+{
+    puts("Start.");
+
+    for (unsigned i = 0; i < BLOB_SIZE; i++) {
+        blob[i] = i * 13;
+    }
+
+    run_test(encode);
+    run_test(encode_chunked);
+    run_test(decode);
+    run_test(decode_chunked);
+
+    puts("Done.");
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup   tests
+ * @{
+ *
+ * @file
+ * @brief     Measures the request rate of gcoap with many requests in flight
+ *
+ * The client keeps GCOAP_REQ_WAITING_MAX requests open against a resource of
+ * the local gcoap server, via the loopback address.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "irq.h"
+#include "mutex.h"
+#include "net/gnrc/coap.h"
+#include "xtimer.h"
+
+#define TIMEOUT_S (5ul)
+#define TIMEOUT (TIMEOUT_S * SEC_IN_USEC)
+
+static ssize_t _bench_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len);
+
+static const coap_resource_t _resources[] = {
+    { "/bench", COAP_GET, _bench_handler },
+};
+
+static gcoap_listener_t _listener = {
+    (coap_resource_t *)&_resources[0],
+    sizeof(_resources) / sizeof(_resources[0]),
+    NULL
+};
+
+static ipv6_addr_t _server = IPV6_ADDR_LOOPBACK;
+static mutex_t _round_done = MUTEX_INIT_LOCKED;
+static unsigned _pending;
+static unsigned _responses;
+static unsigned _failures;
+
+static ssize_t _bench_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len)
+{
+    return gcoap_response(pdu, buf, len, COAP_CODE_CONTENT);
+}
+
+static void _resp_handler(unsigned req_state, coap_pkt_t* pdu)
+{
+    (void)pdu;
+
+    if (req_state == GCOAP_MEMO_RESP) {
+        _responses++;
+    }
+    else {
+        _failures++;
+    }
+    if (--_pending == 0) {
+        mutex_unlock(&_round_done);
+    }
+}
+
+/* Sends as many requests as there are memos, waits until all are done */
+static void _round(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+
+    _pending = GCOAP_REQ_WAITING_MAX;
+    for (unsigned i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
+        ssize_t len = gcoap_request(&pdu, buf, sizeof(buf), COAP_METHOD_GET,
+                                    "/bench");
+        if ((len <= 0) ||
+            !gcoap_req_send(buf, len, &_server, GCOAP_PORT, _resp_handler)) {
+            _failures++;
+            /* handlers may run concurrently */
+            unsigned state = irq_disable();
+            unsigned pending = --_pending;
+            irq_restore(state);
+            if (pending == 0) {
+                return;
+            }
+        }
+    }
+    mutex_lock(&_round_done);
+}
+
+int main(void)
+{
+    puts("Start.");
+    gcoap_register_listener(&_listener);
+
+    uint32_t start = xtimer_now_usec();
+    uint32_t elapsed;
+    do {
+        _round();
+        elapsed = xtimer_now_usec() - start;
+    } while (elapsed < TIMEOUT);
+
+    printf("+ %u requests in flight: %lu responses per second, %u failures\n",
+           GCOAP_REQ_WAITING_MAX,
+           (unsigned long)((uint64_t)_responses * SEC_IN_USEC / elapsed),
+           _failures);
+
+    puts("Done.");
+    return 0;
+}
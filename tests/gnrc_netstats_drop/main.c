@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests the drop counters of the gnrc stack.
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/inet_csum.h"
+#include "net/ipv6/addr.h"
+#include "net/ipv6/hdr.h"
+#include "net/gnrc/ipv6/netif.h"
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netif.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/netreg.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/netstats.h"
+#include "net/protnum.h"
+#include "net/sock/udp.h"
+#include "net/udp.h"
+#include "timex.h"
+#include "xtimer.h"
+
+#define CALL(fn)            puts("Calling " # fn); fn; tear_down()
+
+#define TEST_PORT           (8080U)
+#define TEST_PAYLOAD        "drop"
+#define TEST_TIMEOUT        (100U * MS_IN_USEC)
+
+static sock_udp_t _sock;
+static uint8_t _test_buffer[32];
+static uint32_t _drops[NETSTATS_DROP_AT_NUMOF][NETSTATS_DROP_NUMOF];
+
+static void tear_down(void)
+{
+    sock_udp_close(&_sock);
+    memset(&_sock, 0, sizeof(_sock));
+    netstats_drop_reset();
+}
+
+static void _init_interface(void)
+{
+    kernel_pid_t ifs[GNRC_NETIF_NUMOF];
+    ipv6_addr_t addr = IPV6_ADDR_UNSPECIFIED;
+
+    gnrc_netif_get(ifs);
+
+    addr.u8[0] = 0xfd;
+    addr.u8[1] = 0x01;
+    addr.u8[15] = 0x02;
+    /* fd01::02 */
+    gnrc_ipv6_netif_add_addr(ifs[0], &addr, 64, GNRC_IPV6_NETIF_ADDR_FLAGS_UNICAST);
+}
+
+/* hands a UDP packet from fd01::1 to fd01::2 to IPv6 as if the interface
+ * received it */
+static void _receive_udp(uint16_t port)
+{
+    kernel_pid_t ifs[GNRC_NETIF_NUMOF];
+    gnrc_netif_hdr_t netif_hdr;
+    uint8_t data[sizeof(ipv6_hdr_t) + sizeof(udp_hdr_t) + sizeof(TEST_PAYLOAD) - 1];
+    ipv6_hdr_t *ipv6 = (ipv6_hdr_t *)data;
+    udp_hdr_t *udp = (udp_hdr_t *)(ipv6 + 1);
+    uint16_t udp_len = sizeof(data) - sizeof(ipv6_hdr_t);
+    uint16_t csum;
+
+    gnrc_netif_get(ifs);
+    gnrc_netif_hdr_init(&netif_hdr, 8, 8);
+    netif_hdr.if_pid = ifs[0];
+
+    memset(data, 0, sizeof(data));
+    ipv6_hdr_set_version(ipv6);
+    ipv6->len = byteorder_htons(udp_len);
+    ipv6->nh = PROTNUM_UDP;
+    ipv6->hl = 16;
+    ipv6->src.u8[0] = 0xfd;
+    ipv6->src.u8[1] = 0x01;
+    ipv6->src.u8[15] = 0x01;
+    ipv6->dst.u8[0] = 0xfd;
+    ipv6->dst.u8[1] = 0x01;
+    ipv6->dst.u8[15] = 0x02;
+    udp->src_port = byteorder_htons(TEST_PORT);
+    udp->dst_port = byteorder_htons(port);
+    udp->length = byteorder_htons(udp_len);
+    memcpy(udp + 1, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1);
+    csum = ~ipv6_hdr_inet_csum(inet_csum(0, (uint8_t *)udp, udp_len), ipv6,
+                               PROTNUM_UDP, udp_len);
+    udp->checksum = byteorder_htons((csum == 0) ? 0xffff : csum);
+
+    gnrc_pktsnip_t *netif = gnrc_pktbuf_add(NULL,
+                                            &netif_hdr,
+                                            sizeof(netif_hdr),
+                                            GNRC_NETTYPE_NETIF);
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(netif,
+                                          data,
+                                          sizeof(data),
+                                          GNRC_NETTYPE_UNDEF);
+
+    gnrc_netapi_dispatch_receive(GNRC_NETTYPE_IPV6, GNRC_NETREG_DEMUX_CTX_ALL, pkt);
+}
+
+static void test_netstats_drop__bound(void)
+{
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = TEST_PORT };
+
+    assert(0 == sock_udp_create(&_sock, &local, NULL, 0));
+    _receive_udp(TEST_PORT);
+    assert((ssize_t)(sizeof(TEST_PAYLOAD) - 1) ==
+           sock_udp_recv(&_sock, _test_buffer, sizeof(_test_buffer),
+                         TEST_TIMEOUT, NULL));
+    assert(memcmp(TEST_PAYLOAD, _test_buffer, sizeof(TEST_PAYLOAD) - 1) == 0);
+    netstats_drop_snapshot(_drops);
+    assert(_drops[NETSTATS_DROP_AT_IPV6][NETSTATS_DROP_NO_SUBSCRIBER] == 0);
+    assert(_drops[NETSTATS_DROP_AT_UDP][NETSTATS_DROP_NO_SUBSCRIBER] == 0);
+}
+
+static void test_netstats_drop__unbound(void)
+{
+    _receive_udp(TEST_PORT + 1);
+    /* give the stack time to handle the packet */
+    xtimer_usleep(TEST_TIMEOUT);
+    netstats_drop_snapshot(_drops);
+    assert(_drops[NETSTATS_DROP_AT_IPV6][NETSTATS_DROP_NO_SUBSCRIBER] == 0);
+    assert(_drops[NETSTATS_DROP_AT_UDP][NETSTATS_DROP_NO_SUBSCRIBER] == 1);
+}
+
+int main(void)
+{
+    _init_interface();
+    /* let the interface settle, e.g. finish sending router solicitations */
+    xtimer_usleep(TEST_TIMEOUT);
+    netstats_drop_reset();
+
+    CALL(test_netstats_drop__bound());
+    CALL(test_netstats_drop__unbound());
+
+    puts("ALL TESTS SUCCESSFUL");
+
+    return 0;
+}
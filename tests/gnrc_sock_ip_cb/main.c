@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test for raw IP socks registered with a netapi callback, i.e.
+ *              with asynchronous events
+ *
+ * The plain mbox registration is tested in tests/gnrc_sock_ip.
+ * @}
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/sock/ip.h"
+
+#include "constants.h"
+#include "stack.h"
+
+#define _TEST_BUFFER_SIZE   (128)
+
+#define CALL(fn)            puts("Calling " # fn); fn; tear_down()
+
+static const ipv6_addr_t _src_addr = { .u8 = _TEST_ADDR_REMOTE };
+static const ipv6_addr_t _dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+static const sock_ip_ep_t _local = { .family = AF_INET6 };
+
+static sock_ip_t _sock, _sock2;
+static uint8_t _test_buffer[_TEST_BUFFER_SIZE];
+
+static sock_async_flags_t _async_flags;
+static sock_ip_t *_async_sock;
+
+static void tear_down(void)
+{
+    sock_ip_close(&_sock);
+    memset(&_sock, 0, sizeof(_sock));
+}
+
+static void _async_cb(sock_ip_t *sock, sock_async_flags_t flags, void *arg)
+{
+    _async_sock = sock;
+    _async_flags = flags;
+    assert(arg == &_sock2);
+}
+
+static void _stale_cb(gnrc_sock_reg_t *reg, sock_async_flags_t flags)
+{
+    (void)reg;
+    (void)flags;
+    /* must never be called */
+    assert(false);
+}
+
+static void test_sock_ip_recv__async(void)
+{
+    _async_sock = NULL;
+    _async_flags = 0;
+    assert(0 == sock_ip_create(&_sock, &_local, NULL, _TEST_PROTO,
+                               SOCK_FLAGS_REUSE_EP));
+    sock_ip_set_cb(&_sock, _async_cb, &_sock2);
+    assert(_inject_packet(&_src_addr, &_dst_addr, _TEST_PROTO, "ABCD",
+                          sizeof("ABCD"), _TEST_NETIF));
+    assert(&_sock == _async_sock);
+    assert(SOCK_ASYNC_MSG_RECV == _async_flags);
+    assert(sizeof("ABCD") == sock_ip_recv(&_sock, _test_buffer,
+                                          sizeof(_test_buffer), 0, NULL));
+    assert(memcmp(_test_buffer, "ABCD", sizeof("ABCD")) == 0);
+    /* no more events after removing the callback */
+    _async_sock = NULL;
+    sock_ip_set_cb(&_sock, NULL, NULL);
+    assert(_inject_packet(&_src_addr, &_dst_addr, _TEST_PROTO, "ABCD",
+                          sizeof("ABCD"), _TEST_NETIF));
+    assert(NULL == _async_sock);
+    assert(sizeof("ABCD") == sock_ip_recv(&_sock, _test_buffer,
+                                          sizeof(_test_buffer), 0, NULL));
+    assert(_check_net());
+}
+
+static void test_sock_ip_recv__async_stale_cb(void)
+{
+    /* sock_ip_create() must not keep a callback of a former use of the
+     * memory */
+    _sock.reg.async_cb = _stale_cb;
+    assert(0 == sock_ip_create(&_sock, &_local, NULL, _TEST_PROTO,
+                               SOCK_FLAGS_REUSE_EP));
+    assert(_inject_packet(&_src_addr, &_dst_addr, _TEST_PROTO, "ABCD",
+                          sizeof("ABCD"), _TEST_NETIF));
+    assert(sizeof("ABCD") == sock_ip_recv(&_sock, _test_buffer,
+                                          sizeof(_test_buffer), 0, NULL));
+    assert(_check_net());
+}
+
+int main(void)
+{
+    _net_init();
+    tear_down();
+    CALL(test_sock_ip_recv__async());
+    CALL(test_sock_ip_recv__async_stale_cb());
+
+    puts("ALL TESTS SUCCESSFUL");
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test for UDP socks registered with a netapi callback, i.e.
+ *              with a receive buffer limit and asynchronous events
+ *
+ * The plain mbox registration is tested in tests/gnrc_sock_udp.
+ * @}
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/sock/udp.h"
+#include "xtimer.h"
+
+#include "constants.h"
+#include "stack.h"
+
+#define _TEST_BUFFER_SIZE   (128)
+
+static const ipv6_addr_t _src_addr = { .u8 = _TEST_ADDR_REMOTE };
+static const ipv6_addr_t _dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+static const sock_udp_ep_t _local = { .family = AF_INET6,
+                                      .port = _TEST_PORT_LOCAL };
+
+static uint8_t _test_buffer[_TEST_BUFFER_SIZE];
+static sock_udp_t _sock, _sock2;
+
+#define CALL(fn)            puts("Calling " # fn); fn; tear_down()
+
+static void tear_down(void)
+{
+    sock_udp_close(&_sock);
+    memset(&_sock, 0, sizeof(_sock));
+}
+
+static bool _inject(const char *data)
+{
+    return _inject_packet(&_src_addr, &_dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, (void *)data, strlen(data) + 1,
+                          _TEST_NETIF);
+}
+
+static void _expect(const char *data)
+{
+    assert((ssize_t)(strlen(data) + 1) == sock_udp_recv(&_sock, _test_buffer,
+                                                        sizeof(_test_buffer),
+                                                        0, NULL));
+    assert(memcmp(_test_buffer, data, strlen(data) + 1) == 0);
+}
+
+static void _fill_rcvbuf(gnrc_sock_rcvbuf_policy_t policy)
+{
+    assert(0 == sock_udp_create(&_sock, &_local, NULL, SOCK_FLAGS_REUSE_EP));
+    gnrc_sock_set_rcvbuf(&_sock.reg, 0, policy);
+    assert(_inject("ABCD"));
+    assert(_inject("EFGH"));
+    /* room for exactly the first two packets */
+    gnrc_sock_set_rcvbuf(&_sock.reg, _sock.reg.rcvbuf_used, policy);
+    assert(_inject("IJKL"));
+    assert(1 == _sock.reg.rcvbuf_drops);
+}
+
+static void test_sock_udp_recv__rcvbuf_drop_newest(void)
+{
+    _fill_rcvbuf(GNRC_SOCK_DROP_NEWEST);
+    _expect("ABCD");
+    _expect("EFGH");
+    assert(-EAGAIN == sock_udp_recv(&_sock, _test_buffer,
+                                    sizeof(_test_buffer), 0, NULL));
+    assert(0 == _sock.reg.rcvbuf_used);
+    assert(_check_net());
+}
+
+static void test_sock_udp_recv__rcvbuf_drop_oldest(void)
+{
+    _fill_rcvbuf(GNRC_SOCK_DROP_OLDEST);
+    /* the oldest packet is dropped, the others keep their order */
+    _expect("EFGH");
+    _expect("IJKL");
+    assert(-EAGAIN == sock_udp_recv(&_sock, _test_buffer,
+                                    sizeof(_test_buffer), 0, NULL));
+    assert(0 == _sock.reg.rcvbuf_used);
+    assert(_check_net());
+}
+
+static sock_async_flags_t _async_flags;
+static sock_udp_t *_async_sock;
+
+static void _async_cb(sock_udp_t *sock, sock_async_flags_t flags, void *arg)
+{
+    _async_sock = sock;
+    _async_flags = flags;
+    assert(arg == &_sock2);
+}
+
+static void test_sock_udp_recv__async(void)
+{
+    _async_sock = NULL;
+    _async_flags = 0;
+    assert(0 == sock_udp_create(&_sock, &_local, NULL, SOCK_FLAGS_REUSE_EP));
+    sock_udp_set_cb(&_sock, _async_cb, &_sock2);
+    assert(_inject("ABCD"));
+    assert(&_sock == _async_sock);
+    assert(SOCK_ASYNC_MSG_RECV == _async_flags);
+    _expect("ABCD");
+    /* no more events after removing the callback */
+    _async_sock = NULL;
+    sock_udp_set_cb(&_sock, NULL, NULL);
+    assert(_inject("ABCD"));
+    assert(NULL == _async_sock);
+    _expect("ABCD");
+    assert(_check_net());
+}
+
+static void _stale_cb(gnrc_sock_reg_t *reg, sock_async_flags_t flags)
+{
+    (void)reg;
+    (void)flags;
+    /* must never be called */
+    assert(false);
+}
+
+static void test_sock_udp_recv__async_stale_cb(void)
+{
+    /* sock_udp_create() must not keep a callback of a former use of the
+     * memory */
+    _sock.reg.async_cb = _stale_cb;
+    assert(0 == sock_udp_create(&_sock, &_local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(_inject("ABCD"));
+    _expect("ABCD");
+    assert(_check_net());
+}
+
+static void test_sock_udp_recv__async_implicit_bind(void)
+{
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
+                                          .family = AF_INET6,
+                                          .port = _TEST_PORT_REMOTE };
+
+    _async_sock = NULL;
+    _async_flags = 0;
+    assert(0 == sock_udp_create(&_sock, NULL, &remote, SOCK_FLAGS_REUSE_EP));
+    sock_udp_set_cb(&_sock, _async_cb, &_sock2);
+    /* binds the sock implicitly, the callback must survive that */
+    assert(sizeof("ABCD") == sock_udp_send(&_sock, "ABCD", sizeof("ABCD"),
+                                           NULL));
+    xtimer_usleep(1000);    /* let GNRC stack finish */
+    assert(_sock.local.port != 0);
+    assert(_inject_packet(&_src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _sock.local.port, (void *)"EFGH", sizeof("EFGH"),
+                          _TEST_NETIF));
+    assert(&_sock == _async_sock);
+    assert(SOCK_ASYNC_MSG_RECV == _async_flags);
+    _expect("EFGH");
+    assert(_check_net());
+}
+
+int main(void)
+{
+    _net_init();
+    tear_down();
+    CALL(test_sock_udp_recv__rcvbuf_drop_newest());
+    CALL(test_sock_udp_recv__rcvbuf_drop_oldest());
+    CALL(test_sock_udp_recv__async());
+    CALL(test_sock_udp_recv__async_stale_cb());
+    CALL(test_sock_udp_recv__async_implicit_bind());
+
+    puts("ALL TESTS SUCCESSFUL");
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+def testfunc(child):
+    child.expect_exact(u"Calling test_sock_udp_recv__rcvbuf_drop_newest()")
+    child.expect_exact(u"Calling test_sock_udp_recv__rcvbuf_drop_oldest()")
+    child.expect_exact(u"Calling test_sock_udp_recv__async()")
+    child.expect_exact(u"Calling test_sock_udp_recv__async_stale_cb()")
+    child.expect_exact(u"Calling test_sock_udp_recv__async_implicit_bind()")
+    child.expect_exact(u"ALL TESTS SUCCESSFUL")
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc))
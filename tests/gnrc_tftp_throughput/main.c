@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup   tests
+ * @{
+ *
+ * @file
+ * @brief     Measures the throughput of gnrc_tftp between two nodes
+ *
+ * The file name of a transfer gives its size in bytes, the content is a
+ * counting pattern generated by the sender and checked by the receiver.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "msg.h"
+#include "net/gnrc/tftp.h"
+#include "shell.h"
+#include "thread.h"
+#include "xtimer.h"
+
+/* must be a power of two and hold a whole window of data blocks */
+#define QUEUE_SIZE      (16)
+
+#if GNRC_TFTP_WINDOW_SIZE > QUEUE_SIZE
+#error "QUEUE_SIZE is too small for GNRC_TFTP_WINDOW_SIZE"
+#endif
+
+static msg_t _main_msg_queue[QUEUE_SIZE];
+static msg_t _server_msg_queue[QUEUE_SIZE];
+static char _server_stack[THREAD_STACKSIZE_MAIN + THREAD_EXTRA_STACKSIZE_PRINTF];
+static kernel_pid_t _server_pid = KERNEL_PID_UNDEF;
+
+/* state of the transfer, one for each side */
+typedef struct {
+    size_t size;
+    size_t errors;
+    bool read;
+    bool success;
+} _transfer_t;
+
+static _transfer_t _server;
+static _transfer_t _client;
+
+static int _fill(_transfer_t *t, uint32_t offset, uint8_t *data, size_t len)
+{
+    if (offset >= t->size) {
+        return 0;
+    }
+    if (offset + len > t->size) {
+        len = t->size - offset;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)(offset + i);
+    }
+    return len;
+}
+
+static int _check(_transfer_t *t, uint32_t offset, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != (uint8_t)(offset + i)) {
+            t->errors++;
+        }
+    }
+    return len;
+}
+
+static bool _server_start_cb(tftp_action_t action, tftp_mode_t mode,
+                             const char *file_name, size_t *len)
+{
+    (void)mode;
+
+    memset(&_server, 0, sizeof(_server));
+    _server.read = (action == TFTP_READ);
+    if (_server.read) {
+        _server.size = strtoul(file_name, NULL, 10);
+        *len = _server.size;
+    }
+    return true;
+}
+
+static int _server_data_cb(uint32_t offset, void *data, size_t data_len)
+{
+    if (_server.read) {
+        return _fill(&_server, offset, data, data_len);
+    }
+    return _check(&_server, offset, data, data_len);
+}
+
+static void _server_stop_cb(tftp_event_t event, const char *msg)
+{
+    if (event != TFTP_SUCCESS) {
+        printf("tftp_bench: server transfer failed: %s\n", msg ? msg : "");
+    }
+    else if (_server.errors) {
+        printf("tftp_bench: server received %lu bad bytes\n",
+               (unsigned long)_server.errors);
+    }
+}
+
+static bool _client_start_cb(tftp_action_t action, tftp_mode_t mode,
+                             const char *file_name, size_t *len)
+{
+    (void)action;
+    (void)mode;
+    (void)file_name;
+    (void)len;
+    return true;
+}
+
+static int _client_read_cb(uint32_t offset, void *data, size_t data_len)
+{
+    return _check(&_client, offset, data, data_len);
+}
+
+static int _client_write_cb(uint32_t offset, void *data, size_t data_len)
+{
+    return _fill(&_client, offset, data, data_len);
+}
+
+static void _client_stop_cb(tftp_event_t event, const char *msg)
+{
+    _client.success = (event == TFTP_SUCCESS);
+    if (!_client.success) {
+        printf("tftp_bench: transfer failed: %s\n", msg ? msg : "");
+    }
+}
+
+static void *_server_thread(void *arg)
+{
+    (void)arg;
+
+    msg_init_queue(_server_msg_queue, QUEUE_SIZE);
+    gnrc_tftp_server(_server_data_cb, _server_start_cb, _server_stop_cb, true);
+    _server_pid = KERNEL_PID_UNDEF;
+
+    return NULL;
+}
+
+static int _transfer(bool get, ipv6_addr_t *addr, const char *file_name)
+{
+    memset(&_client, 0, sizeof(_client));
+    _client.size = strtoul(file_name, NULL, 10);
+
+    uint32_t start = xtimer_now_usec();
+    if (get) {
+        gnrc_tftp_client_read(addr, file_name, TTM_OCTET, _client_read_cb,
+                              _client_start_cb, _client_stop_cb, true);
+    }
+    else {
+        gnrc_tftp_client_write(addr, file_name, TTM_OCTET, _client_write_cb,
+                               _client.size, _client_stop_cb, true);
+    }
+    uint32_t duration = xtimer_now_usec() - start;
+
+    if (!_client.success) {
+        return 1;
+    }
+    if (duration == 0) {
+        duration = 1;
+    }
+    printf("tftp_bench: %lu bytes in %lu ms, %lu kbit/s, %lu errors\n",
+           (unsigned long)_client.size,
+           (unsigned long)(duration / MS_IN_USEC),
+           (unsigned long)(((uint64_t)_client.size * 8 * MS_IN_USEC) / duration),
+           (unsigned long)_client.errors);
+    return 0;
+}
+
+static int _bench_cmd(int argc, char **argv)
+{
+    ipv6_addr_t addr;
+
+    if ((argc == 2) && (strcmp(argv[1], "server") == 0)) {
+        if (_server_pid != KERNEL_PID_UNDEF) {
+            puts("tftp_bench: server already running");
+            return 1;
+        }
+        _server_pid = thread_create(_server_stack, sizeof(_server_stack),
+                                    THREAD_PRIORITY_MAIN - 1,
+                                    THREAD_CREATE_STACKTEST,
+                                    _server_thread, NULL, "tftp_bench");
+        return 0;
+    }
+    if ((argc == 4) && ((strcmp(argv[1], "get") == 0) ||
+                        (strcmp(argv[1], "put") == 0))) {
+        if (ipv6_addr_from_str(&addr, argv[2]) == NULL) {
+            puts("tftp_bench: invalid address");
+            return 1;
+        }
+        return _transfer(argv[1][0] == 'g', &addr, argv[3]);
+    }
+
+    printf("usage: %s server\n", argv[0]);
+    printf("       %s <get|put> <addr> <bytes>\n", argv[0]);
+    return 1;
+}
+
+static const shell_command_t _shell_commands[] = {
+    { "tftp_bench", "TFTP throughput benchmark", _bench_cmd },
+    { NULL, NULL, NULL }
+};
+
+int main(void)
+{
+    msg_init_queue(_main_msg_queue, QUEUE_SIZE);
+    printf("TFTP throughput benchmark, window of %u blocks\n",
+           (unsigned)GNRC_TFTP_WINDOW_SIZE);
+
+    char line_buf[SHELL_DEFAULT_BUFSIZE];
+    shell_run(_shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ * @file
+ * @brief       Test for pipe_splice_to(), pipe_splice_from() and the pipe
+ *              watermarks.
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "thread.h"
+#include "pipe.h"
+
+#define BYTES_TOTAL (26)
+#define LOWAT       (4)
+
+static char stack[THREAD_STACKSIZE_MAIN];
+
+static char pipe_buf[6];
+static ringbuffer_t rb;
+static pipe_t pipe;
+
+static ssize_t _print_sink(void *arg, const void *data, size_t len)
+{
+    unsigned *total = arg;
+
+    printf("Sink: <%.*s> [%u:%u]\n", (int)len, (const char *)data,
+           *total, *total + (unsigned)len);
+    *total += len;
+    return len;
+}
+
+static ssize_t _alphabet_source(void *arg, void *data, size_t len)
+{
+    unsigned *total = arg;
+    char *out = data;
+
+    for (size_t i = 0; i < len; i++) {
+        out[i] = 'A' + (*total)++;
+    }
+    return len;
+}
+
+static void *run_end(void *arg)
+{
+    (void) arg;
+
+    unsigned total = 0;
+    while (total < BYTES_TOTAL) {
+        pipe_splice_to(&pipe, _print_sink, &total, BYTES_TOTAL - total);
+    }
+
+    puts("End done.");
+    return NULL;
+}
+
+int main(void)
+{
+    puts("Start.");
+
+    ringbuffer_init(&rb, pipe_buf, sizeof (pipe_buf));
+    pipe_init(&pipe, &rb, NULL);
+    pipe_set_watermarks(&pipe, LOWAT, 1);
+
+    thread_create(stack, sizeof (stack),
+                  THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST,
+                  run_end, NULL, "end");
+
+    unsigned total = 0;
+    while (total < BYTES_TOTAL) {
+        unsigned prev = total;
+        unsigned n = BYTES_TOTAL - total;
+        pipe_splice_from(&pipe, _alphabet_source, &total, n < 3 ? n : 3);
+        printf("Source: [%u:%u]\n", prev, total);
+    }
+
+    /* the tail of the stream is below the low watermark */
+    pipe_set_watermarks(&pipe, 1, 1);
+
+    puts("Main done.");
+    return 0;
+}
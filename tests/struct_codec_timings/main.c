@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup   tests
+ * @{
+ *
+ * @file
+ * @brief     Compares the schema based struct codecs with hand-written
+ *            CBOR and UBJSON serialization and deserialization
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cbor.h"
+#include "kernel_defines.h"
+#include "struct_codec.h"
+#include "ubjson.h"
+#include "xtimer.h"
+
+#define TIMEOUT_S (2ul)
+#define TIMEOUT (TIMEOUT_S * SEC_IN_USEC)
+
+typedef struct {
+    int32_t temp;
+    uint32_t seq;
+    char name[8];
+    int64_t uptime;
+} sensor_t;
+
+#define SENSOR_FIELDS(X, T) \
+    X(T, INT32, temp)       \
+    X(T, UINT32, seq)       \
+    X(T, TEXT, name)        \
+    X(T, INT64, uptime)
+
+STRUCT_CODEC(sensor_codec, sensor_t, SENSOR_FIELDS);
+
+static const sensor_t sensor = { -300, 4711, "sensor", 1234567 };
+static unsigned char buf[64];
+static size_t buf_len;
+static size_t ubjson_pos;
+
+typedef struct {
+    ubjson_cookie_t cookie;
+    size_t pos;
+    sensor_t res;
+} ubjson_reader_t;
+
+static ssize_t _ubjson_write(ubjson_cookie_t *restrict cookie, const void *data, size_t len)
+{
+    (void) cookie;
+    if (ubjson_pos + len > sizeof(buf)) {
+        return -1;
+    }
+    memcpy(&buf[ubjson_pos], data, len);
+    ubjson_pos += len;
+    return len;
+}
+
+static void cbor_hand_encode(void)
+{
+    cbor_stream_t stream;
+
+    cbor_init(&stream, buf, sizeof(buf));
+    cbor_serialize_map(&stream, 4);
+    cbor_serialize_unicode_string(&stream, "temp");
+    cbor_serialize_int(&stream, sensor.temp);
+    cbor_serialize_unicode_string(&stream, "seq");
+    cbor_serialize_uint64_t(&stream, sensor.seq);
+    cbor_serialize_unicode_string(&stream, "name");
+    cbor_serialize_unicode_string(&stream, sensor.name);
+    cbor_serialize_unicode_string(&stream, "uptime");
+    cbor_serialize_int64_t(&stream, sensor.uptime);
+    buf_len = stream.pos;
+}
+
+static void cbor_hand_decode(void)
+{
+    cbor_stream_t stream = { buf, sizeof(buf), buf_len };
+    sensor_t res;
+    char key[8];
+    size_t map_len, offset;
+    uint64_t seq;
+    int temp;
+
+    offset = cbor_deserialize_map(&stream, 0, &map_len);
+    offset += cbor_deserialize_unicode_string(&stream, offset, key, sizeof(key));
+    offset += cbor_deserialize_int(&stream, offset, &temp);
+    res.temp = temp;
+    offset += cbor_deserialize_unicode_string(&stream, offset, key, sizeof(key));
+    offset += cbor_deserialize_uint64_t(&stream, offset, &seq);
+    res.seq = seq;
+    offset += cbor_deserialize_unicode_string(&stream, offset, key, sizeof(key));
+    offset += cbor_deserialize_unicode_string(&stream, offset, res.name, sizeof(res.name) - 1);
+    offset += cbor_deserialize_unicode_string(&stream, offset, key, sizeof(key));
+    cbor_deserialize_int64_t(&stream, offset, &res.uptime);
+}
+
+static void cbor_codec_enc(void)
+{
+    buf_len = cbor_codec_encode(&sensor_codec, &sensor, buf, sizeof(buf));
+}
+
+static void cbor_codec_dec(void)
+{
+    sensor_t res;
+
+    cbor_codec_decode(&sensor_codec, &res, buf, buf_len);
+}
+
+static void ubjson_hand_encode(void)
+{
+    ubjson_cookie_t cookie;
+
+    ubjson_pos = 0;
+    ubjson_write_init(&cookie, _ubjson_write);
+    ubjson_open_object(&cookie);
+    ubjson_write_key(&cookie, "temp", 4);
+    ubjson_write_i32(&cookie, sensor.temp);
+    ubjson_write_key(&cookie, "seq", 3);
+    ubjson_write_i64(&cookie, sensor.seq);
+    ubjson_write_key(&cookie, "name", 4);
+    ubjson_write_string(&cookie, sensor.name, strlen(sensor.name));
+    ubjson_write_key(&cookie, "uptime", 6);
+    ubjson_write_i64(&cookie, sensor.uptime);
+    ubjson_close_object(&cookie);
+    buf_len = ubjson_pos;
+}
+
+static ssize_t _ubjson_read(ubjson_cookie_t *restrict cookie, void *data, size_t max_len)
+{
+    ubjson_reader_t *reader = container_of(cookie, ubjson_reader_t, cookie);
+    size_t len = buf_len - reader->pos;
+
+    if (len > max_len) {
+        len = max_len;
+    }
+    memcpy(data, &buf[reader->pos], len);
+    reader->pos += len;
+    return len;
+}
+
+static ubjson_read_callback_result_t _ubjson_read_cb(ubjson_cookie_t *restrict cookie,
+                                                     ubjson_type_t type1, ssize_t content1,
+                                                     ubjson_type_t type2, ssize_t content2)
+{
+    ubjson_reader_t *reader = container_of(cookie, ubjson_reader_t, cookie);
+    char key[8];
+    int32_t i32;
+    int64_t i64;
+
+    if (type1 == UBJSON_ENTER_OBJECT) {
+        return ubjson_read_object(cookie);
+    }
+    if ((type1 != UBJSON_KEY) || (content1 >= (ssize_t)sizeof(key))) {
+        return UBJSON_ABORTED;
+    }
+    ubjson_get_string(cookie, content1, key);
+    key[content1] = '\0';
+
+    ubjson_peek_value(cookie, &type2, &content2);
+    switch (type2) {
+        case UBJSON_TYPE_INT32:
+            ubjson_get_i32(cookie, content2, &i32);
+            i64 = i32;
+            break;
+        case UBJSON_TYPE_INT64:
+            ubjson_get_i64(cookie, content2, &i64);
+            break;
+        case UBJSON_TYPE_STRING:
+            if ((strcmp(key, "name") != 0) || (content2 >= (ssize_t)sizeof(reader->res.name))) {
+                return UBJSON_ABORTED;
+            }
+            ubjson_get_string(cookie, content2, reader->res.name);
+            reader->res.name[content2] = '\0';
+            return UBJSON_OKAY;
+        default:
+            return UBJSON_ABORTED;
+    }
+
+    if (strcmp(key, "temp") == 0) {
+        reader->res.temp = i64;
+    }
+    else if (strcmp(key, "seq") == 0) {
+        reader->res.seq = i64;
+    }
+    else if (strcmp(key, "uptime") == 0) {
+        reader->res.uptime = i64;
+    }
+    else {
+        return UBJSON_ABORTED;
+    }
+    return UBJSON_OKAY;
+}
+
+static void ubjson_hand_decode(void)
+{
+    ubjson_reader_t reader = { .pos = 0 };
+
+    ubjson_read(&reader.cookie, _ubjson_read, _ubjson_read_cb);
+}
+
+static void ubjson_codec_enc(void)
+{
+    buf_len = ubjson_codec_encode(&sensor_codec, &sensor, buf, sizeof(buf));
+}
+
+static void ubjson_codec_dec(void)
+{
+    sensor_t res;
+
+    ubjson_codec_decode(&sensor_codec, &res, buf, buf_len);
+}
+
+static void callback(void *done_)
+{
+    volatile int *done = done_;
+    *done = 1;
+}
+
+static void run_test(const char *name, void (*test)(void))
+{
+    volatile int done = 0;
+    unsigned long count = 0;
+
+    xtimer_t xtimer;
+    xtimer.callback = callback;
+    xtimer.arg = (void *) &done;
+
+    xtimer_set(&xtimer, TIMEOUT);
+
+    do {
+        test();
+        ++count;
+    } while (done == 0);
+
+    printf("+ %s: %lu iterations per second\n", name, count / TIMEOUT_S);
+}
+
+#define run_test(test) run_test(#test, test)
+
+int main(void)
+{
+    puts("Start.");
+
+    run_test(cbor_hand_encode);
+    run_test(cbor_codec_enc);
+    /* both decoders read the output of cbor_codec_enc() */
+    run_test(cbor_hand_decode);
+    run_test(cbor_codec_dec);
+
+    run_test(ubjson_hand_encode);
+    run_test(ubjson_codec_enc);
+    /* both decoders read the output of ubjson_codec_enc() */
+    run_test(ubjson_hand_decode);
+    run_test(ubjson_codec_dec);
+
+    puts("Done.");
+    return 0;
+}
@@ -380,6 +380,91 @@ static void test_base64_09_encode_size_determination(void)
     TEST_ASSERT_EQUAL_INT(required_out_size, expected_out_size);
 }
 
+static void test_base64_10_stream_api(void)
+{
+    unsigned char data_in[] = "Hello RIOT this is a base64 test!\n"
+                              "This should work as intended.";
+
+    unsigned char expected_encoding[] = "SGVsbG8gUklPVCB0aGlzIGlzIGEgYmFzZTY0IHR"
+                                        "lc3QhClRoaXMgc2hvdWxkIHdvcmsgYXMgaW50ZW5kZWQu";
+
+    size_t data_in_size = strlen((char *)data_in);
+    unsigned char base64_out[sizeof(expected_encoding)];
+    unsigned char data_out[sizeof(data_in)];
+
+    /* odd chunk sizes, so groups span several calls */
+    for (size_t chunk = 1; chunk < 8; chunk++) {
+        base64_encoder_t enc;
+        size_t out = 0;
+
+        base64_encode_init(&enc);
+        for (size_t pos = 0; pos < data_in_size; pos += chunk) {
+            size_t len = (data_in_size - pos < chunk) ? data_in_size - pos : chunk;
+            out += base64_encode_update(&enc, data_in + pos, len, base64_out + out);
+        }
+        out += base64_encode_final(&enc, base64_out + out);
+
+        TEST_ASSERT_EQUAL_INT(strlen((char *)expected_encoding), out);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(expected_encoding, base64_out, out));
+
+        base64_decoder_t dec;
+        size_t in_size = out;
+        out = 0;
+
+        base64_decode_init(&dec);
+        for (size_t pos = 0; pos < in_size; pos += chunk) {
+            size_t len = (in_size - pos < chunk) ? in_size - pos : chunk;
+            out += base64_decode_update(&dec, base64_out + pos, len, data_out + out);
+        }
+        out += base64_decode_final(&dec, data_out + out);
+
+        TEST_ASSERT_EQUAL_INT(data_in_size, out);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(data_in, data_out, out));
+    }
+}
+
+static void test_base64_11_decode_ignored_characters(void)
+{
+    /* line breaks and non-ASCII bytes inside vector sized blocks */
+    unsigned char encoded[] = "UGV0ZXIgUGlwZXIgcGlja2Vk\r\nIGEgcGVjayBvZiBwaWNr\xc3"
+                              "bGVkIHBlcHBlcnMu\n";
+    unsigned char expected[] = "Peter Piper picked a peck of pickled peppers.";
+    unsigned char data_out[sizeof(expected) + 2];
+    size_t data_out_size = sizeof(data_out);
+
+    int ret = base64_decode(encoded, strlen((char *)encoded), data_out, &data_out_size);
+    TEST_ASSERT_EQUAL_INT(BASE64_SUCCESS, ret);
+    TEST_ASSERT_EQUAL_INT(strlen((char *)expected), data_out_size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(expected, data_out, data_out_size));
+}
+
+static void test_base64_12_large_round_trip(void)
+{
+    /* large enough to run through the block wise paths many times, with
+     * every possible tail length */
+    static unsigned char data[1000];
+    static unsigned char encoded[BASE64_ENCODE_UPDATE_SIZE(sizeof(data))];
+    static unsigned char decoded[sizeof(data) + 2];
+
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 7) ^ (i >> 3);
+    }
+
+    for (size_t len = sizeof(data) - 24; len <= sizeof(data); len++) {
+        size_t encoded_size = sizeof(encoded);
+        size_t decoded_size = sizeof(decoded);
+
+        int ret = base64_encode(data, len, encoded, &encoded_size);
+        TEST_ASSERT_EQUAL_INT(BASE64_SUCCESS, ret);
+        TEST_ASSERT_EQUAL_INT(BASE64_ENCODE_UPDATE_SIZE(len), encoded_size);
+
+        ret = base64_decode(encoded, encoded_size, decoded, &decoded_size);
+        TEST_ASSERT_EQUAL_INT(BASE64_SUCCESS, ret);
+        TEST_ASSERT_EQUAL_INT(len, decoded_size);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(data, decoded, len));
+    }
+}
+
 Test *tests_base64_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -392,6 +477,9 @@ Test *tests_base64_tests(void)
         new_TestFixture(test_base64_07_stream_decode),
         new_TestFixture(test_base64_08_encode_16_bytes),
         new_TestFixture(test_base64_09_encode_size_determination),
+        new_TestFixture(test_base64_10_stream_api),
+        new_TestFixture(test_base64_11_decode_ignored_characters),
+        new_TestFixture(test_base64_12_large_round_trip),
     };
 
     EMB_UNIT_TESTCALLER(base64_tests, NULL, NULL, fixtures);
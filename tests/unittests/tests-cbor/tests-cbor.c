@@ -687,6 +687,254 @@ static void test_double_invalid(void)
 }
 #endif /* CBOR_NO_FLOAT */
 
+/* hands out the buffers of chunks[] one after another */
+#define WRITER_CHUNK_SIZE   (3U)
+#define WRITER_CHUNK_NUMOF  (16U)
+
+static unsigned char writer_chunks[WRITER_CHUNK_NUMOF][WRITER_CHUNK_SIZE];
+static unsigned writer_chunks_limit;
+
+static int _next_chunk(cbor_writer_t *writer, void *arg)
+{
+    unsigned *idx = arg;
+
+    if (++(*idx) >= writer_chunks_limit) {
+        return -1;
+    }
+    cbor_writer_set_buffer(writer, writer_chunks[*idx], WRITER_CHUNK_SIZE);
+    return 0;
+}
+
+static void _writer_chain_init(cbor_writer_t *writer, unsigned *idx, unsigned limit)
+{
+    memset(writer_chunks, 0, sizeof(writer_chunks));
+    writer_chunks_limit = limit;
+    *idx = 0;
+    cbor_writer_init(writer, writer_chunks[0], WRITER_CHUNK_SIZE, _next_chunk, idx);
+}
+
+static void test_writer_chain(void)
+{
+    cbor_writer_t writer;
+    unsigned idx;
+    const char bytes[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05 };
+
+    _writer_chain_init(&writer, &idx, WRITER_CHUNK_NUMOF);
+
+    /* the same items written to a contiguous stream must match byte by byte */
+    TEST_ASSERT_EQUAL_INT(1, cbor_writer_map(&writer, 2));
+    TEST_ASSERT_EQUAL_INT(1, cbor_writer_int(&writer, 1));
+    TEST_ASSERT_EQUAL_INT(7, cbor_writer_bytes(&writer, bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_INT(5, cbor_writer_uint(&writer, 0x10000));
+    TEST_ASSERT_EQUAL_INT(1, cbor_writer_array_indefinite(&writer));
+    TEST_ASSERT_EQUAL_INT(3, cbor_writer_int(&writer, -1000));
+    TEST_ASSERT_EQUAL_INT(1, cbor_writer_bool(&writer, true));
+    TEST_ASSERT_EQUAL_INT(4, cbor_writer_text(&writer, "abc", 3));
+    TEST_ASSERT_EQUAL_INT(1, cbor_writer_break(&writer));
+    TEST_ASSERT_EQUAL_INT(24, cbor_writer_len(&writer));
+
+    cbor_serialize_map(&stream, 2);
+    cbor_serialize_int(&stream, 1);
+    cbor_serialize_byte_stringl(&stream, bytes, sizeof(bytes));
+    cbor_serialize_uint64_t(&stream, 0x10000);
+    cbor_serialize_array_indefinite(&stream);
+    cbor_serialize_int(&stream, -1000);
+    cbor_serialize_bool(&stream, true);
+    cbor_serialize_unicode_string(&stream, "abc");
+    cbor_write_break(&stream);
+    TEST_ASSERT_EQUAL_INT(stream.pos, cbor_writer_len(&writer));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(writer_chunks, stream.data, stream.pos));
+}
+
+static void test_writer_backpressure(void)
+{
+    cbor_writer_t writer;
+    unsigned idx;
+
+    /* only two chunks of 3 bytes each are handed out */
+    _writer_chain_init(&writer, &idx, 2);
+
+    TEST_ASSERT_EQUAL_INT(5, cbor_writer_uint(&writer, 0xffffffff));
+    TEST_ASSERT_EQUAL_INT(0, cbor_writer_uint(&writer, 0xffff));
+    TEST_ASSERT_EQUAL_INT(2 * WRITER_CHUNK_SIZE, cbor_writer_len(&writer));
+
+    /* without a callback the writer stops at the end of the first buffer */
+    cbor_writer_init(&writer, writer_chunks[0], WRITER_CHUNK_SIZE, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(2, cbor_writer_uint(&writer, 0xff));
+    TEST_ASSERT_EQUAL_INT(0, cbor_writer_bytes(&writer, "ab", 2));
+}
+
+static void test_reader(void)
+{
+    /* {1: h'000102', "ab": [_ -1, true, 1.5]} */
+    unsigned char data[] = { 0xa2, 0x01, 0x43, 0x00, 0x01, 0x02, 0x62, 0x61,
+                             0x62, 0x9f, 0x20, 0xf5, 0xf9, 0x3e, 0x00, 0xff };
+    cbor_reader_t reader;
+    cbor_item_t item;
+
+    cbor_reader_init(&reader, data, sizeof(data));
+
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_MAP, item.type);
+    TEST_ASSERT_EQUAL_INT(2, item.val);
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_UINT, item.type);
+    TEST_ASSERT_EQUAL_INT(1, item.val);
+    /* strings are views into the input */
+    TEST_ASSERT_EQUAL_INT(4, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_BYTES, item.type);
+    TEST_ASSERT_EQUAL_INT(3, item.val);
+    TEST_ASSERT(item.ptr == &data[3]);
+    TEST_ASSERT_EQUAL_INT(3, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_TEXT, item.type);
+    TEST_ASSERT(item.ptr == &data[7]);
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_ARRAY, item.type);
+    TEST_ASSERT(item.indefinite);
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_NEGINT, item.type);
+    TEST_ASSERT_EQUAL_INT(0, item.val);
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_SIMPLE, item.type);
+    TEST_ASSERT_EQUAL_INT(21, item.val);
+    TEST_ASSERT_EQUAL_INT(3, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_FLOAT, item.type);
+    TEST_ASSERT_EQUAL_INT(2, item.size);
+    TEST_ASSERT_EQUAL_INT(0x3e00, item.val);
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_BREAK, item.type);
+    TEST_ASSERT(cbor_reader_at_end(&reader));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+}
+
+static void test_reader_skip(void)
+{
+    /* [{1: [2, 3]}, [_ "a", h'00'], 4] */
+    unsigned char data[] = { 0x83, 0xa1, 0x01, 0x82, 0x02, 0x03, 0x9f, 0x61,
+                             0x61, 0x41, 0x00, 0xff, 0x04 };
+    cbor_reader_t reader;
+    cbor_item_t item;
+
+    cbor_reader_init(&reader, data, sizeof(data));
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(5, cbor_reader_skip(&reader));
+    TEST_ASSERT_EQUAL_INT(6, cbor_reader_skip(&reader));
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(4, item.val);
+
+    cbor_reader_init(&reader, data, sizeof(data));
+    TEST_ASSERT_EQUAL_INT(sizeof(data), cbor_reader_skip(&reader));
+}
+
+static void test_reader_invalid(void)
+{
+    /* byte string claiming 4 bytes but only 2 follow */
+    unsigned char truncated[] = { 0x44, 0x00, 0x01 };
+    /* array missing its last item */
+    unsigned char incomplete[] = { 0x82, 0x01 };
+    cbor_reader_t reader;
+    cbor_item_t item;
+
+    cbor_reader_init(&reader, truncated, sizeof(truncated));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+
+    cbor_reader_init(&reader, incomplete, sizeof(incomplete));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_skip(&reader));
+    TEST_ASSERT_EQUAL_INT(0, reader.pos);
+}
+
+typedef struct {
+    int32_t temp;
+    uint32_t seq;
+    char name[8];
+    bool alarm;
+    int64_t uptime;
+    uint64_t id;
+#ifndef CBOR_NO_FLOAT
+    float ratio;
+#endif /* CBOR_NO_FLOAT */
+} codec_test_t;
+
+#ifndef CBOR_NO_FLOAT
+#define CODEC_TEST_FLOAT_FIELDS(X, T) X(T, FLOAT, ratio)
+#else
+#define CODEC_TEST_FLOAT_FIELDS(X, T)
+#endif /* CBOR_NO_FLOAT */
+
+#define CODEC_TEST_FIELDS(X, T) \
+    X(T, INT32, temp)           \
+    X(T, UINT32, seq)           \
+    X(T, TEXT, name)            \
+    X(T, BOOL, alarm)           \
+    X(T, INT64, uptime)         \
+    X(T, UINT64, id)            \
+    CODEC_TEST_FLOAT_FIELDS(X, T)
+
+STRUCT_CODEC(codec_test, codec_test_t, CODEC_TEST_FIELDS);
+
+static const codec_test_t codec_test_val = {
+    .temp = -300, .seq = 0x10000, .name = "sensor", .alarm = true,
+    .uptime = -(1LL << 40), .id = UINT64_MAX,
+#ifndef CBOR_NO_FLOAT
+    .ratio = 1.5f,
+#endif /* CBOR_NO_FLOAT */
+};
+
+static void test_codec_hand_written(void)
+{
+    unsigned char buf[96];
+
+    cbor_serialize_map(&stream, codec_test.numof);
+    cbor_serialize_unicode_string(&stream, "temp");
+    cbor_serialize_int(&stream, codec_test_val.temp);
+    cbor_serialize_unicode_string(&stream, "seq");
+    cbor_serialize_uint64_t(&stream, codec_test_val.seq);
+    cbor_serialize_unicode_string(&stream, "name");
+    cbor_serialize_unicode_string(&stream, codec_test_val.name);
+    cbor_serialize_unicode_string(&stream, "alarm");
+    cbor_serialize_bool(&stream, codec_test_val.alarm);
+    cbor_serialize_unicode_string(&stream, "uptime");
+    cbor_serialize_int64_t(&stream, codec_test_val.uptime);
+    cbor_serialize_unicode_string(&stream, "id");
+    cbor_serialize_uint64_t(&stream, codec_test_val.id);
+#ifndef CBOR_NO_FLOAT
+    cbor_serialize_unicode_string(&stream, "ratio");
+    cbor_serialize_float(&stream, codec_test_val.ratio);
+#endif /* CBOR_NO_FLOAT */
+
+    TEST_ASSERT_EQUAL_INT(stream.pos, cbor_codec_size(&codec_test, &codec_test_val));
+    TEST_ASSERT_EQUAL_INT(stream.pos, cbor_codec_encode(&codec_test, &codec_test_val,
+                                                        buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(stream.data, buf, stream.pos));
+    TEST_ASSERT_EQUAL_INT(0, cbor_codec_encode(&codec_test, &codec_test_val,
+                                               buf, stream.pos - 1));
+}
+
+static void test_codec_round_trip(void)
+{
+    unsigned char buf[96];
+    codec_test_t res;
+    size_t len = cbor_codec_encode(&codec_test, &codec_test_val, buf, sizeof(buf));
+
+    TEST_ASSERT(len > 0);
+    memset(&res, 0, sizeof(res));
+    TEST_ASSERT_EQUAL_INT(len, cbor_codec_decode(&codec_test, &res, buf, len));
+    TEST_ASSERT_EQUAL_INT(codec_test_val.temp, res.temp);
+    TEST_ASSERT(codec_test_val.seq == res.seq);
+    TEST_ASSERT_EQUAL_STRING((char *)codec_test_val.name, (char *)res.name);
+    TEST_ASSERT(res.alarm);
+    TEST_ASSERT(codec_test_val.uptime == res.uptime);
+    TEST_ASSERT(codec_test_val.id == res.id);
+#ifndef CBOR_NO_FLOAT
+    TEST_ASSERT(codec_test_val.ratio == res.ratio);
+#endif /* CBOR_NO_FLOAT */
+
+    TEST_ASSERT_EQUAL_INT(0, cbor_codec_decode(&codec_test, &res, buf, len - 1));
+    /* keys must match the member names */
+    buf[2] = 'x';
+    TEST_ASSERT_EQUAL_INT(0, cbor_codec_decode(&codec_test, &res, buf, len));
+}
+
 #ifndef CBOR_NO_PRINT
 /**
  * Manual test for testing the cbor_stream_decode function
@@ -770,6 +1018,13 @@ TestRef tests_cbor_all(void)
                         new_TestFixture(test_map),
                         new_TestFixture(test_map_indefinite),
                         new_TestFixture(test_map_invalid),
+                        new_TestFixture(test_writer_chain),
+                        new_TestFixture(test_writer_backpressure),
+                        new_TestFixture(test_reader),
+                        new_TestFixture(test_reader_skip),
+                        new_TestFixture(test_reader_invalid),
+                        new_TestFixture(test_codec_hand_written),
+                        new_TestFixture(test_codec_round_trip),
 #ifndef CBOR_NO_SEMANTIC_TAGGING
                         new_TestFixture(test_semantic_tagging),
 #ifndef CBOR_NO_CTIME
@@ -16,6 +16,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <string.h>
+
 #include "thread.h"
 #include "ringbuffer.h"
 #include "mutex.h"
@@ -114,10 +116,55 @@ static void tests_core_ringbuffer(void)
     run_add();
 }
 
+static void tests_core_ringbuffer_bulk(void)
+{
+    char buf[BUF_SIZE];
+    char out[BUF_SIZE];
+
+    ringbuffer_init(&rb, rb_buf, sizeof(rb_buf));
+    for (unsigned i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+
+    /* move the start so that the content wraps around */
+    TEST_ASSERT_EQUAL_INT(5, ringbuffer_add(&rb, buf, 5));
+    TEST_ASSERT_EQUAL_INT(5, ringbuffer_get(&rb, out, sizeof(out)));
+
+    TEST_ASSERT_EQUAL_INT(BUF_SIZE, ringbuffer_add(&rb, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, ringbuffer_add(&rb, buf, 1));
+    TEST_ASSERT_EQUAL_INT(BUF_SIZE, ringbuffer_get(&rb, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, out, sizeof(buf)));
+}
+
+static void tests_core_ringbuffer_span(void)
+{
+    char *data;
+
+    ringbuffer_init(&rb, rb_buf, sizeof(rb_buf));
+    ringbuffer_add(&rb, "abcde", 5);
+    TEST_ASSERT_EQUAL_INT(2, ringbuffer_remove(&rb, 2));
+    TEST_ASSERT_EQUAL_INT('c', ringbuffer_peek_one(&rb));
+
+    /* free space wraps around: only the two bytes till the end are contiguous */
+    TEST_ASSERT_EQUAL_INT(2, ringbuffer_reserve_span(&rb, &data));
+    TEST_ASSERT(data == &rb_buf[5]);
+    memcpy(data, "fg", 2);
+    TEST_ASSERT_EQUAL_INT(2, ringbuffer_commit_write(&rb, 2));
+    TEST_ASSERT_EQUAL_INT(2, ringbuffer_reserve_span(&rb, &data));
+    TEST_ASSERT(data == &rb_buf[0]);
+
+    TEST_ASSERT_EQUAL_INT(5, ringbuffer_peek_span(&rb, &data));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, "cdefg", 5));
+    TEST_ASSERT_EQUAL_INT(5, ringbuffer_remove(&rb, 5));
+    TEST_ASSERT(ringbuffer_empty(&rb));
+}
+
 Test *tests_core_ringbuffer_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
         new_TestFixture(tests_core_ringbuffer),
+        new_TestFixture(tests_core_ringbuffer_bulk),
+        new_TestFixture(tests_core_ringbuffer_span),
     };
 
     EMB_UNIT_TESTCALLER(ringbuffer_tests, NULL, NULL, fixtures);
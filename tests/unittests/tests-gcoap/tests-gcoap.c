@@ -13,11 +13,19 @@
  */
 #include <errno.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "embUnit.h"
 
+#include "msg.h"
 #include "net/gnrc/coap.h"
+#include "net/gnrc/ipv6/hdr.h"
+#include "net/gnrc/netreg.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/udp.h"
+#include "utlist.h"
+#include "xtimer.h"
 
 #include "unittests-constants.h"
 #include "tests-gcoap.h"
@@ -156,6 +164,1570 @@ static void test_gcoap__server_get_resp(void)
     }
 }
 
+/*
+ * Server GET response to a confirmable request. Test piggybacking on the ACK.
+ * Request for gcoap_cli /cli/stats resource, as above, but CON
+ */
+static void test_gcoap__server_con_resp(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+
+    /* read request, make it confirmable */
+    _read_cli_stats_req(&pdu, &buf[0]);
+    gcoap_hdr_set_type(pdu.hdr, COAP_TYPE_CON);
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_CON, coap_get_type(&pdu));
+
+    /* generate response */
+    gcoap_resp_init(&pdu, &buf[0], sizeof(buf), COAP_CODE_CONTENT);
+    ssize_t res = gcoap_finish(&pdu, 0, COAP_FORMAT_NONE);
+
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_ACK, coap_get_type(&pdu));
+    TEST_ASSERT_EQUAL_INT(0x20b6, coap_get_id(&pdu));
+    TEST_ASSERT_EQUAL_INT(2, coap_get_token_len(&pdu));
+    TEST_ASSERT_EQUAL_INT(4 + 2, res);
+}
+
+static ssize_t _dummy_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return gcoap_response(pdu, buf, len, COAP_CODE_CONTENT);
+}
+
+/*
+ * Server notification for a resource without observers. Test that nothing
+ * is initialized.
+ */
+static void test_gcoap__server_obs_init_unused(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    coap_resource_t resource = { "/value", COAP_GET, _dummy_handler };
+
+    TEST_ASSERT_EQUAL_INT(GCOAP_OBS_INIT_UNUSED,
+                          gcoap_obs_init(&pdu, &buf[0], sizeof(buf), &resource));
+}
+
+/*
+ * Helpers for the tests below, which pass messages to gcoap from the test
+ * thread. The test thread registers for UDP, so it receives what gcoap sends.
+ */
+#define PEER_PORT       (5684)
+#define MSG_QUEUE_SIZE  (8)
+
+static msg_t _msg_queue[MSG_QUEUE_SIZE];
+static gnrc_netreg_entry_t _udp_entry;
+static ipv6_addr_t _peer = { .u8 = { 0xfe, 0x80, [15] = 0x01 } };
+static int _handled;
+static unsigned _resp_state;
+static unsigned _resp_count;
+
+static void set_up(void)
+{
+    gnrc_pktbuf_init();
+    msg_init_queue(_msg_queue, MSG_QUEUE_SIZE);
+    gnrc_netreg_entry_init_pid(&_udp_entry, GNRC_NETREG_DEMUX_CTX_ALL,
+                               sched_active_pid);
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &_udp_entry);
+    gcoap_reset();
+    _handled = 0;
+    _resp_count = 0;
+}
+
+static void tear_down(void)
+{
+    msg_t msg;
+
+    gcoap_reset();
+    gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &_udp_entry);
+    while (msg_try_receive(&msg) == 1) {
+        gnrc_pktbuf_release(msg.content.ptr);
+    }
+}
+
+/* Passes a CoAP message from the peer to gcoap. */
+static void _inject(const uint8_t *data, size_t len)
+{
+    udp_hdr_t hdr = { .src_port = byteorder_htons(PEER_PORT),
+                      .dst_port = byteorder_htons(GCOAP_PORT) };
+    gnrc_pktsnip_t *ipv6 = gnrc_ipv6_hdr_build(NULL, &_peer, NULL);
+    gnrc_pktsnip_t *udp = gnrc_pktbuf_add(ipv6, &hdr, sizeof(hdr),
+                                          GNRC_NETTYPE_UDP);
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(udp, (void *)data, len,
+                                          GNRC_NETTYPE_UNDEF);
+    msg_t msg = { .type = GNRC_NETAPI_MSG_TYPE_RCV, .content.ptr = pkt };
+
+    gcoap_handle_msg(&msg);
+}
+
+/*
+ * Reads the next CoAP message sent by gcoap, if sent to port; returns its
+ * length, or 0.
+ */
+static size_t _recv_to(uint8_t *buf, size_t len, uint16_t port)
+{
+    gnrc_pktsnip_t *udp, *snip;
+    msg_t msg;
+    size_t res = 0;
+
+    if (msg_try_receive(&msg) != 1) {
+        return 0;
+    }
+    LL_SEARCH_SCALAR((gnrc_pktsnip_t *)msg.content.ptr, udp, type,
+                     GNRC_NETTYPE_UDP);
+    if (udp && (byteorder_ntohs(((udp_hdr_t *)udp->data)->dst_port) == port)) {
+        for (snip = udp->next; snip && (res + snip->size <= len);
+             snip = snip->next) {
+            memcpy(buf + res, snip->data, snip->size);
+            res += snip->size;
+        }
+    }
+    gnrc_pktbuf_release(msg.content.ptr);
+    return res;
+}
+
+/* Reads the next CoAP message sent by gcoap to the peer. */
+static size_t _recv(uint8_t *buf, size_t len)
+{
+    return _recv_to(buf, len, PEER_PORT);
+}
+
+/* Sends a request for path; returns the response code, or -1 if none. */
+static int _request(unsigned method, const char *path)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    ssize_t len;
+
+    len = gcoap_request(&pdu, buf, sizeof(buf), method, (char *)path);
+    _inject(buf, len);
+    len = _recv(buf, sizeof(buf));
+    if ((len == 0) || (coap_parse(&pdu, buf, len) < 0)) {
+        return -1;
+    }
+    return coap_get_code_raw(&pdu);
+}
+
+/* Writes a confirmable GET request for path; returns its length. */
+static size_t _con_request(uint8_t *buf, const char *path)
+{
+    coap_pkt_t pdu;
+    ssize_t len = gcoap_request(&pdu, buf, GCOAP_PDU_BUF_SIZE, COAP_METHOD_GET,
+                                (char *)path);
+
+    gcoap_hdr_set_type(pdu.hdr, COAP_TYPE_CON);
+    return len;
+}
+
+/* Passes a response without options to the request in req to gcoap. */
+static void _inject_resp(const uint8_t *req, unsigned type, unsigned code,
+                         uint16_t id)
+{
+    uint8_t buf[GCOAP_HEADER_MAXLEN];
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)req };
+
+    _inject(buf, coap_build_hdr((coap_hdr_t *)buf, type, &pdu.hdr->data[0],
+                                coap_get_token_len(&pdu), code, id));
+}
+
+/* Passes an empty message to gcoap. */
+static void _inject_empty(unsigned type, uint16_t id)
+{
+    coap_hdr_t hdr;
+
+    _inject((uint8_t *)&hdr, coap_build_hdr(&hdr, type, NULL, 0, 0, id));
+}
+
+/* Returns the message ID of a CoAP message. */
+static uint16_t _id(const uint8_t *buf)
+{
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)buf };
+
+    return coap_get_id(&pdu);
+}
+
+/* Returns the memo of the first request waiting for a response. */
+static gcoap_request_memo_t *_open_memo(void)
+{
+    gcoap_state_t *state = gcoap_get_state();
+
+    for (int i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
+        if (state->open_reqs[i].state == GCOAP_MEMO_WAIT) {
+            return &state->open_reqs[i];
+        }
+    }
+    return NULL;
+}
+
+/* Lets the first request in the timeout queue expire. */
+static void _expire(void)
+{
+    msg_t msg = { .type = GCOAP_NETAPI_MSG_TYPE_TIMEOUT };
+
+    gcoap_get_state()->timeout_queue->deadline = xtimer_now_usec();
+    gcoap_handle_msg(&msg);
+}
+
+static void _resp_handler(unsigned req_state, coap_pkt_t *pdu)
+{
+    (void)pdu;
+    _resp_state = req_state;
+    _resp_count++;
+}
+
+static ssize_t _handle(coap_pkt_t *pdu, uint8_t *buf, size_t len, int id)
+{
+    _handled = id;
+    return gcoap_response(pdu, buf, len, COAP_CODE_CONTENT);
+}
+
+static ssize_t _a_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return _handle(pdu, buf, len, 1);
+}
+
+static ssize_t _a_any_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return _handle(pdu, buf, len, 2);
+}
+
+static ssize_t _a_b_any_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return _handle(pdu, buf, len, 3);
+}
+
+static coap_resource_t _index_resources[] = {
+    { "/a", COAP_GET, _a_handler },
+    { "/a/*", COAP_GET, _a_any_handler },
+    { "/a/b/*", COAP_GET, _a_b_any_handler },
+};
+
+static gcoap_listener_t _index_listener = {
+    &_index_resources[0],
+    sizeof(_index_resources) / sizeof(_index_resources[0]),
+    NULL
+};
+
+/* Checks the resources of _index_listener are found for a request path. */
+static void _check_index_resources(void)
+{
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, _request(COAP_METHOD_GET, "/a"));
+    TEST_ASSERT_EQUAL_INT(1, _handled);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, _request(COAP_METHOD_GET, "/a/x"));
+    TEST_ASSERT_EQUAL_INT(2, _handled);
+    /* a wildcard segment requires a segment in the path */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, _request(COAP_METHOD_GET, "/a/b"));
+    TEST_ASSERT_EQUAL_INT(2, _handled);
+    /* longest prefix wins */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _request(COAP_METHOD_GET, "/a/b/c/d"));
+    TEST_ASSERT_EQUAL_INT(3, _handled);
+
+    /* prefix must end at a segment boundary */
+    _handled = 0;
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_PATH_NOT_FOUND,
+                          _request(COAP_METHOD_GET, "/ab"));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_PATH_NOT_FOUND,
+                          _request(COAP_METHOD_GET, "/b/a"));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_PATH_NOT_FOUND,
+                          _request(COAP_METHOD_POST, "/a"));
+    TEST_ASSERT_EQUAL_INT(0, _handled);
+
+    /* gcoap's own resource */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _request(COAP_METHOD_GET, "/.well-known/core"));
+}
+
+/*
+ * Server lookup of exact and wildcard paths in the resource index.
+ */
+static void test_gcoap__server_index(void)
+{
+    gcoap_register_listener(&_index_listener);
+    TEST_ASSERT(!gcoap_resource_index_full());
+
+    _check_index_resources();
+}
+
+/*
+ * Server lookup with more resources than GCOAP_RESOURCE_INDEX_SIZE. Test that
+ * gcoap falls back to scanning the listeners.
+ */
+static void test_gcoap__server_index_full(void)
+{
+    static char paths[GCOAP_RESOURCE_INDEX_SIZE][8];
+    static coap_resource_t resources[GCOAP_RESOURCE_INDEX_SIZE];
+    static gcoap_listener_t listener = { &resources[0],
+                                         GCOAP_RESOURCE_INDEX_SIZE, NULL };
+
+    for (unsigned i = 0; i < GCOAP_RESOURCE_INDEX_SIZE; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "/r/%u", i);
+        resources[i].path = paths[i];
+        resources[i].methods = COAP_GET;
+        resources[i].handler = _a_handler;
+    }
+    gcoap_register_listener(&listener);
+    TEST_ASSERT(gcoap_resource_index_full());
+    gcoap_register_listener(&_index_listener);
+
+    for (unsigned i = 0; i < GCOAP_RESOURCE_INDEX_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                              _request(COAP_METHOD_GET, paths[i]));
+    }
+    _check_index_resources();
+}
+
+/*
+ * Client request which cannot be sent. Test that it does not remain open.
+ */
+static void test_gcoap__client_send_fail(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    uint8_t open_reqs;
+
+    ssize_t len = gcoap_request(&pdu, buf, sizeof(buf), COAP_METHOD_GET, "/a");
+    gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &_udp_entry);
+
+    TEST_ASSERT_EQUAL_INT(0, gcoap_req_send(buf, len, &_peer, PEER_PORT,
+                                            _resp_handler));
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &_udp_entry);
+    gcoap_op_state(&open_reqs);
+    TEST_ASSERT_EQUAL_INT(0, open_reqs);
+    TEST_ASSERT_EQUAL_INT(0, _resp_count);
+}
+
+/*
+ * Client confirmable requests acknowledged by piggybacked responses. Test the
+ * strong RTO estimator.
+ */
+static void test_gcoap__client_con_rto_strong(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    gcoap_con_stats_t stats;
+    gcoap_request_memo_t *memo;
+    size_t len = _con_request(buf, "/a");
+
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, sent, len));
+    memo = _open_memo();
+    TEST_ASSERT_NOT_NULL(memo);
+    /* unknown peer: default timeout, dithered by up to 50% */
+    TEST_ASSERT(memo->timeout >= GCOAP_ACK_TIMEOUT);
+    TEST_ASSERT(memo->timeout <= GCOAP_ACK_TIMEOUT + GCOAP_ACK_TIMEOUT / 2 + 1);
+
+    /* SRTT 200 ms, RTTVAR 100 ms; RTO (2 s + 200 ms + 4 * 100 ms) / 2 */
+    memo->sent -= 200000;
+    _inject_resp(buf, COAP_TYPE_ACK, COAP_CODE_CONTENT, _id(buf));
+    TEST_ASSERT_EQUAL_INT(1, _resp_count);
+    TEST_ASSERT_EQUAL_INT(GCOAP_MEMO_RESP, _resp_state);
+    TEST_ASSERT(gcoap_peer_rto(&_peer) >= 1300000);
+    TEST_ASSERT(gcoap_peer_rto(&_peer) < 1310000);
+
+    len = _con_request(buf, "/a");
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+    memo = _open_memo();
+    TEST_ASSERT(memo->timeout >= 1300000);
+    TEST_ASSERT(memo->timeout <= 1310000 + 1310000 / 2 + 1);
+
+    /* SRTT 225 ms, RTTVAR 125 ms; RTO (1.3 s + 225 ms + 4 * 125 ms) / 2 */
+    memo->sent -= 400000;
+    _inject_resp(buf, COAP_TYPE_ACK, COAP_CODE_CONTENT, _id(buf));
+    TEST_ASSERT_EQUAL_INT(2, _resp_count);
+    TEST_ASSERT(gcoap_peer_rto(&_peer) >= 1012500);
+    TEST_ASSERT(gcoap_peer_rto(&_peer) < 1022500);
+
+    gcoap_con_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, stats.con_sent);
+    TEST_ASSERT_EQUAL_INT(2, stats.rtt_samples);
+    TEST_ASSERT_EQUAL_INT(0, stats.retransmissions);
+}
+
+/*
+ * Client confirmable request acknowledged after retransmission. Test the weak
+ * RTO estimator, and that a sample after more than two retransmissions is
+ * ignored.
+ */
+static void test_gcoap__client_con_rto_weak(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    gcoap_con_stats_t stats;
+    gcoap_request_memo_t *memo;
+    size_t len = _con_request(buf, "/a");
+
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+    _expire();
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+
+    /* SRTT 200 ms, RTTVAR 100 ms; RTO (3 * 2 s + 200 ms + 100 ms) / 4 */
+    memo = _open_memo();
+    memo->sent -= 200000;
+    _inject_resp(buf, COAP_TYPE_ACK, COAP_CODE_CONTENT, _id(buf));
+    TEST_ASSERT_EQUAL_INT(GCOAP_MEMO_RESP, _resp_state);
+    TEST_ASSERT(gcoap_peer_rto(&_peer) >= 1575000);
+    TEST_ASSERT(gcoap_peer_rto(&_peer) < 1585000);
+
+    len = _con_request(buf, "/a");
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+    for (int i = 0; i < 3; i++) {
+        _expire();
+        TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+    }
+    uint32_t rto = gcoap_peer_rto(&_peer);
+    _inject_resp(buf, COAP_TYPE_ACK, COAP_CODE_CONTENT, _id(buf));
+    TEST_ASSERT_EQUAL_INT(2, _resp_count);
+    TEST_ASSERT_EQUAL_INT(rto, gcoap_peer_rto(&_peer));
+
+    gcoap_con_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.rtt_samples);
+    TEST_ASSERT_EQUAL_INT(4, stats.retransmissions);
+}
+
+/*
+ * Client confirmable requests to a peer with an old RTO estimate. Test that a
+ * short RTO grows and a long one decays towards the default.
+ */
+static void test_gcoap__client_con_rto_aging(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    gcoap_state_t *state = gcoap_get_state();
+    gcoap_peer_t *peer = &state->peers[0];
+    gcoap_request_memo_t *memo;
+    size_t len = _con_request(buf, "/a");
+
+    /* create RTO state for the peer */
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    _recv(sent, sizeof(sent));
+    _inject_resp(buf, COAP_TYPE_ACK, COAP_CODE_CONTENT, _id(buf));
+    if (!ipv6_addr_equal(&peer->addr, &_peer)) {
+        peer = &state->peers[1];
+    }
+    TEST_ASSERT(ipv6_addr_equal(&peer->addr, &_peer));
+
+    peer->rto = 500000;
+    peer->updated = xtimer_now_usec() - 16 * 500000 - 1;
+    len = _con_request(buf, "/a");
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    _recv(sent, sizeof(sent));
+    TEST_ASSERT_EQUAL_INT(1000000, gcoap_peer_rto(&_peer));
+    memo = _open_memo();
+    TEST_ASSERT(memo->timeout >= 1000000);
+    TEST_ASSERT(memo->timeout <= 1500001);
+    _inject_empty(COAP_TYPE_RST, _id(buf));
+
+    peer->rto = 4000000;
+    peer->updated = xtimer_now_usec() - 4 * 4000000 - 1;
+    len = _con_request(buf, "/a");
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    _recv(sent, sizeof(sent));
+    TEST_ASSERT_EQUAL_INT((GCOAP_ACK_TIMEOUT + 4000000) / 2,
+                          gcoap_peer_rto(&_peer));
+    memo = _open_memo();
+    TEST_ASSERT(memo->timeout >= 3000000);
+    TEST_ASSERT(memo->timeout <= 4500001);
+
+    /* a recent estimate stays */
+    _inject_empty(COAP_TYPE_RST, _id(buf));
+    len = _con_request(buf, "/a");
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    _recv(sent, sizeof(sent));
+    TEST_ASSERT_EQUAL_INT(3000000, gcoap_peer_rto(&_peer));
+}
+
+/*
+ * Client confirmable request without any response. Test back-off of the
+ * retransmissions, and the timeout after the last one.
+ */
+static void test_gcoap__client_con_timeout(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    gcoap_con_stats_t stats;
+    uint8_t open_reqs;
+    size_t len = _con_request(buf, "/a");
+
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+
+    gcoap_request_memo_t *memo = _open_memo();
+    for (unsigned i = 1; i <= GCOAP_MAX_RETRANSMIT; i++) {
+        uint32_t timeout = memo->timeout;
+        if (timeout < 1000000U) {
+            timeout *= 3;
+        }
+        else if (timeout > 3000000U) {
+            timeout += timeout / 2;
+        }
+        else {
+            timeout *= 2;
+        }
+
+        _expire();
+        TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+        TEST_ASSERT_EQUAL_INT(0, memcmp(buf, sent, len));
+        TEST_ASSERT_EQUAL_INT(i, memo->retransmits);
+        TEST_ASSERT_EQUAL_INT(timeout, memo->timeout);
+        TEST_ASSERT_EQUAL_INT(0, _resp_count);
+    }
+
+    _expire();
+    TEST_ASSERT_EQUAL_INT(0, _recv(sent, sizeof(sent)));
+    TEST_ASSERT_EQUAL_INT(1, _resp_count);
+    TEST_ASSERT_EQUAL_INT(GCOAP_MEMO_TIMEOUT, _resp_state);
+    gcoap_op_state(&open_reqs);
+    TEST_ASSERT_EQUAL_INT(0, open_reqs);
+
+    gcoap_con_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(GCOAP_MAX_RETRANSMIT, stats.retransmissions);
+    TEST_ASSERT_EQUAL_INT(1, stats.con_timeouts);
+    TEST_ASSERT_EQUAL_INT(0, stats.rtt_samples);
+}
+
+/*
+ * Client confirmable requests expiring together. Test that all of them are
+ * retransmitted, also beyond the batch gcoap collects under its lock.
+ */
+static void test_gcoap__client_con_timeout_many(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    gcoap_state_t *state = gcoap_get_state();
+    msg_t msg = { .type = GCOAP_NETAPI_MSG_TYPE_TIMEOUT };
+    gcoap_con_stats_t stats;
+    size_t len = 0;
+
+    for (unsigned i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
+        len = _con_request(buf, "/a");
+        TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+        TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+    }
+
+    uint32_t now = xtimer_now_usec();
+    for (unsigned i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
+        state->open_reqs[i].deadline = now;
+    }
+    gcoap_handle_msg(&msg);
+    for (unsigned i = 0; i < GCOAP_REQ_WAITING_MAX; i++) {
+        TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+        TEST_ASSERT_EQUAL_INT(1, state->open_reqs[i].retransmits);
+    }
+    TEST_ASSERT_EQUAL_INT(0, _recv(sent, sizeof(sent)));
+    TEST_ASSERT_EQUAL_INT(0, _resp_count);
+
+    gcoap_con_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(GCOAP_REQ_WAITING_MAX, stats.retransmissions);
+}
+
+/*
+ * Client confirmable request acknowledged by an empty ACK, and answered by a
+ * separate response. Test that the ACK stops retransmission, and that gcoap
+ * acknowledges the response.
+ */
+static void test_gcoap__client_con_separate(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    size_t len = _con_request(buf, "/a");
+
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+
+    /* ID of another request does not match */
+    _inject_empty(COAP_TYPE_ACK, _id(buf) + GCOAP_REQ_INDEX_SIZE);
+    TEST_ASSERT_NOT_NULL(_open_memo()->msg);
+
+    _inject_empty(COAP_TYPE_ACK, _id(buf));
+    TEST_ASSERT_NULL(_open_memo()->msg);
+    TEST_ASSERT_EQUAL_INT(0, _resp_count);
+    TEST_ASSERT_EQUAL_INT(0, _recv(sent, sizeof(sent)));
+
+    _inject_resp(buf, COAP_TYPE_CON, COAP_CODE_CONTENT, 0x1234);
+    TEST_ASSERT_EQUAL_INT(1, _resp_count);
+    TEST_ASSERT_EQUAL_INT(GCOAP_MEMO_RESP, _resp_state);
+    TEST_ASSERT_EQUAL_INT(sizeof(coap_hdr_t), _recv(sent, sizeof(sent)));
+    pdu.hdr = (coap_hdr_t *)sent;
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_ACK, coap_get_type(&pdu));
+    TEST_ASSERT_EQUAL_INT(0, coap_get_code_raw(&pdu));
+    TEST_ASSERT_EQUAL_INT(0x1234, coap_get_id(&pdu));
+}
+
+/*
+ * Client confirmable request rejected with RST, and a ping from the peer.
+ */
+static void test_gcoap__client_con_reset(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE], sent[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    uint8_t open_reqs;
+    size_t len = _con_request(buf, "/a");
+
+    TEST_ASSERT(gcoap_req_send(buf, len, &_peer, PEER_PORT, _resp_handler) > 0);
+    TEST_ASSERT_EQUAL_INT(len, _recv(sent, sizeof(sent)));
+
+    _inject_empty(COAP_TYPE_RST, _id(buf));
+    TEST_ASSERT_EQUAL_INT(1, _resp_count);
+    TEST_ASSERT_EQUAL_INT(GCOAP_MEMO_ERR, _resp_state);
+    gcoap_op_state(&open_reqs);
+    TEST_ASSERT_EQUAL_INT(0, open_reqs);
+
+    _inject_empty(COAP_TYPE_CON, 0x4321);
+    TEST_ASSERT_EQUAL_INT(sizeof(coap_hdr_t), _recv(sent, sizeof(sent)));
+    pdu.hdr = (coap_hdr_t *)sent;
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_RST, coap_get_type(&pdu));
+    TEST_ASSERT_EQUAL_INT(0x4321, coap_get_id(&pdu));
+}
+
+/*
+ * Server receives requests twice. Test that the resource handles a request
+ * once, and that only the response to a confirmable request is repeated.
+ */
+static void test_gcoap__server_dup(void)
+{
+    uint8_t req[GCOAP_PDU_BUF_SIZE];
+    uint8_t resp[GCOAP_PDU_BUF_SIZE], resp2[GCOAP_PDU_BUF_SIZE];
+    gcoap_state_t *state = gcoap_get_state();
+    gcoap_con_stats_t stats;
+    coap_pkt_t pdu;
+
+    gcoap_register_listener(&_index_listener);
+
+    size_t len = _con_request(req, "/a");
+    _inject(req, len);
+    TEST_ASSERT_EQUAL_INT(1, _handled);
+    size_t resp_len = _recv(resp, sizeof(resp));
+    TEST_ASSERT(resp_len > 0);
+    pdu.hdr = (coap_hdr_t *)resp;
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_ACK, coap_get_type(&pdu));
+
+    _handled = 0;
+    _inject(req, len);
+    TEST_ASSERT_EQUAL_INT(0, _handled);
+    TEST_ASSERT_EQUAL_INT(resp_len, _recv(resp2, sizeof(resp2)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(resp, resp2, resp_len));
+
+    /* non-confirmable duplicate is dropped */
+    uint8_t req_non[GCOAP_PDU_BUF_SIZE];
+    size_t len_non = gcoap_request(&pdu, req_non, sizeof(req_non),
+                                   COAP_METHOD_GET, "/a");
+    _inject(req_non, len_non);
+    TEST_ASSERT_EQUAL_INT(1, _handled);
+    TEST_ASSERT(_recv(resp2, sizeof(resp2)) > 0);
+    _handled = 0;
+    _inject(req_non, len_non);
+    TEST_ASSERT_EQUAL_INT(0, _handled);
+    TEST_ASSERT_EQUAL_INT(0, _recv(resp2, sizeof(resp2)));
+
+    gcoap_con_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, stats.duplicates);
+
+    /* handled again after the lifetime */
+    for (int i = 0; i < GCOAP_DUP_CACHE_SIZE; i++) {
+        state->dups[i].time -= GCOAP_DUP_LIFETIME;
+    }
+    _inject(req, len);
+    TEST_ASSERT_EQUAL_INT(1, _handled);
+    TEST_ASSERT_EQUAL_INT(resp_len, _recv(resp2, sizeof(resp2)));
+}
+
+static ssize_t _value_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    _handled = 4;
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    pdu->payload[0] = 'v';
+    return gcoap_finish(pdu, 1, COAP_FORMAT_TEXT);
+}
+
+static coap_resource_t _obs_resources[] = {
+    { "/value", COAP_GET, _value_handler },
+};
+
+static gcoap_listener_t _obs_listener = { &_obs_resources[0], 1, NULL };
+
+/*
+ * Writes a GET request for /value with a one byte token, and an Observe
+ * option unless observe is < 0; returns its length.
+ */
+static size_t _obs_request(uint8_t *buf, uint8_t token, int observe)
+{
+    uint8_t *pos = buf;
+    uint8_t value = observe;
+    unsigned last = 0;
+
+    pos += coap_build_hdr((coap_hdr_t *)buf, COAP_TYPE_NON, &token, 1,
+                          COAP_METHOD_GET, token);
+    if (observe >= 0) {
+        pos += coap_put_option(pos, 0, COAP_OPT_OBSERVE, &value,
+                               (observe > 0) ? 1 : 0);
+        last = COAP_OPT_OBSERVE;
+    }
+    pos += coap_put_option_url(pos, last, "/value");
+    return pos - buf;
+}
+
+/*
+ * Sends a notification with payload for /value; returns gcoap_obs_send(), or
+ * gcoap_obs_init() if it fails.
+ */
+static int _notify(char payload)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    int res = gcoap_obs_init(&pdu, buf, sizeof(buf), &_obs_resources[0]);
+
+    if (res != GCOAP_OBS_INIT_OK) {
+        return res;
+    }
+    pdu.payload[0] = payload;
+    ssize_t len = gcoap_finish(&pdu, 1, COAP_FORMAT_TEXT);
+    return gcoap_obs_send(buf, len, &_obs_resources[0]);
+}
+
+/* Allows the next notification for all observers right now. */
+static void _obs_rewind(void)
+{
+    gcoap_state_t *state = gcoap_get_state();
+
+    for (int i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        state->observers[i].last_sent -= GCOAP_OBS_MIN_INTERVAL;
+    }
+}
+
+/*
+ * Server GET request with Observe option. Test the registration, and that
+ * Observe goes in front of the other options of the response.
+ */
+static void test_gcoap__server_obs_register(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    gcoap_observe_t *obs = &gcoap_get_state()->observers[0];
+    /* token, Observe 0, Content-Format 0, payload */
+    uint8_t resp_data[] = { 0x01, 0x60, 0x60, 0xff, 'v' };
+
+    gcoap_register_listener(&_obs_listener);
+
+    _inject(buf, _obs_request(buf, 0x01, 0));
+    TEST_ASSERT_EQUAL_INT(4, _handled);
+    TEST_ASSERT_EQUAL_INT(sizeof(coap_hdr_t) + sizeof(resp_data),
+                          _recv(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&buf[sizeof(coap_hdr_t)], resp_data,
+                                    sizeof(resp_data)));
+    TEST_ASSERT(obs->resource == &_obs_resources[0]);
+    TEST_ASSERT(ipv6_addr_equal(&_peer, &obs->addr));
+    TEST_ASSERT_EQUAL_INT(PEER_PORT, obs->port);
+    TEST_ASSERT_EQUAL_INT(1, obs->token_len);
+    TEST_ASSERT_EQUAL_INT(0x01, obs->token[0]);
+
+    /* registering again updates the token */
+    _inject(buf, _obs_request(buf, 0x02, 0));
+    TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+    TEST_ASSERT_EQUAL_INT(0x02, obs->token[0]);
+    TEST_ASSERT_NULL(gcoap_get_state()->observers[1].resource);
+
+    /* a failed request does not register */
+    gcoap_reset();
+    _inject(buf, _obs_request(buf, 0x03, 0));
+    _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_PATH_NOT_FOUND, buf[1]);
+    TEST_ASSERT_NULL(obs->resource);
+}
+
+/*
+ * Server notifications. Test the sequence number, and that notifications
+ * within GCOAP_OBS_MIN_INTERVAL are coalesced into the latest one.
+ */
+static void test_gcoap__server_obs_notify(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)buf };
+    gcoap_observe_t *obs = &gcoap_get_state()->observers[0];
+    msg_t msg = { .type = GCOAP_NETAPI_MSG_TYPE_OBS };
+    /* token, Observe 1, Content-Format 0, payload */
+    uint8_t notif_data[] = { 0x01, 0x61, 0x01, 0x60, 0xff, 'a' };
+
+    gcoap_register_listener(&_obs_listener);
+    _inject(buf, _obs_request(buf, 0x01, 0));
+    _recv(buf, sizeof(buf));
+
+    _obs_rewind();
+    TEST_ASSERT_EQUAL_INT(1, _notify('a'));
+    TEST_ASSERT_EQUAL_INT(sizeof(coap_hdr_t) + sizeof(notif_data),
+                          _recv(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&buf[sizeof(coap_hdr_t)], notif_data,
+                                    sizeof(notif_data)));
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_NON, coap_get_type(&pdu));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, coap_get_code_raw(&pdu));
+    TEST_ASSERT_EQUAL_INT(obs->last_id, coap_get_id(&pdu));
+
+    /* too soon; only the last one is sent */
+    TEST_ASSERT_EQUAL_INT(1, _notify('b'));
+    TEST_ASSERT_EQUAL_INT(1, _notify('c'));
+    TEST_ASSERT_EQUAL_INT(0, _recv(buf, sizeof(buf)));
+    TEST_ASSERT_NOT_NULL(obs->pending);
+
+    gcoap_handle_msg(&msg);
+    TEST_ASSERT_EQUAL_INT(0, _recv(buf, sizeof(buf)));
+    _obs_rewind();
+    gcoap_handle_msg(&msg);
+    notif_data[2] = 0x03;
+    notif_data[5] = 'c';
+    TEST_ASSERT_EQUAL_INT(sizeof(coap_hdr_t) + sizeof(notif_data),
+                          _recv(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&buf[sizeof(coap_hdr_t)], notif_data,
+                                    sizeof(notif_data)));
+    TEST_ASSERT_NULL(obs->pending);
+    TEST_ASSERT_EQUAL_INT(0, _recv(buf, sizeof(buf)));
+}
+
+/*
+ * Server deregistration of an observer, by GET with Observe 1, and by RST to
+ * a notification.
+ */
+static void test_gcoap__server_obs_deregister(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    gcoap_observe_t *obs = &gcoap_get_state()->observers[0];
+    /* token, Content-Format 0, payload; no Observe */
+    uint8_t resp_data[] = { 0x02, 0xc0, 0xff, 'v' };
+
+    gcoap_register_listener(&_obs_listener);
+    _inject(buf, _obs_request(buf, 0x01, 0));
+    _recv(buf, sizeof(buf));
+
+    /* pending notification is dropped, too */
+    TEST_ASSERT_EQUAL_INT(1, _notify('a'));
+    TEST_ASSERT_NOT_NULL(obs->pending);
+    _inject(buf, _obs_request(buf, 0x02, 1));
+    TEST_ASSERT_EQUAL_INT(sizeof(coap_hdr_t) + sizeof(resp_data),
+                          _recv(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&buf[sizeof(coap_hdr_t)], resp_data,
+                                    sizeof(resp_data)));
+    TEST_ASSERT_NULL(obs->resource);
+    TEST_ASSERT_NULL(obs->pending);
+    TEST_ASSERT_EQUAL_INT(GCOAP_OBS_INIT_UNUSED, _notify('b'));
+
+    _inject(buf, _obs_request(buf, 0x03, 0));
+    _recv(buf, sizeof(buf));
+    _obs_rewind();
+    TEST_ASSERT_EQUAL_INT(1, _notify('c'));
+    TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+
+    /* RST to another message ID is ignored */
+    _inject_empty(COAP_TYPE_RST, obs->last_id + 1);
+    TEST_ASSERT_NOT_NULL(obs->resource);
+    _inject_empty(COAP_TYPE_RST, obs->last_id);
+    TEST_ASSERT_NULL(obs->resource);
+    TEST_ASSERT_EQUAL_INT(0, _recv(buf, sizeof(buf)));
+}
+
+/*
+ * Block-wise transfer: /blk2 serves a representation of _blk_repr_len bytes,
+ * BLK_REPR_LEN by default, with value i at offset i, /blk1 takes one in
+ * blocks.
+ */
+#define BLK_REPR_LEN    (200)
+
+static size_t _blk_repr_len = BLK_REPR_LEN;
+static size_t _blk_offset;
+static size_t _blk_len;
+static bool _blk_more;
+static unsigned _blk_writes;
+
+static ssize_t _blk_read(uint8_t *dst, size_t offset, size_t size, void *arg)
+{
+    (void)arg;
+    size_t res = 0;
+
+    for (size_t i = offset; (i < _blk_repr_len) && (res < size); i++) {
+        dst[res++] = (uint8_t)i;
+    }
+    return res;
+}
+
+static int _blk_write(const uint8_t *src, size_t offset, size_t len,
+                      bool more, void *arg)
+{
+    (void)src;
+    (void)arg;
+    _blk_offset = offset;
+    _blk_len    = len;
+    _blk_more   = more;
+    _blk_writes++;
+    return 0;
+}
+
+static ssize_t _blk2_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return gcoap_block2_respond(pdu, buf, len, COAP_FORMAT_OCTET, _blk_read,
+                                NULL);
+}
+
+static ssize_t _blk1_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return gcoap_block1_receive(pdu, buf, len, COAP_CODE_CHANGED, _blk_write,
+                                NULL);
+}
+
+static coap_resource_t _blk_resources[] = {
+    { "/blk1", COAP_PUT, _blk1_handler },
+    { "/blk2", COAP_GET, _blk2_handler },
+};
+
+static gcoap_listener_t _blk_listener = { &_blk_resources[0], 2, NULL };
+
+/*
+ * Writes a request for path, with option num and value val unless num is 0,
+ * and payload_len bytes of payload; returns its length.
+ */
+static size_t _blk_request(uint8_t *buf, unsigned method, const char *path,
+                           unsigned num, uint32_t val, size_t payload_len)
+{
+    static uint16_t id;
+    uint8_t token = 0x01;
+    uint8_t *pos = buf;
+    uint8_t val_buf[3] = { val >> 16, val >> 8, val };
+    size_t val_len = (val > 0xffff) ? 3 : (val > 0xff) ? 2 : (val) ? 1 : 0;
+
+    pos += coap_build_hdr((coap_hdr_t *)buf, COAP_TYPE_NON, &token, 1,
+                          method, id++);
+    pos += coap_put_option_url(pos, 0, path);
+    if (num) {
+        pos += coap_put_option(pos, COAP_OPT_URI_PATH, num,
+                               &val_buf[3 - val_len], val_len);
+    }
+    if (payload_len) {
+        *pos++ = GCOAP_PAYLOAD_MARKER;
+        memset(pos, 'x', payload_len);
+        pos += payload_len;
+    }
+    return pos - buf;
+}
+
+/*
+ * Returns the value of option num of a message as unsigned integer, or -1 if
+ * the option is missing.
+ */
+static int32_t _opt_value(const uint8_t *buf, size_t len, unsigned num)
+{
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)buf };
+    const uint8_t *pos = buf + coap_get_total_hdr_len(&pdu);
+    const uint8_t *end = buf + len;
+    unsigned onum = 0;
+
+    while ((pos < end) && (*pos != GCOAP_PAYLOAD_MARKER)) {
+        unsigned delta = *pos >> 4, olen = *pos & 0xf;
+
+        pos++;
+        if (delta == 13) {
+            delta = 13 + *pos++;
+        }
+        else if (delta == 14) {
+            delta = 269 + ((pos[0] << 8) | pos[1]);
+            pos += 2;
+        }
+        if (olen == 13) {
+            olen = 13 + *pos++;
+        }
+        onum += delta;
+        if (onum == num) {
+            uint32_t val = 0;
+            for (unsigned i = 0; i < olen; i++) {
+                val = (val << 8) | pos[i];
+            }
+            return val;
+        }
+        pos += olen;
+    }
+    return -1;
+}
+
+/*
+ * Checks a Block2 response: the Block2 option value, and a payload of size
+ * bytes from offset of the representation.
+ */
+static void _check_block2(uint8_t *buf, size_t len, uint32_t block2,
+                          size_t offset, size_t size)
+{
+    coap_pkt_t pdu;
+
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&pdu, buf, len));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, coap_get_code_raw(&pdu));
+    TEST_ASSERT_EQUAL_INT(COAP_FORMAT_OCTET, pdu.content_type);
+    TEST_ASSERT_EQUAL_INT(block2, _opt_value(buf, len, COAP_OPT_BLOCK2));
+    TEST_ASSERT_EQUAL_INT(size, pdu.payload_len);
+    for (size_t i = 0; i < size; i++) {
+        TEST_ASSERT_EQUAL_INT((uint8_t)(offset + i), pdu.payload[i]);
+    }
+}
+
+/*
+ * Server GET request for a resource larger than a block. Block size with the
+ * default GCOAP_PDU_BUF_SIZE is 64 bytes, SZX 2.
+ */
+static void test_gcoap__server_block2(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    size_t len;
+
+    _blk_writes = 0;
+    gcoap_register_listener(&_blk_listener);
+
+    /* first block without Block2 option; NUM 0, M 1, SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2", 0, 0, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x0a, 0, 64);
+
+    /* NUM 1, SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x12, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x1a, 64, 64);
+
+    /* NUM 1 of SZX 3 is too large; same offset as NUM 2, SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x13, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x2a, 128, 64);
+
+    /* smaller block size stays; NUM 5, SZX 0 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x50, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x58, 80, 16);
+
+    /* last block is short, without M bit; NUM 3, SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x32, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x32, 192, BLK_REPR_LEN - 192);
+
+    /* two byte option past the end; NUM 12 of SZX 4 is NUM 48 of SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x0c4, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x302, 0, 0);
+
+    /* last block is full, still without M bit; NUM 2, SZX 2 */
+    _blk_repr_len = 192;
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x22, 0));
+    len = _recv(buf, sizeof(buf));
+    _check_block2(buf, len, 0x22, 128, 64);
+    _blk_repr_len = BLK_REPR_LEN;
+
+    /* SZX 7 is reserved */
+    _inject(buf, _blk_request(buf, COAP_METHOD_GET, "/blk2",
+                              COAP_OPT_BLOCK2, 0x07, 0));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_BAD_OPTION, buf[1]);
+}
+
+/*
+ * Server PUT request in blocks. Test the response code and Block1 option for
+ * each block.
+ */
+static void test_gcoap__server_block1(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    size_t len;
+
+    _blk_writes = 0;
+    gcoap_register_listener(&_blk_listener);
+
+    /* NUM 0, M 1, SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_PUT, "/blk1",
+                              COAP_OPT_BLOCK1, 0x0a, 64));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTINUE, buf[1]);
+    TEST_ASSERT_EQUAL_INT(0x0a, _opt_value(buf, len, COAP_OPT_BLOCK1));
+    TEST_ASSERT_EQUAL_INT(1, _blk_writes);
+    TEST_ASSERT_EQUAL_INT(0, _blk_offset);
+    TEST_ASSERT_EQUAL_INT(64, _blk_len);
+    TEST_ASSERT(_blk_more);
+
+    /* last block, NUM 1, M 0, SZX 2 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_PUT, "/blk1",
+                              COAP_OPT_BLOCK1, 0x12, 10));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CHANGED, buf[1]);
+    TEST_ASSERT_EQUAL_INT(0x12, _opt_value(buf, len, COAP_OPT_BLOCK1));
+    TEST_ASSERT_EQUAL_INT(2, _blk_writes);
+    TEST_ASSERT_EQUAL_INT(64, _blk_offset);
+    TEST_ASSERT_EQUAL_INT(10, _blk_len);
+    TEST_ASSERT(!_blk_more);
+
+    /* too large for the buffer; echo NUM 0 with SZX 2 instead of 6 */
+    _inject(buf, _blk_request(buf, COAP_METHOD_PUT, "/blk1",
+                              COAP_OPT_BLOCK1, 0x06, 10));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CHANGED, buf[1]);
+    TEST_ASSERT_EQUAL_INT(0x02, _opt_value(buf, len, COAP_OPT_BLOCK1));
+
+    /* a block with M bit must be full */
+    _inject(buf, _blk_request(buf, COAP_METHOD_PUT, "/blk1",
+                              COAP_OPT_BLOCK1, 0x0a, 10));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_BAD_OPTION, buf[1]);
+    TEST_ASSERT_EQUAL_INT(3, _blk_writes);
+
+    /* without Block1, a single block */
+    _inject(buf, _blk_request(buf, COAP_METHOD_PUT, "/blk1", 0, 0, 10));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CHANGED, buf[1]);
+    TEST_ASSERT_EQUAL_INT(-1, _opt_value(buf, len, COAP_OPT_BLOCK1));
+    TEST_ASSERT_EQUAL_INT(4, _blk_writes);
+    TEST_ASSERT_EQUAL_INT(0, _blk_offset);
+    TEST_ASSERT(!_blk_more);
+}
+
+/*
+ * Server request larger than GCOAP_PDU_BUF_SIZE. Test the 4.13 response,
+ * which suggests a block size with Block1.
+ */
+static void test_gcoap__server_too_large(void)
+{
+    uint8_t req[GCOAP_PDU_BUF_SIZE + 64];
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    size_t len;
+
+    _blk_writes = 0;
+    gcoap_register_listener(&_blk_listener);
+
+    _inject(req, _blk_request(req, COAP_METHOD_PUT, "/blk1", 0, 0,
+                              GCOAP_PDU_BUF_SIZE));
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_REQUEST_ENTITY_TOO_LARGE, buf[1]);
+    TEST_ASSERT_EQUAL_INT(0x02, _opt_value(buf, len, COAP_OPT_BLOCK1));
+    TEST_ASSERT_EQUAL_INT(0, _blk_writes);
+}
+
+#ifdef MODULE_GCOAP_PROXY
+/*
+ * Forward proxy: the peer is both client and origin server. Requests to the
+ * proxy have a one byte token, upstream requests one of GCOAP_TOKENLEN.
+ */
+#define PROXY_ORIGIN    "coap://[fe80::1]:5684"
+#define PROXY_TOKEN     (0x7f)
+
+/* Writes a request with Proxy-Uri uri to buf; returns its length. */
+static size_t _proxy_request(uint8_t *buf, unsigned method, uint8_t token,
+                             const char *uri)
+{
+    static uint16_t id;
+    uint8_t *pos = buf;
+
+    pos += coap_build_hdr((coap_hdr_t *)buf, COAP_TYPE_NON, &token, 1,
+                          method, id++);
+    pos += coap_put_option(pos, 0, COAP_OPT_PROXY_URI, (uint8_t *)uri,
+                           strlen(uri));
+    return pos - buf;
+}
+
+/*
+ * Sends a GET request for uri to the proxy. Returns the length of the
+ * message gcoap sends in turn, either the upstream request or the response,
+ * or 0.
+ */
+static size_t _proxy_get(uint8_t *buf, size_t len, uint8_t token,
+                         const char *uri)
+{
+    _inject(buf, _proxy_request(buf, COAP_METHOD_GET, token, uri));
+    return _recv(buf, len);
+}
+
+/*
+ * Passes the response of the origin server to the upstream request req, with
+ * Max-Age max_age unless < 0, and payload_len bytes of payload.
+ */
+static void _origin_resp(uint8_t *req, unsigned code, int max_age,
+                         size_t payload_len)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu = { .hdr = (coap_hdr_t *)req };
+    bool con = (coap_get_type(&pdu) == COAP_TYPE_CON);
+    uint8_t age = max_age;
+    uint8_t *pos = buf;
+
+    pos += coap_build_hdr((coap_hdr_t *)buf,
+                          (con) ? COAP_TYPE_ACK : COAP_TYPE_NON,
+                          pdu.hdr->data, coap_get_token_len(&pdu), code,
+                          (con) ? coap_get_id(&pdu) : 0x1234);
+    pos += coap_put_option_ct(pos, 0, COAP_FORMAT_TEXT);
+    if (max_age >= 0) {
+        pos += coap_put_option(pos, COAP_OPT_CONTENT_FORMAT, COAP_OPT_MAX_AGE,
+                               &age, (age) ? 1 : 0);
+    }
+    if (payload_len) {
+        *pos++ = GCOAP_PAYLOAD_MARKER;
+        memset(pos, 'p', payload_len);
+        pos += payload_len;
+    }
+    _inject(buf, pos - buf);
+}
+
+/*
+ * Fetches uri through the proxy from the origin server, which responds with
+ * 2.05 as _origin_resp(). Returns the code of the response to the client, or
+ * -1 if none.
+ */
+static int _proxy_fetch(const char *uri, int max_age, size_t payload_len)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+
+    if (!_proxy_get(buf, sizeof(buf), PROXY_TOKEN, uri) ||
+        (buf[1] != COAP_METHOD_GET)) {
+        return -1;
+    }
+    _origin_resp(buf, COAP_CODE_CONTENT, max_age, payload_len);
+    if (!_recv(buf, sizeof(buf))) {
+        return -1;
+    }
+    return buf[1];
+}
+
+/* Returns the cache entry of the response fetched last. */
+static gcoap_proxy_entry_t *_proxy_last_entry(void)
+{
+    gcoap_proxy_entry_t *last = NULL;
+
+    for (int i = 0; i < GCOAP_PROXY_ENTRIES_MAX; i++) {
+        gcoap_proxy_entry_t *entry = &gcoap_get_state()->proxy_cache[i];
+        if (entry->data &&
+            (!last || ((int32_t)(entry->last_used - last->last_used) > 0))) {
+            last = entry;
+        }
+    }
+    return last;
+}
+
+/* Waits for the next microsecond, to order cache entries by last use. */
+static void _tick(void)
+{
+    uint32_t now = xtimer_now_usec();
+
+    while (xtimer_now_usec() == now) {}
+}
+
+/*
+ * Server request with Proxy-Uri. Test the responses to malformed URIs and
+ * unsupported requests, and the Uri-Path and Uri-Query options of the
+ * upstream request.
+ */
+static void test_gcoap__server_proxy_uri(void)
+{
+    static const char *malformed[] = {
+        "[fe80::1]/a",
+        "coap://fe80::1/a",
+        "coap://[fe80::1/a",
+        "coap://[fe80::g]/a",
+        "coap://[fe80::1]:/a",
+        "coap://[fe80::1]:0/a",
+        "coap://[fe80::1]:65536/a",
+        "coap://[fe80::1]a",
+        /* longer than GCOAP_PROXY_URI_MAXLEN */
+        PROXY_ORIGIN "/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    };
+    static const char *unsupported[] = {
+        "http://[fe80::1]/a",
+        "coaps://[fe80::1]/a",
+    };
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    size_t len;
+
+    for (unsigned i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        TEST_ASSERT(_proxy_get(buf, sizeof(buf), PROXY_TOKEN, malformed[i]) > 0);
+        TEST_ASSERT_EQUAL_INT(COAP_CODE_BAD_OPTION, buf[1]);
+    }
+    for (unsigned i = 0; i < sizeof(unsupported) / sizeof(unsupported[0]); i++) {
+        TEST_ASSERT(_proxy_get(buf, sizeof(buf), PROXY_TOKEN,
+                               unsupported[i]) > 0);
+        TEST_ASSERT_EQUAL_INT(COAP_CODE_PROXYING_NOT_SUPPORTED, buf[1]);
+    }
+
+    /* only GET */
+    _inject(buf, _proxy_request(buf, COAP_METHOD_PUT, PROXY_TOKEN,
+                                PROXY_ORIGIN "/a"));
+    TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_PROXYING_NOT_SUPPORTED, buf[1]);
+
+    /* default port */
+    _inject(buf, _proxy_request(buf, COAP_METHOD_GET, PROXY_TOKEN,
+                                "coap://[fe80::1]/a"));
+    len = _recv_to(buf, sizeof(buf), GCOAP_PORT);
+    TEST_ASSERT_EQUAL_INT(4 + GCOAP_TOKENLEN + 2, len);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+
+    /* path segments, skipping empty ones, and query parameters */
+    uint8_t opts[] = {
+        0xb1, 'a', 0x01, 'b', 0x43, 'x', '=', '1', 0x01, 'y'
+    };
+    len = _proxy_get(buf, sizeof(buf), PROXY_TOKEN, PROXY_ORIGIN "//a/b?x=1&y");
+    TEST_ASSERT_EQUAL_INT(4 + GCOAP_TOKENLEN + sizeof(opts), len);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&buf[4 + GCOAP_TOKENLEN], opts,
+                                    sizeof(opts)));
+}
+
+/*
+ * Server request with Proxy-Uri and other options. Test the options of the
+ * upstream request: the ones addressing the proxy dropped, the others kept,
+ * and Uri-Path and Uri-Query in order.
+ */
+static void test_gcoap__server_proxy_opts(void)
+{
+    static const char uri[] = PROXY_ORIGIN "/a?q";
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    uint8_t token = PROXY_TOKEN;
+    uint8_t val = 5;
+    uint8_t *pos = buf;
+    size_t len;
+
+    pos += coap_build_hdr((coap_hdr_t *)buf, COAP_TYPE_NON, &token, 1,
+                          COAP_METHOD_GET, 1);
+    /* If-Match, Uri-Host, ETag, Observe, Uri-Port, Accept, Size2 */
+    pos += coap_put_option(pos, 0, 1, (uint8_t *)"m", 1);
+    pos += coap_put_option(pos, 1, COAP_OPT_URI_HOST, (uint8_t *)"h", 1);
+    pos += coap_put_option(pos, COAP_OPT_URI_HOST, 4, (uint8_t *)"e", 1);
+    pos += coap_put_option(pos, 4, COAP_OPT_OBSERVE, NULL, 0);
+    pos += coap_put_option(pos, COAP_OPT_OBSERVE, COAP_OPT_URI_PORT, &val, 1);
+    pos += coap_put_option(pos, COAP_OPT_URI_PORT, 17, NULL, 0);
+    pos += coap_put_option(pos, 17, 28, &val, 1);
+    pos += coap_put_option(pos, 28, COAP_OPT_PROXY_URI, (uint8_t *)uri,
+                           sizeof(uri) - 1);
+    /* Proxy-Scheme, Size1 */
+    pos += coap_put_option(pos, COAP_OPT_PROXY_URI, COAP_OPT_PROXY_SCHEME,
+                           (uint8_t *)"coap", 4);
+    pos += coap_put_option(pos, COAP_OPT_PROXY_SCHEME, 60, &val, 1);
+    _inject(buf, pos - buf);
+
+    /* If-Match, ETag, Uri-Path, Uri-Query, Accept, Size2, Size1 */
+    uint8_t opts[] = {
+        0x11, 'm', 0x31, 'e', 0x71, 'a', 0x41, 'q', 0x20, 0xb1, 5,
+        0xd1, 60 - 28 - 13, 5
+    };
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(4 + GCOAP_TOKENLEN + sizeof(opts), len);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&buf[4 + GCOAP_TOKENLEN], opts,
+                                    sizeof(opts)));
+}
+
+/*
+ * Server request with Proxy-Uri for a cached response. Test the Max-Age of
+ * the response from the cache, and which responses are cached.
+ */
+static void test_gcoap__server_proxy_cache(void)
+{
+    uint8_t req[GCOAP_PDU_BUF_SIZE];
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    gcoap_proxy_stats_t stats;
+    int32_t age;
+    size_t len;
+
+    /* confirmable request is acknowledged, and forwarded as such */
+    len = _proxy_request(buf, COAP_METHOD_GET, PROXY_TOKEN, PROXY_ORIGIN "/a");
+    gcoap_hdr_set_type((coap_hdr_t *)buf, COAP_TYPE_CON);
+    _inject(buf, len);
+    TEST_ASSERT(_recv(req, sizeof(req)) > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, req[1]);
+    pdu.hdr = (coap_hdr_t *)req;
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_CON, coap_get_type(&pdu));
+    TEST_ASSERT_EQUAL_INT(4, _recv(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, buf[1]);
+
+    /* response relayed with the token of the client */
+    _origin_resp(req, COAP_CODE_CONTENT, 30, 1);
+    len = _recv(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&pdu, buf, len));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+    TEST_ASSERT_EQUAL_INT(PROXY_TOKEN, buf[4]);
+    TEST_ASSERT_EQUAL_INT(30, _opt_value(buf, len, COAP_OPT_MAX_AGE));
+    TEST_ASSERT_EQUAL_INT(1, pdu.payload_len);
+
+    /* from the cache, with the remaining Max-Age */
+    len = _proxy_get(buf, sizeof(buf), PROXY_TOKEN - 1, PROXY_ORIGIN "/a");
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&pdu, buf, len));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+    TEST_ASSERT_EQUAL_INT(PROXY_TOKEN - 1, buf[4]);
+    TEST_ASSERT_EQUAL_INT(COAP_FORMAT_TEXT, pdu.content_type);
+    age = _opt_value(buf, len, COAP_OPT_MAX_AGE);
+    TEST_ASSERT((age == 29) || (age == 30));
+    TEST_ASSERT_EQUAL_INT(1, pdu.payload_len);
+    TEST_ASSERT_EQUAL_INT('p', pdu.payload[0]);
+
+    _proxy_last_entry()->expires -= 10 * SEC_IN_USEC;
+    len = _proxy_get(buf, sizeof(buf), PROXY_TOKEN, PROXY_ORIGIN "/a");
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+    age = _opt_value(buf, len, COAP_OPT_MAX_AGE);
+    TEST_ASSERT((age == 19) || (age == 20));
+
+    gcoap_proxy_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, stats.hits);
+    TEST_ASSERT_EQUAL_INT(1, stats.misses);
+    TEST_ASSERT_EQUAL_INT(0, stats.coalesced);
+
+    /* stale response is fetched again */
+    _proxy_last_entry()->expires = xtimer_now_usec64();
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _proxy_fetch(PROXY_ORIGIN "/a", 30, 1));
+
+    /* without Max-Age, cached for the default; Max-Age added */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _proxy_fetch(PROXY_ORIGIN "/b", -1, 1));
+    len = _proxy_get(buf, sizeof(buf), PROXY_TOKEN, PROXY_ORIGIN "/b");
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+    age = _opt_value(buf, len, COAP_OPT_MAX_AGE);
+    TEST_ASSERT((age == GCOAP_PROXY_MAX_AGE_DEFAULT - 1) ||
+                (age == GCOAP_PROXY_MAX_AGE_DEFAULT));
+
+    /* not cached with Max-Age 0 */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _proxy_fetch(PROXY_ORIGIN "/c", 0, 1));
+    TEST_ASSERT(_proxy_get(buf, sizeof(buf), PROXY_TOKEN,
+                           PROXY_ORIGIN "/c") > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+
+    /* nor other than 2.05 */
+    _origin_resp(buf, COAP_CODE_404, 30, 0);
+    TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_404, buf[1]);
+    TEST_ASSERT(_proxy_get(buf, sizeof(buf), PROXY_TOKEN,
+                           PROXY_ORIGIN "/c") > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+
+    gcoap_proxy_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(3, stats.hits);
+    TEST_ASSERT_EQUAL_INT(6, stats.misses);
+}
+
+/* Responses in test_gcoap__server_proxy_evict() */
+#define PROXY_SEG_LEN       (GCOAP_PROXY_URI_MAXLEN - sizeof(PROXY_ORIGIN))
+#define PROXY_KEY_LEN       (2 + PROXY_SEG_LEN)
+/* Content-Format, payload marker, payload */
+#define PROXY_BODY_LEN(n)   (2 + (n))
+#define PROXY_ENTRY_LEN     (PROXY_KEY_LEN + PROXY_BODY_LEN(100))
+
+/* Returns a URI of GCOAP_PROXY_URI_MAXLEN with a path of c. */
+static const char *_proxy_long_uri(char c)
+{
+    static char uri[GCOAP_PROXY_URI_MAXLEN + 1];
+
+    memcpy(uri, PROXY_ORIGIN "/", sizeof(PROXY_ORIGIN));
+    memset(&uri[sizeof(PROXY_ORIGIN)], c, PROXY_SEG_LEN);
+    uri[GCOAP_PROXY_URI_MAXLEN] = '\0';
+    return uri;
+}
+
+/*
+ * Server requests with Proxy-Uri beyond the capacity of the cache. Test that
+ * the least recently used response is evicted, and the bytes in use.
+ */
+static void test_gcoap__server_proxy_evict(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    gcoap_state_t *state = gcoap_get_state();
+
+    /* three fit into GCOAP_PROXY_CACHE_SIZE */
+    TEST_ASSERT(4 * PROXY_ENTRY_LEN > GCOAP_PROXY_CACHE_SIZE);
+    TEST_ASSERT(3 * PROXY_ENTRY_LEN + PROXY_KEY_LEN <= GCOAP_PROXY_CACHE_SIZE);
+    for (char c = 'a'; c <= 'c'; c++) {
+        TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                              _proxy_fetch(_proxy_long_uri(c), -1, 100));
+        _tick();
+    }
+    TEST_ASSERT_EQUAL_INT(3 * PROXY_ENTRY_LEN, state->proxy_cache_used);
+
+    /* use a, so b is the least recently used */
+    _proxy_get(buf, sizeof(buf), PROXY_TOKEN, _proxy_long_uri('a'));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+    _tick();
+
+    /* response of d takes the space of b */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _proxy_fetch(_proxy_long_uri('d'), -1, 100));
+    TEST_ASSERT_EQUAL_INT(3 * PROXY_ENTRY_LEN, state->proxy_cache_used);
+    for (char c = 'a'; c <= 'd'; c++) {
+        if (c != 'b') {
+            _tick();
+            _proxy_get(buf, sizeof(buf), PROXY_TOKEN, _proxy_long_uri(c));
+            TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+        }
+    }
+    _proxy_get(buf, sizeof(buf), PROXY_TOKEN, _proxy_long_uri('b'));
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+    TEST_ASSERT_EQUAL_INT(3 * PROXY_ENTRY_LEN + PROXY_KEY_LEN,
+                          state->proxy_cache_used);
+    _origin_resp(buf, COAP_CODE_CONTENT, -1, 1);
+    TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+    TEST_ASSERT_EQUAL_INT(3 * PROXY_ENTRY_LEN + PROXY_KEY_LEN +
+                          PROXY_BODY_LEN(1), state->proxy_cache_used);
+    _tick();
+
+    /* all entries in use; e takes the one of a */
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT,
+                          _proxy_fetch(PROXY_ORIGIN "/e", -1, 1));
+    TEST_ASSERT_EQUAL_INT(2 * PROXY_ENTRY_LEN + PROXY_KEY_LEN +
+                          PROXY_BODY_LEN(1) + 2 + PROXY_BODY_LEN(1),
+                          state->proxy_cache_used);
+    _proxy_get(buf, sizeof(buf), PROXY_TOKEN, _proxy_long_uri('a'));
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+}
+
+/*
+ * Server requests with Proxy-Uri while the response is being fetched. Test
+ * that one upstream request serves all of them.
+ */
+static void test_gcoap__server_proxy_coalesce(void)
+{
+    uint8_t req[GCOAP_PDU_BUF_SIZE];
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    gcoap_proxy_stats_t stats;
+    unsigned tokens = 0;
+
+    TEST_ASSERT(_proxy_get(req, sizeof(req), 1, PROXY_ORIGIN "/a") > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, req[1]);
+    TEST_ASSERT_EQUAL_INT(0, _proxy_get(buf, sizeof(buf), 2,
+                                        PROXY_ORIGIN "/a"));
+    gcoap_proxy_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.misses);
+    TEST_ASSERT_EQUAL_INT(1, stats.coalesced);
+
+    /* both clients get the response */
+    _origin_resp(req, COAP_CODE_CONTENT, 30, 1);
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+        TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, buf[1]);
+        tokens |= 1 << buf[4];
+    }
+    TEST_ASSERT_EQUAL_INT((1 << 1) | (1 << 2), tokens);
+    TEST_ASSERT_EQUAL_INT(0, _recv(buf, sizeof(buf)));
+}
+
+/*
+ * Server request with Proxy-Uri, and no response of the origin server. Test
+ * the 5.04 response.
+ */
+static void test_gcoap__server_proxy_timeout(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+
+    TEST_ASSERT(_proxy_get(buf, sizeof(buf), PROXY_TOKEN,
+                           PROXY_ORIGIN "/a") > 0);
+    _expire();
+    TEST_ASSERT(_recv(buf, sizeof(buf)) > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_GATEWAY_TIMEOUT, buf[1]);
+    TEST_ASSERT_EQUAL_INT(PROXY_TOKEN, buf[4]);
+    TEST_ASSERT_EQUAL_INT(0, gcoap_get_state()->proxy_cache_used);
+
+    /* forwarded again */
+    TEST_ASSERT(_proxy_get(buf, sizeof(buf), PROXY_TOKEN,
+                           PROXY_ORIGIN "/a") > 0);
+    TEST_ASSERT_EQUAL_INT(COAP_METHOD_GET, buf[1]);
+}
+#endif /* MODULE_GCOAP_PROXY */
+
 Test *tests_gcoap_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -163,6 +1735,8 @@ Test *tests_gcoap_tests(void)
         new_TestFixture(test_gcoap__client_get_resp),
         new_TestFixture(test_gcoap__server_get_req),
         new_TestFixture(test_gcoap__server_get_resp),
+        new_TestFixture(test_gcoap__server_con_resp),
+        new_TestFixture(test_gcoap__server_obs_init_unused),
     };
 
     EMB_UNIT_TESTCALLER(gcoap_tests, NULL, NULL, fixtures);
@@ -170,8 +1744,44 @@ Test *tests_gcoap_tests(void)
     return (Test *)&gcoap_tests;
 }
 
+Test *tests_gcoap_server_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_gcoap__server_index),
+        new_TestFixture(test_gcoap__server_index_full),
+        new_TestFixture(test_gcoap__client_send_fail),
+        new_TestFixture(test_gcoap__client_con_rto_strong),
+        new_TestFixture(test_gcoap__client_con_rto_weak),
+        new_TestFixture(test_gcoap__client_con_rto_aging),
+        new_TestFixture(test_gcoap__client_con_timeout),
+        new_TestFixture(test_gcoap__client_con_timeout_many),
+        new_TestFixture(test_gcoap__client_con_separate),
+        new_TestFixture(test_gcoap__client_con_reset),
+        new_TestFixture(test_gcoap__server_dup),
+        new_TestFixture(test_gcoap__server_obs_register),
+        new_TestFixture(test_gcoap__server_obs_notify),
+        new_TestFixture(test_gcoap__server_obs_deregister),
+        new_TestFixture(test_gcoap__server_block2),
+        new_TestFixture(test_gcoap__server_block1),
+        new_TestFixture(test_gcoap__server_too_large),
+#ifdef MODULE_GCOAP_PROXY
+        new_TestFixture(test_gcoap__server_proxy_uri),
+        new_TestFixture(test_gcoap__server_proxy_opts),
+        new_TestFixture(test_gcoap__server_proxy_cache),
+        new_TestFixture(test_gcoap__server_proxy_evict),
+        new_TestFixture(test_gcoap__server_proxy_coalesce),
+        new_TestFixture(test_gcoap__server_proxy_timeout),
+#endif
+    };
+
+    EMB_UNIT_TESTCALLER(gcoap_server_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&gcoap_server_tests;
+}
+
 void tests_gcoap(void)
 {
     TESTS_RUN(tests_gcoap_tests());
+    TESTS_RUN(tests_gcoap_server_tests());
 }
 /** @} */
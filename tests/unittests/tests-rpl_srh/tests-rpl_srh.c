@@ -11,6 +11,7 @@
  *
  * @file
  */
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include "embUnit.h"
@@ -19,6 +20,9 @@
 #include "net/ipv6/ext.h"
 #include "net/ipv6/hdr.h"
 #include "net/gnrc/rpl/srh.h"
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+#include "net/fib.h"
+#endif
 
 #include "unittests-constants.h"
 #include "tests-rpl_srh.h"
@@ -35,6 +39,14 @@
                                0x00, 0x00, 0x00, 0x00, \
                                0x00, 0x00, 0x00, 0x00, \
                                0x00, 0x00, 0x00, 0x03 }}
+#define IPV6_ADDR3          {{ 0x20, 0x01, 0xab, 0xcd, \
+                               0x00, 0x00, 0x00, 0x00, \
+                               0x00, 0x00, 0x00, 0x00, \
+                               0x00, 0x00, 0x00, 0x04 }}
+#define IPV6_OTHER_PREFIX   {{ 0x20, 0x01, 0xab, 0xcd, \
+                               0x00, 0x00, 0x00, 0x01, \
+                               0x00, 0x00, 0x00, 0x00, \
+                               0x00, 0x00, 0x00, 0x01 }}
 
 #define IPV6_ADDR1_ELIDED   { 0x00, 0x00, 0x02 }
 #define IPV6_ADDR2_ELIDED   { 0x00, 0x00, 0x03 }
@@ -105,11 +117,125 @@ static void test_rpl_srh_nexthop_prefix_elided(void)
     TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &expected2));
 }
 
+static void test_rpl_srh_build(void)
+{
+    ipv6_hdr_t hdr;
+    uint8_t buf[sizeof(gnrc_rpl_srh_t) + 2 * sizeof(ipv6_addr_t)];
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *) buf;
+    ipv6_addr_t route[] = { IPV6_ADDR1, IPV6_ADDR2, IPV6_DST };
+    int res;
+
+    res = gnrc_rpl_srh_build(route, 3, buf, sizeof(buf));
+    /* two addresses with 15 octets elided and 6 octets padding */
+    TEST_ASSERT_EQUAL_INT(16, res);
+    TEST_ASSERT_EQUAL_INT(1, srh->len);
+    TEST_ASSERT_EQUAL_INT(GNRC_RPL_SRH_TYPE, srh->type);
+    TEST_ASSERT_EQUAL_INT(SRH_SEG_LEFT, srh->seg_left);
+    TEST_ASSERT_EQUAL_INT(0xFF, srh->compr);
+    TEST_ASSERT_EQUAL_INT(6 << 4, srh->pad_resv);
+
+    hdr.dst = route[0];
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_FORWARD, gnrc_rpl_srh_process(&hdr, srh));
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &route[1]));
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_FORWARD, gnrc_rpl_srh_process(&hdr, srh));
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &route[2]));
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_OK, gnrc_rpl_srh_process(&hdr, srh));
+
+    TEST_ASSERT_EQUAL_INT(-EINVAL, gnrc_rpl_srh_build(route, 1, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, gnrc_rpl_srh_build(route, 3, buf, 8));
+}
+
+static void test_rpl_srh_build_other_prefix(void)
+{
+    ipv6_hdr_t hdr;
+    uint8_t buf[sizeof(gnrc_rpl_srh_t) + 2 * sizeof(ipv6_addr_t)];
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *) buf;
+    ipv6_addr_t route[] = { IPV6_ADDR1, IPV6_ADDR2, IPV6_OTHER_PREFIX };
+
+    /* the destination only shares the first 7 octets */
+    TEST_ASSERT_EQUAL_INT(24, gnrc_rpl_srh_build(route, 3, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT((15 << 4) | 7, srh->compr);
+    TEST_ASSERT_EQUAL_INT(sizeof(gnrc_rpl_srh_t) + 1 + 9,
+                          (srh->len + 1) * 8 - (srh->pad_resv >> 4));
+
+    hdr.dst = route[0];
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_FORWARD, gnrc_rpl_srh_process(&hdr, srh));
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &route[1]));
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_FORWARD, gnrc_rpl_srh_process(&hdr, srh));
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &route[2]));
+}
+
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+#define TEST_MAX_FIB_SR         (4)
+
+static fib_sr_t _sr_headers[TEST_MAX_FIB_SR];
+static fib_sr_entry_t _sr_datapool[TEST_MAX_FIB_SR * 4];
+static fib_sr_meta_t _entries_sr = { .headers = _sr_headers,
+                                     .entry_pool = _sr_datapool,
+                                     .entry_pool_size = TEST_MAX_FIB_SR * 4 };
+static fib_table_t _sr_table;
+
+static void test_rpl_srh_cache(void)
+{
+    ipv6_hdr_t hdr;
+    uint8_t buf[sizeof(gnrc_rpl_srh_t) + 2 * sizeof(ipv6_addr_t)];
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *) buf;
+    ipv6_addr_t a1 = IPV6_ADDR1, a2 = IPV6_ADDR2, a3 = IPV6_ADDR3, dst = IPV6_DST;
+    ipv6_addr_t next_hop;
+    fib_sr_t *sr;
+
+    _sr_table.data.source_routes = &_entries_sr;
+    _sr_table.table_type = FIB_TABLE_TYPE_SR;
+    _sr_table.size = TEST_MAX_FIB_SR;
+    mutex_init(&(_sr_table.mtx_access));
+    _sr_table.notify_rp_pos = 0;
+    fib_init(&_sr_table);
+    gnrc_rpl_srh_cache_invalidate(NULL);
+
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
+                          gnrc_rpl_srh_cache_get(&_sr_table, &dst, &next_hop, buf, sizeof(buf)));
+
+    TEST_ASSERT_EQUAL_INT(0, fib_sr_create(&_sr_table, &sr, 42, 0, 10000));
+    TEST_ASSERT_EQUAL_INT(0, fib_sr_entry_append(&_sr_table, sr, a1.u8, sizeof(a1)));
+    TEST_ASSERT_EQUAL_INT(0, fib_sr_entry_append(&_sr_table, sr, a2.u8, sizeof(a2)));
+    TEST_ASSERT_EQUAL_INT(0, fib_sr_entry_append(&_sr_table, sr, dst.u8, sizeof(dst)));
+
+    TEST_ASSERT_EQUAL_INT(16, gnrc_rpl_srh_cache_get(&_sr_table, &dst, &next_hop,
+                                                     buf, sizeof(buf)));
+    TEST_ASSERT(ipv6_addr_equal(&next_hop, &a1));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, gnrc_rpl_srh_cache_get(&_sr_table, &dst, &next_hop,
+                                                           buf, 8));
+
+    /* the cached header stays in use until the route is invalidated */
+    TEST_ASSERT_EQUAL_INT(0, fib_sr_entry_overwrite(&_sr_table, sr, a2.u8, sizeof(a2),
+                                                    a3.u8, sizeof(a3)));
+    TEST_ASSERT_EQUAL_INT(16, gnrc_rpl_srh_cache_get(&_sr_table, &dst, &next_hop,
+                                                     buf, sizeof(buf)));
+    hdr.dst = next_hop;
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_FORWARD, gnrc_rpl_srh_process(&hdr, srh));
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &a2));
+
+    gnrc_rpl_srh_cache_invalidate(&a2);
+    TEST_ASSERT_EQUAL_INT(16, gnrc_rpl_srh_cache_get(&_sr_table, &dst, &next_hop,
+                                                     buf, sizeof(buf)));
+    hdr.dst = next_hop;
+    TEST_ASSERT_EQUAL_INT(EXT_RH_CODE_FORWARD, gnrc_rpl_srh_process(&hdr, srh));
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &a3));
+
+    fib_deinit(&_sr_table);
+}
+#endif
+
 Test *tests_rpl_srh_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
         new_TestFixture(test_rpl_srh_nexthop_no_prefix_elided),
         new_TestFixture(test_rpl_srh_nexthop_prefix_elided),
+        new_TestFixture(test_rpl_srh_build),
+        new_TestFixture(test_rpl_srh_build_other_prefix),
+#ifdef MODULE_GNRC_RPL_SRH_CACHE
+        new_TestFixture(test_rpl_srh_cache),
+#endif
     };
 
     EMB_UNIT_TESTCALLER(rpl_srh_tests, NULL, NULL, fixtures);
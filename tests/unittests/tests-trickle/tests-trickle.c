@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include <string.h>
+
+#include "embUnit.h"
+#include "thread.h"
+#include "trickle.h"
+
+#include "tests-trickle.h"
+
+#define TRICKLE_MSG_INTERVAL    (0xfff0)
+#define TRICKLE_MSG_CALLBACK    (0xfff1)
+/* long enough for no timer to fire while a test runs */
+#define TRICKLE_IMIN            (1U << 16)
+#define TRICKLE_IMAX            (8U)
+/* trickle_start() is random in the interval, so probe its bounds repeatedly */
+#define TRICKLE_ROUNDS          (32U)
+
+static trickle_t _trickle;
+static unsigned _calls;
+
+static void _callback(void *args)
+{
+    (void)args;
+    _calls++;
+}
+
+static void set_up(void)
+{
+    memset(&_trickle, 0, sizeof(_trickle));
+    _trickle.callback.func = _callback;
+    _calls = 0;
+}
+
+static void tear_down(void)
+{
+    trickle_stop(&_trickle);
+}
+
+static void _start(uint8_t k)
+{
+    trickle_start(thread_getpid(), &_trickle, TRICKLE_MSG_INTERVAL,
+                  TRICKLE_MSG_CALLBACK, TRICKLE_IMIN, TRICKLE_IMAX, k);
+}
+
+static void _interval(uint16_t c)
+{
+    _trickle.c = c;
+    trickle_interval(&_trickle);
+}
+
+static void test_trickle_stats(void)
+{
+    _start(2);
+    trickle_callback(&_trickle);
+    TEST_ASSERT_EQUAL_INT(1, _calls);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.transmitted);
+    TEST_ASSERT_EQUAL_INT(0, _trickle.stats.suppressed);
+
+    trickle_increment_counter(&_trickle);
+    trickle_increment_counter(&_trickle);
+    trickle_callback(&_trickle);
+    TEST_ASSERT_EQUAL_INT(1, _calls);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.transmitted);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.suppressed);
+
+    trickle_reset_timer(&_trickle);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.resets);
+    TEST_ASSERT_EQUAL_INT(0, _trickle.c);
+    trickle_reset_timer(&_trickle);
+    TEST_ASSERT_EQUAL_INT(2, _trickle.stats.resets);
+    /* trickle_start() keeps the statistics */
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.transmitted);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.suppressed);
+}
+
+static void test_trickle_stats_k_infinite(void)
+{
+    _start(0);
+    _trickle.c = 100;
+    trickle_callback(&_trickle);
+    TEST_ASSERT_EQUAL_INT(1, _calls);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.transmitted);
+    TEST_ASSERT_EQUAL_INT(0, _trickle.stats.suppressed);
+}
+
+static void test_trickle_ewma_heard(void)
+{
+    _start(1);
+    /* a sample enters with a weight of 1/8, in units of 1/8 */
+    _interval(1);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.adaptive.heard);
+    /* c messages every interval settle at c * 8 */
+    for (unsigned i = 0; i < 64; i++) {
+        _interval(3);
+    }
+    TEST_ASSERT_EQUAL_INT(3 * 8, _trickle.adaptive.heard);
+    _interval(3);
+    TEST_ASSERT_EQUAL_INT(3 * 8, _trickle.adaptive.heard);
+    _interval(0);
+    TEST_ASSERT_EQUAL_INT(3 * 8 - 3, _trickle.adaptive.heard);
+}
+
+static void test_trickle_ewma_heard_capped(void)
+{
+    _start(1);
+    _interval(1000);
+    TEST_ASSERT_EQUAL_INT(UINT8_MAX, _trickle.adaptive.heard);
+}
+
+static void test_trickle_ewma_suppression(void)
+{
+    _start(1);
+    for (unsigned i = 0; i < 64; i++) {
+        _trickle.c = 1;
+        trickle_callback(&_trickle);
+    }
+    /* suppressing every callback settles at 256/256 */
+    TEST_ASSERT_EQUAL_INT(256, _trickle.adaptive.suppression);
+    TEST_ASSERT_EQUAL_INT(64, _trickle.stats.suppressed);
+    _trickle.c = 0;
+    trickle_callback(&_trickle);
+    TEST_ASSERT_EQUAL_INT(256 - 32, _trickle.adaptive.suppression);
+}
+
+static void test_trickle_ewma_inconsistency(void)
+{
+    _start(1);
+    trickle_reset_timer(&_trickle);
+    TEST_ASSERT_EQUAL_INT(32, _trickle.adaptive.inconsistency);
+    trickle_reset_timer(&_trickle);
+    TEST_ASSERT_EQUAL_INT(32 - 4 + 32, _trickle.adaptive.inconsistency);
+    _interval(0);
+    TEST_ASSERT_EQUAL_INT(60 - 7, _trickle.adaptive.inconsistency);
+}
+
+static void test_trickle_k_density(void)
+{
+    _start(4);
+    /* exactly TRICKLE_ADAPTIVE_DENSITY neighbors keep k */
+    _trickle.adaptive.heard = TRICKLE_ADAPTIVE_DENSITY * 8;
+    _interval(TRICKLE_ADAPTIVE_DENSITY);
+    TEST_ASSERT_EQUAL_INT(TRICKLE_ADAPTIVE_DENSITY * 8, _trickle.adaptive.heard);
+    TEST_ASSERT_EQUAL_INT(4, trickle_get_k(&_trickle));
+
+    /* twice as many halve it */
+    _trickle.adaptive.heard = TRICKLE_ADAPTIVE_DENSITY * 2 * 8;
+    _interval(TRICKLE_ADAPTIVE_DENSITY * 2);
+    TEST_ASSERT_EQUAL_INT(2, trickle_get_k(&_trickle));
+    TEST_ASSERT_EQUAL_INT(4, _trickle.k);
+}
+
+static void test_trickle_k_density_suppressed(void)
+{
+    _start(4);
+    /* hearing TRICKLE_ADAPTIVE_DENSITY while sending only every other
+     * interval means twice as many neighbors */
+    _trickle.adaptive.heard = TRICKLE_ADAPTIVE_DENSITY * 8;
+    _trickle.adaptive.suppression = 128;
+    _interval(TRICKLE_ADAPTIVE_DENSITY);
+    TEST_ASSERT_EQUAL_INT(2, trickle_get_k(&_trickle));
+}
+
+static void test_trickle_k_min(void)
+{
+    _start(4);
+    _trickle.adaptive.heard = UINT8_MAX * 8;
+    _interval(UINT8_MAX);
+    TEST_ASSERT_EQUAL_INT(1, trickle_get_k(&_trickle));
+    _trickle.c = 1;
+    trickle_callback(&_trickle);
+    TEST_ASSERT_EQUAL_INT(1, _trickle.stats.suppressed);
+}
+
+static void test_trickle_k_infinite(void)
+{
+    _start(0);
+    _trickle.adaptive.heard = UINT8_MAX * 8;
+    _interval(UINT8_MAX);
+    TEST_ASSERT_EQUAL_INT(0, trickle_get_k(&_trickle));
+}
+
+static void test_trickle_imin_sparse(void)
+{
+    _start(1);
+    /* exactly TRICKLE_ADAPTIVE_DENSITY neighbors are not dense yet */
+    _trickle.adaptive.heard = TRICKLE_ADAPTIVE_DENSITY * 8;
+    /* the third reset in a row crosses TRICKLE_ADAPTIVE_INCONSISTENT */
+    trickle_reset_timer(&_trickle);
+    trickle_reset_timer(&_trickle);
+    TEST_ASSERT(_trickle.adaptive.inconsistency < TRICKLE_ADAPTIVE_INCONSISTENT);
+    for (unsigned i = 0; i < TRICKLE_ROUNDS; i++) {
+        _start(1);
+        TEST_ASSERT(_trickle.I >= 2 * TRICKLE_IMIN);
+        TEST_ASSERT(_trickle.I < 10 * TRICKLE_IMIN);
+    }
+    trickle_reset_timer(&_trickle);
+    TEST_ASSERT(_trickle.adaptive.inconsistency >= TRICKLE_ADAPTIVE_INCONSISTENT);
+    for (unsigned i = 0; i < TRICKLE_ROUNDS; i++) {
+        _start(1);
+        TEST_ASSERT(_trickle.I >= TRICKLE_IMIN);
+        TEST_ASSERT(_trickle.I < 5 * TRICKLE_IMIN);
+    }
+    /* Imin is what was configured, only the interval is halved */
+    TEST_ASSERT_EQUAL_INT(TRICKLE_IMIN, _trickle.Imin);
+}
+
+static void test_trickle_imin_dense(void)
+{
+    _start(1);
+    _trickle.adaptive.heard = TRICKLE_ADAPTIVE_DENSITY * 2 * 8;
+    for (unsigned i = 0; i < TRICKLE_ROUNDS; i++) {
+        _start(1);
+        TEST_ASSERT(_trickle.I >= 2 * TRICKLE_IMIN);
+        TEST_ASSERT(_trickle.I < 10 * TRICKLE_IMIN);
+    }
+    _trickle.adaptive.inconsistency = TRICKLE_ADAPTIVE_INCONSISTENT;
+    for (unsigned i = 0; i < TRICKLE_ROUNDS; i++) {
+        _start(1);
+        TEST_ASSERT(_trickle.I >= 4 * TRICKLE_IMIN);
+        TEST_ASSERT(_trickle.I < 20 * TRICKLE_IMIN);
+    }
+    TEST_ASSERT_EQUAL_INT(TRICKLE_IMIN, _trickle.Imin);
+}
+
+static void test_trickle_imin_recover(void)
+{
+    _start(1);
+    _trickle.adaptive.inconsistency = TRICKLE_ADAPTIVE_INCONSISTENT;
+    /* consistent intervals let the inconsistency decay below the threshold */
+    _interval(0);
+    TEST_ASSERT(_trickle.adaptive.inconsistency < TRICKLE_ADAPTIVE_INCONSISTENT);
+    for (unsigned i = 0; i < TRICKLE_ROUNDS; i++) {
+        _start(1);
+        TEST_ASSERT(_trickle.I >= 2 * TRICKLE_IMIN);
+        TEST_ASSERT(_trickle.I < 10 * TRICKLE_IMIN);
+    }
+}
+
+Test *tests_trickle_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_trickle_stats),
+        new_TestFixture(test_trickle_stats_k_infinite),
+        new_TestFixture(test_trickle_ewma_heard),
+        new_TestFixture(test_trickle_ewma_heard_capped),
+        new_TestFixture(test_trickle_ewma_suppression),
+        new_TestFixture(test_trickle_ewma_inconsistency),
+        new_TestFixture(test_trickle_k_density),
+        new_TestFixture(test_trickle_k_density_suppressed),
+        new_TestFixture(test_trickle_k_min),
+        new_TestFixture(test_trickle_k_infinite),
+        new_TestFixture(test_trickle_imin_sparse),
+        new_TestFixture(test_trickle_imin_dense),
+        new_TestFixture(test_trickle_imin_recover),
+    };
+
+    EMB_UNIT_TESTCALLER(trickle_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&trickle_tests;
+}
+
+void tests_trickle(void)
+{
+    TESTS_RUN(tests_trickle_tests());
+}
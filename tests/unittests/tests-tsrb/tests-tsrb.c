@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit.h"
+#include "tsrb.h"
+
+#include "tests-tsrb.h"
+
+#define BUF_SIZE    (8U)
+
+static char buf[BUF_SIZE];
+static tsrb_t rb;
+
+static void set_up(void)
+{
+    tsrb_init(&rb, buf, sizeof(buf));
+}
+
+static void test_tsrb_one(void)
+{
+    TEST_ASSERT_EQUAL_INT(-1, tsrb_get_one(&rb));
+    TEST_ASSERT_EQUAL_INT(0, tsrb_add_one(&rb, 'a'));
+    TEST_ASSERT_EQUAL_INT(1, tsrb_avail(&rb));
+    TEST_ASSERT_EQUAL_INT('a', tsrb_get_one(&rb));
+    TEST_ASSERT(tsrb_empty(&rb));
+}
+
+static void test_tsrb_bulk_wrap_around(void)
+{
+    char out[BUF_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(6, tsrb_add(&rb, "012345", 6));
+    TEST_ASSERT_EQUAL_INT(6, tsrb_get(&rb, out, sizeof(out)));
+
+    /* content now wraps around the end of buf */
+    TEST_ASSERT_EQUAL_INT(BUF_SIZE, tsrb_add(&rb, "abcdefghij", 10));
+    TEST_ASSERT(tsrb_full(&rb));
+    TEST_ASSERT_EQUAL_INT(-1, tsrb_add_one(&rb, 'x'));
+    TEST_ASSERT_EQUAL_INT(3, tsrb_get(&rb, out, 3));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(out, "abc", 3));
+    TEST_ASSERT_EQUAL_INT(5, tsrb_get(&rb, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(out, "defgh", 5));
+    TEST_ASSERT_EQUAL_INT(0, tsrb_get(&rb, out, sizeof(out)));
+}
+
+static void test_tsrb_span(void)
+{
+    char *data;
+
+    tsrb_add(&rb, "012345", 6);
+    TEST_ASSERT_EQUAL_INT(6, tsrb_peek_span(&rb, &data));
+    TEST_ASSERT(data == &buf[0]);
+    tsrb_commit_read(&rb, 5);
+
+    /* only the two bytes till the end of buf are contiguous */
+    TEST_ASSERT_EQUAL_INT(2, tsrb_reserve_span(&rb, &data));
+    TEST_ASSERT(data == &buf[6]);
+    memcpy(data, "ab", 2);
+    tsrb_commit_write(&rb, 2);
+    TEST_ASSERT_EQUAL_INT(5, tsrb_reserve_span(&rb, &data));
+    TEST_ASSERT(data == &buf[0]);
+    memcpy(data, "cd", 2);
+    tsrb_commit_write(&rb, 2);
+
+    TEST_ASSERT_EQUAL_INT(5, tsrb_avail(&rb));
+    TEST_ASSERT_EQUAL_INT(3, tsrb_peek_span(&rb, &data));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, "5ab", 3));
+    tsrb_commit_read(&rb, 3);
+    TEST_ASSERT_EQUAL_INT(2, tsrb_peek_span(&rb, &data));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, "cd", 2));
+    tsrb_commit_read(&rb, 2);
+    TEST_ASSERT(tsrb_empty(&rb));
+}
+
+Test *tests_tsrb_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_tsrb_one),
+        new_TestFixture(test_tsrb_bulk_wrap_around),
+        new_TestFixture(test_tsrb_span),
+    };
+
+    EMB_UNIT_TESTCALLER(tsrb_tests, set_up, NULL, fixtures);
+
+    return (Test *)&tsrb_tests;
+}
+
+void tests_tsrb(void)
+{
+    TESTS_RUN(tests_tsrb_tests());
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "tests-ubjson.h"
+#include "struct_codec.h"
+
+typedef struct {
+    int32_t temp;
+    uint32_t seq;
+    char name[8];
+    float ratio;
+    bool alarm;
+    int64_t uptime;
+    uint64_t id;
+} test_ubjson_codec_t;
+
+#define TEST_UBJSON_CODEC_FIELDS(X, T) \
+    X(T, INT32, temp)                  \
+    X(T, UINT32, seq)                  \
+    X(T, TEXT, name)                   \
+    X(T, FLOAT, ratio)                 \
+    X(T, BOOL, alarm)                  \
+    X(T, INT64, uptime)                \
+    X(T, UINT64, id)
+
+STRUCT_CODEC(test_ubjson_codec, test_ubjson_codec_t, TEST_UBJSON_CODEC_FIELDS);
+
+typedef struct {
+    int32_t temp;
+    char name[8];
+    float ratio;
+} test_ubjson_codec_small_t;
+
+#define TEST_UBJSON_CODEC_SMALL_FIELDS(X, T) \
+    X(T, INT32, temp)                        \
+    X(T, TEXT, name)                         \
+    X(T, FLOAT, ratio)
+
+STRUCT_CODEC(test_ubjson_codec_small, test_ubjson_codec_small_t,
+             TEST_UBJSON_CODEC_SMALL_FIELDS);
+
+static uint8_t test_ubjson_codec_buf[64];
+static size_t test_ubjson_codec_pos;
+
+static ssize_t test_ubjson_codec_write(ubjson_cookie_t *restrict cookie,
+                                       const void *buf, size_t len)
+{
+    (void) cookie;
+    if (test_ubjson_codec_pos + len > sizeof(test_ubjson_codec_buf)) {
+        return -1;
+    }
+    memcpy(&test_ubjson_codec_buf[test_ubjson_codec_pos], buf, len);
+    test_ubjson_codec_pos += len;
+    return len;
+}
+
+void test_ubjson_codec_hand_written(void)
+{
+    const test_ubjson_codec_small_t val = { -300, "abc", 0.5f };
+    uint8_t buf[sizeof(test_ubjson_codec_buf)];
+    ubjson_cookie_t cookie;
+
+    test_ubjson_codec_pos = 0;
+    ubjson_write_init(&cookie, test_ubjson_codec_write);
+    ubjson_open_object(&cookie);
+    ubjson_write_key(&cookie, "temp", 4);
+    ubjson_write_i32(&cookie, val.temp);
+    ubjson_write_key(&cookie, "name", 4);
+    ubjson_write_string(&cookie, val.name, strlen(val.name));
+    ubjson_write_key(&cookie, "ratio", 5);
+    ubjson_write_float(&cookie, val.ratio);
+    ubjson_close_object(&cookie);
+
+    TEST_ASSERT_EQUAL_INT(test_ubjson_codec_pos,
+                          ubjson_codec_size(&test_ubjson_codec_small, &val));
+    TEST_ASSERT_EQUAL_INT(test_ubjson_codec_pos,
+                          ubjson_codec_encode(&test_ubjson_codec_small, &val,
+                                              buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(test_ubjson_codec_buf, buf, test_ubjson_codec_pos));
+}
+
+void test_ubjson_codec_round_trip(void)
+{
+    const test_ubjson_codec_t val = {
+        .temp = INT32_MIN, .seq = UINT32_MAX, .name = "sensor", .ratio = -1.25f,
+        .alarm = true, .uptime = -(1LL << 40), .id = (1ULL << 62),
+    };
+    test_ubjson_codec_t res;
+    uint8_t buf[128];
+    ssize_t len;
+
+    len = ubjson_codec_encode(&test_ubjson_codec, &val, buf, sizeof(buf));
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, ubjson_codec_encode(&test_ubjson_codec, &val,
+                                                        buf, len - 1));
+
+    memset(&res, 0, sizeof(res));
+    TEST_ASSERT_EQUAL_INT(len, ubjson_codec_decode(&test_ubjson_codec, &res, buf, len));
+    TEST_ASSERT_EQUAL_INT(val.temp, res.temp);
+    TEST_ASSERT(val.seq == res.seq);
+    TEST_ASSERT_EQUAL_STRING((char *)val.name, (char *)res.name);
+    TEST_ASSERT(val.ratio == res.ratio);
+    TEST_ASSERT(res.alarm);
+    TEST_ASSERT(val.uptime == res.uptime);
+    TEST_ASSERT(val.id == res.id);
+
+    /* truncated input */
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, ubjson_codec_decode(&test_ubjson_codec, &res,
+                                                        buf, len - 1));
+}
@@ -45,6 +45,8 @@ void test_ubjson_test(void (*sender_fun)(void), void (*receiver_fun)(void));
 
 void test_ubjson_empty_array(void);
 void test_ubjson_empty_object(void);
+void test_ubjson_codec_hand_written(void);
+void test_ubjson_codec_round_trip(void);
 
 #ifdef __cplusplus
 }